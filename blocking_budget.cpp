@@ -0,0 +1,105 @@
+/*
+  Project Name:   Powered Air Quality
+  Description:    per subsystem blocking time budgets (see blocking_budget.h)
+*/
+
+#include "Arduino.h"
+#include <esp_task_wdt.h>
+
+#include "config.h"               // budgets, watchdog and network timeouts
+#include "blocking_budget.h"
+
+// Shared helper function
+extern void debugMessage(String messageText, uint8_t messageLevel);
+
+const char* const budgetName[kBudgetCount] = {"sensors", "influx", "thingspeak", "mqtt", "owm", "wifi"};
+
+namespace {
+  BudgetStats stats[kBudgetCount] = {
+    {budgetSensorsMS, 0, 0, 0, ""},
+    {budgetInfluxMS, 0, 0, 0, ""},
+    {budgetThingSpeakMS, 0, 0, 0, ""},
+    {budgetMQTTMS, 0, 0, 0, ""},
+    {budgetOWMMS, 0, 0, 0, ""},
+    {budgetWiFiMS, 0, 0, 0, ""},
+  };
+  uint32_t startMS[kBudgetCount];
+  bool watchdogActive = false;
+}
+
+void budgetWatchdogBegin()
+{
+  esp_task_wdt_config_t config;
+  config.timeout_ms = timeWatchdogMS;
+  config.idle_core_mask = 1 << 0;  // keep watching the core 0 idle task, as the core does by default
+  config.trigger_panic = true;     // panic and reboot
+  // the core may or may not have started the watchdog already
+  esp_err_t error = esp_task_wdt_reconfigure(&config);
+  if (error == ESP_ERR_INVALID_STATE) error = esp_task_wdt_init(&config);
+  // subscribe the loop task, unless it already is
+  if (error == ESP_OK && esp_task_wdt_status(NULL) != ESP_OK) error = esp_task_wdt_add(NULL);
+  watchdogActive = (error == ESP_OK);
+  if (watchdogActive)
+    debugMessage(String("Task watchdog armed for loop(), ") + (timeWatchdogMS/1000) + " second timeout",1);
+  else
+    debugMessage(String("Task watchdog setup failed, error ") + error,1);
+}
+
+void budgetWatchdogAdd()
+{
+  if (!watchdogActive || esp_task_wdt_status(NULL) == ESP_OK) return;
+  const esp_err_t error = esp_task_wdt_add(NULL);
+  if (error != ESP_OK) debugMessage(String("Task watchdog subscription failed, error ") + error,1);
+}
+
+void budgetWatchdogFeed()
+{
+  if (watchdogActive) esp_task_wdt_reset();
+}
+
+void budgetStart(uint8_t subsystem)
+{
+  budgetWatchdogFeed();
+  startMS[subsystem] = millis();
+}
+
+bool budgetEnd(uint8_t subsystem, const char* culprit)
+{
+  budgetWatchdogFeed();
+  const uint32_t elapsedMS = millis() - startMS[subsystem];
+  BudgetStats& budget = stats[subsystem];
+  budget.runs++;
+  if (elapsedMS > budget.worstMS) {
+    budget.worstMS = elapsedMS;
+    budget.worstCulprit = culprit;
+  }
+  if (elapsedMS <= budget.budgetMS) return true;
+
+  budget.overruns++;
+  debugMessage(String("Budget overrun: ") + budgetName[subsystem] + " " + culprit + " blocked " + elapsedMS
+    + " ms, budget " + budget.budgetMS + " ms (" + budget.overruns + " overruns)",1);
+  return false;
+}
+
+bool budgetTransferOpen(uint8_t subsystem)
+{
+  if (millis() - startMS[subsystem] >= timeNetworkTransferMS) return false;
+  budgetWatchdogFeed();
+  return true;
+}
+
+const BudgetStats& budgetStats(uint8_t subsystem)
+{
+  return stats[subsystem];
+}
+
+String budgetReport()
+{
+  String report = "Blocking budgets since boot: subsystem, budget ms, runs, overruns, worst ms (culprit)";
+  for (uint8_t subsystem = 0; subsystem < kBudgetCount; subsystem++) {
+    const BudgetStats& budget = stats[subsystem];
+    report += String("\n  ") + budgetName[subsystem] + ", " + budget.budgetMS + ", " + budget.runs + ", "
+      + budget.overruns + ", " + budget.worstMS + (budget.runs ? String(" (") + budget.worstCulprit + ")" : String());
+  }
+  return report;
+}
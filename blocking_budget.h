@@ -0,0 +1,76 @@
+/*
+  Project:      Powered Air Quality
+  Description:  per subsystem blocking time budgets, backed by the ESP32 task watchdog
+*/
+
+#ifndef BLOCKING_BUDGET_H
+  #define BLOCKING_BUDGET_H
+
+  #include <Arduino.h>
+
+  #include "config.h"           // timeNetworkReadMS
+
+  enum budgetSubsystem : uint8_t { budgetSensors, budgetInflux, budgetThingSpeak, budgetMQTT, budgetOWM,
+    budgetWiFi, kBudgetCount };
+  extern const char* const budgetName[kBudgetCount];
+
+  struct BudgetStats {
+    uint32_t budgetMS;
+    uint32_t runs;
+    uint32_t overruns;
+    uint32_t worstMS;
+    const char* worstCulprit;
+  };
+
+  // subscribes the loop task to the task watchdog, timeout timeWatchdogMS; fed at every budget
+  // boundary, so it only fires if one subsystem blocks that long
+  void budgetWatchdogBegin();
+  // subscribes the calling task too, once budgetWatchdogBegin() has armed the watchdog
+  void budgetWatchdogAdd();
+  void budgetWatchdogFeed();
+
+  void budgetStart(uint8_t subsystem);
+  // ends the subsystem's span; returns false, logs and counts if it ran over budget
+  bool budgetEnd(uint8_t subsystem, const char* culprit);
+
+  // true while the subsystem's span has run less than timeNetworkTransferMS, feeding the watchdog
+  bool budgetTransferOpen(uint8_t subsystem);
+
+  const BudgetStats& budgetStats(uint8_t subsystem);
+  String budgetReport();
+
+  // budgetStart() now and budgetEnd() when the scope exits, for functions with many returns
+  class BudgetScope {
+    public:
+      BudgetScope(uint8_t subsystem, const char* culprit) : _subsystem(subsystem), _culprit(culprit)
+      {
+        budgetStart(subsystem);
+      }
+      ~BudgetScope() { budgetEnd(_subsystem, _culprit); }
+
+    private:
+      uint8_t _subsystem;
+      const char* _culprit;
+  };
+
+  // a network response body read within a subsystem's span, cut off once budgetTransferOpen()
+  // is false, so a slow drip can't outlast the watchdog. Readers wait for each piece on this
+  // stream's timeout, not the wrapped client's, so it's timeNetworkReadMS rather than Stream's
+  // 1 second
+  class BudgetStream : public Stream {
+    public:
+      BudgetStream(uint8_t subsystem, Stream& stream) : _subsystem(subsystem), _stream(stream)
+      {
+        setTimeout(timeNetworkReadMS);
+      }
+      size_t write(uint8_t c) override { (void)c; return 0; }
+      int available() override { return budgetTransferOpen(_subsystem) ? _stream.available() : 0; }
+      int read() override { return budgetTransferOpen(_subsystem) ? _stream.read() : -1; }
+      int peek() override { return budgetTransferOpen(_subsystem) ? _stream.peek() : -1; }
+
+    private:
+      uint8_t _subsystem;
+      Stream& _stream;
+  };
+
+#endif  // #ifdef BLOCKING_BUDGET_H
@@ -21,6 +21,19 @@
 // Comment out to turn off
 // #define HARDWARE_SIMULATE
 
+// Configuration Step 5: Record or replay raw sensor readings, see sensor_trace.h.
+// Comment out to turn off
+// #define SENSOR_TRACE         // write a TRACE line to Serial for every raw sensor reading
+// #define SENSOR_TRACE_REPLAY  // take sensor readings from a replayed trace instead of the hardware
+
+// Configuration Step 6: Sample faster while readings change quickly and slower while they are
+// flat, see sample_rate.h. Comment out to sample every timeSensorSampleMS
+// #define SAMPLE_ADAPTIVE
+
+// Configuration Step 7: SCD41 only. Measure CO2 once per sample, started by the sample schedule,
+// instead of the SCD4x low power periodic measurement every 30 seconds. Comment out to turn off
+// #define SCD4X_SINGLE_SHOT
+
 // Configuration variables that are less likely to require changes
 
 // Open Weather Map (OWM)
@@ -33,6 +46,14 @@ const String OWMPollutionLabel[5] = {"Good", "Fair", "Moderate", "Poor", "Very P
 // UI
 enum screenNames {sMain, sCO2, sPM25, sVOC, sForecast};
 
+// sensor reads are non-blocking; loop() calls again while a read is pending
+enum sensorReadResult {readPending, readSuccess, readFailure};
+// a sensor read's error when the sensor never had data ready, apart from the driver's codes
+constexpr uint16_t kSensorErrorNotReady = 0xFFFF;
+
+// sensor channels, each with its own warm-up after power on
+enum sensorChannel {channelCO2, channelPM, channelVOC, kSensorChannelCount};
+
 // screen layout assists in pixels
 constexpr uint8_t kXMargins = 5;
 constexpr uint8_t kYMargins = 5;
@@ -40,6 +61,29 @@ constexpr uint8_t kYStatusRegion = 30; // display.height()/8 assuming 320x240 sc
 
 // How many samples are retained in a FIFO queue
 constexpr uint8_t kSampleCapacity = 10;
+// How many samples the graphs' history holds, see sample_history.h; a day at 60 s per sample
+constexpr uint16_t kHistoryCapacity = 1440;
+// graphs of more than kSampleCapacity samples plot a point per kGraphColumnPx wide column,
+// with markers while there's kGraphMarkerPx between points
+constexpr uint8_t kGraphColumnPx = 2;
+constexpr uint8_t kGraphMarkerPx = 12;
+// history tiers, see history_tiers.h; finest first, each bucket a whole number of the
+// previous tier's: 1 minute for 2 hours, 5 minutes for 24 hours, 1 hour for 30 days
+constexpr uint8_t kTierCount = 3;
+constexpr uint32_t kTierBucketMS[kTierCount] = {60000, 300000, 3600000};
+constexpr uint16_t kTierBuckets[kTierCount] = {120, 288, 720};
+constexpr uint16_t kTierBucketTotal = kTierBuckets[0] + kTierBuckets[1] + kTierBuckets[2];
+constexpr uint8_t kTierDay = 1;  // the tier the reports' 24 hour figures come from
+// sample log on flash, see sample_log.h: 256 byte flash pages of compressed samples (see
+// series_codec.h), kLogSegmentPages to a segment file (64 KB) and kLogSegments files in the
+// default partition scheme's 1.4 MB LittleFS partition; the first sample of every
+// kLogIndexStride'th page is kept in RAM
+constexpr uint16_t kLogPageBytes = 256;
+constexpr uint16_t kLogSegmentPages = 256;
+constexpr uint8_t kLogSegments = 16;
+constexpr uint16_t kLogIndexStride = 8;
+// at most this long rebuilding the graphs' history from the log at boot, newest first
+constexpr uint32_t timeLogRebuildMS = 500;
 
 // warnings
 const String warningLabel[4]={"Good", "Fair", "Poor", "Bad"};
@@ -60,7 +104,8 @@ constexpr uint8_t screenBLLow  = 52;   // 255 * 0.20
 // timers
 // Internet and network endpoints
 constexpr uint8_t timeConnectTimeoutSeconds = 10; // how long WFM attempts network connect before failing
-constexpr uint32_t timeOWMRenewMS = 1800000; // min time between OWM calls
+constexpr uint32_t timeOWMRenewMS = 1800000; // time between OWM calls
+constexpr uint32_t timeOWMRetryMS = 300000; // time to the next OWM call after one fails
 constexpr uint32_t timeWebPortalTimeOutMS = 180000; // how long web configuration portal stays active
 
 constexpr uint32_t timeHardwareSleepTimeμS = 10000000;  // sleep time if hardware error occurs
@@ -69,20 +114,61 @@ constexpr uint32_t timeStartPortalHoldMS = 5000;  // long-press duration to star
 constexpr uint32_t timeDeviceResetHoldMS = 10000; // Long-press duration to wipe config
 
 constexpr uint32_t timeScreenSaverStartMS = 300000; // switch to screen saver if no input after this period
+constexpr uint32_t timeLoopIdleMaxMS = 20; // longest idle at the end of loop(), bounds touch and portal latency
+
+// blocking budgets, the longest a subsystem should hold up loop(); overruns are logged and counted
+constexpr uint32_t budgetSensorsMS = 500;     // each sensor read step, SCD4x polls are non-blocking
+constexpr uint32_t budgetInfluxMS = 5000;
+constexpr uint32_t budgetThingSpeakMS = 5000;
+constexpr uint32_t budgetMQTTMS = 5000;       // connect and publish
+constexpr uint32_t budgetOWMMS = 5000;        // each Open Weather Map fetch
+constexpr uint32_t budgetWiFiMS = (timeConnectTimeoutSeconds + 2) * 1000;
+// task watchdog for loop() and the worker task, reboots if any one subsystem blocks this long; fed at
+// every budget boundary
+constexpr uint32_t timeWatchdogMS = 30000;
+// network timeouts, so no request holds a subsystem for the watchdog's period; a request waits
+// at most timeNetworkReadMS for each reply or piece of one, and its response body is cut off
+// timeNetworkTransferMS into the subsystem's budget span
+constexpr uint16_t timeNetworkReadMS = 5000;
+constexpr uint32_t timeNetworkTransferMS = 15000;
+static_assert(timeNetworkTransferMS + timeNetworkReadMS < timeWatchdogMS, "network transfers end before the watchdog fires");
+
+// dual core split, sensing and network reporting in a task on coreWorker, see dual_core.h
+constexpr uint8_t coreWorker = 0;                // with the WiFi stack; loop() runs on core 1
+constexpr uint32_t coreWorkerStackBytes = 8192;  // as the Arduino loop task, which ran this work before
+constexpr uint8_t coreWorkerPriority = 1;        // as the Arduino loop task
+constexpr uint32_t timeWorkerIdleMaxMS = timeWatchdogMS / 2;  // longest worker idle, so it feeds the watchdog
+constexpr uint32_t timeRestartFlushMS = 6000;    // a restart waits this long for the worker to start writing the sample log
+constexpr uint8_t kSampleQueueDepth = 2;         // sample snapshots waiting for loop(), which draws the newest
+constexpr uint8_t kUIEventQueueDepth = 8;        // alerts and notices waiting for loop()
+constexpr uint8_t kLoopTimingQueueDepth = 2;     // loop() timing figures waiting for the worker
+constexpr uint8_t kConfigQueueDepth = 2;         // web portal saves waiting for the worker
 
 // sampling and reporting intervals
 #if defined (DEBUG) && !defined (HARDWARE_SIMULATE)
   // time between sensor reads, e.g. samples
   constexpr uint32_t timeSensorSampleMS = 30000; // minimum inter-sample time for many sensors
+  // SAMPLE_ADAPTIVE range of times between samples
+  constexpr uint32_t timeSampleFastMS = 10000;
+  constexpr uint32_t timeSampleSlowMS = 120000;
   // time between samplePost()
   constexpr uint32_t timeReportMS = 90000;
 #elif defined(DEBUG) && defined (HARDWARE_SIMULATE) // rapid samples for debugging
   constexpr uint32_t timeSensorSampleMS = 10000;
+  constexpr uint32_t timeSampleFastMS = 5000;
+  constexpr uint32_t timeSampleSlowMS = 60000;
   constexpr uint32_t timeReportMS = 100000; // 10 samples per report
 #else // Production sample pace
   constexpr uint32_t timeSensorSampleMS = 60000;
+  constexpr uint32_t timeSampleFastMS = 10000;
+  constexpr uint32_t timeSampleSlowMS = 300000;
   constexpr uint32_t timeReportMS = 900000;
 #endif
+// SAMPLE_ADAPTIVE pace by sensorChannel, see sampleRateNext(): CO2 ppm, PM2.5 ug/m3 and VOC index
+// points per minute
+constexpr float kSampleFastPerMinute[kSensorChannelCount] = {30.0f, 5.0f, 20.0f};
+constexpr float kSampleFlatPerMinute[kSensorChannelCount] = {5.0f, 1.0f, 3.0f};
+constexpr uint8_t kSampleFlatCount = 5;  // flat samples in a row before the period doubles
 
 constexpr uint8_t reportFailureThreshold = 3; // report attempt failures before UI alert starts
 
@@ -128,7 +214,35 @@ constexpr uint16_t sensorCO2Bad =   1600;
 #else 
   constexpr uint16_t sensorCO2Max =   5000;
 #endif
-constexpr uint8_t co2SensorReadFailureLimit = 20;
+constexpr uint8_t co2SensorReadFailureLimit = 20; // data-ready polls before a read fails
+constexpr uint32_t timeSCD4xPollMS = 100;          // between data-ready polls
+constexpr uint32_t timeSCD4xSingleShotMS = 5000;   // SCD41 measure_single_shot execution time
+// SAMPLE_ADAPTIVE reads a sensor no more often than it measures
+#ifdef SCD4X_SINGLE_SHOT
+  constexpr uint32_t timeSCD4xReadMinMS = timeSCD4xSingleShotMS;
+#else
+  constexpr uint32_t timeSCD4xReadMinMS = 30000;   // low power periodic measurement interval
+#endif
+constexpr uint32_t timeSEN5xReadMinMS = 1000;
+constexpr uint32_t timeSEN5xAcquireMS = 1000;      // SEN5x readings between samples, see taskPMAcquireRun()
+// a recovery's waits between its steps, see sensorRecoverStep()
+constexpr uint32_t timeSCD4xStopMS = 500;          // SCD4x stop_periodic_measurement execution time
+constexpr uint16_t kSEN5xDeviceResetCmd = 0xD304;
+constexpr uint32_t timeSEN5xResetMS = 200;         // SEN5x device_reset execution time
+// longest after sensorInit() before a channel's readings are valid, by sensorChannel. The CO2
+// channel ends early with the first valid sensorSCD4xRead(), polls during warm-up don't count
+// as failures
+constexpr uint32_t timeSensorWarmupMS[kSensorChannelCount] = {
+  timeSCD4xReadMinMS + 5000,  // CO2, temperature, humidity: the first low power periodic or single shot measurement
+  1100,                       // PM: first SEN5x measurement
+  7000,                       // VOC: SEN54 takes 6-7 seconds for valid VOC index values
+};
+// sensor recovery in place, see sensor_health.h
+constexpr uint8_t  kSensorDegradedLimit = 3;        // read failures in a row before a recovery
+constexpr uint32_t timeSensorRecoveryMS = 5000;     // first recovery backoff, doubling per failed attempt
+constexpr uint32_t timeSensorRecoveryMaxMS = 300000;
+constexpr uint8_t  kSensorRecoveryAttempts = 5;     // failed attempts before a sensor counts as failed
+constexpr uint8_t  kSensorBusClearPulses = 9;       // SCL pulses to free a device holding SDA
 constexpr uint8_t sensorCO2VariabilityRange = 30;
 constexpr float   kSigmaMultiplier = 2.5f;
 constexpr float   kMinSigmaFloor   = 25.0f; // ppm/sample
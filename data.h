@@ -28,5 +28,13 @@
   #define VALUE_KEY_AQI           "aqi"
   #define VALUE_KEY_VOC           "vocIndex"
   #define VALUE_KEY_RSSI          "rssi"
+  // loop() phase timing (loop_timing.h), as "loop_<phase>_<statistic>_us" fields
+  #define VALUE_KEY_LOOP          "loop"
+  // blocking budgets (blocking_budget.h), as "budget_<subsystem>_<statistic>" fields
+  #define VALUE_KEY_BUDGET        "budget"
+  // worker task (dual_core.h), as "worker_<statistic>" fields
+  #define VALUE_KEY_WORKER        "worker"
+  // sample durations (sample_rate.h), as "sample_<statistic>_ms" fields
+  #define VALUE_KEY_SAMPLE        "sample"
 
 #endif  // #ifdef DATA_H
\ No newline at end of file
@@ -0,0 +1,43 @@
+/*
+  Project Name:   Powered Air Quality
+  Description:    decimation filter for oversampled sensor readings (see decimation.h)
+*/
+
+#include "Arduino.h"
+
+#include "decimation.h"
+
+namespace {
+  float median3(float a, float b, float c)
+  {
+    if (a > b) { const float t = a; a = b; b = t; }
+    if (b > c) b = c;
+    return (a > b) ? a : b;
+  }
+}
+
+void DecimationFilter::include(float value)
+{
+  // until there are three readings, they pass through
+  const float filtered = (_stored < 2) ? value : median3(_history[0], _history[1], value);
+  _history[0] = _history[1];
+  _history[1] = value;
+  if (_stored < 2) _stored++;
+  _sum += filtered;
+  _count++;
+}
+
+float DecimationFilter::take()
+{
+  const float mean = _count ? _sum / _count : NAN;
+  _sum = 0.0f;
+  _count = 0;
+  return mean;
+}
+
+void DecimationFilter::reset()
+{
+  _stored = 0;
+  _sum = 0.0f;
+  _count = 0;
+}
@@ -0,0 +1,29 @@
+/*
+  Project:      Powered Air Quality
+  Description:  decimation filter for oversampled sensor readings
+*/
+
+#ifndef DECIMATION_H
+  #define DECIMATION_H
+
+  #include <Arduino.h>
+
+  // a median of three, to drop single spikes, feeding a boxcar average
+  class DecimationFilter {
+    public:
+      void include(float value);
+      // readings since the last take()
+      uint16_t count() const { return _count; }
+      // the mean of the filtered readings since the last take(), NAN with none
+      float take();
+      // forgets the median history too, e.g. after a sensor restart
+      void reset();
+
+    private:
+      float _history[2] = {0.0f, 0.0f};  // the two previous readings, oldest first
+      uint8_t _stored = 0;
+      float _sum = 0.0f;
+      uint16_t _count = 0;
+  };
+
+#endif  // #ifdef DECIMATION_H
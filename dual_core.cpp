@@ -0,0 +1,103 @@
+/*
+  Project Name:   Powered Air Quality
+  Description:    worker task and the queues to loop() (see dual_core.h)
+*/
+
+#include "Arduino.h"
+#include <atomic>
+
+#include "dual_core.h"
+
+// Shared helper function
+extern void debugMessage(String messageText, uint8_t messageLevel);
+
+SPSCQueue<SampleSnapshot, kSampleQueueDepth> sampleQueue;
+SPSCQueue<UIEvent, kUIEventQueueDepth> uiEventQueue;
+SPSCQueue<LoopTimingSnapshot, kLoopTimingQueueDepth> loopTimingQueue;
+SPSCQueue<ConfigSnapshot, kConfigQueueDepth> configQueue;
+
+namespace {
+  TaskHandle_t workerHandle = nullptr;
+  void (*workerSetupFunction)() = nullptr;
+  void (*workerLoopFunction)() = nullptr;
+  std::atomic<void (*)()> workerRunFunction{nullptr};  // requested, see dualCoreWorkerRun()
+  std::atomic<bool> workerRunning{false};              // the worker has taken the request
+  std::atomic<TaskHandle_t> workerRunCaller{nullptr};  // notified when a run ends
+
+  void workerTask(void* parameter)
+  {
+    (void)parameter;
+    workerSetupFunction();
+    for (;;) {
+      workerLoopFunction();
+      if (workerRunFunction.load()) {
+        // flagged before the request is taken, so dualCoreWorkerRun() always sees one of them
+        workerRunning = true;
+        void (*function)() = workerRunFunction.exchange(nullptr);
+        if (function)
+          function();
+        workerRunning = false;
+        xTaskNotifyGive(workerRunCaller.load());
+      }
+    }
+  }
+}
+
+bool dualCoreStart(void (*workerSetup)(), void (*workerLoop)())
+{
+  // a reboot in the host build runs setup() again; the device starts from scratch anyway
+  workerHandle = nullptr;
+  if (portNUM_PROCESSORS < 2 || xPortGetCoreID() == coreWorker) {
+    debugMessage("Single core: sensing and reporting run in loop()",1);
+    return false;
+  }
+  workerSetupFunction = workerSetup;
+  workerLoopFunction = workerLoop;
+  TaskHandle_t handle = nullptr;
+  if (xTaskCreatePinnedToCore(workerTask, "worker", coreWorkerStackBytes, nullptr, coreWorkerPriority, &handle,
+      coreWorker) != pdPASS) {
+    debugMessage("Worker task not started, sensing and reporting run in loop()",1);
+    return false;
+  }
+  workerHandle = handle;
+  debugMessage(String("Worker task started on core ") + coreWorker + ", loop() on core " + xPortGetCoreID(),1);
+  return true;
+}
+
+bool dualCoreSplit()
+{
+  return workerHandle != nullptr;
+}
+
+void dualCoreWorkerWake()
+{
+  if (dualCoreSplit())
+    xTaskNotifyGive(workerHandle);
+}
+
+bool dualCoreWorkerRun(void (*function)(), uint32_t timeoutMS)
+{
+  if (!dualCoreSplit()) {
+    function();
+    return true;
+  }
+  // the worker notifies the caller once the run ends, see workerTask()
+  ulTaskNotifyTake(pdTRUE, 0);
+  workerRunCaller = xTaskGetCurrentTaskHandle();
+  workerRunFunction = function;
+  dualCoreWorkerWake();
+  const uint32_t startMS = millis();
+  uint32_t waitedMS = 0;
+  while ((workerRunFunction.load() || workerRunning.load()) && waitedMS < timeoutMS) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeoutMS - waitedMS));
+    waitedMS = millis() - startMS;
+  }
+  // not started in time, the worker mustn't run it after all
+  void (*expected)() = function;
+  if (workerRunFunction.compare_exchange_strong(expected, nullptr))
+    return false;
+  // started, let it finish rather than have the caller act on a half done run
+  while (workerRunning.load())
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  return true;
+}
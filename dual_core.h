@@ -0,0 +1,70 @@
+/*
+  Project:      Powered Air Quality
+  Description:  sensing and network reporting on core 0, touch and rendering on core 1
+*/
+
+#ifndef DUAL_CORE_H
+  #define DUAL_CORE_H
+
+  #include <Arduino.h>
+  #include <Measure.hpp>
+
+  #include "config.h"
+  #include "powered_air_quality.h"
+  #include "spsc_queue.h"
+  #include "sample_history.h"
+  #include "loop_timing.h"
+
+  // what the screens show, as of the worker's last sample or Open Weather Map update
+  struct SampleSnapshot {
+    Measure<kSampleCapacity> temperatureF, humidity, co2, vocIndex, pm25;
+    OpenWeatherMapAirQuality owmAirQuality;
+    SiteForecast owmSiteForecast;
+    bool owmAirQualityValid = false;  // the last air pollution fetch succeeded
+    bool owmForecastValid = false;    // the last forecast fetch succeeded
+    uint32_t lastReportMS = 0;        // timeLastReportMS, 0 until the first report
+    uint32_t historyEnd = 0;          // sampleHistory.appended(), the graphs draw the samples before it
+    HistoryRange historyRange[kHistoryChannelCount];  // sampleHistory.extrema() as of historyEnd
+    bool warmingUp[kSensorChannelCount] = {};         // sensorWarmingUp()
+  };
+
+  // the settings the worker reports with, as loop() saved them from the web portal
+  struct ConfigSnapshot {
+    uint16_t altitude;
+    float latitude;
+    float longitude;
+    networkEndpointConfig endpointPath;
+    MqttConfig mqttBrokerConfig;
+    influxConfig influxdbConfig;
+  };
+
+  // alerts and notices from the worker, for loop() to draw
+  enum uiEventType : uint8_t { uiEventReadFail, uiEventCO2Rising, uiEventNoSamples, uiEventReported };
+  struct UIEvent {
+    uint8_t type;
+  };
+
+  // worker to loop(); loop() drains both every pass, a full queue drops the newest item
+  extern SPSCQueue<SampleSnapshot, kSampleQueueDepth> sampleQueue;
+  extern SPSCQueue<UIEvent, kUIEventQueueDepth> uiEventQueue;
+  // loop() to the worker, loop()'s timing figures with each sample snapshot it draws, for the
+  // worker's reports; the worker drains it every pass, keeping the newest
+  extern SPSCQueue<LoopTimingSnapshot, kLoopTimingQueueDepth> loopTimingQueue;
+  // loop() to the worker, settings saved in the web portal; the worker applies them between
+  // its passes, never while a report uses the ones it has
+  extern SPSCQueue<ConfigSnapshot, kConfigQueueDepth> configQueue;
+
+  // starts the worker task, which calls workerSetup() once and then workerLoop() forever;
+  // false if it runs single core instead (a single core chip, or loop() already on
+  // coreWorker), and the caller adds the worker's tasks to loop()'s scheduler
+  bool dualCoreStart(void (*workerSetup)(), void (*workerLoop)());
+  // true while the worker task runs
+  bool dualCoreSplit();
+  // ends the worker's idle, for something loop() queued for it; nothing running single core
+  void dualCoreWorkerWake();
+  // runs function in the worker task between two of its passes, or at once running single
+  // core, and returns once it has run; false if the worker didn't start it within timeoutMS,
+  // and then it never runs. Once started it runs to completion, however long that takes
+  bool dualCoreWorkerRun(void (*function)(), uint32_t timeoutMS);
+
+#endif  // #ifdef DUAL_CORE_H
@@ -84,16 +84,6 @@ mqtt:
         name: "Climatron"
         identifiers:
           - "Climatron-0857" 
-    - name: "NOxIndex"
-      device_class: "aqi"
-      state_topic: "homeassistant/<site>>/<location>/<room>/Climatron-0857/state"
-      unique_id: "Climatron-0857-noxIndex"
-      value_template: "{{ value_json.noxIndex }}"
-      state_class: "measurement"
-      device:
-        name: "Climatron"
-        identifiers:
-          - "Climatron-0857" 
  */
 
 #include "Arduino.h"
@@ -119,9 +109,10 @@ mqtt:
   // Note that it depends on the value of the state topic matching what's in Home
   // Assistant's configuration file (configuration.yaml).
   
-  bool hassio_mqtt_publish(float pm25, float co2, float temperatureF, float humidity, float vocIndex, float noxIndex, float aqi) {
+  // SEN54 has no NOx channel, so no noxIndex is published
+  bool hassio_mqtt_publish(float pm25, float co2, float temperatureF, float humidity, float vocIndex, float aqi) {
     bool success = false;
-    const int capacity = JSON_OBJECT_SIZE(7);
+    const int capacity = JSON_OBJECT_SIZE(6);
     StaticJsonDocument<capacity> doc;
 
     // Declare buffer to hold serialized object
@@ -136,14 +127,14 @@ mqtt:
     debugMessage("Publishing Climatron values to Home Assistant via MQTT (state topic below)",1);
     debugMessage(topic,1);
 
-    // Generate the state topic payload (as JSON)
-    doc["temperatureF"] = temperatureF;
-    doc["humidity"] = humidity;
-    doc["co2"] = co2;
-    doc["pm25"] = pm25;
-    doc["vocIndex"] = vocIndex;
-    doc["noxIndex"] = noxIndex;
-    doc["aqi"] = aqi;
+    // Generate the state topic payload (as JSON), without values that had no readings over
+    // the report interval (NAN)
+    if (!isnan(temperatureF)) doc["temperatureF"] = temperatureF;
+    if (!isnan(humidity)) doc["humidity"] = humidity;
+    if (!isnan(co2)) doc["co2"] = co2;
+    if (!isnan(pm25)) doc["pm25"] = pm25;
+    if (!isnan(vocIndex)) doc["vocIndex"] = vocIndex;
+    if (!isnan(aqi)) doc["aqi"] = aqi;
 
     // Serialize the payload so it can be posted via MQTT
     serializeJson(doc,output);
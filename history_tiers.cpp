@@ -0,0 +1,125 @@
+/*
+  Project Name:   Powered Air Quality
+  Description:    multi-resolution round-robin history of the sensor channels (see history_tiers.h)
+*/
+
+#include "Arduino.h"
+
+#include "history_tiers.h"
+
+namespace {
+  // a tier's first slot in _buckets
+  uint16_t tierOffset(uint8_t tier)
+  {
+    uint16_t offset = 0;
+    for (uint8_t finer = 0; finer < tier; finer++) offset += kTierBuckets[finer];
+    return offset;
+  }
+}
+
+void HistoryTiers::include(uint8_t channel, float value, uint32_t nowMS)
+{
+  if (channel >= kHistoryChannelCount || isnan(value)) return;
+  if (!_started) {
+    // every tier's buckets count from the first reading, so finer ones nest in coarser ones
+    for (uint8_t tier = 0; tier < kTierCount; tier++) _openMS[tier] = nowMS;
+    _started = true;
+  }
+  advance(0, nowMS);
+  accumulate(_open[0][channel], value, value, value, 1);
+}
+
+void HistoryTiers::accumulate(Accumulator& open, float minValue, float maxValue, float total, uint32_t count)
+{
+  if (!open.count || minValue < open.minValue) open.minValue = minValue;
+  if (!open.count || maxValue > open.maxValue) open.maxValue = maxValue;
+  open.total += total;
+  open.count += count;
+}
+
+void HistoryTiers::advance(uint8_t tier, uint32_t nowMS)
+{
+  // a gap closes a bucket for each interval of it, empty where there were no readings
+  while (nowMS - _openMS[tier] >= kTierBucketMS[tier])
+    close(tier);
+}
+
+void HistoryTiers::close(uint8_t tier)
+{
+  const bool coarser = (tier + 1 < kTierCount);
+  // the coarser tier's open bucket is the one this bucket falls in
+  if (coarser) advance(tier + 1, _openMS[tier]);
+
+  // once the ring is full the slot holds its oldest bucket, which leaves the totals
+  const bool full = (_closed[tier] >= kTierBuckets[tier]);
+  Bucket *slot = _buckets[tierOffset(tier) + _closed[tier] % kTierBuckets[tier]];
+  for (uint8_t channel = 0; channel < kHistoryChannelCount; channel++) {
+    Accumulator& open = _open[tier][channel];
+    Totals& totals = _totals[tier][channel];
+    const Bucket evicted = full ? slot[channel] : Bucket();
+    Bucket bucket = {};
+    if (open.count) {
+      bucket = {historyStored(channel, open.minValue), historyStored(channel, open.maxValue),
+        historyStored(channel, open.total / open.count), (uint16_t)((open.count < UINT16_MAX) ? open.count : UINT16_MAX)};
+      if (coarser) accumulate(_open[tier + 1][channel], open.minValue, open.maxValue, open.total, open.count);
+    }
+    slot[channel] = bucket;
+    open = Accumulator();
+
+    bool extremeLeft = false;
+    if (evicted.count) {
+      totals.total -= (int64_t)evicted.mean * evicted.count;
+      totals.count -= evicted.count;
+      extremeLeft = (evicted.minValue == totals.minValue || evicted.maxValue == totals.maxValue);
+    }
+    if (bucket.count) {
+      if (!totals.count || bucket.minValue < totals.minValue) totals.minValue = bucket.minValue;
+      if (!totals.count || bucket.maxValue > totals.maxValue) totals.maxValue = bucket.maxValue;
+      totals.total += (int64_t)bucket.mean * bucket.count;
+      totals.count += bucket.count;
+    }
+    // only when the ring's minimum or maximum leaves it does it need reading again
+    if (extremeLeft && totals.count) rescan(tier, channel);
+  }
+  _openMS[tier] += kTierBucketMS[tier];
+  _closed[tier]++;
+}
+
+void HistoryTiers::rescan(uint8_t tier, uint8_t channel)
+{
+  Totals& totals = _totals[tier][channel];
+  const uint16_t offset = tierOffset(tier);
+  bool any = false;
+  for (uint16_t bucket = 0; bucket < kTierBuckets[tier]; bucket++) {
+    const Bucket& slot = _buckets[offset + bucket][channel];
+    if (!slot.count) continue;
+    if (!any || slot.minValue < totals.minValue) totals.minValue = slot.minValue;
+    if (!any || slot.maxValue > totals.maxValue) totals.maxValue = slot.maxValue;
+    any = true;
+  }
+}
+
+bool HistoryTiers::window(uint8_t tier, uint8_t channel, uint32_t nowMS, HistorySpan& result)
+{
+  if (tier >= kTierCount || channel >= kHistoryChannelCount || !_started) return false;
+  advance(0, nowMS);
+
+  const Totals& totals = _totals[tier][channel];
+  const float scale = kHistoryScale[channel];
+  float low = totals.minValue / scale, high = totals.maxValue / scale;
+  double total = (double)totals.total / scale;
+  uint32_t count = totals.count;
+  // the open buckets: the tier's own, and the finer ones not yet folded into it
+  for (uint8_t open = 0; open <= tier; open++) {
+    const Accumulator& accumulator = _open[open][channel];
+    if (!accumulator.count) continue;
+    if (!count || accumulator.minValue < low) low = accumulator.minValue;
+    if (!count || accumulator.maxValue > high) high = accumulator.maxValue;
+    total += accumulator.total;
+    count += accumulator.count;
+  }
+
+  if (!count) return false;
+  result = {low, high, (float)(total / count), count};
+  return true;
+}
@@ -0,0 +1,64 @@
+/*
+  Project:      Powered Air Quality
+  Description:  multi-resolution round-robin history of the sensor channels
+*/
+
+#ifndef HISTORY_TIERS_H
+  #define HISTORY_TIERS_H
+
+  #include <Arduino.h>
+
+  #include "config.h"
+  #include "sample_history.h"   // historyChannel, fixed point scales
+
+  struct HistorySpan {
+    float minValue;
+    float maxValue;
+    float mean;           // of the readings, however the buckets they fell in were filled
+    uint32_t readings;
+  };
+
+  // rings of min/max/mean buckets per tier (kTierBucketMS, kTierBuckets), each tier folded from
+  // the finer one's closed buckets by reading count, so coarse means weigh every reading alike.
+  // Each tier keeps running totals over its ring as buckets close; only the worker task, which
+  // feeds it, may call window()
+  class HistoryTiers {
+    public:
+      // a reading of a historyChannel, at nowMS; readings come in time order
+      void include(uint8_t channel, float value, uint32_t nowMS);
+      // a channel over a tier's window as of nowMS, its ring and the open buckets not yet closed
+      // into it: about the last 2 hours, 24 hours or 30 days. Constant cost once the buckets
+      // nowMS has passed are closed, as include() would; false with no readings in it
+      bool window(uint8_t tier, uint8_t channel, uint32_t nowMS, HistorySpan& result);
+
+    private:
+      struct Bucket {
+        int16_t minValue, maxValue, mean;   // scaled
+        uint16_t count;                     // readings, 0 with none
+      };
+      struct Accumulator {
+        float minValue, maxValue, total;
+        uint32_t count;                     // readings, including those of finer buckets folded in
+      };
+      struct Totals {
+        int64_t total;                      // scaled mean x count over the ring's buckets
+        uint32_t count;
+        int16_t minValue, maxValue;         // scaled, with a count
+      };
+
+      void advance(uint8_t tier, uint32_t nowMS);
+      void close(uint8_t tier);
+      void rescan(uint8_t tier, uint8_t channel);
+      static void accumulate(Accumulator& open, float minValue, float maxValue, float total, uint32_t count);
+
+      Bucket _buckets[kTierBucketTotal][kHistoryChannelCount] = {};
+      Accumulator _open[kTierCount][kHistoryChannelCount] = {};
+      Totals _totals[kTierCount][kHistoryChannelCount] = {};
+      uint32_t _openMS[kTierCount] = {};    // start of each tier's open bucket
+      uint32_t _closed[kTierCount] = {};    // buckets closed since the first reading
+      bool _started = false;
+  };
+
+  extern HistoryTiers historyTiers;
+
+#endif  // #ifdef HISTORY_TIERS_H
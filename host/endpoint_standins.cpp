@@ -0,0 +1,165 @@
+/*
+  Project:      Powered Air Quality
+  Description:  stand-in servers for the sketch's network endpoints
+*/
+
+#include "endpoint_standins.h"
+
+#include <cstdio>
+#include <ctime>
+
+namespace {
+  constexpr uint32_t kEpochBase = 1760000000UL;  // stand-in wall clock at boot, seconds
+  constexpr uint8_t kForecastCount = 40;          // 5 days in 3 hour steps
+  constexpr uint32_t kForecastStepS = 3 * 3600;
+
+  HostHTTPResponse failure(int status)
+  {
+    char body[96];
+    snprintf(body, sizeof(body), "{\"code\":%d,\"message\":\"stand-in failure\"}", status);
+    return {status, body};
+  }
+
+  std::string airPollutionJSON()
+  {
+    char json[512];
+    snprintf(json, sizeof(json),
+      "{\"coord\":{\"lon\":-122.3321,\"lat\":47.6062},\"list\":[{\"main\":{\"aqi\":2},\"components\":"
+      "{\"co\":201.94,\"no\":0.02,\"no2\":0.77,\"o3\":68.66,\"so2\":0.64,\"pm2_5\":8.5,\"pm10\":10.2,\"nh3\":0.12},"
+      "\"dt\":%lu}]}", (unsigned long)(kEpochBase + millis() / 1000));
+    return json;
+  }
+
+  std::string forecastJSON()
+  {
+    static const struct { uint16_t id; const char *main; const char *description; const char *icon; } kWeather[] = {
+      {800, "Clear", "clear sky", "01d"},
+      {803, "Clouds", "broken clouds", "04d"},
+      {500, "Rain", "light rain", "10d"},
+      {600, "Snow", "light snow", "13d"},
+    };
+    const uint32_t now = kEpochBase + millis() / 1000;
+    const uint32_t first = now - now % kForecastStepS + kForecastStepS;
+    std::string json = "{\"cod\":\"200\",\"message\":0,\"cnt\":40,\"list\":[";
+    char entry[768];
+    for (uint8_t i = 0; i < kForecastCount; i++) {
+      const uint32_t dt = first + i * kForecastStepS;
+      const float temp = 55.0f + 12.0f * (float)((i % 8) < 4 ? (i % 8) : 8 - (i % 8)) / 4.0f;
+      const auto &weather = kWeather[(i / 8) % 4];
+      const time_t t = (time_t)dt;
+      struct tm utc;
+      gmtime_r(&t, &utc);
+      snprintf(entry, sizeof(entry),
+        "%s{\"dt\":%lu,\"main\":{\"temp\":%.2f,\"feels_like\":%.2f,\"temp_min\":%.2f,\"temp_max\":%.2f,"
+        "\"pressure\":1016,\"sea_level\":1016,\"grnd_level\":1011,\"humidity\":%d,\"temp_kf\":0},"
+        "\"weather\":[{\"id\":%u,\"main\":\"%s\",\"description\":\"%s\",\"icon\":\"%s\"}],"
+        "\"clouds\":{\"all\":%d},\"wind\":{\"speed\":6.35,\"deg\":212,\"gust\":9.1},\"visibility\":10000,"
+        "\"pop\":0.2,\"sys\":{\"pod\":\"d\"},\"dt_txt\":\"%04d-%02d-%02d %02d:00:00\"}",
+        i ? "," : "", (unsigned long)dt, temp, temp - 1.5f, temp - 0.8f, temp + 0.8f, 60 + i % 25, weather.id,
+        weather.main, weather.description, weather.icon, (i * 7) % 100, utc.tm_year + 1900, utc.tm_mon + 1,
+        utc.tm_mday, utc.tm_hour);
+      json += entry;
+    }
+    json += "],\"city\":{\"id\":5809844,\"name\":\"Seattle\",\"coord\":{\"lat\":47.6062,\"lon\":-122.3321},"
+      "\"country\":\"US\",\"population\":608660,\"timezone\":-25200,\"sunrise\":1759932000,\"sunset\":1759972800}}";
+    return json;
+  }
+
+  // value of name in an application/x-www-form-urlencoded body
+  String formValue(const String &body, const String &name)
+  {
+    const String key = name + "=";
+    int start = body.startsWith(key) ? 0 : body.indexOf("&" + key);
+    if (start < 0) return String();
+    if (start > 0) start++;
+    start += key.length();
+    const int end = body.indexOf('&', start);
+    return (end < 0) ? body.substring(start) : body.substring(start, end);
+  }
+}
+
+HostHTTPResponse OWMStandIn::httpRequest(const HostHTTPRequest &request)
+{
+  if (failStatus) return failure(failStatus);
+  if (request.method != "GET" || !request.path.startsWith(_pathPrefix)) return failure(404);
+  if (request.path.indexOf("APPID=") < 0 && request.path.indexOf("appid=") < 0) return failure(401);
+
+  const String endpoint = request.path.substring(_pathPrefix.length());
+  if (endpoint.startsWith("air_pollution?")) {
+    accepted++;
+    return {200, airPollutionJSON()};
+  }
+  if (endpoint.startsWith("forecast?")) {
+    accepted++;
+    return {200, forecastJSON()};
+  }
+  return failure(404);
+}
+
+HostHTTPResponse InfluxStandIn::httpRequest(const HostHTTPRequest &request)
+{
+  if (failStatus) return failure(failStatus);
+  if (request.method == "GET" && request.path == "/health")
+    return {200, "{\"name\":\"influxdb\",\"message\":\"ready for queries and writes\",\"status\":\"pass\",\"version\":\"v2.7.10\"}"};
+  if (request.method == "POST" && request.path.startsWith("/api/v2/write?")) {
+    if (request.header("Authorization") != "Token " + _token)
+      return {401, "{\"code\":\"unauthorized\",\"message\":\"unauthorized access\"}"};
+    accepted++;
+    // one point per line of line protocol
+    const String &body = request.body;
+    for (unsigned int i = 0; i < body.length(); i++) points += (body[i] == '\n');
+    if (body.length() && body[body.length() - 1] != '\n') points++;
+    return {204, ""};
+  }
+  return failure(404);
+}
+
+HostHTTPResponse ThingSpeakStandIn::httpRequest(const HostHTTPRequest &request)
+{
+  if (failStatus) return failure(failStatus);
+  if (request.method != "POST" || request.path != "/update") return failure(404);
+  if (formValue(request.body, "api_key") != _apiKey) return {200, "0"};
+  // updates closer together than the account allows are answered with entry 0 (signed,
+  // as fleet runs interleave device timelines)
+  if (_entryID && (int32_t)(millis() - _lastUpdateMS) >= 0 && millis() - _lastUpdateMS < kMinIntervalMS)
+    return {200, "0"};
+  _lastUpdateMS = millis();
+  accepted++;
+  return {200, std::to_string(++_entryID)};
+}
+
+uint8_t MQTTBrokerStandIn::mqttConnect(const String &clientID, const String &user, const String &password)
+{
+  if (failStatus) return 3;
+  if (clientID.isEmpty()) return 2;
+  if (_user.length() && (user != _user || password != _password)) return 4;
+  return 0;
+}
+
+void MQTTBrokerStandIn::mqttPublish(const String &topic, const String &payload, bool retained)
+{
+  (void)retained;
+  accepted++;
+  lastTopic = topic;
+  lastPayload = payload;
+}
+
+bool endpointURLSplit(const String &url, String &host, uint16_t &port, String &path)
+{
+  const int schemeEnd = url.indexOf("://");
+  if (schemeEnd <= 0) return false;
+  const String scheme = url.substring(0, schemeEnd);
+  if (scheme != "http" && scheme != "https") return false;
+  port = (scheme == "https") ? 443 : 80;
+
+  const String rest = url.substring(schemeEnd + 3);
+  const int pathStart = rest.indexOf('/');
+  host = (pathStart < 0) ? rest : rest.substring(0, pathStart);
+  path = (pathStart < 0) ? String("/") : rest.substring(pathStart);
+  const int portStart = host.indexOf(':');
+  if (portStart >= 0) {
+    port = (uint16_t)host.substring(portStart + 1).toInt();
+    host = host.substring(0, portStart);
+  }
+  return !host.isEmpty();
+}
@@ -0,0 +1,67 @@
+/*
+  Project:      Powered Air Quality
+  Description:  stand-in servers for the sketch's network endpoints
+*/
+
+#ifndef ENDPOINT_STANDINS_H
+  #define ENDPOINT_STANDINS_H
+
+  #include <host_net.h>
+
+  #include <string>
+
+  class EndpointStandIn : public HostNetServer {
+    public:
+      int failStatus = 0;     // answers every request with this HTTP status; the broker refuses
+      uint32_t accepted = 0;  // requests or messages the service took
+  };
+
+  class OWMStandIn : public EndpointStandIn {
+    public:
+      explicit OWMStandIn(const String &pathPrefix) : _pathPrefix(pathPrefix) {}
+      HostHTTPResponse httpRequest(const HostHTTPRequest &request) override;
+
+    private:
+      String _pathPrefix;  // e.g. /data/2.5/
+  };
+
+  class InfluxStandIn : public EndpointStandIn {
+    public:
+      explicit InfluxStandIn(const String &token) : _token(token) {}
+      HostHTTPResponse httpRequest(const HostHTTPRequest &request) override;
+
+      uint32_t points = 0;
+
+    private:
+      String _token;
+  };
+
+  class ThingSpeakStandIn : public EndpointStandIn {
+    public:
+      static constexpr uint32_t kMinIntervalMS = 15000;  // free account update limit
+
+      explicit ThingSpeakStandIn(const String &apiKey) : _apiKey(apiKey) {}
+      HostHTTPResponse httpRequest(const HostHTTPRequest &request) override;
+
+    private:
+      String _apiKey;
+      uint32_t _entryID = 0;
+      uint32_t _lastUpdateMS = 0;
+  };
+
+  class MQTTBrokerStandIn : public EndpointStandIn {
+    public:
+      MQTTBrokerStandIn(const String &user, const String &password) : _user(user), _password(password) {}
+      uint8_t mqttConnect(const String &clientID, const String &user, const String &password) override;
+      void mqttPublish(const String &topic, const String &payload, bool retained) override;
+
+      String lastTopic, lastPayload;
+
+    private:
+      String _user, _password;
+  };
+
+  // Splits an http(s) URL into host, port and path; returns false if it isn't one
+  bool endpointURLSplit(const String &url, String &host, uint16_t &port, String &path);
+
+#endif  // #ifdef ENDPOINT_STANDINS_H
@@ -0,0 +1,185 @@
+/*
+  Project:      Powered Air Quality
+  Description:  sliding window minimum and maximum cost report
+
+  Feeds the same series, a random walk broken by long rises and falls with every 97th
+  sample missing, through SlidingExtrema (see sliding_extrema.h) at windows of 100, 1000
+  and kHistoryWindow samples, storing each sample in the ring and asking for the window's
+  extrema after it, as SampleHistory::append() and the worker do, and times it against
+  rescanning the window each time. Then does the same through sampleHistory itself,
+  append() and extrema(). Fails unless the deques agree with the scan on every sample
+  rescanned and their cost per sample at kHistoryWindow stays within 2x of the cost at 100,
+  that is, doesn't grow with the window.
+
+  Usage: paq_extrema_bench [--samples N] [--reps N]
+    --samples N  samples fed at each window (default 200000)
+    --reps N     timing repetitions per window (default 5, the fastest is reported)
+*/
+
+#include <Arduino.h>
+#include "config.h"
+#include "sample_history.h"
+#include "sliding_extrema.h"
+#include "test_check.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+  struct Series {
+    std::vector<int16_t> values;
+    std::vector<bool> present;
+  };
+
+  Series series(uint32_t count)
+  {
+    Series made;
+    std::mt19937 random(25);
+    int32_t value = 1000;
+    for (uint32_t i = 0; i < count; i++) {
+      // 5000 sample phases: a walk, a rise and a fall, longer than the largest window
+      const uint32_t phase = (i / 5000) % 3;
+      if (phase == 0) value += std::uniform_int_distribution<int>(-3, 3)(random);
+      else value += (phase == 1) ? 1 : -1;
+      value = std::min(std::max(value, 0), 30000);
+      made.values.push_back(value);
+      made.present.push_back(i % 97 != 0);
+    }
+    return made;
+  }
+
+  struct Result {
+    uint32_t window;
+    double dequeNS;       // per sample, the store, include() and extrema()
+    double rescanNS;      // per sample, the store and a scan of the window
+    uint32_t rescanned;   // samples checked against the scan
+    bool same;
+  };
+
+  double nowNS()
+  {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  // the ring is the window and kHistoryGuard more, as in SampleHistory
+  template <uint16_t kWindow>
+  Result run(const Series& input, uint32_t reps)
+  {
+    constexpr uint16_t kRing = kWindow + kHistoryGuard;
+    static int16_t ring[kRing];
+    static SlidingExtrema<kWindow, kRing> extrema;
+    const uint32_t count = input.values.size();
+    Result result = {kWindow, 1e30, 0.0, 0, true};
+    int64_t sink = 0;
+
+    for (uint32_t rep = 0; rep < reps; rep++) {
+      extrema.clear();
+      const double startNS = nowNS();
+      for (uint32_t sample = 0; sample < count; sample++) {
+        ring[sample % kRing] = input.present[sample] ? input.values[sample] : kHistoryMissing;
+        extrema.include(sample, ring, input.present[sample]);
+        int16_t low, high;
+        if (extrema.extrema(ring, low, high)) sink += high - low;
+      }
+      result.dequeNS = std::min(result.dequeNS, (nowNS() - startNS) / count);
+    }
+
+    result.rescanned = std::min<uint32_t>(count, 20000);
+    std::vector<int16_t> scanLow(result.rescanned, INT16_MAX), scanHigh(result.rescanned, INT16_MIN);
+    const double startNS = nowNS();
+    for (uint32_t sample = 0; sample < result.rescanned; sample++) {
+      ring[sample % kRing] = input.present[sample] ? input.values[sample] : kHistoryMissing;
+      const uint32_t first = (sample + 1 > kWindow) ? sample + 1 - kWindow : 0;
+      for (uint32_t old = first; old <= sample; old++) {
+        const int16_t value = ring[old % kRing];
+        if (value == kHistoryMissing) continue;
+        if (value < scanLow[sample]) scanLow[sample] = value;
+        if (value > scanHigh[sample]) scanHigh[sample] = value;
+      }
+    }
+    result.rescanNS = (nowNS() - startNS) / result.rescanned;
+
+    extrema.clear();
+    for (uint32_t sample = 0; sample < result.rescanned; sample++) {
+      ring[sample % kRing] = input.present[sample] ? input.values[sample] : kHistoryMissing;
+      extrema.include(sample, ring, input.present[sample]);
+      int16_t low = 0, high = 0;
+      const bool found = extrema.extrema(ring, low, high);
+      // a scan that found nothing left low above high
+      if (found != (scanLow[sample] <= scanHigh[sample]) || (found && (low != scanLow[sample] || high != scanHigh[sample])))
+        result.same = false;
+    }
+    if (sink == 42) printf(" ");  // keeps the work
+    return result;
+  }
+
+  // sampleHistory's append() and extrema() of every channel, CO2 from the series; the scan is
+  // span() over the samples extrema() covers
+  Result runHistory(const Series& input)
+  {
+    const uint32_t count = input.values.size();
+    Result result = {kHistoryWindow, 0.0, 0.0, 0, true};
+    float sink = 0.0f;
+
+    sampleHistory.preset(0);
+    double startNS = nowNS();
+    for (uint32_t sample = 0; sample < count; sample++) {
+      const float values[kHistoryChannelCount] = {70.0f, 40.0f, (float)input.values[sample], 5.0f, 100.0f};
+      sampleHistory.append(values, input.present[sample] ? 0xFF : 0);
+      for (uint8_t channel = 0; channel < kHistoryChannelCount; channel++) sink += sampleHistory.extrema(channel).maxValue;
+    }
+    result.dequeNS = (nowNS() - startNS) / count;
+
+    result.rescanned = std::min<uint32_t>(count, 20000);
+    sampleHistory.preset(0);
+    startNS = nowNS();
+    for (uint32_t sample = 0; sample < result.rescanned; sample++) {
+      const float values[kHistoryChannelCount] = {70.0f, 40.0f, (float)input.values[sample], 5.0f, 100.0f};
+      sampleHistory.append(values, input.present[sample] ? 0xFF : 0);
+      const uint32_t end = sampleHistory.appended();
+      float minValue = 0.0f, maxValue = 0.0f, mean;
+      const bool spanned = sampleHistory.span(historyCO2, end - sampleHistory.available(end), end, minValue, maxValue, mean);
+      const HistoryRange range = sampleHistory.extrema(historyCO2);
+      if (range.valid != spanned || (spanned && (range.minValue != minValue || range.maxValue != maxValue)))
+        result.same = false;
+    }
+    result.rescanNS = (nowNS() - startNS) / result.rescanned;
+    if (sink == 42.0f) printf(" ");  // keeps the work
+    return result;
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  uint32_t samples = 200000, reps = 5;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--samples") && i + 1 < argc) samples = std::max(20000, atoi(argv[++i]));
+    else if (!strcmp(argv[i], "--reps") && i + 1 < argc) reps = std::max(1, atoi(argv[++i]));
+    else {
+      fprintf(stderr, "usage: %s [--samples N] [--reps N]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  const Series input = series(samples);
+  const std::vector<Result> results = {run<100>(input, reps), run<1000>(input, reps), run<kHistoryWindow>(input, reps)};
+  const Result history = runHistory(input);
+
+  printf("paq_extrema_bench: %u samples, window minimum and maximum after every sample\n", samples);
+  printf("%8s %12s %12s %10s\n", "window", "deque ns", "rescan ns", "rescanned");
+  bool ok = true;
+  for (const Result& result : results) {
+    printf("%8u %12.1f %12.1f %10u\n", result.window, result.dequeNS, result.rescanNS, result.rescanned);
+    ok &= check(result.same, "the deques agree with a scan of the window");
+  }
+  printf("%8u %12.1f %12.1f %10u  sampleHistory, append() and extrema() of %u channels against span()\n",
+    history.window, history.dequeNS, history.rescanNS, history.rescanned, (unsigned)kHistoryChannelCount);
+  ok &= check(history.same, "sampleHistory.extrema() agrees with span()");
+  ok &= check(results.back().dequeNS <= 2 * results.front().dequeNS, "the cost per sample doesn't grow with the window");
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,326 @@
+/*
+  Project:      Powered Air Quality
+  Description:  fleet simulator, many devices reporting to the same backends
+
+  Simulates N PAQ devices in one process against InfluxDB, MQTT broker (with Home
+  Assistant state topics) and ThingSpeak stand-ins (see endpoint_standins.h). The
+  hardware build with MQTT and HASSIO_MQTT runs setup() once; each device then keeps
+  its own endpointPath (deviceID, room), boot time, crystal skew and readings, and at
+  each of its report deadlines is swapped into the sketch's globals and reported
+  through the real samplePost(), i.e. post_thingspeak(), post_influx(), the MQTT
+  publishes of post_mqtt.cpp and hassio_mqtt_publish().
+
+  Devices run on their own timelines: the virtual clock is set to each report's start,
+  so reports that overlap in time reach the backends at their true times. Like the
+  sketch, a device's next report is timeReportMS after its previous one finished, so
+  slow posts spread a fleet out. Backends serve every request in the same time (no
+  queueing between devices).
+
+  Usage: paq_fleet [--devices N] [--hours H] [--rooms R] [--boot-spread-s S] [--skew-ppm P]
+                   [--rtt-ms MS] [--service-ms MS] [--seed N] [--verbose]
+    --devices N       fleet size (default 100)
+    --hours H         simulated time (default 2, fractions allowed)
+    --rooms R         distinct room tags (default 12)
+    --boot-spread-s S devices boot within S seconds of each other, as after a power cut
+                      (default 10)
+    --skew-ppm P      each device's clock runs fast or slow by up to P ppm (default 50)
+    --rtt-ms, --service-ms
+                      link round trip and backend service time (default 5, 20)
+    --seed N          fleet randomness (default 1)
+    --verbose         show the sketch's serial output
+*/
+
+#include <Arduino.h>
+#include "host_runtime.h"
+#include "sketch_prototypes.h"
+#include "config.h"
+#include "powered_air_quality.h"
+#include "secrets.h"
+#include "endpoint_standins.h"
+#include "sensirion_sim.h"
+#include <Measure.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+// sketch state
+extern Measure<kSampleCapacity> totalTemperatureF, totalHumidity, totalCO2, totalVOCIndex, totalPM25;
+
+namespace {
+  const char *kThingSpeakHost = "api.thingspeak.com";  // post_thingspeak.cpp posts to a fixed URL
+  constexpr uint16_t kThingSpeakPort = 80;
+  const char *kRoomNames[] = {"kitchen", "living", "office", "bedroom", "lab", "lobby", "conference", "library",
+    "classroom", "workshop", "nursery", "gym"};
+
+  // one request as the backend saw it
+  struct Arrival {
+    uint64_t ms;      // fleet time
+    uint32_t payload; // HTTP body, or MQTT topic and payload, bytes
+    bool ok;
+  };
+
+  uint64_t nowMS()
+  {
+    return hostClockMicros() / 1000;
+  }
+
+  class FleetInflux : public InfluxStandIn {
+    public:
+      using InfluxStandIn::InfluxStandIn;
+      HostHTTPResponse httpRequest(const HostHTTPRequest &request) override
+      {
+        HostHTTPResponse response = InfluxStandIn::httpRequest(request);
+        arrivals.push_back({nowMS(), (uint32_t)request.body.length(), response.code < 400});
+        return response;
+      }
+      std::vector<Arrival> arrivals;
+  };
+
+  class FleetThingSpeak : public ThingSpeakStandIn {
+    public:
+      using ThingSpeakStandIn::ThingSpeakStandIn;
+      HostHTTPResponse httpRequest(const HostHTTPRequest &request) override
+      {
+        HostHTTPResponse response = ThingSpeakStandIn::httpRequest(request);
+        arrivals.push_back({nowMS(), (uint32_t)request.body.length(), response.body != "0"});
+        return response;
+      }
+      std::vector<Arrival> arrivals;
+  };
+
+  class FleetBroker : public MQTTBrokerStandIn {
+    public:
+      using MQTTBrokerStandIn::MQTTBrokerStandIn;
+      uint8_t mqttConnect(const String &clientID, const String &user, const String &password) override
+      {
+        const uint8_t code = MQTTBrokerStandIn::mqttConnect(clientID, user, password);
+        arrivals.push_back({nowMS(), (uint32_t)(clientID.length() + user.length() + password.length()), code == 0});
+        return code;
+      }
+      void mqttPublish(const String &topic, const String &payload, bool retained) override
+      {
+        MQTTBrokerStandIn::mqttPublish(topic, payload, retained);
+        arrivals.push_back({nowMS(), (uint32_t)(topic.length() + payload.length()), true});
+        if (topic.startsWith("homeassistant/")) hassioStates++;
+      }
+      std::vector<Arrival> arrivals;
+      uint32_t hassioStates = 0;
+  };
+
+  struct Device {
+    networkEndpointConfig path;
+    double skew;            // local time runs (1 + skew) times fleet time
+    std::mt19937 random;
+    float co2, temperatureF, humidity, pm25, vocIndex;
+    uint32_t reports = 0;
+  };
+
+  // a device's readings wander around its room's levels between reports
+  float wander(std::mt19937 &random, float value, float step, float low, float high)
+  {
+    value += std::uniform_real_distribution<float>(-step, step)(random);
+    return std::min(high, std::max(low, value));
+  }
+
+  struct Report {
+    uint64_t atMS;
+    uint32_t device;
+    bool operator>(const Report &other) const { return atMS > other.atMS; }
+  };
+
+  void backendPrint(const char *name, const std::vector<Arrival> &arrivals, uint64_t durationMS)
+  {
+    uint64_t payload = 0;
+    uint32_t failures = 0;
+    std::map<uint64_t, uint32_t> perSecond;
+    for (const Arrival &arrival : arrivals) {
+      payload += arrival.payload;
+      failures += !arrival.ok;
+      perSecond[arrival.ms / 1000]++;
+    }
+    const uint64_t seconds = std::max<uint64_t>(1, durationMS / 1000);
+    const double mean = (double)arrivals.size() / seconds;
+    // per second counts, idle seconds included
+    std::vector<uint32_t> counts;
+    counts.reserve(perSecond.size());
+    for (const auto &second : perSecond) counts.push_back(second.second);
+    std::sort(counts.begin(), counts.end());
+    double variance = 0.0;
+    for (uint32_t count : counts) variance += (count - mean) * (count - mean);
+    variance += (seconds - counts.size()) * mean * mean;
+    variance /= seconds;
+    uint64_t peakSecond = 0;
+    uint32_t peak = 0;
+    for (const auto &second : perSecond) {
+      if (second.second > peak) {
+        peak = second.second;
+        peakSecond = second.first;
+      }
+    }
+    const uint64_t p99Index = seconds - 1 - std::min<uint64_t>(seconds - 1, seconds / 100);
+    const uint64_t idle = seconds - counts.size();
+    const uint32_t p99 = (p99Index < idle) ? 0 : counts[p99Index - idle];
+
+    printf("%-11s %9zu %7u %8.2f %6u %6u %9.1f %10.1f %10llu %7.0f  peak at %llu s\n", name, arrivals.size(), failures,
+      mean, p99, peak, mean > 0 ? peak / mean : 0.0, mean > 0 ? variance / mean : 0.0, (unsigned long long)payload,
+      arrivals.empty() ? 0.0 : (double)payload / arrivals.size(), (unsigned long long)peakSecond);
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  uint32_t deviceCount = 100;
+  double hours = 2.0;
+  uint32_t rooms = 12;
+  double bootSpreadS = 10.0;
+  double skewPPM = 50.0;
+  HostNetLink link;
+  link.rttMS = 5;
+  link.serviceMS = 20;
+  uint32_t seed = 1;
+  bool verbose = false;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--devices") && i + 1 < argc) deviceCount = (uint32_t)std::max(1, atoi(argv[++i]));
+    else if (!strcmp(argv[i], "--hours") && i + 1 < argc) hours = atof(argv[++i]);
+    else if (!strcmp(argv[i], "--rooms") && i + 1 < argc) rooms = (uint32_t)std::max(1, atoi(argv[++i]));
+    else if (!strcmp(argv[i], "--boot-spread-s") && i + 1 < argc) bootSpreadS = std::max(0.0, atof(argv[++i]));
+    else if (!strcmp(argv[i], "--skew-ppm") && i + 1 < argc) skewPPM = std::fabs(atof(argv[++i]));
+    else if (!strcmp(argv[i], "--rtt-ms") && i + 1 < argc) link.rttMS = (uint32_t)atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--service-ms") && i + 1 < argc) link.serviceMS = (uint32_t)atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--seed") && i + 1 < argc) seed = (uint32_t)strtoul(argv[++i], nullptr, 0);
+    else if (!strcmp(argv[i], "--verbose")) verbose = true;
+    else {
+      fprintf(stderr, "usage: %s [--devices N] [--hours H] [--rooms R] [--boot-spread-s S] [--skew-ppm P] "
+        "[--rtt-ms MS] [--service-ms MS] [--seed N] [--verbose]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  hostSerialMute(!verbose);
+  hostClockVirtualSet(true);
+
+  // one setup() brings up the sketch's WiFi, configuration and endpoint settings
+  SCD4xSim scd4x;
+  SEN5xSim sen5x;
+  sensirionSimAttach(&scd4x, &sen5x);
+  try {
+    setup();
+  }
+  catch (const HostRestart &) {
+    fprintf(stderr, "paq_fleet: sketch restarted during setup\n");
+    return 1;
+  }
+  sensirionSimAttach(nullptr, nullptr);
+  const networkEndpointConfig setupPath = endpointPath;
+
+  FleetInflux influx(influxKey);
+  FleetBroker broker(mqttBrokerConfig.user, mqttBrokerConfig.password);
+  FleetThingSpeak thingSpeak(THINGS_APIKEY);
+  EndpointStandIn *servers[] = {&influx, &broker, &thingSpeak};
+  for (EndpointStandIn *server : servers) server->link = link;
+  hostNetListen(influxdbConfig.host, influxdbConfig.port, &influx);
+  hostNetListen(mqttBrokerConfig.host, mqttBrokerConfig.port, &broker);
+  hostNetListen(kThingSpeakHost, kThingSpeakPort, &thingSpeak);
+
+  // the fleet's clock starts at the first boot
+  const uint64_t fleetStartMS = nowMS();
+  const uint64_t durationMS = (uint64_t)(hours * 3600000.0);
+  std::mt19937 fleetRandom(seed);
+  std::vector<Device> devices(deviceCount);
+  std::priority_queue<Report, std::vector<Report>, std::greater<Report>> reports;
+  for (uint32_t d = 0; d < deviceCount; d++) {
+    Device &device = devices[d];
+    device.random.seed(seed * 7919u + d);
+    char id[16];
+    snprintf(id, sizeof(id), "%s-%04X", hardwareDeviceType.c_str(), (unsigned)(fleetRandom() & 0xFFFF));
+    device.path = setupPath;
+    device.path.deviceID = id;
+    device.path.room = String(kRoomNames[d % rooms % (sizeof(kRoomNames) / sizeof(kRoomNames[0]))]);
+    if (rooms > sizeof(kRoomNames) / sizeof(kRoomNames[0])) device.path.room += String("-") + (d % rooms);
+    device.skew = std::uniform_real_distribution<double>(-skewPPM, skewPPM)(fleetRandom) / 1e6;
+    device.co2 = std::uniform_real_distribution<float>(500, 900)(device.random);
+    device.temperatureF = std::uniform_real_distribution<float>(68, 75)(device.random);
+    device.humidity = std::uniform_real_distribution<float>(35, 55)(device.random);
+    device.pm25 = std::uniform_real_distribution<float>(2, 15)(device.random);
+    device.vocIndex = std::uniform_real_distribution<float>(80, 130)(device.random);
+
+    // first report one report interval after boot, in this device's time
+    const uint64_t bootMS = (uint64_t)(std::uniform_real_distribution<double>(0, bootSpreadS)(fleetRandom) * 1000);
+    reports.push({fleetStartMS + bootMS + (uint64_t)(timeReportMS / (1.0 + device.skew)), d});
+  }
+
+  const uint32_t samplesPerReport = timeReportMS / timeSensorSampleMS;
+  uint32_t reportCount = 0;
+  try {
+    while (!reports.empty() && reports.top().atMS < fleetStartMS + durationMS) {
+      const Report report = reports.top();
+      reports.pop();
+      Device &device = devices[report.device];
+
+      // the device's samples since its last report, then its samplePost()
+      endpointPath = device.path;
+      uint8_t numSamples = 0;
+      for (uint32_t s = 0; s < samplesPerReport; s++) {
+        device.co2 = wander(device.random, device.co2, 25, sensorCO2Min, sensorCO2Bad);
+        device.temperatureF = wander(device.random, device.temperatureF, 0.3f, 60, 85);
+        device.humidity = wander(device.random, device.humidity, 1, 20, 70);
+        device.pm25 = wander(device.random, device.pm25, 1.5f, 0, 60);
+        device.vocIndex = wander(device.random, device.vocIndex, 5, 1, 300);
+        totalCO2.include(device.co2);
+        totalTemperatureF.include(device.temperatureF);
+        totalHumidity.include(device.humidity);
+        totalPM25.include(device.pm25);
+        totalVOCIndex.include(device.vocIndex);
+        numSamples++;
+      }
+      hostClockVirtualJump(report.atMS * 1000);
+      samplePost(numSamples);
+      device.reports++;
+      reportCount++;
+
+      // as in loop(): timeLastReportMS is set after samplePost() returns
+      reports.push({nowMS() + (uint64_t)(timeReportMS / (1.0 + device.skew)), report.device});
+    }
+  }
+  catch (const HostRestart &) {
+    fprintf(stderr, "paq_fleet: sketch restarted during a report\n");
+    return 1;
+  }
+  hostNetReset();
+
+  uint32_t minReports = UINT32_MAX, maxReports = 0;
+  for (const Device &device : devices) {
+    minReports = std::min(minReports, device.reports);
+    maxReports = std::max(maxReports, device.reports);
+  }
+  printf("paq_fleet: %u devices in %u rooms over %.2f h, booting within %.0f s, clock skew up to %.0f ppm, "
+    "report every %lu s\n", deviceCount, std::min<uint32_t>(rooms, deviceCount), hours, bootSpreadS, skewPPM,
+    (unsigned long)(timeReportMS / 1000));
+  printf("  %u reports (%u-%u per device), Home Assistant states %u, InfluxDB points %u, ThingSpeak updates %u\n",
+    reportCount, minReports, maxReports, broker.hassioStates, influx.points, thingSpeak.accepted);
+  printf("%-11s %9s %7s %8s %6s %6s %9s %10s %10s %7s\n", "backend", "requests", "fails", "req/s", "p99/s", "peak/s",
+    "peak/mean", "var/mean", "payload B", "B/req");
+  backendPrint("influxdb", influx.arrivals, durationMS);
+  backendPrint("mqtt", broker.arrivals, durationMS);
+  backendPrint("thingspeak", thingSpeak.arrivals, durationMS);
+  printf("  requests: HTTP requests, or MQTT CONNECT and PUBLISH packets; p99/s, peak/s: requests in the busiest\n");
+  printf("  1 s windows; peak/mean and var/mean (index of dispersion, 1 for Poisson arrivals) measure burstiness\n");
+  if (thingSpeak.arrivals.size() > thingSpeak.accepted)
+    printf("  ThingSpeak: every device posts with the one compiled in THINGS_APIKEY, so the channel's 15 s update\n"
+      "  limit drops most of the fleet's updates\n");
+
+  // every device reported every interval, and the backends with per device identity took everything
+  bool failed = minReports == 0;
+  for (const Arrival &arrival : influx.arrivals) failed |= !arrival.ok;
+  for (const Arrival &arrival : broker.arrivals) failed |= !arrival.ok;
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,119 @@
+/*
+  Project:      Powered Air Quality
+  Description:  history tier check
+
+  Feeds 32 days of synthetic CO2 readings (a daily swing of +/-200 ppm around 800 with a
+  weekly drift, at irregular 5 s to 2 minute intervals as SAMPLE_ADAPTIVE samples, and a
+  3 hour outage) through HistoryTiers (see history_tiers.h), then reads each tier's window
+  and compares it with a brute force scan of every reading. Fails unless each window holds
+  exactly the readings since the start of its oldest bucket, its minimum and maximum are
+  theirs, and its mean is theirs to the stored precision; and unless the 2 hour window at
+  the end of the outage has no readings.
+
+  Usage: paq_history
+*/
+
+#include <Arduino.h>
+#include "config.h"
+#include "history_tiers.h"
+#include "test_check.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+  constexpr uint32_t kMinuteMS = 60000;
+  constexpr uint32_t kHourMS = 60 * kMinuteMS;
+  constexpr uint32_t kDayMS = 24 * kHourMS;
+  constexpr uint32_t kOutageStartMS = 20 * kDayMS + 5 * kHourMS;
+  constexpr uint32_t kOutageEndMS = kOutageStartMS + 3 * kHourMS;
+
+  struct Reading {
+    uint32_t ms;
+    float co2;
+  };
+
+  HistoryTiers tiers;
+  std::vector<Reading> readings;
+
+  // the room, at any ms
+  float room(uint32_t ms)
+  {
+    const double day = (double)ms / kDayMS;
+    return 800.0f + 200.0f * sinf(2.0f * PI * day) + 50.0f * sinf(2.0f * PI * day / 7.0f);
+  }
+
+  struct Exact {
+    uint32_t readings = 0;
+    float minValue = 0.0f, maxValue = 0.0f;
+    double mean = 0.0;
+  };
+
+  // the readings from startMS on
+  Exact exact(uint32_t startMS)
+  {
+    Exact result;
+    double total = 0.0;
+    for (const Reading &r : readings) {
+      if (r.ms < startMS) continue;
+      if (!result.readings || r.co2 < result.minValue) result.minValue = r.co2;
+      if (!result.readings || r.co2 > result.maxValue) result.maxValue = r.co2;
+      total += r.co2;
+      result.readings++;
+    }
+    if (result.readings) result.mean = total / result.readings;
+    return result;
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc > 1) {
+    fprintf(stderr, "usage: %s\n", argv[0]);
+    return 2;
+  }
+
+  std::mt19937 random(7);
+  const uint32_t endMS = 32 * kDayMS;
+  bool ok = true;
+  for (uint32_t ms = 1000; ms < endMS; ms += std::uniform_int_distribution<uint32_t>(5000, 120000)(random)) {
+    if (ms >= kOutageStartMS && ms < kOutageEndMS) continue;
+    const float co2 = room(ms) + std::uniform_real_distribution<float>(-5.0f, 5.0f)(random);
+    // the first reading after the outage, the 2 hours before had none
+    if (ms >= kOutageEndMS && readings.back().ms < kOutageStartMS) {
+      HistorySpan outage;
+      ok &= check(!tiers.window(0, historyCO2, ms, outage), "no readings in the outage");
+    }
+    readings.push_back({ms, co2});
+    tiers.include(historyCO2, co2, ms);
+  }
+
+  printf("paq_history: %zu readings over %u days, %u tiers, %zu bytes\n", readings.size(), endMS / kDayMS,
+    (unsigned)kTierCount, sizeof(HistoryTiers));
+  printf("  %-8s %9s %16s %16s %18s\n", "tier", "readings", "min (exact)", "max (exact)", "mean (exact)");
+  const uint32_t nowMS = endMS;
+  const uint32_t firstMS = readings.front().ms;
+  for (uint8_t tier = 0; tier < kTierCount; tier++) {
+    HistorySpan window;
+    char name[16];
+    snprintf(name, sizeof(name), "%lu min", (unsigned long)(kTierBucketMS[tier] / kMinuteMS));
+    if (!check(tiers.window(tier, historyCO2, nowMS, window), name)) {
+      ok = false;
+      continue;
+    }
+    // buckets count from the first reading; the window is the ring and the open bucket
+    const uint32_t openMS = firstMS + (nowMS - firstMS) / kTierBucketMS[tier] * kTierBucketMS[tier];
+    const Exact expected = exact(openMS - kTierBuckets[tier] * kTierBucketMS[tier]);
+    const float tolerance = 1.0f / kHistoryScale[historyCO2];
+    printf("  %-8s %9u %7.0f (%6.0f) %7.0f (%6.0f) %8.2f (%7.2f)\n", name, window.readings, window.minValue,
+      expected.minValue, window.maxValue, expected.maxValue, window.mean, expected.mean);
+    ok &= check(window.readings == expected.readings, "readings");
+    ok &= check(fabsf(window.minValue - expected.minValue) <= tolerance, "minimum");
+    ok &= check(fabsf(window.maxValue - expected.maxValue) <= tolerance, "maximum");
+    ok &= check(fabs(window.mean - expected.mean) <= tolerance, "mean");
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,53 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host runner; calls the sketch's setup() and loop() like the ESP32 core does
+
+  Usage: paq_host [--loops N] [--duration-ms MS] [--quiet]
+    --loops N         stop after N loop() calls (default: unlimited)
+    --duration-ms MS  stop after MS milliseconds of millis() time (default 15000)
+    --quiet           suppress the sketch's serial output
+*/
+
+#include <Arduino.h>
+#include "host_runtime.h"
+#include "sketch_prototypes.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char *argv[])
+{
+  uint64_t loopLimit = 0;
+  uint32_t durationMS = 15000;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--loops") && i + 1 < argc) loopLimit = strtoull(argv[++i], nullptr, 10);
+    else if (!strcmp(argv[i], "--duration-ms") && i + 1 < argc) durationMS = (uint32_t)strtoul(argv[++i], nullptr, 10);
+    else if (!strcmp(argv[i], "--quiet")) hostSerialMute(true);
+    else {
+      fprintf(stderr, "usage: %s [--loops N] [--duration-ms MS] [--quiet]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  uint64_t loops = 0;
+  uint32_t restarts = 0;
+  const uint32_t timeStartMS = millis();
+
+  try {
+    setup();
+    while ((!loopLimit || loops < loopLimit) && (millis() - timeStartMS) < durationMS) {
+      loop();
+      loops++;
+    }
+  }
+  catch (const HostRestart &) {
+    restarts++;
+  }
+
+  printf("paq_host: %llu loop() calls, %lu ms, %u restart(s), %lu serial lines\n",
+    (unsigned long long)loops, (unsigned long)(millis() - timeStartMS), restarts,
+    (unsigned long)hostSerialLines());
+  return restarts ? 1 : 0;
+}
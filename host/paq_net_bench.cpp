@@ -0,0 +1,427 @@
+/*
+  Project:      Powered Air Quality
+  Description:  network endpoint latency benchmark
+
+  Runs the hardware build with MQTT enabled against stand-in servers for Open Weather
+  Map, InfluxDB, ThingSpeak and an MQTT broker (see endpoint_standins.h), listening where
+  the sketch's own settings point: kOWMServer, influxdbConfig, mqttBrokerConfig and the
+  ThingSpeak URL in post_thingspeak.cpp. For each link scenario (latency, loss, server
+  errors, slow responses) it calls every endpoint path the sketch has and times it on
+  the virtual clock, then runs loop() through a whole report interval, pressing the
+  touchscreen every kTouchEveryMS, and totals the time loop() was blocked and the time
+  from each press to its redraw. The scenarios then run again dual core, reporting in
+  the worker task (see dual_core.h), where every press must be redrawn within
+  timeLoopIdleMaxMS, one pass of loop(), even while a report is in flight. Times are
+  what the device would spend waiting, not host time; drawing itself takes none. Under the
+  slow drip the small bodies, OWM air pollution and ThingSpeak's, must arrive whole.
+
+  Usage: paq_net_bench [--cycles N] [--scenario NAME] [--rtt-ms MS] [--service-ms MS] [--loss PCT]
+                       [--drip BYTES/MS] [--status CODE] [--verbose]
+    --cycles N        repetitions per scenario (default 3)
+    --scenario NAME   run only this built in scenario
+    --rtt-ms .. --status
+                      run one custom scenario with these link conditions instead: round trip
+                      time, server think time, packet exchange loss, a slow drip of BYTES every
+                      MS for response bodies, and an HTTP status every server answers with
+    --verbose         show the sketch's serial output
+*/
+
+#include <Arduino.h>
+#include "host_runtime.h"
+#include "sketch_prototypes.h"
+#include "config.h"
+#include "powered_air_quality.h"
+#include "data.h"
+#include "secrets.h"
+#include "endpoint_standins.h"
+#include "sensirion_sim.h"
+#include "blocking_budget.h"
+#include "scheduler.h"
+#include "dual_core.h"
+#include <PubSubClient.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+// post_thingspeak.cpp, post_influx.cpp, post_mqtt.cpp
+extern bool post_thingspeak(float pm25, float co2, float temperatureF, float humidity, float vocIndex, float aqi);
+extern bool post_influx(float temperatureF, float humidity, float co2, float pm25, float vocIndex, uint8_t rssi);
+extern bool mqttConnect();
+extern bool mqttPublishValue(String key, const String &payload);
+
+// sketch state
+extern PubSubClient mqtt;
+extern uint32_t timeLastReportMS, timeLastInputMS;
+extern uint8_t taskReport;
+
+namespace {
+  const char *kThingSpeakHost = "api.thingspeak.com";  // post_thingspeak.cpp posts to a fixed URL
+  constexpr uint16_t kThingSpeakPort = 80;
+
+  // values posted by the direct endpoint calls
+  constexpr float kPM25 = 12.5f, kCO2 = 812.0f, kTemperatureF = 71.5f, kHumidity = 45.0f, kVOC = 102.0f, kAQI = 52.0f;
+  constexpr uint8_t kRSSI = 60;
+
+  // touchscreen presses, at the middle of the screen
+  constexpr uint32_t kTouchEveryMS = 1000;
+  constexpr uint16_t kTouchX = (touchscreenMinX + touchscreenMaxX) / 2;
+  constexpr uint16_t kTouchY = (touchscreenMinY + touchscreenMaxY) / 2;
+
+  struct Scenario {
+    std::string name;
+    HostNetLink link;
+    int status;       // HTTP status every server answers with, 0 for normal service
+    bool listening;   // false: nothing listening, connections are refused
+  };
+
+  Scenario scenarioMake(const char *name, uint32_t rttMS, uint32_t serviceMS, uint8_t lossPercent,
+                        uint32_t dripBytes = 0, uint32_t dripIntervalMS = 0, int status = 0, bool listening = true)
+  {
+    Scenario scenario = {name, HostNetLink(), status, listening};
+    scenario.link.rttMS = rttMS;
+    scenario.link.serviceMS = serviceMS;
+    scenario.link.lossPercent = lossPercent;
+    scenario.link.dripBytes = dripBytes;
+    scenario.link.dripIntervalMS = dripIntervalMS;
+    return scenario;
+  }
+
+  std::vector<Scenario> scenariosBuiltIn()
+  {
+    return {
+      scenarioMake("lan", 2, 10, 0),
+      scenarioMake("wan", 120, 60, 0),
+      scenarioMake("lossy", 120, 60, 10),
+      scenarioMake("slow-server", 120, 4000, 0),
+      scenarioMake("stalled", 120, 20000, 0),
+      scenarioMake("slow-drip", 120, 60, 0, 256, 1000),
+      scenarioMake("http-500", 120, 60, 0, 0, 0, 500),
+      scenarioMake("http-503", 120, 60, 0, 0, 0, 503),
+      scenarioMake("blackhole", 120, 60, 100),
+      scenarioMake("offline", 0, 0, 0, 0, 0, 0, false),
+    };
+  }
+
+  struct Endpoint {
+    const char *name;
+    EndpointStandIn *server;
+    std::function<bool()> call;
+    // per scenario
+    uint32_t ok;
+    std::vector<double> ms;
+    HostNetStats stats;
+  };
+
+  struct Listener {
+    String host;
+    uint16_t port;
+    EndpointStandIn *server;
+  };
+
+  double virtualMS(uint64_t sinceUS)
+  {
+    return (hostClockMicros() - sinceUS) / 1000.0;
+  }
+
+  HostNetStats statsDelta(const HostNetStats &now, const HostNetStats &before)
+  {
+    HostNetStats delta;
+    delta.requests = now.requests - before.requests;
+    delta.failures = now.failures - before.failures;
+    delta.bytesSent = now.bytesSent - before.bytesSent;
+    delta.bytesReceived = now.bytesReceived - before.bytesReceived;
+    return delta;
+  }
+
+  void statsAdd(HostNetStats &total, const HostNetStats &delta)
+  {
+    total.requests += delta.requests;
+    total.failures += delta.failures;
+    total.bytesSent += delta.bytesSent;
+    total.bytesReceived += delta.bytesReceived;
+  }
+
+  // a report interval as loop() saw it
+  struct Interval {
+    double blockedMS = 0.0;   // loop() blocked, not idling
+    double loopMaxMS = 0.0;   // the longest loop() call
+    double reportMS = 0.0;    // the report task's run, on whichever core
+    double touchTotalMS = 0.0;
+    double touchMaxMS = 0.0;  // press to redraw
+    uint32_t touches = 0;
+  };
+
+  // the queued touchscreen press, which may outlast a report interval
+  uint64_t pressUS = 0;
+  bool pressPending = false;
+
+  // calls loop() at each deadline, loop()'s or the worker's, and at each touch press until a
+  // report has been made
+  Interval loopUntilReport()
+  {
+    Interval interval;
+    for (;;) {
+      if (!pressPending) {
+        pressUS = hostClockMicros() + (uint64_t)kTouchEveryMS * 1000;
+        hostTouchPressAt(kTouchX, kTouchY, pressUS);
+        pressPending = true;
+      }
+      // the worker may report while the clock advances
+      const uint32_t reportBefore = timeLastReportMS;
+      const uint32_t inputBefore = timeLastInputMS;
+      const uint64_t nowUS = hostClockMicros();
+      const uint64_t wakeUS = std::min(hostTasksWakeMicros(), pressUS);
+      hostClockAdvanceMicros(std::min((uint64_t)schedulerIdleMS() * 1000, wakeUS > nowUS ? wakeUS - nowUS : 0));
+
+      const uint64_t startUS = hostClockMicros();
+      const uint64_t idleBeforeUS = schedulerStats().idleTotalUS;
+      loop();
+      const double ms = virtualMS(startUS) - (schedulerStats().idleTotalUS - idleBeforeUS) / 1000.0;
+      interval.blockedMS += ms;
+      interval.loopMaxMS = std::max(interval.loopMaxMS, ms);
+      if (timeLastInputMS != inputBefore) {
+        const double touchMS = (double)(timeLastInputMS - (uint32_t)(pressUS / 1000));
+        interval.touchTotalMS += touchMS;
+        interval.touchMaxMS = std::max(interval.touchMaxMS, touchMS);
+        interval.touches++;
+        pressPending = false;
+      }
+      if (timeLastReportMS != reportBefore) {
+        const uint8_t core = dualCoreSplit() ? coreWorker : xPortGetCoreID();
+        interval.reportMS = schedulerTask(taskReport, core).busyMaxUS / 1000.0;
+        return interval;
+      }
+    }
+  }
+
+  // setup() again, as the device does after a restart; false if that restarted too. A
+  // press queued before is lost, as it would be while the device boots
+  bool setupAgain()
+  {
+    hostTouchClear();
+    pressPending = false;
+    try {
+      setup();
+    }
+    catch (const HostRestart &) {
+      return false;
+    }
+    return true;
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  uint32_t cycles = 3;
+  std::vector<Scenario> scenarios = scenariosBuiltIn();
+  const char *only = nullptr;
+  Scenario custom = scenarioMake("custom", 2, 10, 0);
+  bool customSet = false;
+  bool verbose = false;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--cycles") && i + 1 < argc) cycles = (uint32_t)std::max(1, atoi(argv[++i]));
+    else if (!strcmp(argv[i], "--scenario") && i + 1 < argc) only = argv[++i];
+    else if (!strcmp(argv[i], "--rtt-ms") && i + 1 < argc) { custom.link.rttMS = (uint32_t)atoi(argv[++i]); customSet = true; }
+    else if (!strcmp(argv[i], "--service-ms") && i + 1 < argc) { custom.link.serviceMS = (uint32_t)atoi(argv[++i]); customSet = true; }
+    else if (!strcmp(argv[i], "--loss") && i + 1 < argc) { custom.link.lossPercent = (uint8_t)std::min(100, atoi(argv[++i])); customSet = true; }
+    else if (!strcmp(argv[i], "--drip") && i + 1 < argc &&
+             sscanf(argv[i + 1], "%u/%u", &custom.link.dripBytes, &custom.link.dripIntervalMS) == 2) { i++; customSet = true; }
+    else if (!strcmp(argv[i], "--status") && i + 1 < argc) { custom.status = atoi(argv[++i]); customSet = true; }
+    else if (!strcmp(argv[i], "--verbose")) verbose = true;
+    else {
+      fprintf(stderr, "usage: %s [--cycles N] [--scenario NAME] [--rtt-ms MS] [--service-ms MS] [--loss PCT] "
+        "[--drip BYTES/MS] [--status CODE] [--verbose]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (customSet) scenarios = {custom};
+  else if (only) {
+    scenarios.erase(std::remove_if(scenarios.begin(), scenarios.end(),
+      [only](const Scenario &s) { return s.name != only; }), scenarios.end());
+    if (scenarios.empty()) {
+      fprintf(stderr, "paq_net_bench: no scenario named %s\n", only);
+      return 2;
+    }
+  }
+
+  hostSerialMute(!verbose);
+  hostClockVirtualSet(true);
+
+  SCD4xSim scd4x;
+  SEN5xSim sen5x;
+  sensirionSimAttach(&scd4x, &sen5x);
+  try {
+    setup();
+  }
+  catch (const HostRestart &) {
+    fprintf(stderr, "paq_net_bench: sketch restarted during setup\n");
+    return 1;
+  }
+
+  // stand-ins go where setup() left the endpoint settings
+  String owmHost, owmPath;
+  uint16_t owmPort = 0;
+  if (!endpointURLSplit(kOWMServer, owmHost, owmPort, owmPath)) {
+    fprintf(stderr, "paq_net_bench: can't parse kOWMServer %s\n", kOWMServer.c_str());
+    return 2;
+  }
+  OWMStandIn owm(owmPath);
+  InfluxStandIn influx(influxKey);
+  ThingSpeakStandIn thingSpeak(THINGS_APIKEY);
+  MQTTBrokerStandIn broker(mqttBrokerConfig.user, mqttBrokerConfig.password);
+  const std::vector<Listener> listeners = {
+    {owmHost, owmPort, &owm},
+    {influxdbConfig.host, influxdbConfig.port, &influx},
+    {kThingSpeakHost, kThingSpeakPort, &thingSpeak},
+    {mqttBrokerConfig.host, mqttBrokerConfig.port, &broker},
+  };
+
+  std::vector<Endpoint> endpoints = {
+    {"owm-air", &owm, [] { return OWMAirPollutionRead(); }, 0, {}, {}},
+    {"owm-forecast", &owm, [] { return (bool)OWMForecastRead(); }, 0, {}, {}},
+    {"thingspeak", &thingSpeak, [] { return post_thingspeak(kPM25, kCO2, kTemperatureF, kHumidity, kVOC, kAQI); }, 0, {}, {}},
+    {"influx", &influx, [] { return post_influx(kTemperatureF, kHumidity, (uint16_t)kCO2, kPM25, kVOC, kRSSI); }, 0, {}, {}},
+    // the MQTT block of samplePost()
+    {"mqtt", &broker, [] {
+      if (!mqttConnect()) return false;
+      bool ok = mqttPublishValue(VALUE_KEY_RSSI, String(kRSSI));
+      ok &= mqttPublishValue(VALUE_KEY_TEMPERATURE, String(kTemperatureF));
+      ok &= mqttPublishValue(VALUE_KEY_HUMIDITY, String(kHumidity));
+      ok &= mqttPublishValue(VALUE_KEY_PM25, String(kPM25));
+      ok &= mqttPublishValue(VALUE_KEY_VOC, String(kVOC));
+      ok &= mqttPublishValue(VALUE_KEY_CO2, String(kCO2));
+      mqtt.disconnect();
+      return ok;
+    }, 0, {}, {}},
+  };
+
+  printf("paq_net_bench: %u cycles per scenario, report interval %lu s, times are device ms on the virtual clock\n",
+    cycles, (unsigned long)(timeReportMS / 1000));
+  printf("  OWM %s:%u, InfluxDB %s:%u, ThingSpeak %s:%u, MQTT %s:%u\n", owmHost.c_str(), owmPort,
+    influxdbConfig.host.c_str(), influxdbConfig.port, kThingSpeakHost, kThingSpeakPort, mqttBrokerConfig.host.c_str(),
+    mqttBrokerConfig.port);
+  printf("%-12s %-13s %5s %9s %9s %5s %5s %8s %8s\n", "scenario", "endpoint", "ok", "mean ms", "max ms", "reqs",
+    "fails", "sent B", "recv B");
+
+  bool failed = false;
+  for (const bool dualCore : {false, true}) {
+    if (dualCore) {
+      // the worker task makes the reports; its requests would mix with direct endpoint calls
+      printf("dual core: sensing and reporting in the worker task on core %u, loop() on core %d\n", coreWorker,
+        (int)xPortGetCoreID());
+      hostTasksEnable(true);
+      if (!setupAgain() || !dualCoreSplit()) {
+        fprintf(stderr, "paq_net_bench: worker task did not start\n");
+        return 1;
+      }
+    }
+
+    for (const Scenario &scenario : scenarios) {
+      for (const Listener &listener : listeners) {
+        listener.server->link = scenario.link;
+        listener.server->failStatus = scenario.status;
+        listener.server->lossSeed = 0x9E3779B9;
+        hostNetListen(listener.host, listener.port, scenario.listening ? listener.server : nullptr);
+      }
+      for (Endpoint &endpoint : endpoints) {
+        endpoint.ok = 0;
+        endpoint.ms.clear();
+        endpoint.stats = HostNetStats();
+      }
+      std::vector<Interval> intervals;
+      uint32_t overrunsBefore[kBudgetCount];
+      for (uint8_t b = 0; b < kBudgetCount; b++) overrunsBefore[b] = budgetStats(b).overruns;
+      const uint32_t tripsBefore = hostTaskWDTStats().trips;
+
+      try {
+        for (uint32_t c = 0; c < cycles; c++) {
+          // past ThingSpeak's rate limit since the last report's update
+          if (!dualCore) hostClockAdvanceMicros((uint64_t)ThingSpeakStandIn::kMinIntervalMS * 1000);
+          for (Endpoint &endpoint : endpoints) {
+            if (dualCore) break;
+            const HostNetStats before = endpoint.server->stats;
+            const uint64_t startUS = hostClockMicros();
+            budgetWatchdogFeed();  // as loop() would before each call
+            const bool ok = endpoint.call();
+            endpoint.ms.push_back(virtualMS(startUS));
+            endpoint.ok += ok;
+            statsAdd(endpoint.stats, statsDelta(endpoint.server->stats, before));
+          }
+
+          // catch up to a report, then time one full report interval
+          loopUntilReport();
+          intervals.push_back(loopUntilReport());
+        }
+      }
+      catch (const HostRestart &) {
+        // the network timeouts (config.h) end every request well inside the watchdog's period,
+        // so however bad the link, a block shows as a budget overrun and never as a reset
+        const bool watchdog = hostTaskWDTStats().trips != tripsBefore;
+        printf("%-12s %s\n", scenario.name.c_str(), watchdog ? "task watchdog reset the device" : "sketch restarted");
+        failed = true;
+        if (!setupAgain()) {
+          fprintf(stderr, "paq_net_bench: sketch restarted during setup\n");
+          return 1;
+        }
+        continue;
+      }
+
+      for (size_t e = 0; e < endpoints.size() && !dualCore; e++) {
+        const Endpoint &endpoint = endpoints[e];
+        double totalMS = 0.0;
+        for (double ms : endpoint.ms) totalMS += ms;
+        char okText[16];
+        snprintf(okText, sizeof(okText), "%u/%u", endpoint.ok, cycles);
+        printf("%-12s %-13s %5s %9.1f %9.1f %5u %5u %8llu %8llu\n", e ? "" : scenario.name.c_str(), endpoint.name, okText,
+          totalMS / cycles, *std::max_element(endpoint.ms.begin(), endpoint.ms.end()), endpoint.stats.requests,
+          endpoint.stats.failures, (unsigned long long)endpoint.stats.bytesSent,
+          (unsigned long long)endpoint.stats.bytesReceived);
+        if (scenario.name == "lan" && endpoint.ok != cycles) failed = true;
+        // gaps under timeNetworkReadMS don't end a body, only the transfer limit does
+        const bool small = !strcmp(endpoint.name, "owm-air") || !strcmp(endpoint.name, "thingspeak");
+        if (scenario.name == "slow-drip" && small && endpoint.ok != cycles) {
+          printf("  %s: a body dripping in under the read timeout was cut off\n", endpoint.name);
+          failed = true;
+        }
+      }
+      Interval total, worst;
+      for (const Interval &interval : intervals) {
+        total.blockedMS += interval.blockedMS;
+        total.reportMS += interval.reportMS;
+        total.touchTotalMS += interval.touchTotalMS;
+        total.touches += interval.touches;
+        worst.blockedMS = std::max(worst.blockedMS, interval.blockedMS);
+        worst.loopMaxMS = std::max(worst.loopMaxMS, interval.loopMaxMS);
+        worst.touchMaxMS = std::max(worst.touchMaxMS, interval.touchMaxMS);
+      }
+      printf("%-12s %-13s %5s %9.1f %9.1f   loop() blocked per report interval; longest loop() %.1f ms, report %.1f ms\n",
+        dualCore ? scenario.name.c_str() : "", "report cycle", "-", total.blockedMS / cycles, worst.blockedMS,
+        worst.loopMaxMS, total.reportMS / cycles);
+      printf("%-12s %-13s %5s %9.1f %9.1f   press to redraw, %u touches\n", "", "touch", "-",
+        total.touches ? total.touchTotalMS / total.touches : 0.0, worst.touchMaxMS, total.touches);
+      if (dualCore && worst.touchMaxMS > timeLoopIdleMaxMS) failed = true;
+      String overruns;
+      for (uint8_t b = 0; b < kBudgetCount; b++) {
+        const uint32_t count = budgetStats(b).overruns - overrunsBefore[b];
+        if (count) overruns += String(" ") + budgetName[b] + " " + count;
+      }
+      printf("%-12s %-13s %s\n", "", "overruns", overruns.length() ? overruns.c_str() + 1 : "none");
+      if (scenario.name == "lan" && overruns.length()) failed = true;
+    }
+  }
+  hostTasksEnable(false);
+  hostNetReset();
+  sensirionSimAttach(nullptr, nullptr);
+  printf("  ok: calls that returned success; reqs/fails: HTTP requests and MQTT packets, failed ones time out,\n");
+  printf("  were refused or got an HTTP error; sent/recv: bytes on the link including TCP, TLS and HTTP overhead;\n");
+  printf("  touch: ms from a press to loop() redrawing for it, at most %lu ms dual core\n",
+    (unsigned long)timeLoopIdleMaxMS);
+
+  return failed ? 1 : 0;
+}
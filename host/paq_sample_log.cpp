@@ -0,0 +1,297 @@
+/*
+  Project:      Powered Air Quality
+  Description:  sample log check
+
+  Appends samples to the flash sample log (see sample_log.h) on the LittleFS stand-in,
+  at 30 to 90 s apart on the virtual clock, and reboots it along the way: after three
+  segments and more, after it wraps past kLogSegments, with a torn write at its tail and
+  with a page corrupted. Fails unless writes are whole flash pages to a segment file opened
+  once, not once a page, samples compress to
+  less than half their 14 bytes, a reboot keeps every record but the page being filled,
+  a restart through the sketch's deviceRestart() mid-page keeps them all, records read back as appended, sampleLogFind() agrees with a scan of the appended times
+  in a few reads, the log holds no more than kLogSegments, a torn tail starts a new
+  segment, a corrupt page rebuilds as missing samples, and the history rebuilds in full,
+  or within its budget newest first, at boot; and unless without a LittleFS partition the
+  log does nothing.
+
+  Usage: paq_sample_log [--verbose]
+    --verbose  print the log's report at each reboot
+*/
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include "host_runtime.h"
+#include "sketch_prototypes.h"
+#include "config.h"
+#include "sample_history.h"
+#include "sample_log.h"
+#include "test_check.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+  struct Expected {
+    uint32_t timeS;
+    int16_t values[kHistoryChannelCount];
+  };
+
+  // records by number, as the log numbers them since its last reboot
+  std::vector<Expected> expected;
+  std::mt19937 random(11);
+  SampleHistory history;
+  bool verbose = false;
+
+  void append(uint32_t count)
+  {
+    std::uniform_int_distribution<int> noise(-2, 2);
+    for (uint32_t i = 0; i < count; i++) {
+      // mostly 30 s apart, as at a steady sample period
+      const uint32_t apartMS = (random() % 8) ? 30000 : std::uniform_int_distribution<uint32_t>(30000, 90000)(random);
+      hostClockAdvanceMicros(apartMS * 1000ULL);
+      // a room drifting through the day, with sensor noise
+      const uint32_t n = expected.size();
+      const float values[kHistoryChannelCount] = {21.5f + 1.5f * sinf(n / 500.0f) + noise(random) / 10.0f,
+        45.0f + 5.0f * sinf(n / 700.0f), 600.0f + 300.0f * powf(sinf(n / 300.0f), 2) + noise(random),
+        3.0f + (noise(random) + 2) / 10.0f, 100.0f + 20.0f * sinf(n / 900.0f)};
+      // a field missing now and then
+      const uint8_t valid = (n % 37) ? 0x1F : 0x1F & ~(1 << (n % kHistoryChannelCount));
+      Expected record;
+      // the time sampleLogAppend() is about to take
+      record.timeS = sampleLogTimeS();
+      for (uint8_t channel = 0; channel < kHistoryChannelCount; channel++)
+        record.values[channel] = (valid & (1 << channel)) ? historyStored(channel, values[channel]) : kHistoryMissing;
+      expected.push_back(record);
+      sampleLogAppend(values, valid);
+    }
+  }
+
+  // appends until the log writes a page; returns the number of the record that starts the
+  // page being filled
+  uint32_t appendPage()
+  {
+    const uint32_t pages = sampleLogStats().pages;
+    while (sampleLogStats().pages == pages) append(1);
+    return sampleLogEnd() - 1;
+  }
+
+  // boots the log again; returns how many records of the page being filled it lost. Records are numbered
+  // from the oldest on flash again
+  uint32_t reboot()
+  {
+    const uint32_t first = sampleLogFirst();
+    sampleLogBegin();
+    expected.erase(expected.begin(), expected.begin() + first);
+    const uint32_t lost = expected.size() - sampleLogEnd();
+    expected.resize(sampleLogEnd());
+    if (verbose) printf("  %s\n", sampleLogReport().c_str());
+    return lost;
+  }
+
+  bool readsBack(const char *what)
+  {
+    std::vector<SampleLogRecord> records(sampleLogEnd() - sampleLogFirst());
+    uint32_t read = 0;
+    while (read < records.size()) {
+      const uint16_t chunk = std::min<uint32_t>(records.size() - read, 1000);
+      const uint16_t got = sampleLogRead(sampleLogFirst() + read, records.data() + read, chunk);
+      if (got != chunk) break;
+      read += got;
+    }
+    bool same = (read == records.size());
+    for (uint32_t i = 0; same && i < read; i++) {
+      const Expected &want = expected[sampleLogFirst() + i];
+      same = records[i].timeS == want.timeS && !memcmp(records[i].values, want.values, sizeof(want.values));
+    }
+    return check(same, what);
+  }
+
+  // average flash reads per sampleLogFind(), checked against a scan of the appended times
+  bool finds(uint32_t lookups, float &readsPerLookup)
+  {
+    const uint32_t first = sampleLogFirst();
+    const uint32_t firstS = expected[first].timeS, lastS = expected.back().timeS;
+    hostFlashStatsReset();
+    bool same = true;
+    for (uint32_t i = 0; i < lookups; i++) {
+      const uint32_t timeS = std::uniform_int_distribution<uint32_t>(firstS ? firstS - 10 : 0, lastS + 10)(random);
+      const auto it = std::lower_bound(expected.begin() + first, expected.end(), timeS,
+        [](const Expected &record, uint32_t t) { return record.timeS < t; });
+      if (sampleLogFind(timeS) != (uint32_t)(it - expected.begin())) same = false;
+    }
+    readsPerLookup = (float)hostFlashStats().reads / lookups;
+    return same;
+  }
+
+  // a sample of the rebuilt history against the record it came from
+  bool rebuiltSame(uint32_t sample, const Expected &want)
+  {
+    for (uint8_t channel = 0; channel < kHistoryChannelCount; channel++) {
+      float low, high, mean;
+      const bool present = history.span(channel, sample, sample + 1, low, high, mean);
+      if (present != (want.values[channel] != kHistoryMissing)) return false;
+      if (present && roundf(mean * kHistoryScale[channel]) != want.values[channel]) return false;
+    }
+    return true;
+  }
+
+  bool rebuildsNewest(uint32_t restored)
+  {
+    const uint32_t count = std::min<uint32_t>(sampleLogEnd() - sampleLogFirst(), kHistoryCapacity);
+    bool same = history.appended() == count;
+    for (uint32_t i = count - restored; same && i < count; i++) same = rebuiltSame(i, expected[sampleLogEnd() - count + i]);
+    return same;
+  }
+
+  String newestSegment()
+  {
+    String newest;
+    File directory = LittleFS.open("/samples");
+    for (File file = directory.openNextFile(); file; file = directory.openNextFile())
+      if (newest.length() == 0 || strcmp(file.name(), newest.c_str()) > 0) newest = file.name();
+    return String("/samples/") + newest;
+  }
+
+  uint32_t segmentFiles()
+  {
+    uint32_t count = 0;
+    File directory = LittleFS.open("/samples");
+    for (File file = directory.openNextFile(); file; file = directory.openNextFile()) count++;
+    return count;
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--verbose")) verbose = true;
+    else {
+      fprintf(stderr, "usage: %s [--verbose]\n", argv[0]);
+      return 2;
+    }
+  }
+  hostClockVirtualSet(true);
+  hostFlashErase();
+  bool ok = true;
+
+  ok &= check(sampleLogBegin() && sampleLogEnd() == 0, "a fresh partition mounts, empty");
+  hostFlashStatsReset();
+  while (segmentFiles() < 4) append(1000);
+  const HostFlashStats written = hostFlashStats();
+  const uint32_t firstRun = sampleLogEnd();
+  ok &= check(written.writes == sampleLogStats().pages
+    && written.bytesWritten == (uint64_t)written.writes * kLogPageBytes, "writes whole pages");
+
+  // a reboot keeps what was written
+  const uint32_t lost = reboot();
+  const float bytesPerRecord = (float)written.bytesWritten / sampleLogEnd();
+  printf("paq_sample_log: %u records, %u page writes of %u bytes, %.2f bytes a record (%u raw); a reboot lost %u\n",
+    firstRun, written.writes, kLogPageBytes, bytesPerRecord,
+    (unsigned)(sizeof(uint32_t) + kHistoryChannelCount * sizeof(int16_t)), lost);
+  // days a KB holds at the sample period, the log's compressed records and the graphs'
+  // uncompressed history in DRAM
+  const float daysPerSample = timeSensorSampleMS / 86400000.0f;
+  printf("  %.3f days of samples a KB of flash, %.3f a KB of DRAM history (%u bytes a sample, uncompressed)\n",
+    1024.0f / bytesPerRecord * daysPerSample, 1024.0f / (kHistoryChannelCount * sizeof(int16_t)) * daysPerSample,
+    (unsigned)(kHistoryChannelCount * sizeof(int16_t)));
+  ok &= check(bytesPerRecord < 7.0f, "records compress to less than half");
+  ok &= check(lost * bytesPerRecord < kLogPageBytes, "a reboot loses only the page being filled");
+  ok &= readsBack("records read back as appended");
+  hostFlashStatsReset();
+  for (uint8_t i = 0; i < 20; i++) appendPage();
+  ok &= check(hostFlashStats().opens <= 1, "opens a segment's file once, not once a page");
+
+  // a restart writes the page being filled first
+  appendPage();
+  append(20);
+  try {
+    deviceRestart();
+  }
+  catch (const HostRestart &) {
+  }
+  ok &= check(reboot() == 0, "a restart mid-page keeps every record");
+  ok &= readsBack("records read back after a restart mid-page");
+  ok &= check(sampleLogTimeS() > expected.back().timeS, "the clock carries on after a reboot");
+  uint32_t restored = sampleLogRebuild(history, 60000);
+  ok &= check(restored == kHistoryCapacity && rebuildsNewest(restored), "the history rebuilds in full");
+  printf("  rebuilt %u samples in %u ms\n", restored, sampleLogStats().rebuildMS);
+
+  float readsPerLookup = 0.0f;
+  ok &= check(finds(1000, readsPerLookup), "sampleLogFind() agrees with a scan");
+  printf("  %u records on flash, %.1f flash reads per lookup\n", sampleLogEnd() - sampleLogFirst(), readsPerLookup);
+  ok &= check(readsPerLookup <= kLogIndexStride + 1, "a lookup reads one stride's headers and a page");
+
+  // wrapping deletes the oldest segments
+  while (!sampleLogFirst()) append(1000);
+  append(5000);
+  ok &= check(segmentFiles() <= kLogSegments && sampleLogFirst() > 0, "the log keeps kLogSegments segments");
+  ok &= readsBack("records read back after wrapping");
+  ok &= check(finds(1000, readsPerLookup), "sampleLogFind() agrees with a scan after wrapping");
+  ok &= check(reboot() * bytesPerRecord < kLogPageBytes && sampleLogFirst() == 0, "a reboot after wrapping");
+  ok &= readsBack("records read back after a reboot after wrapping");
+  printf("  wrapped: %u records in %u segments\n", sampleLogEnd(), segmentFiles());
+
+  // a write cut off by a reset leaves a torn page at the tail
+  {
+    File file = LittleFS.open(newestSegment(), FILE_APPEND);
+    const uint8_t torn[5] = {1, 2, 3, 4, 5};
+    file.write(torn, sizeof(torn));
+    file.close();
+  }
+  const String torn = newestSegment();
+  ok &= check(reboot() == 0, "a torn tail keeps the whole pages");
+  appendPage();
+  ok &= check(newestSegment() != torn, "a torn tail starts a new segment");
+  ok &= readsBack("records read back after a torn tail");
+  ok &= check(finds(1000, readsPerLookup), "sampleLogFind() agrees with a scan after a torn tail");
+
+  // a corrupt page rebuilds as missing samples, and reads back with a time of 0
+  // numbered from the oldest on flash, as after the reboot
+  const uint32_t corruptFirst = appendPage() - sampleLogFirst();
+  append(10);
+  sampleLogFlush();
+  {
+    const size_t size = LittleFS.open(newestSegment()).size();
+    File file = LittleFS.open(newestSegment(), "r+");
+    file.seek(size - kLogPageBytes / 2);
+    const uint8_t flipped = 0x5A;
+    file.write(&flipped, 1);
+    file.close();
+  }
+  reboot();
+  restored = sampleLogRebuild(history, 60000);
+  const uint32_t corruptCount = sampleLogEnd() - corruptFirst;
+  const bool corruptBefore = rebuiltSame(kHistoryCapacity - corruptCount - 1, expected[corruptFirst - 1]);
+  for (uint32_t i = corruptFirst; i < sampleLogEnd(); i++) {
+    expected[i].timeS = 0;
+    for (int16_t &value : expected[i].values) value = kHistoryMissing;
+  }
+  ok &= check(restored == kHistoryCapacity && sampleLogStats().crcErrors == 1 && corruptBefore
+    && rebuildsNewest(restored), "a corrupt page rebuilds as missing");
+  ok &= readsBack("a corrupt page reads back as missing");
+
+  // a rebuild stops at its budget, newest first
+  const uint32_t budgetMS = 1;
+  restored = sampleLogRebuild(history, budgetMS);
+  bool oldestMissing = true;
+  for (uint8_t channel = 0; channel < kHistoryChannelCount; channel++) {
+    float low, high, mean;
+    if (history.span(channel, 0, 1, low, high, mean)) oldestMissing = false;
+  }
+  printf("  %u ms budget: rebuilt %u of %u samples in %u ms\n", budgetMS, restored, kHistoryCapacity,
+    sampleLogStats().rebuildMS);
+  ok &= check(restored > 0 && restored < kHistoryCapacity && oldestMissing && rebuildsNewest(restored)
+    && sampleLogStats().rebuildMS <= budgetMS + 5, "a rebuild keeps to its budget, newest first");
+
+  // without a LittleFS partition the log does nothing
+  hostFlashMountFailSet(true);
+  const bool mounted = sampleLogBegin();
+  append(100);
+  ok &= check(!mounted && sampleLogEnd() == 0 && sampleLogRebuild(history, budgetMS) == 0, "no partition");
+  hostFlashMountFailSet(false);
+  return ok ? 0 : 1;
+}
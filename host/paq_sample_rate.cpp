@@ -0,0 +1,183 @@
+/*
+  Project:      Powered Air Quality
+  Description:  adaptive sample pace check
+
+  Feeds a synthetic stove episode (flat, burner on at 40:00 with CO2 and PM2.5 rising, off
+  at 55:00 and decaying) through sample_rate.h the way the SAMPLE_ADAPTIVE sketch does:
+  samples at the period sampleRateNext() picks, the SCD4x read no more often than it
+  measures, the SEN5x every sample. Compares the sample count and each report interval's
+  PM2.5 average, plain and time weighted, against the true average of the episode, for
+  the fixed and the adaptive pace, at the HARDWARE_SIMULATE intervals of config.h.
+  Fails unless the adaptive pace backs off while flat, goes fast soon after the burner
+  comes on, and its time weighted averages are closer to the truth than its plain ones.
+  Also checks the sketch's sampleAlign() after a sample that waited for the periodic SCD4x:
+  it moves the timeSensorSampleMS pace onto the sensor's cadence, and leaves a
+  timeSampleFastMS pace from samplePeriodSet() as it is.
+
+  Usage: paq_sample_rate [--verbose]
+    --verbose  print every sample
+*/
+
+#include <Arduino.h>
+#include "config.h"
+#include "sample_rate.h"
+#include "scheduler.h"
+#include "test_check.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+// powered_air_quality.ino
+extern uint8_t taskSample;
+extern uint32_t timeSampleStartMS, timeSCD4xReadyMS;
+extern void sampleAlign();
+extern void samplePeriodSet(uint32_t periodMS);
+
+namespace {
+  constexpr uint32_t kEpisodeMS = 90 * 60000;
+  constexpr uint32_t kBurnerOnMS = 40 * 60000;
+  constexpr uint32_t kBurnerOffMS = 55 * 60000;
+
+  // the room, at any ms
+  float episode(uint32_t ms, float baseline, float risePerMinute, float tauMinutes)
+  {
+    if (ms < kBurnerOnMS) return baseline + 0.5f * sinf(ms / 47000.0f);
+    const float peak = risePerMinute * (kBurnerOffMS - kBurnerOnMS) / 60000.0f;
+    if (ms < kBurnerOffMS) return baseline + risePerMinute * (ms - kBurnerOnMS) / 60000.0f;
+    return baseline + peak * expf(-(float)(ms - kBurnerOffMS) / (tauMinutes * 60000.0f));
+  }
+  float co2At(uint32_t ms) { return episode(ms, 600.0f, 60.0f, 10.0f); }
+  float pm25At(uint32_t ms) { return episode(ms, 3.0f, 8.0f, 8.0f); }
+
+  float trueAverage(uint32_t startMS, uint32_t endMS)
+  {
+    double total = 0.0;
+    for (uint32_t ms = startMS; ms < endMS; ms += 100) total += pm25At(ms);
+    return total / ((endMS - startMS) / 100);
+  }
+
+  struct Result {
+    uint32_t samples = 0;
+    uint32_t firstFastMS = 0;      // first fast period after the burner came on
+    bool slowBeforeBurner = false;
+    double plainError = 0.0;       // sum over report intervals of |average - true average|
+    double weightedError = 0.0;
+  };
+
+  Result run(bool adaptive, bool verbose)
+  {
+    Result result;
+    sampleRateReset();
+    TimeWeightedMean weighted;
+    double plainTotal = 0.0;
+    uint32_t plainCount = 0;
+    uint32_t reportStartMS = 0, nextReportMS = timeReportMS;
+    uint32_t lastSCD4xMS = 0;
+    bool scd4xRead = false;
+
+    for (uint32_t ms = 0; ms < kEpisodeMS; ) {
+      // report intervals end before the next sample, as when taskReport runs first
+      while (ms >= nextReportMS) {
+        const float truth = trueAverage(reportStartMS, nextReportMS);
+        if (plainCount) {
+          result.plainError += fabs(plainTotal / plainCount - truth);
+          result.weightedError += fabs(weighted.average(nextReportMS) - truth);
+        }
+        plainTotal = 0.0;
+        plainCount = 0;
+        weighted.clear(nextReportMS);
+        reportStartMS = nextReportMS;
+        nextReportMS += timeReportMS;
+      }
+
+      // the SCD4x has a new measurement every timeSCD4xReadMinMS
+      if (!scd4xRead || ms - lastSCD4xMS >= timeSCD4xReadMinMS) {
+        sampleRateInclude(channelCO2, co2At(ms), ms);
+        lastSCD4xMS = ms;
+        scd4xRead = true;
+      }
+      const float pm25 = pm25At(ms);
+      sampleRateInclude(channelPM, pm25, ms);
+      sampleRateInclude(channelVOC, 100.0f, ms);
+      weighted.include(pm25, ms);
+      plainTotal += pm25;
+      plainCount++;
+      result.samples++;
+
+      const uint32_t periodMS = adaptive ? sampleRateNext() : timeSensorSampleMS;
+      if (periodMS == timeSampleSlowMS && ms < kBurnerOnMS) result.slowBeforeBurner = true;
+      if (periodMS == timeSampleFastMS && ms >= kBurnerOnMS && !result.firstFastMS) result.firstFastMS = ms;
+      if (verbose)
+        printf("  %5u s  CO2 %6.1f  PM2.5 %5.1f  next %u s\n", ms / 1000, co2At(ms), pm25, periodMS / 1000);
+      ms += periodMS;
+    }
+    return result;
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  bool verbose = false;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--verbose")) verbose = true;
+    else {
+      fprintf(stderr, "usage: %s [--verbose]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  bool ok = true;
+
+  // linear from 10 to 20 over 60 s, then 20 held for 10 s
+  TimeWeightedMean mean;
+  mean.include(10.0f, 0);
+  mean.include(20.0f, 60000);
+  ok &= check(fabsf(mean.average(70000) - (15.0f * 60 + 20.0f * 10) / 70) < 0.001f, "time weighted average");
+  // a new interval at 30 s takes the line from there, 15 to 20
+  mean.clear(0);
+  mean.include(10.0f, 0);
+  mean.clear(30000);
+  mean.include(20.0f, 60000);
+  ok &= check(fabsf(mean.average(60000) - 17.5f) < 0.001f, "interval start");
+  // readings more than kSampleHoldMaxMS apart aren't joined
+  mean.clear(0);
+  mean.include(10.0f, 0);
+  mean.include(20.0f, 10 * kSampleHoldMaxMS);
+  ok &= check(fabsf(mean.average(10 * kSampleHoldMaxMS) - 20.0f) < 0.001f, "gap");
+
+  const Result fixed = run(false, false);
+  const Result adaptive = run(true, verbose);
+  printf("paq_sample_rate: %u minute stove episode, %u s report interval\n", kEpisodeMS / 60000, timeReportMS / 1000);
+  printf("  fixed %u s: %u samples, PM2.5 average error plain %.2f, time weighted %.2f (ug/m3, summed over reports)\n",
+    timeSensorSampleMS / 1000, fixed.samples, fixed.plainError, fixed.weightedError);
+  printf("  adaptive %u-%u s: %u samples, PM2.5 average error plain %.2f, time weighted %.2f\n",
+    timeSampleFastMS / 1000, timeSampleSlowMS / 1000, adaptive.samples, adaptive.plainError, adaptive.weightedError);
+  printf("  first fast sample %u s after the burner came on\n", (adaptive.firstFastMS - kBurnerOnMS) / 1000);
+
+  ok &= check(adaptive.slowBeforeBurner, "backs off to timeSampleSlowMS while flat");
+  ok &= check(adaptive.firstFastMS && adaptive.firstFastMS - kBurnerOnMS <= timeSampleSlowMS + timeSensorSampleMS,
+    "goes fast within a slow period of the burner coming on");
+  ok &= check(adaptive.weightedError < adaptive.plainError, "time weighted averages beat plain ones when uneven");
+
+  // a sample that found the SCD4x measurement 3 s in, at the fixed pace and then the fast one
+  schedulerClear();
+  taskSample = schedulerAdd("sample", [] {}, timeSensorSampleMS);
+  timeSampleStartMS = millis();
+  schedulerAt(taskSample, timeSampleStartMS + timeSensorSampleMS);
+  timeSCD4xReadyMS = timeSampleStartMS + 3000;
+  sampleAlign();
+  const uint32_t alignedMS = schedulerTask(taskSample).dueMS;
+  samplePeriodSet(timeSampleFastMS);
+  timeSCD4xReadyMS = timeSampleStartMS + 3000;
+  sampleAlign();
+  const uint32_t fastMS = schedulerTask(taskSample).dueMS;
+  printf("  after a read that waited for the SCD4x: next sample %u ms after it at %u s, %u ms at %u s\n",
+    alignedMS - timeSampleStartMS, timeSensorSampleMS / 1000, fastMS - timeSampleStartMS, timeSampleFastMS / 1000);
+  if (timeSensorSampleMS >= timeSCD4xReadMinMS)
+    ok &= check((alignedMS - (timeSampleStartMS + 3000)) % timeSCD4xReadMinMS == 0
+      && alignedMS - (timeSampleStartMS + timeSensorSampleMS) < timeSCD4xReadMinMS, "the fixed pace moves onto the SCD4x cadence");
+  ok &= check(fastMS == timeSampleStartMS + timeSampleFastMS && schedulerTask(taskSample).periodMS == timeSampleFastMS,
+    "a fast pace survives a read that waited for the SCD4x");
+  return ok ? 0 : 1;
+}
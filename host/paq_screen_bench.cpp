@@ -0,0 +1,163 @@
+/*
+  Project:      Powered Air Quality
+  Description:  screen rendering cost report
+
+  Brings the HARDWARE_SIMULATE build up on a virtual clock until every Measure holds a
+  full set of samples, then draws each screen and the heavier drawing helpers on their
+  own, the graph also over a full sample history (kHistoryCapacity samples, see
+  sample_history.h), and reports what the TFT_eSPI stand-in recorded: pixels and address windows
+  written, panel reads, SPI bytes, font loads and anti-aliased primitive calls. Rows are
+  ranked by the time those bytes keep the SPI bus busy at the setup header's
+  SPI_FREQUENCY, which is the floor on how long the device spends drawing them.
+
+  Usage: paq_screen_bench [--reps N] [--verbose]
+    --reps N     host timing repetitions per row (default 20, the median is reported)
+    --verbose    show the sketch's serial output
+*/
+
+#include <Arduino.h>
+#include "host_runtime.h"
+#include "sketch_prototypes.h"
+#include "config.h"
+#include "powered_air_quality.h"
+#include "screen_fixture.h"
+#include "sample_history.h"
+#include "dual_core.h"
+#include <Measure.hpp>
+#include <TFT_eSPI.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+// screens.cpp
+extern void screenHelperHeaderBar(uint16_t, uint16_t, String);
+extern void screenHelperGraph(uint16_t, uint16_t, uint16_t, uint16_t, uint32_t, const HistoryRange&, uint8_t, uint8_t, String);
+extern void arcMeter(uint16_t, uint16_t, uint16_t, uint16_t);
+extern void arcGauge(uint16_t, uint16_t, uint16_t, uint16_t);
+extern uint16_t arcGaugeHeight(uint16_t);
+extern uint8_t co2Range(float);
+extern uint8_t vocRange(float);
+
+// sketch state
+extern TFT_eSPI display;
+extern Measure<kSampleCapacity> totalCO2, totalVOCIndex;
+extern SampleSnapshot screenData;
+
+namespace {
+  struct Row {
+    const char *name;
+    std::function<void()> draw;
+    TFTStats stats;
+    double hostUS;
+  };
+}
+
+int main(int argc, char *argv[])
+{
+  uint32_t reps = 20;
+  bool verbose = false;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--reps") && i + 1 < argc) reps = std::max(1, atoi(argv[++i]));
+    else if (!strcmp(argv[i], "--verbose")) verbose = true;
+    else {
+      fprintf(stderr, "usage: %s [--reps N] [--verbose]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  hostSerialMute(!verbose);
+  if (!screenFixtureStart()) {
+    fprintf(stderr, "paq_screen_bench: sketch restarted during setup\n");
+    return 1;
+  }
+
+  // a full history for the last row, drawn after the screens; CO2 swings from 400 to 1199
+  // ppm, every 97th sample missing
+  uint32_t fullEnd = 0;
+  HistoryRange fullRange;
+  auto historyFill = [&fullEnd, &fullRange] {
+    for (uint32_t i = 0; i < kHistoryCapacity; i++) {
+      const float values[kHistoryChannelCount] = {70.0f, 40.0f, 400.0f + (i * 7) % 800, 5.0f, 100.0f};
+      sampleHistory.append(values, (i % 97) ? 0xFF : 0);
+    }
+    fullEnd = sampleHistory.appended();
+    fullRange = sampleHistory.extrema(historyCO2);
+  };
+
+  // helper arguments are the ones the screens pass
+  const uint16_t graphY = display.height() * 2 / 5;
+  const uint16_t gaugeY = 17 + 97 + 15 + arcGaugeHeight(86) + 10;  // screenMain bottom row
+  std::vector<Row> rows;
+  for (uint8_t i = 0; i < kScreenCount; i++) rows.push_back({kScreens[i].name, kScreens[i].draw, {}, 0});
+  std::vector<Row> helpers = {
+    {"screenHelperHeaderBar", [] { screenHelperHeaderBar(TFT_WHITE, TFT_DARKGREY, "Recent CO2 Values"); }, {}, 0},
+    {"screenHelperGraph", [graphY] {
+      screenHelperGraph(kXMargins, graphY, display.width() - (2 * kXMargins), (display.height() - graphY) - kYMargins,
+        screenData.historyEnd, screenData.historyRange[historyCO2], historyCO2, CO2_DATA, "");
+    }, {}, 0},
+    {"arcMeter", [] {
+      arcMeter(display.width() / 2, display.height() * 4 / 5, display.width(), vocRange(totalVOCIndex.getCurrent()));
+    }, {}, 0},
+    {"arcGauge", [gaugeY] { arcGauge(17 + 86 / 2, gaugeY, 86, co2Range(totalCO2.getCurrent())); }, {}, 0},
+  };
+  rows.insert(rows.end(), helpers.begin(), helpers.end());
+  rows.push_back({"screenHelperGraph full", [graphY, &fullEnd, &fullRange, &historyFill] {
+    if (!fullEnd) historyFill();
+    screenHelperGraph(kXMargins, graphY, display.width() - (2 * kXMargins), (display.height() - graphY) - kYMargins,
+      fullEnd, fullRange, historyCO2, CO2_DATA, "");
+  }, {}, 0});
+
+  for (Row &row : rows) {
+    display.hostStatsReset();
+    row.draw();
+    row.stats = display.hostStats();
+
+    std::vector<double> times;
+    for (uint32_t r = 0; r < reps; r++) {
+      const auto before = std::chrono::steady_clock::now();
+      row.draw();
+      times.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - before).count());
+    }
+    std::sort(times.begin(), times.end());
+    row.hostUS = times[times.size() / 2];
+  }
+
+  std::sort(rows.begin(), rows.end(), [](const Row &a, const Row &b) {
+    return a.stats.spiMicros() > b.stats.spiMicros();
+  });
+
+  printf("paq_screen_bench: %dx%d panel, SPI %.1f MHz write / %.1f MHz read, ranked by estimated bus time\n",
+    display.width(), display.height(), SPI_FREQUENCY / 1e6, SPI_READ_FREQUENCY / 1e6);
+  printf("%-22s %8s %9s %8s %8s %6s %5s %6s %5s %7s %6s %5s %8s\n", "", "spi ms", "bytes", "windows", "pixels",
+    "reads", "win%", "fonts", "arcs", "circles", "wedges", "fills", "host us");
+  bool drewAll = true;
+  for (const Row &row : rows) {
+    const TFTStats &s = row.stats;
+    const double windowShare = s.bytesWritten ? 100.0 * s.windows * 11 / s.bytesWritten : 0.0;
+    printf("%-22s %8.2f %9llu %8llu %8llu %6llu %5.1f %3u/%-2u %5u %7u %6u %5u %8.1f\n", row.name,
+      s.spiMicros() / 1000.0, (unsigned long long)(s.bytesWritten + s.bytesRead), (unsigned long long)s.windows,
+      (unsigned long long)s.pixelsWritten, (unsigned long long)s.pixelsRead, windowShare, s.fontLoads,
+      s.fontUnloads, s.arcs, s.smoothCircles, s.wedgeLines, s.fillScreens, row.hostUS);
+    if (!s.pixelsWritten) drewAll = false;
+  }
+  printf("  win%%: share of written bytes spent on address windows; fonts: loads/unloads; arcs counts drawArc()\n");
+  printf("  passes, including those made by drawSmoothArc(); reads are panel reads for anti-aliasing\n");
+
+  // the full history reads back through the fixed point ring
+  float minValue = 0.0f, maxValue = 0.0f, mean = 0.0f;
+  const uint16_t available = sampleHistory.available(fullEnd);
+  const bool spanned = sampleHistory.span(historyCO2, fullEnd - available, fullEnd, minValue, maxValue, mean);
+  printf("  full history: %u of %u samples drawn, CO2 %.0f to %.0f ppm, mean %.1f\n", available,
+    (unsigned)kHistoryCapacity, minValue, maxValue, mean);
+  const bool historyOK = spanned && available == kHistoryCapacity - kHistoryGuard && minValue == 400.0f && maxValue == 1199.0f
+    && fullRange.valid && fullRange.minValue == minValue && fullRange.maxValue == maxValue;
+  if (!historyOK) printf("FAIL: history span\n");
+
+  return (drewAll && historyOK) ? 0 : 1;
+}
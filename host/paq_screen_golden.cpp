@@ -0,0 +1,224 @@
+/*
+  Project:      Powered Air Quality
+  Description:  golden image and render cost regression check for the screens
+
+  Renders every screen into the TFT_eSPI stand-in's 320x240 RGB565 framebuffer (real
+  Roboto fonts from ui/fonts, anti-aliasing blended against what is already drawn) and
+  writes <out>/<screen>.png. Each image is compared pixel for pixel with
+  <golden>/<screen>.png; on a mismatch <out>/<screen>_diff.png marks changed pixels in
+  red over a dimmed copy of the new image.
+
+  Render cost is checked against <golden>/render_cost.csv. The estimated SPI bus time
+  (see TFTStats) is deterministic, so it is held to a tight tolerance; host wall clock
+  time depends on the machine and is only checked when --host-tolerance is given.
+
+  Usage: paq_screen_golden [--golden DIR] [--out DIR] [--update] [--reps N]
+                           [--spi-tolerance PCT] [--host-tolerance PCT] [--max-diff N]
+    --golden DIR          golden images and render_cost.csv (default host/golden in the source tree)
+    --out DIR             where rendered and diff images go (default current directory)
+    --update              accept the current rendering: rewrite the goldens and render_cost.csv
+    --reps N              host timing repetitions per screen (default 20, the median is used)
+    --spi-tolerance PCT   allowed increase in estimated SPI time (default 2)
+    --host-tolerance PCT  allowed increase in median host render time (default: not checked)
+    --max-diff N          changed pixels allowed per screen (default 0)
+*/
+
+#include <Arduino.h>
+#include "host_runtime.h"
+#include "screen_fixture.h"
+#include "png_file.h"
+#include <TFT_eSPI.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifndef PAQ_GOLDEN_DIR
+  #define PAQ_GOLDEN_DIR "golden"
+#endif
+
+extern TFT_eSPI display;
+
+namespace {
+  const char *kCostFile = "render_cost.csv";
+
+  struct RenderCost {
+    double spiUS;
+    double hostUS;
+  };
+
+  std::map<std::string, RenderCost> costRead(const std::string &path)
+  {
+    std::map<std::string, RenderCost> costs;
+    FILE *f = fopen(path.c_str(), "r");
+    if (!f) return costs;
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+      char name[64];
+      RenderCost cost;
+      if (sscanf(line, "%63[^,],%lf,%lf", name, &cost.spiUS, &cost.hostUS) == 3) costs[name] = cost;
+    }
+    fclose(f);
+    return costs;
+  }
+
+  bool costWrite(const std::string &path, const std::map<std::string, RenderCost> &costs)
+  {
+    FILE *f = fopen(path.c_str(), "w");
+    if (!f) return false;
+    fprintf(f, "screen,spi_us,host_us\n");
+    for (const auto &entry : costs) fprintf(f, "%s,%.1f,%.1f\n", entry.first.c_str(), entry.second.spiUS, entry.second.hostUS);
+    return fclose(f) == 0;
+  }
+
+  // changed pixels in red, everything else at a quarter brightness
+  std::vector<uint16_t> diffImage(const uint16_t *rendered, const std::vector<uint16_t> &golden, uint32_t &changed)
+  {
+    std::vector<uint16_t> diff(golden.size());
+    changed = 0;
+    for (size_t i = 0; i < golden.size(); i++) {
+      if (rendered[i] != golden[i]) {
+        diff[i] = TFT_RED;
+        changed++;
+      }
+      else {
+        diff[i] = (rendered[i] >> 2) & 0x39E7;  // each channel / 4
+      }
+    }
+    return diff;
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  std::string goldenDir = PAQ_GOLDEN_DIR;
+  std::string outDir = ".";
+  bool update = false;
+  uint32_t reps = 20;
+  double spiTolerance = 2.0;
+  double hostTolerance = -1.0;
+  uint32_t maxDiff = 0;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--golden") && i + 1 < argc) goldenDir = argv[++i];
+    else if (!strcmp(argv[i], "--out") && i + 1 < argc) outDir = argv[++i];
+    else if (!strcmp(argv[i], "--update")) update = true;
+    else if (!strcmp(argv[i], "--reps") && i + 1 < argc) reps = std::max(1, atoi(argv[++i]));
+    else if (!strcmp(argv[i], "--spi-tolerance") && i + 1 < argc) spiTolerance = atof(argv[++i]);
+    else if (!strcmp(argv[i], "--host-tolerance") && i + 1 < argc) hostTolerance = atof(argv[++i]);
+    else if (!strcmp(argv[i], "--max-diff") && i + 1 < argc) maxDiff = (uint32_t)atoi(argv[++i]);
+    else {
+      fprintf(stderr, "usage: %s [--golden DIR] [--out DIR] [--update] [--reps N] [--spi-tolerance PCT] "
+        "[--host-tolerance PCT] [--max-diff N]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  hostSerialMute(true);
+  if (!screenFixtureStart()) {
+    fprintf(stderr, "paq_screen_golden: sketch restarted during setup\n");
+    return 1;
+  }
+
+  const std::map<std::string, RenderCost> baseline = costRead(goldenDir + "/" + kCostFile);
+  std::map<std::string, RenderCost> measured;
+  uint8_t failures = 0;
+
+  printf("paq_screen_golden: %dx%d, goldens in %s\n", display.width(), display.height(), goldenDir.c_str());
+  printf("%-16s %9s %9s %9s %9s %s\n", "", "changed", "spi ms", "host us", "base us", "result");
+
+  // every image first, then the timing repetitions; the fixture pins what each screen
+  // draws (see screen_fixture.h)
+  std::vector<std::vector<uint16_t>> frames(kScreenCount);
+  for (uint8_t s = 0; s < kScreenCount; s++) {
+    display.hostFramebufferEnable(true);
+    display.hostStatsReset();
+    kScreens[s].draw();
+    const uint16_t *frame = display.hostFramebuffer();
+    frames[s].assign(frame, frame + (size_t)display.width() * display.height());
+    measured[kScreens[s].name].spiUS = display.hostStats().spiMicros();
+  }
+  display.hostFramebufferEnable(false);
+
+  for (uint8_t s = 0; s < kScreenCount; s++) {
+    std::vector<double> times;
+    for (uint32_t r = 0; r < reps; r++) {
+      const auto before = std::chrono::steady_clock::now();
+      kScreens[s].draw();
+      times.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - before).count());
+    }
+    std::sort(times.begin(), times.end());
+    measured[kScreens[s].name].hostUS = times[times.size() / 2];
+  }
+
+  for (uint8_t s = 0; s < kScreenCount; s++) {
+    const std::string name = kScreens[s].name;
+    const RenderCost cost = measured[name];
+    const uint16_t *frame = frames[s].data();
+    const uint16_t w = (uint16_t)display.width(), h = (uint16_t)display.height();
+    if (!pngWriteRGB565(outDir + "/" + name + ".png", frame, w, h)) {
+      fprintf(stderr, "paq_screen_golden: can't write %s/%s.png\n", outDir.c_str(), name.c_str());
+      return 2;
+    }
+
+    std::string result = "ok";
+    uint32_t changed = 0;
+    if (update) {
+      if (!pngWriteRGB565(goldenDir + "/" + name + ".png", frame, w, h)) {
+        fprintf(stderr, "paq_screen_golden: can't write %s/%s.png\n", goldenDir.c_str(), name.c_str());
+        return 2;
+      }
+      result = "updated";
+    }
+    else {
+      std::vector<uint16_t> golden;
+      uint16_t gw = 0, gh = 0;
+      if (!pngReadRGB565(goldenDir + "/" + name + ".png", golden, gw, gh)) {
+        result = "FAIL no golden image";
+      }
+      else if (gw != w || gh != h) {
+        result = "FAIL golden image size differs";
+      }
+      else {
+        const std::vector<uint16_t> diff = diffImage(frame, golden, changed);
+        if (changed) pngWriteRGB565(outDir + "/" + name + "_diff.png", diff.data(), w, h);
+        if (changed > maxDiff) result = "FAIL pixels changed";
+      }
+
+      const auto base = baseline.find(name);
+      if (base == baseline.end()) {
+        if (result == "ok") result = "FAIL no render cost baseline";
+      }
+      else {
+        if (cost.spiUS > base->second.spiUS * (1.0 + spiTolerance / 100.0)) {
+          if (result == "ok") result = "FAIL";
+          result += " slower on the bus";
+        }
+        if (hostTolerance >= 0.0 && cost.hostUS > base->second.hostUS * (1.0 + hostTolerance / 100.0)) {
+          if (result == "ok") result = "FAIL";
+          result += " slower on the host";
+        }
+      }
+      if (result != "ok") failures++;
+    }
+
+    const auto base = baseline.find(name);
+    printf("%-16s %9u %9.2f %9.1f %9.1f %s\n", name.c_str(), changed, cost.spiUS / 1000.0, cost.hostUS,
+      (base != baseline.end()) ? base->second.hostUS : 0.0, result.c_str());
+  }
+
+  if (update) {
+    if (!costWrite(goldenDir + "/" + kCostFile, measured)) {
+      fprintf(stderr, "paq_screen_golden: can't write %s/%s\n", goldenDir.c_str(), kCostFile);
+      return 2;
+    }
+    return 0;
+  }
+  if (failures) printf("  %u screen(s) failed; if the change is intended, accept it with --update\n", failures);
+  return failures ? 1 : 0;
+}
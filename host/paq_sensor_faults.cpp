@@ -0,0 +1,330 @@
+/*
+  Project:      Powered Air Quality
+  Description:  sensor fault injection and sample path blocking report
+
+  Runs the hardware build of the sketch (no HARDWARE_SIMULATE) on a virtual clock with
+  simulated SCD4x and SEN5x sensors on the I2C bus (see sensirion_sim.h), once per fault
+  scenario. Each scenario powers up fresh sensors, runs setup(), then calls loop() at
+  every deadline in the sketch's scheduler (sample starts and the polls of a pending
+  sample), and records the longest loop() call of the sample, how long loop() kept the
+  device busy: the virtual time its delay()s, sensor execution waits and I2C transfers
+  took, less the time it idled until the next deadline. That bounds touch and
+  portal latency during sampling. It also records how long the sample took to complete.
+  The 1 Hz SEN5x acquisition between samples (see taskPMAcquireRun()) is timed apart.
+  Network reporting is held off so the numbers cover the sensor paths only. Sensors that
+  fail recover in place (see sensor_health.h); the scenarios that end in a recovery fail
+  the run unless the SCD4x ends healthy without a restart, and the one whose reinits
+  succeed while its reads keep failing unless the SCD4x gets to failed.
+
+  Usage: paq_sensor_faults [--samples N] [--scd4x SCRIPT] [--sen5x SCRIPT] [--max-block-ms MS] [--verbose]
+    --samples N         sample periods per scenario (default 12)
+    --scd4x SCRIPT      run one scenario with this SCD4x fault script instead of the built in set
+    --sen5x SCRIPT      same for the SEN5x; scripts are described in sensirion_sim.h, times
+                        count from power up (setup() takes about 1 s)
+    --max-block-ms MS   fail if any loop() call of a sample blocks longer than this
+    --verbose           show the sketch's serial output
+*/
+
+#include <Arduino.h>
+#include "host_runtime.h"
+#include "sketch_prototypes.h"
+#include "config.h"
+#include "scheduler.h"
+#include "sensor_health.h"
+#include "sensirion_sim.h"
+#include <Measure.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// sketch state
+extern uint32_t timeLastSampleMS;
+extern uint8_t taskReport, taskSample;
+extern Measure<kSampleCapacity> totalTemperatureF, totalCO2, totalPM25, totalVOCIndex;
+
+namespace {
+  constexpr uint8_t kSetupAttempts = 3;
+  constexpr uint32_t kSampleLoopsMax = 1000;  // loop() calls before a sample that never completes is abandoned
+
+  struct Scenario {
+    std::string name;
+    std::string scd4x;
+    std::string sen5x;
+    bool recovers;     // the SCD4x fails, then recovers in place
+    bool fails = false;        // the SCD4x ACKs every reinit but never reads, and gets to failed
+    uint32_t samplesMin = 0;   // sample periods it needs, at least
+  };
+
+  // sample path faults start after the first sample period
+  const Scenario kScenarios[] = {
+    {"nominal", "", "", false},
+    {"scd4x-ready-delay", "ready-delay=2500@40", "", false},
+    {"scd4x-not-ready", "not-ready@40", "", false},
+    {"scd4x-nack", "nack@40", "", false},
+    {"scd4x-crc", "crc@40", "", false},
+    {"scd4x-out-of-range", "range@40", "", false},
+    {"sen5x-not-ready", "", "not-ready@40", false},
+    {"sen5x-nack", "", "nack@40", false},
+    {"sen5x-crc", "", "crc@40", false},
+    {"sen5x-out-of-range", "", "range@40", false},
+    {"stuck-bus", "stuck@40", "", false},
+    // held SDA until a bus clear, and a sensor missing at boot that comes back
+    {"scd4x-latch", "latch@40", "", true},
+    {"scd4x-unplugged", "nack@0-60", "", true},
+    // reinit succeeds but reads never do: recoveries back off until the SCD4x is failed
+    {"scd4x-reads-fail", "not-ready@40", "", false, true, 30},
+  };
+
+  struct Result {
+    bool booted = false;
+    uint8_t restarts = 0;
+    double setupMS = 0.0;
+    double firstCO2MS = -1.0;  // power up to the first accepted SCD4x reading
+    uint32_t co2WarmingUp = 0; // samples that accepted a CO2 reading but still showed it warming up
+    uint32_t samples = 0;
+    uint32_t scd4xOK = 0;
+    uint32_t sen5xOK = 0;
+    uint32_t temperatureOK = 0;  // fields the sample kept beside an out of range one
+    uint32_t vocOK = 0;
+    uint32_t nanAccepted = 0;  // samples that put a NaN into a Measure
+    uint32_t sen5xStale = 0;   // SEN5x reads that returned an already read measurement
+    std::vector<double> blockMS;    // longest loop() call per sample
+    std::vector<double> readMS;     // sample start to completion
+    double acquireMaxMS = 0.0;      // longest loop() call between samples
+    uint8_t health[kSensorCount] = {};  // at the end
+    bool scd4xFailed = false;           // the SCD4x was failed after some sample
+    uint32_t recoveries = 0;
+    uint32_t recoveryAttempts = 0;
+    HostI2CStats i2c;
+  };
+
+  double percentile(const std::vector<double> &sorted, double p)
+  {
+    if (sorted.empty()) return 0.0;
+    return sorted[(size_t)(p * (sorted.size() - 1) + 0.5)];
+  }
+
+  double elapsedMS(uint64_t sinceUS)
+  {
+    return (hostClockMicros() - sinceUS) / 1000.0;
+  }
+
+  // loop() once; how long it kept the device busy, less its idle time
+  double loopBlockMS()
+  {
+    const uint64_t loopStartUS = hostClockMicros();
+    const uint64_t idleBeforeUS = schedulerStats().idleTotalUS;
+    loop();
+    const double idleMS = (schedulerStats().idleTotalUS - idleBeforeUS) / 1000.0;
+    return elapsedMS(loopStartUS) - idleMS;
+  }
+
+  Result scenarioRun(const std::vector<SensirionFault> &scd4xFaults, const std::vector<SensirionFault> &sen5xFaults,
+                     uint32_t samples)
+  {
+    Result result;
+    SCD4xSim scd4x;
+    SEN5xSim sen5x;
+    sensirionSimAttach(&scd4x, &sen5x);
+    scd4x.faultsSet(scd4xFaults);
+    sen5x.faultsSet(sen5xFaults);
+    // counts since boot, and the sketch isn't reloaded between scenarios
+    const uint32_t recoveriesBefore = sensorHealth(sensorSCD4x).recoveries + sensorHealth(sensorSEN5x).recoveries;
+    const uint32_t attemptsBefore = sensorHealth(sensorSCD4x).recoveryAttempts + sensorHealth(sensorSEN5x).recoveryAttempts;
+
+    const uint64_t powerUpUS = hostClockMicros();
+    while (!result.booted && result.restarts < kSetupAttempts) {
+      const uint64_t setupStartUS = hostClockMicros();
+      try {
+        setup();
+        result.booted = true;
+      }
+      catch (const HostRestart &) {
+        result.restarts++;
+      }
+      result.setupMS = elapsedMS(setupStartUS);
+    }
+    if (result.booted) schedulerCancel(taskReport);
+
+    hostI2CStatsReset();
+    while (result.booted && result.samples < samples) {
+      const uint32_t co2Before = totalCO2.getCount();
+      const uint32_t pmBefore = totalPM25.getCount();
+      const uint32_t temperatureBefore = totalTemperatureF.getCount();
+      const uint32_t vocBefore = totalVOCIndex.getCount();
+      const uint32_t sampleBefore = timeLastSampleMS;
+      uint64_t sampleStartUS = 0;
+      double longestMS = 0.0;
+      try {
+        // deadlines before the sample's are the SEN5x acquisition's
+        hostClockAdvanceMicros((uint64_t)schedulerIdleMS() * 1000);
+        while ((int32_t)(millis() - schedulerTask(taskSample).dueMS) < 0) {
+          result.acquireMaxMS = std::max(result.acquireMaxMS, loopBlockMS());
+          hostClockAdvanceMicros((uint64_t)schedulerIdleMS() * 1000);
+        }
+
+        sampleStartUS = hostClockMicros();
+        for (uint32_t loops = 0; loops < kSampleLoopsMax && timeLastSampleMS == sampleBefore; loops++) {
+          if (loops) hostClockAdvanceMicros((uint64_t)schedulerIdleMS() * 1000);
+          longestMS = std::max(longestMS, loopBlockMS());
+        }
+      }
+      catch (const HostRestart &) {
+        result.restarts++;
+        break;
+      }
+      result.blockMS.push_back(longestMS);
+      result.readMS.push_back(elapsedMS(sampleStartUS));
+      result.samples++;
+      result.scd4xFailed |= sensorHealth(sensorSCD4x).state == healthFailed;
+
+      const bool co2Read = totalCO2.getCount() != co2Before;
+      const bool pmRead = totalPM25.getCount() != pmBefore;
+      result.scd4xOK += co2Read;
+      if (co2Read && result.firstCO2MS < 0.0) result.firstCO2MS = elapsedMS(powerUpUS);
+      result.co2WarmingUp += co2Read && sensorWarmingUp(channelCO2);
+      result.sen5xOK += pmRead;
+      result.temperatureOK += totalTemperatureF.getCount() != temperatureBefore;
+      result.vocOK += totalVOCIndex.getCount() != vocBefore;
+      if ((co2Read && std::isnan(totalCO2.getCurrent())) ||
+          (pmRead && (std::isnan(totalPM25.getCurrent()) || std::isnan(totalVOCIndex.getCurrent()))))
+        result.nanAccepted++;
+    }
+    result.i2c = hostI2CStats();
+    result.sen5xStale = sen5x.staleReads();
+    for (uint8_t sensor = 0; sensor < kSensorCount; sensor++) result.health[sensor] = sensorHealth(sensor).state;
+    result.recoveries = sensorHealth(sensorSCD4x).recoveries + sensorHealth(sensorSEN5x).recoveries - recoveriesBefore;
+    result.recoveryAttempts = sensorHealth(sensorSCD4x).recoveryAttempts + sensorHealth(sensorSEN5x).recoveryAttempts
+      - attemptsBefore;
+    sensirionSimAttach(nullptr, nullptr);
+    return result;
+  }
+
+  bool faultsParse(const char *sensor, const std::string &script, std::vector<SensirionFault> &faults)
+  {
+    std::string error;
+    if (sensirionFaultsParse(script, faults, error)) return true;
+    fprintf(stderr, "paq_sensor_faults: %s script: %s\n", sensor, error.c_str());
+    return false;
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  uint32_t samples = 12;
+  std::vector<Scenario> scenarios(std::begin(kScenarios), std::end(kScenarios));
+  Scenario custom = {"custom", "", "", false};
+  bool customSet = false;
+  double maxBlockMS = -1.0;
+  bool verbose = false;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--samples") && i + 1 < argc) samples = (uint32_t)std::max(1, atoi(argv[++i]));
+    else if (!strcmp(argv[i], "--scd4x") && i + 1 < argc) { custom.scd4x = argv[++i]; customSet = true; }
+    else if (!strcmp(argv[i], "--sen5x") && i + 1 < argc) { custom.sen5x = argv[++i]; customSet = true; }
+    else if (!strcmp(argv[i], "--max-block-ms") && i + 1 < argc) maxBlockMS = atof(argv[++i]);
+    else if (!strcmp(argv[i], "--verbose")) verbose = true;
+    else {
+      fprintf(stderr, "usage: %s [--samples N] [--scd4x SCRIPT] [--sen5x SCRIPT] [--max-block-ms MS] [--verbose]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (customSet) scenarios = {custom};
+
+  hostSerialMute(!verbose);
+  hostClockVirtualSet(true);
+
+  printf("paq_sensor_faults: %u samples per scenario, %lu s apart, co2SensorReadFailureLimit %u\n", samples,
+    (unsigned long)(timeSensorSampleMS / 1000), (unsigned)co2SensorReadFailureLimit);
+  printf("%-20s %8s %8s %7s %7s %5s %4s %9s %9s %9s %8s %8s %7s %7s %6s %7s %8s %7s %7s\n", "", "setup ms", "1st co2",
+    "scd4x", "sen5x", "stale", "nan", "block avg", "block p50", "block max", "read avg", "read p50", "acq max", "i2c/smp",
+    "nacks", "timeout",
+    "bus ms", "health", "recov");
+
+  bool failed = false;
+  for (const Scenario &scenario : scenarios) {
+    std::vector<SensirionFault> scd4xFaults, sen5xFaults;
+    if (!faultsParse("scd4x", scenario.scd4x, scd4xFaults) || !faultsParse("sen5x", scenario.sen5x, sen5xFaults))
+      return 2;
+
+    const uint32_t scenarioSamples = customSet ? samples : std::max(samples, scenario.samplesMin);
+    const Result r = scenarioRun(scd4xFaults, sen5xFaults, scenarioSamples);
+    std::vector<double> sorted(r.blockMS);
+    std::sort(sorted.begin(), sorted.end());
+    double totalMS = 0.0, readMS = 0.0;
+    for (double ms : sorted) totalMS += ms;
+    for (double ms : r.readMS) readMS += ms;
+    std::vector<double> readSorted(r.readMS);
+    std::sort(readSorted.begin(), readSorted.end());
+
+    char scd4xText[16], sen5xText[16];
+    snprintf(scd4xText, sizeof(scd4xText), "%u/%u", r.scd4xOK, r.samples);
+    snprintf(sen5xText, sizeof(sen5xText), "%u/%u", r.sen5xOK, r.samples);
+    printf("%-20s %8.1f %8.1f %7s %7s %5u %4u %9.1f %9.1f %9.1f %8.1f %8.1f %7.1f %7.1f %6u %7u %8.1f", scenario.name.c_str(),
+      r.setupMS, r.firstCO2MS, scd4xText, sen5xText, r.sen5xStale, r.nanAccepted, r.samples ? totalMS / r.samples : 0.0, percentile(sorted, 0.5),
+      sorted.empty() ? 0.0 : sorted.back(), r.samples ? readMS / r.samples : 0.0, percentile(readSorted, 0.5), r.acquireMaxMS,
+      r.samples ? (double)r.i2c.transactions / r.samples : 0.0,
+      r.i2c.nacks, r.i2c.timeouts, r.i2c.busMicros / 1000.0);
+    char recoveriesText[16];
+    snprintf(recoveriesText, sizeof(recoveriesText), "%u/%u", r.recoveries, r.recoveryAttempts);
+    printf(" %3c/%-3c %7s", toupper(sensorHealthStateName[r.health[sensorSCD4x]][0]),
+      toupper(sensorHealthStateName[r.health[sensorSEN5x]][0]), recoveriesText);
+    if (!r.booted) printf("  no boot after %u restarts", r.restarts);
+    else if (r.restarts) printf("  restarts %u", r.restarts);
+    printf("\n");
+
+    if (!r.booted || r.samples < scenarioSamples) failed = true;
+    // the first sample waits out the SCD4x warm-up (its first measurement, single shot in
+    // either build, timeSCD4xSingleShotMS after start) without failing, so every reading is accepted
+    if (scenario.name == "nominal" && (r.scd4xOK != r.samples || r.sen5xOK != r.samples || r.sen5xStale || r.nanAccepted))
+      failed = true;
+    if (scenario.name == "nominal" && r.firstCO2MS > r.setupMS + timeSCD4xSingleShotMS + 1000) {
+      printf("  %s: the first CO2 reading came %.1f ms after power up\n", scenario.name.c_str(), r.firstCO2MS);
+      failed = true;
+    }
+    // the first valid CO2 reading ends the channel's warm-up, whatever timeSensorWarmupMS says
+    if (r.co2WarmingUp) {
+      printf("  %s: %u samples read CO2 while it still warmed up\n", scenario.name.c_str(), r.co2WarmingUp);
+      failed = true;
+    }
+    if (maxBlockMS >= 0.0 && !sorted.empty() && sorted.back() > maxBlockMS) failed = true;
+    // an out of range value skips only its own field, the sample keeps the sensor's others
+    // (though repeated ones start recoveries, whose warm-ups skip every field)
+    if ((scenario.name == "scd4x-out-of-range" && r.temperatureOK <= r.scd4xOK) ||
+        (scenario.name == "sen5x-out-of-range" && r.vocOK <= r.sen5xOK)) {
+      printf("  %s: other fields not kept, temperature %u/%u, VOC %u/%u\n", scenario.name.c_str(), r.temperatureOK,
+        r.samples, r.vocOK, r.samples);
+      failed = true;
+    }
+    // a sensor is failed only after recovery attempts, whatever its fault
+    if (r.scd4xFailed && !r.recoveryAttempts) {
+      printf("  %s: the SCD4x was failed without a recovery attempt\n", scenario.name.c_str());
+      failed = true;
+    }
+    if (scenario.recovers && (r.restarts || !r.recoveries || r.health[sensorSCD4x] != healthHealthy)) failed = true;
+    // the reinits count as recoveries, but only a good read would reset the backoff, and the
+    // SEN5x carries on meanwhile
+    if (scenario.fails && (r.restarts || r.recoveries < kSensorRecoveryAttempts || !r.scd4xFailed
+        || r.sen5xOK != r.samples)) {
+      printf("  %s: the SCD4x wasn't failed after %u recoveries\n", scenario.name.c_str(), r.recoveries);
+      failed = true;
+    }
+  }
+  printf("  1st co2: power up to the first accepted SCD4x reading, in virtual ms, -1 if none\n");
+  printf("  scd4x/sen5x: samples the sensor's values were accepted; stale: SEN5x reads that repeated an old\n");
+  printf("  measurement (a sample reads the sensor itself, without checking its data-ready flag, when the\n");
+  printf("  acquisition has no readings for it); nan: samples that stored a NaN;\n");
+  printf("  block: the sample's longest loop() call, in virtual ms; read: sample start to completion, across\n");
+  printf("  loop() calls, the first waits out the SCD4x warm-up; acq max: the longest loop() call between\n");
+  printf("  samples, the SEN5x acquisition's; i2c/smp, nacks/timeout/bus ms cover both; health: SCD4x/SEN5x\n");
+  printf("  at the end, (H)ealthy, (D)egraded, (R)ecovering or (F)ailed; recov: in place recoveries of\n");
+  printf("  attempts, see sensor_health.h\n");
+
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,179 @@
+/*
+  Project:      Powered Air Quality
+  Description:  virtual clock simulation runner
+
+  Runs setup() and loop() of the HARDWARE_SIMULATE build on a virtual clock, dual core:
+  sensing and reporting in the worker task (see dual_core.h), loop() in the runner's
+  thread. After each loop() call the clock is fast-forwarded to the next deadline in
+  loop()'s scheduler (alert end, screensaver, web portal timeout) or the worker's wake
+  up (sample, sensor poll, report, Open Weather Map), whichever is first, so weeks of
+  operation take seconds. Reports the wall clock cost of each loop() call, the worker's
+  runs while loop() idled included, and counts what the sketch did. The screens aren't
+  rasterized unless asked for, see paq_screen_bench for their cost.
+
+  Usage: paq_sim [--days D] [--seed N] [--scd4x-mode M] [--scd4x-cycles C] [--csv FILE] [--render] [--verbose]
+    --days D          simulated duration in days (default 30, fractions allowed)
+    --seed N          value returned by esp_random(), which seeds random()
+    --scd4x-mode M    sensorSCD4xSimulate() mode, 0-3 (default 1; 3 exercises sampleEvaluate())
+    --scd4x-cycles C  sensorSCD4xSimulate() cycles per mode (default 10)
+    --csv FILE        write one line per loop() call: simulated ms, wall us, sample, report, alert
+    --render          rasterize the screens, so loop()'s cost includes drawing them
+    --verbose         show the sketch's serial output
+*/
+
+#include <Arduino.h>
+#include "host_runtime.h"
+#include "sketch_prototypes.h"
+#include "config.h"
+#include "scheduler.h"
+#include <TFT_eSPI.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// sketch state the runner counts
+extern uint32_t timeLastSampleMS, timeLastReportMS;
+extern uint32_t alertStartMS;
+extern uint8_t simulateSCD4xMode, simulateSCD4xCycles;
+extern TFT_eSPI display;
+
+namespace {
+  constexpr uint64_t kMSPerDay = 86400000ULL;
+
+  double percentile(std::vector<double> &sorted, double p)
+  {
+    if (sorted.empty()) return 0.0;
+    size_t index = (size_t)(p * (sorted.size() - 1) + 0.5);
+    return sorted[index];
+  }
+
+  void printDuration(uint64_t ms)
+  {
+    uint64_t s = ms / 1000;
+    printf("%llud %02llu:%02llu:%02llu", (unsigned long long)(s / 86400), (unsigned long long)(s / 3600 % 24),
+      (unsigned long long)(s / 60 % 60), (unsigned long long)(s % 60));
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  double days = 30.0;
+  const char *csvPath = nullptr;
+  bool verbose = false;
+  bool render = false;
+
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--days") && i + 1 < argc) days = atof(argv[++i]);
+    else if (!strcmp(argv[i], "--seed") && i + 1 < argc) hostRandomSeedSet((uint32_t)strtoul(argv[++i], nullptr, 0));
+    else if (!strcmp(argv[i], "--scd4x-mode") && i + 1 < argc) simulateSCD4xMode = (uint8_t)atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--scd4x-cycles") && i + 1 < argc) simulateSCD4xCycles = (uint8_t)atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--csv") && i + 1 < argc) csvPath = argv[++i];
+    else if (!strcmp(argv[i], "--render")) render = true;
+    else if (!strcmp(argv[i], "--verbose")) verbose = true;
+    else {
+      fprintf(stderr, "usage: %s [--days D] [--seed N] [--scd4x-mode M] [--scd4x-cycles C] [--csv FILE] [--render] [--verbose]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  FILE *csv = nullptr;
+  if (csvPath) {
+    csv = fopen(csvPath, "w");
+    if (!csv) {
+      perror(csvPath);
+      return 2;
+    }
+    fprintf(csv, "sim_ms,wall_us,sample,report,alert\n");
+  }
+
+  hostSerialMute(!verbose);
+  display.hostRasterizeEnable(render);
+  hostClockVirtualSet(true);
+  hostTasksEnable(true);
+
+  const uint64_t simulatedMS = (uint64_t)(days * kMSPerDay);
+  const uint64_t timeStartUS = hostClockMicros();
+  const auto wallStart = std::chrono::steady_clock::now();
+
+  uint64_t loops = 0, samples = 0, reports = 0, alerts = 0;
+  uint32_t restarts = 0;
+  std::vector<double> costs;
+  double longestUS = 0.0;
+  uint64_t longestAtMS = 0;
+  const char *longestWhat = "idle";
+
+  bool needSetup = true;
+  // the worker samples and reports between loop() calls too, so changes count from the
+  // previous loop() call's
+  uint32_t sampleBefore = 0, reportBefore = 0, alertBefore = 0;
+  while ((hostClockMicros() - timeStartUS) / 1000 < simulatedMS) {
+    try {
+      if (needSetup) {
+        setup();
+        needSetup = false;
+        sampleBefore = timeLastSampleMS;
+        reportBefore = timeLastReportMS;
+        alertBefore = alertStartMS;
+      }
+
+      const uint64_t simNowMS = (hostClockMicros() - timeStartUS) / 1000;
+
+      const auto wallBefore = std::chrono::steady_clock::now();
+      loop();
+      const double costUS = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - wallBefore).count();
+
+      const bool sampled = (timeLastSampleMS != sampleBefore);
+      const bool reported = (timeLastReportMS != reportBefore);
+      const bool alerted = (alertStartMS != alertBefore) && (alertStartMS != 0);
+      loops++;
+      samples += sampled;
+      reports += reported;
+      alerts += alerted;
+      costs.push_back(costUS);
+      if (costUS > longestUS) {
+        longestUS = costUS;
+        longestAtMS = simNowMS;
+        longestWhat = reported ? (sampled ? "sample+report" : "report") : (sampled ? "sample" : "other");
+      }
+      if (csv) fprintf(csv, "%llu,%.1f,%d,%d,%d\n", (unsigned long long)simNowMS, costUS, sampled, reported, alerted);
+      sampleBefore = timeLastSampleMS;
+      reportBefore = timeLastReportMS;
+      alertBefore = alertStartMS;
+
+      const uint64_t nowUS = hostClockMicros();
+      const uint64_t wakeUS = hostTasksWakeMicros();
+      hostClockAdvanceMicros(std::min((uint64_t)schedulerIdleMS() * 1000, wakeUS > nowUS ? wakeUS - nowUS : 0));
+    }
+    catch (const HostRestart &) {
+      restarts++;
+      needSetup = true;
+    }
+  }
+
+  const double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  const uint64_t elapsedMS = (hostClockMicros() - timeStartUS) / 1000;
+  if (csv) fclose(csv);
+
+  std::vector<double> sorted(costs);
+  std::sort(sorted.begin(), sorted.end());
+  double totalUS = 0.0;
+  for (double c : costs) totalUS += c;
+
+  printf("paq_sim: simulated ");
+  printDuration(elapsedMS);
+  printf(" in %.2f s wall (%.0fx real time)\n", wallS, wallS > 0 ? elapsedMS / 1000.0 / wallS : 0.0);
+  printf("  loop() calls %llu, samples %llu, reports %llu, alerts %llu, restarts %u\n",
+    (unsigned long long)loops, (unsigned long long)samples, (unsigned long long)reports,
+    (unsigned long long)alerts, restarts);
+  printf("  loop() wall cost us: mean %.1f, p50 %.1f, p99 %.1f, max %.1f\n",
+    loops ? totalUS / loops : 0.0, percentile(sorted, 0.50), percentile(sorted, 0.99), longestUS);
+  printf("  longest iteration: %.1f us (%s) at simulated ", longestUS, longestWhat);
+  printDuration(longestAtMS);
+  printf("\n");
+
+  return (samples && reports) ? 0 : 1;
+}
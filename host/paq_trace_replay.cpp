@@ -0,0 +1,195 @@
+/*
+  Project:      Powered Air Quality
+  Description:  sensor trace replay
+
+  Replays a trace of raw sensor readings (see sensor_trace.h; a serial log captured from a
+  device built with SENSOR_TRACE works as is) through the SENSOR_TRACE_REPLAY build of
+  the sketch on a virtual clock. Each sample takes the next recorded SCD4x reading and the
+  decimated SEN5x readings recorded before it, so range checks, the Measure totals, sampleEvaluate() alerts and samplePost()
+  reporting (to InfluxDB and ThingSpeak stand-ins, see endpoint_standins.h) all run on
+  the recorded data. Prints when alerts fired, in trace time, and the host cost of the
+  sample path.
+
+  Usage: paq_trace_replay TRACE [--expect-co2-alerts N] [--verbose]
+    --expect-co2-alerts N  fail unless exactly N rapid CO2 rise alerts fire
+    --verbose              show the sketch's serial output
+*/
+
+#include <Arduino.h>
+#include "host_runtime.h"
+#include "sketch_prototypes.h"
+#include "config.h"
+#include "scheduler.h"
+#include "powered_air_quality.h"
+#include "secrets.h"
+#include "sensor_trace.h"
+#include "endpoint_standins.h"
+#include <Measure.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// sketch state
+extern uint32_t timeLastSampleMS, timeLastReportMS;
+extern uint32_t alertStartMS;
+extern bool alertSound;
+extern Measure<kSampleCapacity> totalCO2;
+
+namespace {
+  const char *kThingSpeakHost = "api.thingspeak.com";  // post_thingspeak.cpp posts to a fixed URL
+  constexpr uint16_t kThingSpeakPort = 80;
+
+  std::string traceTime(uint32_t ms)
+  {
+    char text[32];
+    const uint32_t s = ms / 1000;
+    snprintf(text, sizeof(text), "%02u:%02u:%02u", s / 3600, s / 60 % 60, s % 60);
+    return text;
+  }
+
+  uint32_t medianIntervalMS(const std::vector<SensorTraceRecord> &records, uint8_t sensor)
+  {
+    std::vector<uint32_t> intervals;
+    const SensorTraceRecord *previous = nullptr;
+    for (const SensorTraceRecord &record : records) {
+      if (record.sensor != sensor) continue;
+      if (previous) intervals.push_back(record.timeMS - previous->timeMS);
+      previous = &record;
+    }
+    if (intervals.empty()) return 0;
+    std::sort(intervals.begin(), intervals.end());
+    return intervals[intervals.size() / 2];
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  const char *tracePath = nullptr;
+  int expectCO2Alerts = -1;
+  bool verbose = false;
+  bool usage = false;
+  for (int i = 1; i < argc && !usage; i++) {
+    if (!strcmp(argv[i], "--expect-co2-alerts") && i + 1 < argc) expectCO2Alerts = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--verbose")) verbose = true;
+    else if (argv[i][0] != '-' && !tracePath) tracePath = argv[i];
+    else usage = true;
+  }
+  if (usage || !tracePath) {
+    fprintf(stderr, "usage: %s TRACE [--expect-co2-alerts N] [--verbose]\n", argv[0]);
+    return 2;
+  }
+
+  std::ifstream file(tracePath);
+  if (!file) {
+    fprintf(stderr, "paq_trace_replay: can't open %s\n", tracePath);
+    return 2;
+  }
+  std::vector<SensorTraceRecord> records;
+  uint32_t counts[2] = {0, 0}, errors[2] = {0, 0};
+  std::string line;
+  while (std::getline(file, line)) {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    // serial captures may carry a timestamp or other text before the TRACE field
+    const size_t start = line.find("TRACE,");
+    SensorTraceRecord record;
+    if (start == std::string::npos || !sensorTraceParse(String(line.substr(start).c_str()), record)) continue;
+    records.push_back(record);
+    sensorTraceReplayAdd(record);
+    counts[record.sensor]++;
+    errors[record.sensor] += record.error != 0;
+  }
+  if (records.empty()) {
+    fprintf(stderr, "paq_trace_replay: no TRACE lines in %s\n", tracePath);
+    return 2;
+  }
+  std::vector<const SensorTraceRecord *> scd4xRecords;
+  for (const SensorTraceRecord &record : records) {
+    if (record.sensor == traceSCD4x) scd4xRecords.push_back(&record);
+  }
+
+  const uint32_t traceStartMS = records.front().timeMS;
+  const uint32_t intervalMS = medianIntervalMS(records, traceSCD4x);
+  printf("paq_trace_replay: %s: %u SCD4x and %u SEN5x readings (%u and %u errors) over %s, every %.1f s\n",
+    tracePath, counts[traceSCD4x], counts[traceSEN5x], errors[traceSCD4x], errors[traceSEN5x],
+    traceTime(records.back().timeMS - traceStartMS).c_str(), intervalMS / 1000.0);
+  if (intervalMS && (intervalMS < timeSensorSampleMS * 9 / 10 || intervalMS > timeSensorSampleMS * 11 / 10))
+    printf("  note: this build samples every %lu s, so replayed time runs at a different pace than the trace\n",
+      (unsigned long)(timeSensorSampleMS / 1000));
+
+  hostSerialMute(!verbose);
+  hostClockVirtualSet(true);
+
+  InfluxStandIn influx(influxKey);
+  ThingSpeakStandIn thingSpeak(THINGS_APIKEY);
+  try {
+    setup();
+  }
+  catch (const HostRestart &) {
+    fprintf(stderr, "paq_trace_replay: sketch restarted during setup\n");
+    return 1;
+  }
+  hostNetListen(influxdbConfig.host, influxdbConfig.port, &influx);
+  hostNetListen(kThingSpeakHost, kThingSpeakPort, &thingSpeak);
+
+  uint32_t samples = 0, reports = 0, co2Alerts = 0, failAlerts = 0;
+  std::vector<double> sampleUS;
+  printf("%-10s %-20s %s\n", "trace", "alert", "CO2 ppm (last 4 samples)");
+  try {
+    while (sensorTraceReplayRemaining(traceSCD4x) || sensorTraceReplayRemaining(traceSEN5x)) {
+      hostClockAdvanceMicros((uint64_t)schedulerIdleMS() * 1000);
+
+      const uint32_t sampleBefore = timeLastSampleMS, reportBefore = timeLastReportMS, alertBefore = alertStartMS;
+      const uint32_t scd4xNext = counts[traceSCD4x] - sensorTraceReplayRemaining(traceSCD4x);
+      const auto start = std::chrono::steady_clock::now();
+      loop();
+      const double costUS = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+      const bool sampled = timeLastSampleMS != sampleBefore;
+      const bool reported = timeLastReportMS != reportBefore;
+      samples += sampled;
+      reports += reported;
+      if (sampled && !reported) sampleUS.push_back(costUS);
+      if (!sampled || alertStartMS == alertBefore) continue;
+
+      // the sample's alert: rapid CO2 rise sounds, a failed read does not
+      const uint32_t atMS = (scd4xNext < scd4xRecords.size() ? scd4xRecords[scd4xNext]->timeMS : records.back().timeMS);
+      if (alertSound) {
+        co2Alerts++;
+        printf("%-10s %-20s", traceTime(atMS - traceStartMS).c_str(), "CO2 rising rapidly");
+        const uint16_t stored = totalCO2.getStored();
+        for (uint16_t i = stored > 4 ? stored - 4 : 0; i < stored; i++) printf(" %.0f", totalCO2.getMember(i));
+        printf("\n");
+      }
+      else {
+        failAlerts++;
+        printf("%-10s %-20s\n", traceTime(atMS - traceStartMS).c_str(), "Sensor read fail");
+      }
+    }
+  }
+  catch (const HostRestart &) {
+    printf("  sketch restarted during replay\n");
+    return 1;
+  }
+  hostNetReset();
+
+  std::sort(sampleUS.begin(), sampleUS.end());
+  double totalUS = 0.0;
+  for (double us : sampleUS) totalUS += us;
+  printf("samples %u, read fail alerts %u, CO2 rise alerts %u, reports %u (InfluxDB points %u, ThingSpeak updates %u)\n",
+    samples, failAlerts, co2Alerts, reports, influx.points, thingSpeak.accepted);
+  if (!sampleUS.empty())
+    printf("sample path host cost: mean %.1f us, p50 %.1f us, max %.1f us per loop()\n", totalUS / sampleUS.size(),
+      sampleUS[sampleUS.size() / 2], sampleUS.back());
+
+  if (expectCO2Alerts >= 0 && co2Alerts != (uint32_t)expectCO2Alerts) {
+    printf("expected %d CO2 rise alerts\n", expectCO2Alerts);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,165 @@
+/*
+  Project:      Powered Air Quality
+  Description:  RGB565 framebuffer to and from 8 bit RGB PNG files, for golden image tests
+*/
+
+#include "png_file.h"
+
+#include <zlib.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+  const uint8_t kPNGSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  constexpr uint8_t kBitDepth = 8;
+  constexpr uint8_t kColorTypeRGB = 2;
+  constexpr uint8_t kBytesPerPixel = 3;
+
+  void putInt32(std::vector<uint8_t> &out, uint32_t value)
+  {
+    out.push_back((uint8_t)(value >> 24));
+    out.push_back((uint8_t)(value >> 16));
+    out.push_back((uint8_t)(value >> 8));
+    out.push_back((uint8_t)value);
+  }
+
+  uint32_t getInt32(const uint8_t *p)
+  {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+  }
+
+  void putChunk(std::vector<uint8_t> &out, const char *type, const std::vector<uint8_t> &data)
+  {
+    putInt32(out, (uint32_t)data.size());
+    const size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    putInt32(out, (uint32_t)crc32(0, out.data() + start, (uInt)(out.size() - start)));
+  }
+
+  uint8_t paeth(int a, int b, int c)
+  {
+    int p = a + b - c;
+    int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+    if (pa <= pb && pa <= pc) return (uint8_t)a;
+    return (uint8_t)((pb <= pc) ? b : c);
+  }
+}
+
+bool pngWriteRGB565(const std::string &path, const uint16_t *pixels, uint16_t width, uint16_t height)
+{
+  // one filter type byte (0, none) per row, then the row's RGB triples
+  const size_t stride = (size_t)width * kBytesPerPixel + 1;
+  std::vector<uint8_t> raw(stride * height);
+  for (uint16_t y = 0; y < height; y++) {
+    uint8_t *row = raw.data() + y * stride;
+    *row++ = 0;
+    for (uint16_t x = 0; x < width; x++) {
+      const uint16_t c = pixels[(size_t)y * width + x];
+      const uint8_t r = (c >> 11) & 0x1F, g = (c >> 5) & 0x3F, b = c & 0x1F;
+      *row++ = (uint8_t)((r << 3) | (r >> 2));
+      *row++ = (uint8_t)((g << 2) | (g >> 4));
+      *row++ = (uint8_t)((b << 3) | (b >> 2));
+    }
+  }
+
+  uLongf packedSize = compressBound((uLong)raw.size());
+  std::vector<uint8_t> packed(packedSize);
+  if (compress2(packed.data(), &packedSize, raw.data(), (uLong)raw.size(), Z_BEST_COMPRESSION) != Z_OK) return false;
+  packed.resize(packedSize);
+
+  std::vector<uint8_t> header;
+  putInt32(header, width);
+  putInt32(header, height);
+  header.push_back(kBitDepth);
+  header.push_back(kColorTypeRGB);
+  header.push_back(0);  // compression
+  header.push_back(0);  // filter method
+  header.push_back(0);  // no interlace
+
+  std::vector<uint8_t> file(kPNGSignature, kPNGSignature + sizeof(kPNGSignature));
+  putChunk(file, "IHDR", header);
+  putChunk(file, "IDAT", packed);
+  putChunk(file, "IEND", {});
+
+  FILE *f = fopen(path.c_str(), "wb");
+  if (!f) return false;
+  const bool written = (fwrite(file.data(), 1, file.size(), f) == file.size());
+  return (fclose(f) == 0) && written;
+}
+
+bool pngReadRGB565(const std::string &path, std::vector<uint16_t> &pixels, uint16_t &width, uint16_t &height)
+{
+  FILE *f = fopen(path.c_str(), "rb");
+  if (!f) return false;
+  std::vector<uint8_t> file;
+  uint8_t buffer[4096];
+  size_t got;
+  while ((got = fread(buffer, 1, sizeof(buffer), f)) > 0) file.insert(file.end(), buffer, buffer + got);
+  fclose(f);
+
+  if (file.size() < sizeof(kPNGSignature) || memcmp(file.data(), kPNGSignature, sizeof(kPNGSignature))) return false;
+
+  std::vector<uint8_t> packed;
+  uint32_t w = 0, h = 0;
+  size_t pos = sizeof(kPNGSignature);
+  while (pos + 12 <= file.size()) {
+    const uint32_t length = getInt32(&file[pos]);
+    const char *type = (const char *)&file[pos + 4];
+    const uint8_t *data = &file[pos + 8];
+    if (pos + 12 + length > file.size()) return false;
+    if (!memcmp(type, "IHDR", 4)) {
+      if (length < 13) return false;
+      w = getInt32(data);
+      h = getInt32(data + 4);
+      if (data[8] != kBitDepth || data[9] != kColorTypeRGB || data[12] != 0) return false;
+    }
+    else if (!memcmp(type, "IDAT", 4)) {
+      packed.insert(packed.end(), data, data + length);
+    }
+    else if (!memcmp(type, "IEND", 4)) {
+      break;
+    }
+    pos += 12 + length;
+  }
+  if (!w || !h || w > 0xFFFF || h > 0xFFFF) return false;
+
+  const size_t stride = (size_t)w * kBytesPerPixel + 1;
+  std::vector<uint8_t> raw(stride * h);
+  uLongf rawSize = (uLongf)raw.size();
+  if (uncompress(raw.data(), &rawSize, packed.data(), (uLong)packed.size()) != Z_OK || rawSize != raw.size()) return false;
+
+  // undo the per row filters in place
+  const size_t rowBytes = stride - 1;
+  for (uint32_t y = 0; y < h; y++) {
+    uint8_t *row = raw.data() + y * stride + 1;
+    const uint8_t *prior = y ? row - stride : nullptr;
+    const uint8_t filter = row[-1];
+    for (size_t i = 0; i < rowBytes; i++) {
+      const int a = (i >= kBytesPerPixel) ? row[i - kBytesPerPixel] : 0;
+      const int b = prior ? prior[i] : 0;
+      const int c = (prior && i >= kBytesPerPixel) ? prior[i - kBytesPerPixel] : 0;
+      switch (filter) {
+        case 0: break;
+        case 1: row[i] += a; break;
+        case 2: row[i] += b; break;
+        case 3: row[i] += (a + b) / 2; break;
+        case 4: row[i] += paeth(a, b, c); break;
+        default: return false;
+      }
+    }
+  }
+
+  width = (uint16_t)w;
+  height = (uint16_t)h;
+  pixels.resize((size_t)w * h);
+  for (uint32_t y = 0; y < h; y++) {
+    const uint8_t *row = raw.data() + y * stride + 1;
+    for (uint32_t x = 0; x < w; x++, row += kBytesPerPixel) {
+      pixels[(size_t)y * w + x] = (uint16_t)(((row[0] & 0xF8) << 8) | ((row[1] & 0xFC) << 3) | (row[2] >> 3));
+    }
+  }
+  return true;
+}
@@ -0,0 +1,20 @@
+/*
+  Project:      Powered Air Quality
+  Description:  RGB565 framebuffer to and from 8 bit RGB PNG files, for golden image tests
+*/
+
+#ifndef PNG_FILE_H
+  #define PNG_FILE_H
+
+  #include <cstdint>
+  #include <string>
+  #include <vector>
+
+  bool pngWriteRGB565(const std::string &path, const uint16_t *pixels, uint16_t width, uint16_t height);
+
+  // Reads 8 bit RGB (colour type 2) PNGs such as pngWriteRGB565() writes, packing each
+  // pixel back to RGB565
+  bool pngReadRGB565(const std::string &path, std::vector<uint16_t> &pixels, uint16_t &width,
+    uint16_t &height);
+
+#endif  // #ifdef PNG_FILE_H
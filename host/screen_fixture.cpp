@@ -0,0 +1,115 @@
+/*
+  Project:      Powered Air Quality
+  Description:  shared setup for the host screen tools (paq_screen_bench, paq_screen_golden)
+*/
+
+#include "screen_fixture.h"
+
+#include <Arduino.h>
+#include <Measure.hpp>
+#include "host_runtime.h"
+#include "sketch_prototypes.h"
+#include "config.h"
+#include "powered_air_quality.h"
+#include "sample_history.h"
+
+// screens.cpp
+extern void screenMain();
+extern void screenCO2();
+extern void screenVOC();
+extern void screenPM25();
+extern void screenForecast();
+
+// sketch state the worker publishes to loop()
+extern Measure<kSampleCapacity> totalTemperatureF, totalHumidity, totalCO2, totalVOCIndex, totalPM25;
+extern SampleHistory sampleHistory;
+extern OpenWeatherMapAirQuality owmAirQuality;
+extern SiteForecast owmSiteForecast;
+extern bool owmAirQualityValid, owmForecastValid;
+extern uint32_t timeLastReportMS;
+
+namespace {
+  // the screens' samples, oldest first, by historyChannel; a report went out after the
+  // ninth, clearing the totals
+  constexpr uint8_t kPinnedSamples = 10;
+  constexpr uint8_t kPinnedReportAfter = 9;
+  const float kPinnedValues[kPinnedSamples][kHistoryChannelCount] = {
+    {54.88f, 76.12f, 781, 118.04f, 475.37f},
+    {54.88f, 74.12f, 801, 320.77f, 224.11f},
+    {54.88f, 76.12f, 791, 47.97f, 312.40f},
+    {52.88f, 76.12f, 775, 35.17f, 34.14f},
+    {51.88f, 76.12f, 756, 84.67f, 55.38f},
+    {53.88f, 76.12f, 774, 75.03f, 159.36f},
+    {54.88f, 74.12f, 774, 160.86f, 1.11f},
+    {52.88f, 76.12f, 750, 568.99f, 185.14f},
+    {38.03f, 23.30f, 454, 576.03f, 323.90f},
+    {38.03f, 22.30f, 478, 457.46f, 390.42f},
+  };
+  const OpenWeatherMapAirQuality kPinnedAirQuality = {4, 60.9f};
+  const DailyForecast kPinnedForecast[5] = {
+    {92.23f, 65.58f, 58.66f, 3, 0, 40},
+    {97.91f, 56.09f, 31.61f, 4, 1, 40},
+    {120.10f, 61.19f, 69.31f, 5, 2, 40},
+    {72.34f, 39.13f, 0.84f, 5, 3, 40},
+    {94.81f, 40.25f, 86.41f, 2, 4, 40},
+  };
+
+  // seeds random() so the screen's simulated WiFi RSSI read, the only random value drawn
+  // while drawing, returns rssi
+  void rssiPin(uint8_t rssi)
+  {
+    for (uint32_t seed = 1;; seed++) {
+      randomSeed(seed);
+      if (random(networkRSSIMin, networkRSSIMax) == rssi) {
+        randomSeed(seed);
+        return;
+      }
+    }
+  }
+}
+
+const ScreenFixture kScreens[] = {
+  {"screenMain", [] { rssiPin(83); screenMain(); }},
+  {"screenVOC", [] { rssiPin(61); screenVOC(); }},
+  {"screenCO2", [] { rssiPin(45); screenCO2(); }},
+  {"screenPM25", [] { rssiPin(68); screenPM25(); }},
+  {"screenForecast", [] { rssiPin(51); screenForecast(); }},
+};
+const uint8_t kScreenCount = sizeof(kScreens) / sizeof(kScreens[0]);
+
+bool screenFixtureStart()
+{
+  hostClockVirtualSet(true);
+  try {
+    setup();
+    for (uint8_t i = 0; i < kPinnedSamples; i++) {
+      hostClockAdvanceMicros((uint64_t)timeSensorSampleMS * 1000);
+      const float *values = kPinnedValues[i];
+      totalTemperatureF.include(values[historyTemperatureF]);
+      totalHumidity.include(values[historyHumidity]);
+      totalCO2.include(values[historyCO2]);
+      totalPM25.include(values[historyPM25]);
+      totalVOCIndex.include(values[historyVOCIndex]);
+      sampleHistory.append(values, 0xFF);
+      if (i + 1 == kPinnedReportAfter) {
+        totalTemperatureF.clear();
+        totalHumidity.clear();
+        totalCO2.clear();
+        totalPM25.clear();
+        totalVOCIndex.clear();
+        timeLastReportMS = millis();
+      }
+    }
+    owmAirQuality = kPinnedAirQuality;
+    owmSiteForecast.cityName = "Pleasantville (US)";
+    for (uint8_t day = 0; day < 5; day++) owmSiteForecast.forecastData[day] = kPinnedForecast[day];
+    owmAirQualityValid = owmForecastValid = true;
+    // through the worker's snapshot, as loop() gets it
+    samplePublish();
+    workerResultsShow();
+  }
+  catch (const HostRestart &) {
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,26 @@
+/*
+  Project:      Powered Air Quality
+  Description:  shared setup for the host screen tools (paq_screen_bench, paq_screen_golden)
+*/
+
+#ifndef SCREEN_FIXTURE_H
+  #define SCREEN_FIXTURE_H
+
+  #include <cstdint>
+
+  struct ScreenFixture {
+    const char *name;
+    void (*draw)();
+  };
+
+  // The sketch's screens, in screenNames order
+  extern const ScreenFixture kScreens[];
+  extern const uint8_t kScreenCount;
+
+  // Runs setup() of the HARDWARE_SIMULATE build on the virtual clock, then hands loop() a
+  // fixed set of samples and Open Weather Map data through the worker's snapshot, so the
+  // screens don't depend on which tasks ran or what the simulated sensors drew. Each
+  // screen draws with the same WiFi RSSI every time. Returns false if the sketch restarted.
+  bool screenFixtureStart();
+
+#endif  // #ifdef SCREEN_FIXTURE_H
@@ -0,0 +1,405 @@
+/*
+  Project:      Powered Air Quality
+  Description:  simulated Sensirion SCD4x and SEN5x sensors for the host I2C bus
+*/
+
+#include "sensirion_sim.h"
+
+#include <Arduino.h>
+#include <SensirionCore.h>
+#include "host_runtime.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+  // SCD4x commands and execution times (datasheet section 3)
+  constexpr uint16_t kSCD4xStartPeriodic = 0x21B1;
+  constexpr uint16_t kSCD4xStartLowPower = 0x21AC;
+  constexpr uint16_t kSCD4xStopPeriodic = 0x3F86;
+  constexpr uint16_t kSCD4xSetAltitude = 0x2427;
+  constexpr uint16_t kSCD4xDataReady = 0xE4B8;
+  constexpr uint16_t kSCD4xReadMeasurement = 0xEC05;
+  constexpr uint16_t kSCD4xSingleShot = 0x219D;
+  constexpr uint16_t kSCD4xWakeUp = 0x36F6;
+  constexpr uint16_t kSCD4xReinit = 0x3646;
+  constexpr uint32_t kSCD4xStopMS = 500;
+  constexpr uint32_t kSCD4xSingleShotMS = 5000;
+  constexpr uint32_t kSCD4xReinitMS = 30;
+  constexpr uint32_t kSCD4xPeriodicMS = 5000;
+  constexpr uint32_t kSCD4xLowPowerMS = 30000;
+  constexpr uint16_t kSCD4xRangeCO2 = 6000;
+
+  // SEN5x commands and execution times (datasheet section 6.1)
+  constexpr uint16_t kSEN5xDeviceReset = 0xD304;
+  constexpr uint16_t kSEN5xStartMeasurement = 0x0021;
+  constexpr uint16_t kSEN5xStopMeasurement = 0x0104;
+  constexpr uint16_t kSEN5xDataReady = 0x0202;
+  constexpr uint16_t kSEN5xReadMeasuredValues = 0x03C4;
+  constexpr uint32_t kSEN5xResetMS = 100;
+  constexpr uint32_t kSEN5xStartMS = 50;
+  constexpr uint32_t kSEN5xStopMS = 200;
+  constexpr uint32_t kSEN5xReadMS = 20;
+  constexpr float kSEN5xRangePM25 = 2000.0f;
+
+  // endTransmission() codes
+  constexpr uint8_t kAck = 0;
+  constexpr uint8_t kAddressNack = 2;
+  constexpr uint8_t kDataNack = 3;
+
+  uint16_t encodeUnsigned(float value, float scale)
+  {
+    if (std::isnan(value)) return 0xFFFF;
+    return (uint16_t)std::lround(std::min(std::max(value * scale, 0.0f), 65534.0f));
+  }
+
+  uint16_t encodeSigned(float value, float scale)
+  {
+    if (std::isnan(value)) return 0x7FFF;
+    return (uint16_t)(int16_t)std::lround(std::min(std::max(value * scale, -32768.0f), 32766.0f));
+  }
+
+  SCD4xReading scd4xDefault(uint32_t ms)
+  {
+    const float phase = 2.0f * (float)M_PI * (float)(ms % 3600000UL) / 3600000.0f;
+    return {(uint16_t)(800.0f + 200.0f * sinf(phase)), 22.0f, 45.0f};
+  }
+
+  SEN5xReading sen5xDefault(uint32_t ms)
+  {
+    (void)ms;
+    return {3.0f, 5.0f, 6.0f, 7.0f, 45.0f, 22.0f, 100.0f};
+  }
+
+  bool parseKind(const std::string &name, SensirionFaultKind &kind)
+  {
+    static const struct { const char *name; SensirionFaultKind kind; } kKinds[] = {
+      {"nack", SensirionFaultKind::nack},
+      {"crc", SensirionFaultKind::crc},
+      {"ready-delay", SensirionFaultKind::readyDelay},
+      {"not-ready", SensirionFaultKind::notReady},
+      {"stuck", SensirionFaultKind::stuck},
+      {"latch", SensirionFaultKind::latch},
+      {"range", SensirionFaultKind::range},
+    };
+    for (const auto &entry : kKinds) {
+      if (name == entry.name) {
+        kind = entry.kind;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool parseSeconds(const std::string &text, uint32_t &ms)
+  {
+    char *end = nullptr;
+    const double seconds = strtod(text.c_str(), &end);
+    if (text.empty() || *end || seconds < 0.0) return false;
+    ms = (uint32_t)(seconds * 1000.0 + 0.5);
+    return true;
+  }
+}
+
+bool sensirionFaultsParse(const std::string &script, std::vector<SensirionFault> &faults, std::string &error)
+{
+  faults.clear();
+  size_t begin = 0;
+  while (begin <= script.size()) {
+    size_t end = script.find(';', begin);
+    if (end == std::string::npos) end = script.size();
+    const std::string entry = script.substr(begin, end - begin);
+    begin = end + 1;
+    if (entry.empty()) continue;
+
+    SensirionFault fault = {SensirionFaultKind::nack, NAN, 0, UINT32_MAX};
+    const size_t at = entry.find('@');
+    const std::string head = entry.substr(0, at);
+    const size_t equals = head.find('=');
+    if (!parseKind(head.substr(0, equals), fault.kind)) {
+      error = "unknown fault '" + head.substr(0, equals) + "'";
+      return false;
+    }
+    if (equals != std::string::npos) {
+      char *tail = nullptr;
+      fault.value = strtof(head.c_str() + equals + 1, &tail);
+      if (*tail || tail == head.c_str() + equals + 1) {
+        error = "bad value in '" + entry + "'";
+        return false;
+      }
+    }
+    if (fault.kind == SensirionFaultKind::readyDelay && std::isnan(fault.value)) {
+      error = "ready-delay needs a value in milliseconds";
+      return false;
+    }
+    if (at != std::string::npos) {
+      const std::string window = entry.substr(at + 1);
+      const size_t dash = window.find('-');
+      if (!parseSeconds(window.substr(0, dash), fault.startMS) ||
+          (dash != std::string::npos && dash + 1 < window.size() && !parseSeconds(window.substr(dash + 1), fault.endMS))) {
+        error = "bad time window in '" + entry + "'";
+        return false;
+      }
+      if (dash == std::string::npos) fault.endMS = UINT32_MAX;
+      if (fault.endMS <= fault.startMS) {
+        error = "empty time window in '" + entry + "'";
+        return false;
+      }
+    }
+    faults.push_back(fault);
+  }
+  return true;
+}
+
+void SensirionSimDevice::faultsSet(const std::vector<SensirionFault> &faults)
+{
+  _faults = faults;
+  _faultOriginMS = millis();
+  _latch = nullptr;
+  _latchClocks = 0;
+}
+
+const SensirionFault *SensirionSimDevice::faultActive(SensirionFaultKind kind) const
+{
+  const uint32_t ms = millis() - _faultOriginMS;
+  for (const SensirionFault &fault : _faults) {
+    if (fault.kind == kind && ms >= fault.startMS && ms < fault.endMS) return &fault;
+  }
+  return nullptr;
+}
+
+bool SensirionSimDevice::i2cHoldsBus() const
+{
+  if (faultActive(SensirionFaultKind::stuck)) return true;
+  const SensirionFault *latch = faultActive(SensirionFaultKind::latch);
+  if (!latch) return false;
+  const uint32_t clocks = (latch == _latch) ? _latchClocks : 0;
+  return clocks < (std::isnan(latch->value) ? 9u : (uint32_t)latch->value);
+}
+
+void SensirionSimDevice::i2cClock()
+{
+  const SensirionFault *latch = faultActive(SensirionFaultKind::latch);
+  if (latch != _latch) {
+    _latch = latch;
+    _latchClocks = 0;
+  }
+  if (_latch) _latchClocks++;
+}
+
+void SensirionSimDevice::busyFor(uint32_t ms)
+{
+  _busy = (ms != 0);
+  _busyUntilMS = millis() + ms;
+}
+
+void SensirionSimDevice::respond(const uint16_t *words, size_t count)
+{
+  _responseLength = 0;
+  for (size_t i = 0; i < count && _responseLength + 3 <= sizeof(_response); i++) {
+    _response[_responseLength++] = (uint8_t)(words[i] >> 8);
+    _response[_responseLength++] = (uint8_t)(words[i] & 0xFF);
+    _response[_responseLength] = sensirionCRC8(&_response[_responseLength - 2], 2);
+    _responseLength++;
+  }
+}
+
+uint8_t SensirionSimDevice::i2cWrite(const uint8_t *data, size_t length)
+{
+  // the sensor does not acknowledge its address while executing a command
+  if (_busy && (int32_t)(millis() - _busyUntilMS) < 0) return kAddressNack;
+  _busy = false;
+  if (faultActive(SensirionFaultKind::nack)) return kAddressNack;
+  if (length < 2 || (length - 2) % 3) return kDataNack;
+
+  uint16_t args[4];
+  const size_t argCount = std::min((length - 2) / 3, sizeof(args) / sizeof(args[0]));
+  for (size_t i = 0; i < argCount; i++) {
+    const uint8_t *word = data + 2 + 3 * i;
+    if (sensirionCRC8(word, 2) != word[2]) return kDataNack;
+    args[i] = (uint16_t)((word[0] << 8) | word[1]);
+  }
+  _responseLength = 0;
+  _commands++;
+  return command((uint16_t)((data[0] << 8) | data[1]), args, argCount);
+}
+
+size_t SensirionSimDevice::i2cRead(uint8_t *data, size_t length)
+{
+  if (_busy && (int32_t)(millis() - _busyUntilMS) < 0) return 0;
+  if (faultActive(SensirionFaultKind::nack) || !_responseLength) return 0;
+
+  const size_t count = std::min(length, _responseLength);
+  memcpy(data, _response, count);
+  if (faultActive(SensirionFaultKind::crc)) {
+    for (size_t i = 2; i < count; i += 3) data[i] ^= 0x5A;
+  }
+  _responseLength = 0;
+  return count;
+}
+
+uint32_t SCD4xSim::intervalMS() const
+{
+  return (_mode == Mode::lowPower) ? kSCD4xLowPowerMS : kSCD4xPeriodicMS;
+}
+
+uint32_t SCD4xSim::completed() const
+{
+  if (_mode == Mode::idle) return 0;
+  if (faultActive(SensirionFaultKind::notReady)) return _consumed;
+  const SensirionFault *late = faultActive(SensirionFaultKind::readyDelay);
+  const uint32_t delayMS = late ? (uint32_t)late->value : 0;
+  const uint32_t elapsed = millis() - _modeStartMS;
+  if (elapsed < delayMS) return 0;
+  const uint32_t count = (elapsed - delayMS) / intervalMS();
+  return (_mode == Mode::singleShot) ? std::min(count, (uint32_t)1) : count;
+}
+
+bool SCD4xSim::dataReady() const
+{
+  return completed() > _consumed;
+}
+
+uint8_t SCD4xSim::command(uint16_t code, const uint16_t *args, size_t argCount)
+{
+  const bool periodic = (_mode == Mode::periodic) || (_mode == Mode::lowPower);
+  switch (code) {
+    case kSCD4xStartPeriodic:
+    case kSCD4xStartLowPower:
+    case kSCD4xSingleShot:
+      if (periodic) return kDataNack;
+      _mode = (code == kSCD4xStartPeriodic) ? Mode::periodic :
+              (code == kSCD4xStartLowPower) ? Mode::lowPower : Mode::singleShot;
+      _modeStartMS = millis();
+      _consumed = 0;
+      if (_mode == Mode::singleShot) busyFor(kSCD4xSingleShotMS);
+      return kAck;
+
+    case kSCD4xStopPeriodic:
+      _mode = Mode::idle;
+      busyFor(kSCD4xStopMS);
+      return kAck;
+
+    case kSCD4xSetAltitude:
+      if (periodic || argCount != 1) return kDataNack;
+      _altitude = args[0];
+      busyFor(1);
+      return kAck;
+
+    case kSCD4xDataReady: {
+      const uint16_t status = dataReady() ? 0x8006 : 0x8000;  // low 11 bits non-zero when ready
+      respond(&status, 1);
+      busyFor(1);
+      return kAck;
+    }
+
+    case kSCD4xReadMeasurement: {
+      busyFor(1);
+      // without new data the read phase is not acknowledged
+      if (!dataReady()) return kAck;
+      _consumed = completed();
+      _measurementsRead++;
+      SCD4xReading reading = values ? values(millis()) : scd4xDefault(millis());
+      if (const SensirionFault *range = faultActive(SensirionFaultKind::range))
+        reading.co2 = std::isnan(range->value) ? kSCD4xRangeCO2 : (uint16_t)range->value;
+      const uint16_t words[3] = {
+        reading.co2,
+        encodeUnsigned(reading.temperatureC + 45.0f, 65535.0f / 175.0f),
+        encodeUnsigned(reading.humidity, 65535.0f / 100.0f),
+      };
+      respond(words, 3);
+      return kAck;
+    }
+
+    case kSCD4xWakeUp:
+      // wake_up is not acknowledged
+      return kAddressNack;
+
+    case kSCD4xReinit:
+      if (periodic) return kDataNack;
+      busyFor(kSCD4xReinitMS);
+      return kAck;
+
+    default:
+      return kDataNack;
+  }
+}
+
+uint32_t SEN5xSim::completed() const
+{
+  if (!_measuring) return 0;
+  if (faultActive(SensirionFaultKind::notReady)) return _consumed;
+  const SensirionFault *late = faultActive(SensirionFaultKind::readyDelay);
+  const uint32_t delayMS = late ? (uint32_t)late->value : 0;
+  const uint32_t elapsed = millis() - _startMS;
+  return (elapsed < delayMS) ? 0 : (elapsed - delayMS) / kIntervalMS;
+}
+
+uint8_t SEN5xSim::command(uint16_t code, const uint16_t *args, size_t argCount)
+{
+  (void)args; (void)argCount;
+  switch (code) {
+    case kSEN5xDeviceReset:
+      _measuring = false;
+      busyFor(kSEN5xResetMS);
+      return kAck;
+
+    case kSEN5xStartMeasurement:
+      if (!_measuring) {
+        _measuring = true;
+        _startMS = millis();
+        _consumed = 0;
+      }
+      busyFor(kSEN5xStartMS);
+      return kAck;
+
+    case kSEN5xStopMeasurement:
+      _measuring = false;
+      busyFor(kSEN5xStopMS);
+      return kAck;
+
+    case kSEN5xDataReady: {
+      const uint16_t ready = (completed() > _consumed) ? 0x0001 : 0x0000;
+      respond(&ready, 1);
+      busyFor(kSEN5xReadMS);
+      return kAck;
+    }
+
+    case kSEN5xReadMeasuredValues: {
+      if (!_measuring) return kDataNack;
+      busyFor(kSEN5xReadMS);
+      // the latest measurement, or "unknown" words before the first one
+      uint16_t words[8] = {0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0x7FFF, 0x7FFF, 0x7FFF, 0x7FFF};
+      const uint32_t done = completed();
+      if (done) {
+        if (done > _consumed) _measurementsRead++;
+        else _staleReads++;
+        _consumed = done;
+        SEN5xReading reading = values ? values(millis()) : sen5xDefault(millis());
+        if (const SensirionFault *range = faultActive(SensirionFaultKind::range))
+          reading.pm2p5 = std::isnan(range->value) ? kSEN5xRangePM25 : range->value;
+        words[0] = encodeUnsigned(reading.pm1p0, 10.0f);
+        words[1] = encodeUnsigned(reading.pm2p5, 10.0f);
+        words[2] = encodeUnsigned(reading.pm4p0, 10.0f);
+        words[3] = encodeUnsigned(reading.pm10p0, 10.0f);
+        words[4] = encodeSigned(reading.humidity, 100.0f);
+        words[5] = encodeSigned(reading.temperatureC, 200.0f);
+        if (millis() - _startMS >= kVOCWarmUpMS) words[6] = encodeSigned(reading.vocIndex, 10.0f);
+        // SEN54 has no NOx sensor, words[7] stays unknown
+      }
+      respond(words, 8);
+      return kAck;
+    }
+
+    default:
+      return kDataNack;
+  }
+}
+
+void sensirionSimAttach(SCD4xSim *scd4x, SEN5xSim *sen5x)
+{
+  hostI2CAttach(SCD4xSim::kAddress, scd4x);
+  hostI2CAttach(SEN5xSim::kAddress, sen5x);
+}
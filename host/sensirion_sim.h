@@ -0,0 +1,149 @@
+/*
+  Project:      Powered Air Quality
+  Description:  simulated Sensirion SCD4x and SEN5x sensors for the host I2C bus
+*/
+
+#ifndef SENSIRION_SIM_H
+  #define SENSIRION_SIM_H
+
+  #include <Wire.h>
+
+  #include <cstdint>
+  #include <functional>
+  #include <string>
+  #include <vector>
+
+  enum class SensirionFaultKind : uint8_t { nack, crc, readyDelay, notReady, stuck, latch, range };
+
+  struct SensirionFault {
+    SensirionFaultKind kind;
+    float value;       // kind specific, NAN for the default
+    uint32_t startMS;  // relative to when the script was applied
+    uint32_t endMS;    // exclusive, UINT32_MAX for open ended
+  };
+
+  // Parses a fault script, "kind[=value][@start[-end]]" entries separated by ';' with times in
+  // seconds since it was applied (open ended without end, always on without @):
+  //   nack           address not acknowledged, for writes and reads
+  //   crc            every data word read has a bad CRC
+  //   ready-delay=MS measurements complete MS late
+  //   not-ready      no measurement ever completes
+  //   stuck          the sensor holds SDA low, which blocks the whole bus
+  //   latch[=N]      the sensor holds SDA low mid-transfer until SCL is pulsed N times
+  //                  outside a transaction (default 9), as by a bus clear
+  //   range[=V]      out of range values: CO2 ppm for SCD4x (default 6000), PM2.5 ug/m3 for
+  //                  SEN5x (default 2000)
+  // e.g. "ready-delay=2500@60-300;crc@600-610". On failure returns false and describes the
+  // problem in error
+  bool sensirionFaultsParse(const std::string &script, std::vector<SensirionFault> &faults,
+    std::string &error);
+
+  // Command framing and fault handling shared by the sensor models, which answer their
+  // datasheet command set, timing and CRCs at the real I2C address
+  class SensirionSimDevice : public I2CDevice {
+    public:
+      uint8_t i2cWrite(const uint8_t *data, size_t length) override;
+      size_t i2cRead(uint8_t *data, size_t length) override;
+      bool i2cHoldsBus() const override;
+      void i2cClock() override;
+
+      // replaces the fault script; times in it count from now
+      void faultsSet(const std::vector<SensirionFault> &faults);
+      // the active fault of this kind, or nullptr
+      const SensirionFault *faultActive(SensirionFaultKind kind) const;
+
+      uint32_t commands() const { return _commands; }
+
+    protected:
+      // handles a received command; returns the endTransmission() code. Responses are
+      // queued with respond() and execution time set with busyFor().
+      virtual uint8_t command(uint16_t code, const uint16_t *args, size_t argCount) = 0;
+      void respond(const uint16_t *words, size_t count);
+      void busyFor(uint32_t ms);
+
+    private:
+      std::vector<SensirionFault> _faults;
+      uint32_t _faultOriginMS = 0;
+      const SensirionFault *_latch = nullptr;  // the latch fault clocks count against
+      uint32_t _latchClocks = 0;
+      uint32_t _busyUntilMS = 0;
+      bool _busy = false;
+      uint8_t _response[3 * 9];
+      size_t _responseLength = 0;
+      uint32_t _commands = 0;
+  };
+
+  struct SCD4xReading {
+    uint16_t co2;        // ppm
+    float temperatureC;
+    float humidity;      // %RH
+  };
+
+  class SCD4xSim : public SensirionSimDevice {
+    public:
+      static constexpr uint8_t kAddress = 0x62;
+
+      // what the sensor measures at a given time; the default drifts CO2 between 600 and
+      // 1000 ppm over an hour at 22C and 45%RH
+      std::function<SCD4xReading(uint32_t ms)> values;
+
+      bool measuring() const { return _mode != Mode::idle; }
+      uint32_t measurements() const { return _measurementsRead; }
+
+    protected:
+      uint8_t command(uint16_t code, const uint16_t *args, size_t argCount) override;
+
+    private:
+      enum class Mode : uint8_t { idle, periodic, lowPower, singleShot };
+
+      uint32_t intervalMS() const;
+      uint32_t completed() const;  // measurements finished since the mode started
+      bool dataReady() const;
+
+      Mode _mode = Mode::idle;
+      uint32_t _modeStartMS = 0;
+      uint32_t _consumed = 0;      // measurements read since the mode started
+      uint32_t _measurementsRead = 0;
+      uint16_t _altitude = 0;
+  };
+
+  struct SEN5xReading {
+    float pm1p0, pm2p5, pm4p0, pm10p0;  // ug/m3
+    float humidity;                     // %RH
+    float temperatureC;
+    float vocIndex;
+  };
+
+  class SEN5xSim : public SensirionSimDevice {
+    public:
+      static constexpr uint8_t kAddress = 0x69;
+      static constexpr uint32_t kIntervalMS = 1000;
+      // VOC index reads as unavailable this long after startMeasurement (the sketch's
+      // sensorInit() waits 7 s for it)
+      static constexpr uint32_t kVOCWarmUpMS = 7000;
+
+      // what the sensor measures at a given time; the default is a clean room
+      std::function<SEN5xReading(uint32_t ms)> values;
+
+      bool measuring() const { return _measuring; }
+      uint32_t measurements() const { return _measurementsRead; }
+      // reads answered with a measurement that had already been read
+      uint32_t staleReads() const { return _staleReads; }
+
+    protected:
+      uint8_t command(uint16_t code, const uint16_t *args, size_t argCount) override;
+
+    private:
+      uint32_t completed() const;
+
+      bool _measuring = false;
+      uint32_t _startMS = 0;
+      uint32_t _consumed = 0;
+      uint32_t _measurementsRead = 0;
+      uint32_t _staleReads = 0;
+  };
+
+  // Attaches both sensors to the host I2C bus at their addresses (nullptr detaches)
+  void sensirionSimAttach(SCD4xSim *scd4x, SEN5xSim *sen5x);
+
+#endif  // #ifdef SENSIRION_SIM_H
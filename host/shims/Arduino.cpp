@@ -0,0 +1,627 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for the ESP32 Arduino core
+*/
+
+#include "Arduino.h"
+#include "host_runtime.h"
+#include "esp_task_wdt.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+  const auto timeStart = std::chrono::steady_clock::now();
+  std::atomic<bool> clockVirtual{false};
+  std::atomic<uint64_t> clockVirtualMicros{0};
+  bool serialMuted = false;
+  uint32_t serialLines = 0;
+  uint32_t randomSeedValue = 0x5EED5EED;
+  std::mt19937 randomEngine;
+  std::map<uint8_t, bool> buttonPressed;
+  std::map<uint8_t, uint32_t> ledcDuty;
+  std::map<uint8_t, uint32_t> ledcTone;
+
+  // task watchdog; the core starts it at boot with nothing subscribed
+  bool wdtInitialized = true;
+  uint32_t wdtTimeoutMS = 5000;
+  bool wdtSubscribed = false;
+  uint64_t wdtFedMicros = 0;
+  HostTaskWDTStats wdtStats;
+
+  // FreeRTOS tasks, see hostTasksEnable(). Only the task holding the baton (taskRunning)
+  // runs; the clock and watchdog globals above are its own, swapped on each hand off.
+  // tasks[0] is the runner's thread, the loop task, once another task exists.
+  struct HostTask {
+    std::string name;
+    uint8_t core = 1;
+    uint64_t clockMicros = 0;
+    bool wdtSubscribed = false;
+    uint64_t wdtFedMicros = 0;
+    bool killed = false;  // deleted, unwinds at its next hand off
+    uint32_t notifyCount = 0;       // see xTaskNotifyGive()
+    bool notifyWaiting = false;     // in ulTaskNotifyTake(), since notifyWaitMicros
+    uint64_t notifyWaitMicros = 0;
+    bool done = false;
+    std::thread thread;
+  };
+  struct HostTaskKill {};  // thrown in a deleted task
+
+  bool tasksEnabled = false;
+  std::vector<std::unique_ptr<HostTask>> tasks;
+  size_t taskRunning = 0;
+  bool taskRestartPending = false;  // a task restarted the chip, the loop task throws next
+  std::mutex taskMutex;
+  std::condition_variable taskTurn;
+  thread_local size_t taskCurrent = 0;
+}
+
+HardwareSerial Serial;
+EspClass ESP;
+
+// time; see hostClockVirtualSet()
+static uint64_t clockRealMicros()
+{
+  return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - timeStart).count();
+}
+
+uint64_t hostClockMicros()
+{
+  return clockVirtual ? clockVirtualMicros.load() : clockRealMicros();
+}
+
+void hostClockVirtualSet(bool isVirtual)
+{
+  if (isVirtual && !clockVirtual) clockVirtualMicros = clockRealMicros();
+  clockVirtual = isVirtual;
+}
+
+bool hostClockIsVirtual()
+{
+  return clockVirtual;
+}
+
+// tasks; see hostTasksEnable()
+static void taskSave(HostTask &task)
+{
+  task.clockMicros = clockVirtualMicros;
+  task.wdtSubscribed = wdtSubscribed;
+  task.wdtFedMicros = wdtFedMicros;
+}
+
+static void taskLoad(const HostTask &task)
+{
+  clockVirtualMicros = task.clockMicros;
+  wdtSubscribed = task.wdtSubscribed;
+  wdtFedMicros = task.wdtFedMicros;
+}
+
+// the task furthest behind; on a tie a created task before the loop task, as a higher
+// priority task that became ready would run
+static size_t taskNext()
+{
+  size_t next = 0;
+  for (size_t i = 1; i < tasks.size(); i++)
+    if (!tasks[i]->done && tasks[i]->clockMicros <= tasks[next]->clockMicros) next = i;
+  return next;
+}
+
+// passes the baton and waits for it to come back
+static void taskHandOff(size_t next)
+{
+  std::unique_lock<std::mutex> lock(taskMutex);
+  taskRunning = next;
+  taskTurn.notify_all();
+  taskTurn.wait(lock, [] { return taskRunning == taskCurrent; });
+}
+
+// deletes every task but the loop task; from the loop task only
+static void tasksKill()
+{
+  if (tasks.empty()) return;
+  taskSave(*tasks[0]);
+  for (size_t i = 1; i < tasks.size(); i++) {
+    HostTask &task = *tasks[i];
+    task.killed = true;
+    if (!task.done) taskHandOff(i);
+    task.thread.join();
+  }
+  taskLoad(*tasks[0]);
+  tasks.clear();
+  taskRestartPending = false;
+}
+
+// a restart deletes the tasks before the loop task unwinds to the runner; in another
+// task it ends the task, and the loop task throws at its next hand off
+[[noreturn]] static void restartThrow()
+{
+  if (taskCurrent == 0) tasksKill();
+  throw HostRestart();
+}
+
+// after the calling task's clock moved, lets the task furthest behind run until it is
+// the furthest behind again
+static void taskSwitch()
+{
+  if (tasks.empty()) return;
+  HostTask &self = *tasks[taskCurrent];
+  taskSave(self);
+  const size_t next = taskNext();
+  if (next != taskCurrent) {
+    taskHandOff(next);
+    taskLoad(self);
+  }
+  if (std::uncaught_exceptions()) return;
+  if (self.killed) throw HostTaskKill();
+  if (taskCurrent == 0 && taskRestartPending) restartThrow();
+}
+
+static void taskThread(size_t index, HostTask *self, TaskFunction_t function, void *parameter)
+{
+  taskCurrent = index;
+  {
+    std::unique_lock<std::mutex> lock(taskMutex);
+    taskTurn.wait(lock, [] { return taskRunning == taskCurrent; });
+  }
+  taskLoad(*self);
+  bool toLoopTask = true;
+  if (!self->killed) {
+    try {
+      function(parameter);
+      toLoopTask = false;  // FreeRTOS tasks must not return; the device would abort
+    }
+    catch (const HostRestart &) {
+      taskRestartPending = true;
+    }
+    catch (const HostTaskKill &) {
+    }
+  }
+  self->done = true;
+  std::lock_guard<std::mutex> lock(taskMutex);
+  taskRunning = toLoopTask ? 0 : taskNext();
+  taskTurn.notify_all();
+}
+
+void hostTasksEnable(bool enabled)
+{
+  if (!enabled) tasksKill();
+  tasksEnabled = enabled && clockVirtual;
+}
+
+uint64_t hostTasksWakeMicros()
+{
+  uint64_t wakeUS = UINT64_MAX;
+  for (size_t i = 0; i < tasks.size(); i++)
+    if (i != taskCurrent && !tasks[i]->done) wakeUS = std::min(wakeUS, tasks[i]->clockMicros);
+  return wakeUS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t stackDepth, void *parameter,
+  UBaseType_t priority, TaskHandle_t *createdTask, BaseType_t coreID)
+{
+  (void)stackDepth;
+  (void)priority;
+  if (!tasksEnabled) return pdFAIL;
+  if (tasks.empty()) {
+    tasks.push_back(std::make_unique<HostTask>());
+    tasks[0]->name = "loopTask";
+    static const bool exitHook = (atexit(tasksKill) == 0);
+    (void)exitHook;
+  }
+  tasks.push_back(std::make_unique<HostTask>());
+  HostTask *task = tasks.back().get();
+  task->name = name;
+  task->core = (uint8_t)coreID;
+  task->clockMicros = clockVirtualMicros;
+  task->wdtFedMicros = clockVirtualMicros;
+  task->thread = std::thread(taskThread, tasks.size() - 1, task, function, parameter);
+  if (createdTask) *createdTask = task;
+  return pdPASS;
+}
+
+BaseType_t xPortGetCoreID()
+{
+  return tasks.empty() ? 1 : tasks[taskCurrent]->core;
+}
+
+// runner advanced time stands for loop() spinning, which feeds the watchdog
+void hostClockAdvanceMicros(uint64_t us)
+{
+  if (clockVirtual) clockVirtualMicros += us;
+  wdtFedMicros = hostClockMicros();
+  taskSwitch();
+}
+
+void hostClockVirtualJump(uint64_t us)
+{
+  if (clockVirtual) clockVirtualMicros = us;
+  wdtFedMicros = hostClockMicros();
+}
+
+// panics, as the device would at the moment the timeout ran out
+static void wdtCheck()
+{
+  if (!wdtInitialized || !wdtSubscribed) return;
+  const uint64_t timeoutUS = (uint64_t)wdtTimeoutMS * 1000;
+  const uint64_t nowUS = hostClockMicros();
+  if (nowUS - wdtFedMicros <= timeoutUS) return;
+  if (clockVirtual) clockVirtualMicros = wdtFedMicros + timeoutUS;
+  wdtFedMicros = hostClockMicros();
+  wdtStats.trips++;
+  if (!serialMuted) printf("E (%lu) task_wdt: Task watchdog got triggered, %s did not reset the watchdog in time\n",
+    (unsigned long)millis(), tasks.empty() ? "loopTask" : tasks[taskCurrent]->name.c_str());
+  restartThrow();
+}
+
+uint32_t millis()
+{
+  return (uint32_t)(hostClockMicros() / 1000);
+}
+
+uint32_t micros()
+{
+  return (uint32_t)hostClockMicros();
+}
+
+void delay(uint32_t ms)
+{
+  if (clockVirtual) clockVirtualMicros += (uint64_t)ms * 1000;
+  else std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+  wdtCheck();
+  taskSwitch();
+}
+
+void delayMicroseconds(uint32_t us)
+{
+  if (clockVirtual) clockVirtualMicros += us;
+  else std::this_thread::sleep_for(std::chrono::microseconds(us));
+  wdtCheck();
+  taskSwitch();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+  return tasks.empty() ? nullptr : tasks[taskCurrent].get();
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+  HostTask *notified = static_cast<HostTask *>(task);
+  if (!notified) return pdFAIL;
+  notified->notifyCount++;
+  // a waiting task wakes at the notifying task's time, not at its timeout
+  if (notified->notifyWaiting && notified != xTaskGetCurrentTaskHandle())
+    notified->clockMicros = std::min(notified->clockMicros, std::max(hostClockMicros(), notified->notifyWaitMicros));
+  return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait)
+{
+  HostTask *self = static_cast<HostTask *>(xTaskGetCurrentTaskHandle());
+  if (!self) {
+    // no other task to notify it, so it waits out the timeout
+    if (ticksToWait) delay(ticksToWait);
+    return 0;
+  }
+  if (!self->notifyCount && ticksToWait) {
+    self->notifyWaiting = true;
+    self->notifyWaitMicros = hostClockMicros();
+    clockVirtualMicros += (uint64_t)ticksToWait * 1000;
+    taskSwitch();
+    self->notifyWaiting = false;
+    wdtCheck();
+  }
+  const uint32_t count = self->notifyCount;
+  self->notifyCount = clearCountOnExit ? 0 : (count ? count - 1 : 0);
+  return count;
+}
+
+void yield() {}
+
+// random numbers, same contract as the ESP32 core: [0, howbig) and [howsmall, howbig)
+long random(long howbig)
+{
+  if (howbig <= 0) return 0;
+  return (long)(randomEngine() % (uint32_t)howbig);
+}
+
+long random(long howsmall, long howbig)
+{
+  if (howsmall >= howbig) return howsmall;
+  return random(howbig - howsmall) + howsmall;
+}
+
+void randomSeed(unsigned long seed)
+{
+  if (seed != 0) randomEngine.seed((uint32_t)seed);
+}
+
+uint32_t esp_random()
+{
+  return randomSeedValue;
+}
+
+long map(long x, long in_min, long in_max, long out_min, long out_max)
+{
+  const long run = in_max - in_min;
+  if (run == 0) return out_min;
+  return (x - in_min) * (out_max - out_min) / run + out_min;
+}
+
+// GPIO and LEDC
+void pinMode(uint8_t pin, uint8_t mode) { (void)pin; (void)mode; }
+
+int digitalRead(uint8_t pin)
+{
+  int level;
+  if (hostI2CPinRead(pin, level)) return level;
+  // buttons are active low with pull-ups
+  auto it = buttonPressed.find(pin);
+  return (it != buttonPressed.end() && it->second) ? LOW : HIGH;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) { hostI2CPinWrite(pin, val); }
+
+bool ledcAttach(uint8_t pin, uint32_t freq, uint8_t resolution)
+{
+  (void)freq; (void)resolution;
+  ledcDuty[pin] = 0;
+  return true;
+}
+
+bool ledcWrite(uint8_t pin, uint32_t duty)
+{
+  ledcDuty[pin] = duty;
+  return true;
+}
+
+uint32_t ledcWriteTone(uint8_t pin, uint32_t freq)
+{
+  ledcTone[pin] = freq;
+  return freq;
+}
+
+// number formatting
+char *dtostrf(double val, signed char width, unsigned char prec, char *sout)
+{
+  sprintf(sout, "%*.*f", width, prec, val);
+  return sout;
+}
+
+static char *formatInteger(unsigned long long magnitude, bool negative, char *str, int base)
+{
+  char digits[72];
+  int n = 0;
+  if (base < 2 || base > 36) base = 10;
+  do {
+    const int d = (int)(magnitude % base);
+    digits[n++] = (char)(d < 10 ? '0' + d : 'a' + d - 10);
+    magnitude /= base;
+  } while (magnitude);
+  char *out = str;
+  if (negative) *out++ = '-';
+  while (n) *out++ = digits[--n];
+  *out = '\0';
+  return str;
+}
+
+char *utoa(unsigned int value, char *str, int base)
+{
+  return formatInteger(value, false, str, base);
+}
+
+char *itoa(int value, char *str, int base)
+{
+  const bool negative = (value < 0) && (base == 10);
+  const unsigned long long magnitude = negative ? (unsigned long long)(-(long long)value) : (unsigned int)value;
+  return formatInteger(magnitude, negative, str, base);
+}
+
+// String
+std::string String::formatUnsigned(unsigned long long value, unsigned char base)
+{
+  char buffer[72];
+  return formatInteger(value, false, buffer, base);
+}
+
+std::string String::formatSigned(long long value, unsigned char base)
+{
+  char buffer[72];
+  const bool negative = (value < 0) && (base == 10);
+  const unsigned long long magnitude = negative ? (unsigned long long)(-value) : (unsigned long long)value;
+  return formatInteger(magnitude, negative, buffer, base);
+}
+
+std::string String::formatFloat(double value, unsigned int decimalPlaces)
+{
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), "%.*f", (int)decimalPlaces, value);
+  return buffer;
+}
+
+void String::replace(const String &find, const String &replacement)
+{
+  if (find._buffer.empty()) return;
+  size_t pos = 0;
+  while ((pos = _buffer.find(find._buffer, pos)) != std::string::npos) {
+    _buffer.replace(pos, find._buffer.length(), replacement._buffer);
+    pos += replacement._buffer.length();
+  }
+}
+
+void String::trim()
+{
+  size_t begin = 0, end = _buffer.length();
+  while (begin < end && isspace((unsigned char)_buffer[begin])) begin++;
+  while (end > begin && isspace((unsigned char)_buffer[end - 1])) end--;
+  _buffer = _buffer.substr(begin, end - begin);
+}
+
+void String::toLowerCase()
+{
+  std::transform(_buffer.begin(), _buffer.end(), _buffer.begin(), [](unsigned char c) { return (char)tolower(c); });
+}
+
+void String::toUpperCase()
+{
+  std::transform(_buffer.begin(), _buffer.end(), _buffer.begin(), [](unsigned char c) { return (char)toupper(c); });
+}
+
+// Print and Stream
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+  size_t n = 0;
+  while (size--) n += write(*buffer++);
+  return n;
+}
+
+size_t Print::printf(const char *format, ...)
+{
+  char buffer[512];
+  va_list args;
+  va_start(args, format);
+  const int len = vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  if (len <= 0) return 0;
+  return write((const uint8_t *)buffer, std::min((size_t)len, sizeof(buffer) - 1));
+}
+
+int Stream::timedRead()
+{
+  const uint32_t startMS = millis();
+  do {
+    const int c = read();
+    if (c >= 0) return c;
+    delay(1);
+  } while (millis() - startMS < _timeoutMS);
+  return -1;
+}
+
+size_t Stream::readBytes(char *buffer, size_t length)
+{
+  size_t count = 0;
+  int c;
+  while (count < length && (c = timedRead()) >= 0) buffer[count++] = (char)c;
+  return count;
+}
+
+String Stream::readString()
+{
+  std::string s;
+  int c;
+  while ((c = timedRead()) >= 0) s += (char)c;
+  return String(std::move(s));
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+  if (c == '\n') serialLines++;
+  if (!serialMuted) fputc(c, stdout);
+  return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+  serialLines += (uint32_t)std::count(buffer, buffer + size, (uint8_t)'\n');
+  if (!serialMuted) fwrite(buffer, 1, size, stdout);
+  return size;
+}
+
+void HardwareSerial::flush()
+{
+  if (!serialMuted) fflush(stdout);
+}
+
+// chip services
+void EspClass::restart()
+{
+  restartThrow();
+}
+
+// task watchdog, each task's own
+esp_err_t esp_task_wdt_init(const esp_task_wdt_config_t *config)
+{
+  if (wdtInitialized) return ESP_ERR_INVALID_STATE;
+  wdtInitialized = true;
+  wdtTimeoutMS = config->timeout_ms;
+  return ESP_OK;
+}
+
+esp_err_t esp_task_wdt_reconfigure(const esp_task_wdt_config_t *config)
+{
+  if (!wdtInitialized) return ESP_ERR_INVALID_STATE;
+  wdtTimeoutMS = config->timeout_ms;
+  wdtFedMicros = hostClockMicros();
+  return ESP_OK;
+}
+
+esp_err_t esp_task_wdt_deinit()
+{
+  if (!wdtInitialized || wdtSubscribed) return ESP_ERR_INVALID_STATE;
+  wdtInitialized = false;
+  return ESP_OK;
+}
+
+esp_err_t esp_task_wdt_add(TaskHandle_t task)
+{
+  (void)task;
+  if (!wdtInitialized) return ESP_ERR_INVALID_STATE;
+  if (wdtSubscribed) return ESP_ERR_INVALID_ARG;
+  wdtSubscribed = true;
+  wdtFedMicros = hostClockMicros();
+  return ESP_OK;
+}
+
+esp_err_t esp_task_wdt_delete(TaskHandle_t task)
+{
+  (void)task;
+  if (!wdtSubscribed) return ESP_ERR_INVALID_ARG;
+  wdtSubscribed = false;
+  return ESP_OK;
+}
+
+esp_err_t esp_task_wdt_status(TaskHandle_t task)
+{
+  (void)task;
+  if (!wdtInitialized) return ESP_ERR_INVALID_STATE;
+  return wdtSubscribed ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t esp_task_wdt_reset()
+{
+  if (!wdtInitialized || !wdtSubscribed) return ESP_ERR_NOT_FOUND;
+  wdtFedMicros = hostClockMicros();
+  wdtStats.feeds++;
+  return ESP_OK;
+}
+
+uint64_t EspClass::getEfuseMac()
+{
+  return 0x0000A4CF12345678ULL;  // fixed MAC so deviceGetID() is stable across runs
+}
+
+uint32_t EspClass::getFreeHeap()
+{
+  return 200000;
+}
+
+// host runtime controls
+void hostSerialMute(bool muted) { serialMuted = muted; }
+uint32_t hostSerialLines() { return serialLines; }
+void hostRandomSeedSet(uint32_t seed) { randomSeedValue = seed; }
+const HostTaskWDTStats &hostTaskWDTStats() { return wdtStats; }
+void hostButtonSet(uint8_t pin, bool pressed) { buttonPressed[pin] = pressed; }
+uint32_t hostLedcDuty(uint8_t pin) { return ledcDuty.count(pin) ? ledcDuty[pin] : 0; }
+uint32_t hostLedcTone(uint8_t pin) { return ledcTone.count(pin) ? ledcTone[pin] : 0; }
@@ -0,0 +1,129 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for the ESP32 Arduino core
+
+  Only the subset of the core used by the sketch is provided. Time, GPIO, LEDC and
+  the serial port are backed by the host runtime (see host_runtime.h) so runners can
+  drive the sketch and observe what it did.
+*/
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <math.h>     // isnan() and the rest at global scope, as the ESP32 core
+
+#include "WString.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x01
+#define OUTPUT       0x03
+#define INPUT_PULLUP 0x05
+#define OUTPUT_OPEN_DRAIN 0x13
+
+#ifndef PI
+  #define PI 3.1415926535897932384626433832795
+#endif
+
+#define PROGMEM
+#define pgm_read_byte(addr) (*(const uint8_t *)(addr))
+
+// time
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+// random numbers; the C library random(void) stays visible alongside these overloads
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+uint32_t esp_random();
+
+long map(long x, long in_min, long in_max, long out_min, long out_max);
+
+// GPIO and LEDC (PWM)
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t val);
+bool ledcAttach(uint8_t pin, uint32_t freq, uint8_t resolution);
+bool ledcWrite(uint8_t pin, uint32_t duty);
+uint32_t ledcWriteTone(uint8_t pin, uint32_t freq);
+
+// number formatting helpers from the AVR/ESP32 libc
+char *dtostrf(double val, signed char width, unsigned char prec, char *sout);
+char *utoa(unsigned int value, char *str, int base);
+char *itoa(int value, char *str, int base);
+
+// Byte sink with the print helpers the sketch uses
+class Print {
+  public:
+    virtual ~Print() = default;
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    size_t write(const char *str) { return str ? write((const uint8_t *)str, strlen(str)) : 0; }
+    virtual void flush() {}
+
+    size_t print(const String &s) { return write((const uint8_t *)s.c_str(), s.length()); }
+    size_t print(const char *str) { return write(str); }
+    size_t print(char c) { return write((uint8_t)c); }
+    template <typename T>
+    size_t print(T value) { return print(String(value)); }
+    size_t println() { return write("\r\n"); }
+    template <typename T>
+    size_t println(T value) { size_t n = print(value); return n + println(); }
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+// Byte source, used by HTTPClient::getStream() and ArduinoJson. As in the ESP32 core, read()
+// doesn't wait; readBytes() and readString() wait up to the timeout for each byte
+class Stream : public Print {
+  public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    void setTimeout(uint32_t timeoutMS) { _timeoutMS = timeoutMS; }
+    size_t readBytes(char *buffer, size_t length);
+    String readString();
+
+  protected:
+    int timedRead();
+
+    uint32_t _timeoutMS = 1000;
+};
+
+// Serial console; output goes to stdout unless muted by the host runner
+class HardwareSerial : public Stream {
+  public:
+    void begin(unsigned long baud) { (void)baud; }
+    void end() {}
+    explicit operator bool() const { return true; }
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+    void flush() override;
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+};
+extern HardwareSerial Serial;
+
+// Chip level services
+class EspClass {
+  public:
+    [[noreturn]] void restart();
+    uint64_t getEfuseMac();
+    uint32_t getFreeHeap();
+};
+extern EspClass ESP;
@@ -0,0 +1,520 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for ArduinoJson (https://github.com/bblanchon/ArduinoJson)
+*/
+
+#include "ArduinoJson.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+// JsonNode
+
+const JsonNode *JsonNode::member(const std::string &key) const
+{
+  if (type != Type::Object) return nullptr;
+  for (size_t i = 0; i < keys.size(); i++) {
+    if (keys[i] == key) return &children[i];
+  }
+  return nullptr;
+}
+
+double JsonNode::number() const
+{
+  switch (type) {
+    case Type::Bool:    return boolean ? 1.0 : 0.0;
+    case Type::Integer: return (double)integer;
+    case Type::Float:   return real;
+    default:            return 0.0;
+  }
+}
+
+// JsonVariant
+
+JsonVariant JsonVariant::child(const char *key) const
+{
+  JsonVariant result(*this);
+  result._path.push_back({false, key ? key : "", 0});
+  return result;
+}
+
+JsonVariant JsonVariant::child(size_t index) const
+{
+  JsonVariant result(*this);
+  result._path.push_back({true, std::string(), index});
+  return result;
+}
+
+const JsonNode *JsonVariant::resolve() const
+{
+  const JsonNode *node = _root;
+  for (const PathElement &element : _path) {
+    if (element.isIndex) {
+      if (node->type != JsonNode::Type::Array || element.index >= node->children.size()) return nullptr;
+      node = &node->children[element.index];
+    }
+    else {
+      node = node->member(element.key);
+      if (!node) return nullptr;
+    }
+  }
+  return node;
+}
+
+JsonNode *JsonVariant::create()
+{
+  JsonNode *node = _root;
+  for (const PathElement &element : _path) {
+    if (element.isIndex) {
+      if (node->type != JsonNode::Type::Array) {
+        *node = JsonNode();
+        node->type = JsonNode::Type::Array;
+      }
+      if (element.index >= node->children.size()) node->children.resize(element.index + 1);
+      node = &node->children[element.index];
+    }
+    else {
+      if (node->type != JsonNode::Type::Object) {
+        *node = JsonNode();
+        node->type = JsonNode::Type::Object;
+      }
+      size_t i = 0;
+      while (i < node->keys.size() && node->keys[i] != element.key) i++;
+      if (i == node->keys.size()) {
+        node->keys.push_back(element.key);
+        node->children.emplace_back();
+      }
+      node = &node->children[i];
+    }
+  }
+  return node;
+}
+
+JsonVariant &JsonVariant::operator=(bool value)
+{
+  JsonNode *node = create();
+  *node = JsonNode();
+  node->type = JsonNode::Type::Bool;
+  node->boolean = value;
+  return *this;
+}
+
+JsonVariant &JsonVariant::operator=(const char *value)
+{
+  JsonNode *node = create();
+  *node = JsonNode();
+  if (value) {
+    node->type = JsonNode::Type::String;
+    node->text = value;
+  }
+  return *this;
+}
+
+JsonVariant &JsonVariant::operator=(double value)
+{
+  JsonNode *node = create();
+  *node = JsonNode();
+  node->type = JsonNode::Type::Float;
+  node->real = value;
+  return *this;
+}
+
+JsonVariant &JsonVariant::operator=(long long value)
+{
+  JsonNode *node = create();
+  *node = JsonNode();
+  node->type = JsonNode::Type::Integer;
+  node->integer = value;
+  return *this;
+}
+
+namespace {
+  void writeJson(const JsonNode &node, std::string &out, int indent, int depth);
+}
+
+String JsonVariant::asString() const
+{
+  const JsonNode *node = resolve();
+  if (!node || node->type == JsonNode::Type::Null) return String();
+  if (node->type == JsonNode::Type::String) return String(node->text);
+  std::string out;
+  writeJson(*node, out, 0, 0);
+  return String(out);
+}
+
+// DeserializationError
+
+const char *DeserializationError::c_str() const
+{
+  switch (_code) {
+    case Ok:              return "Ok";
+    case EmptyInput:      return "EmptyInput";
+    case IncompleteInput: return "IncompleteInput";
+    case InvalidInput:    return "InvalidInput";
+    case NoMemory:        return "NoMemory";
+    case TooDeep:         return "TooDeep";
+  }
+  return "Unknown";
+}
+
+// Parsing and serialization
+
+namespace {
+  constexpr int kMaxNesting = 32;
+
+  class Parser {
+    public:
+      explicit Parser(const std::string &text) : _text(text) {}
+
+      DeserializationError::Code parse(JsonNode &root)
+      {
+        skipSpace();
+        if (_pos >= _text.size()) return DeserializationError::EmptyInput;
+        return value(root, 0);
+      }
+
+    private:
+      DeserializationError::Code value(JsonNode &node, int depth)
+      {
+        if (depth > kMaxNesting) return DeserializationError::TooDeep;
+        skipSpace();
+        if (_pos >= _text.size()) return DeserializationError::IncompleteInput;
+        char c = _text[_pos];
+        if (c == '{') return object(node, depth);
+        if (c == '[') return array(node, depth);
+        if (c == '"') {
+          node.type = JsonNode::Type::String;
+          return string(node.text);
+        }
+        if (c == '-' || (c >= '0' && c <= '9')) return number(node);
+        if (literal("true")) { node.type = JsonNode::Type::Bool; node.boolean = true; return DeserializationError::Ok; }
+        if (literal("false")) { node.type = JsonNode::Type::Bool; node.boolean = false; return DeserializationError::Ok; }
+        if (literal("null")) { node.type = JsonNode::Type::Null; return DeserializationError::Ok; }
+        return (_text.size() - _pos < 5) ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+      }
+
+      DeserializationError::Code object(JsonNode &node, int depth)
+      {
+        node.type = JsonNode::Type::Object;
+        _pos++;
+        skipSpace();
+        if (peek() == '}') { _pos++; return DeserializationError::Ok; }
+        while (true) {
+          skipSpace();
+          if (_pos >= _text.size()) return DeserializationError::IncompleteInput;
+          if (peek() != '"') return DeserializationError::InvalidInput;
+          std::string key;
+          DeserializationError::Code code = string(key);
+          if (code != DeserializationError::Ok) return code;
+          skipSpace();
+          if (_pos >= _text.size()) return DeserializationError::IncompleteInput;
+          if (_text[_pos++] != ':') return DeserializationError::InvalidInput;
+          node.keys.push_back(key);
+          node.children.emplace_back();
+          code = value(node.children.back(), depth + 1);
+          if (code != DeserializationError::Ok) return code;
+          skipSpace();
+          if (_pos >= _text.size()) return DeserializationError::IncompleteInput;
+          char c = _text[_pos++];
+          if (c == '}') return DeserializationError::Ok;
+          if (c != ',') return DeserializationError::InvalidInput;
+        }
+      }
+
+      DeserializationError::Code array(JsonNode &node, int depth)
+      {
+        node.type = JsonNode::Type::Array;
+        _pos++;
+        skipSpace();
+        if (peek() == ']') { _pos++; return DeserializationError::Ok; }
+        while (true) {
+          node.children.emplace_back();
+          DeserializationError::Code code = value(node.children.back(), depth + 1);
+          if (code != DeserializationError::Ok) return code;
+          skipSpace();
+          if (_pos >= _text.size()) return DeserializationError::IncompleteInput;
+          char c = _text[_pos++];
+          if (c == ']') return DeserializationError::Ok;
+          if (c != ',') return DeserializationError::InvalidInput;
+        }
+      }
+
+      DeserializationError::Code string(std::string &out)
+      {
+        _pos++;  // opening quote
+        while (_pos < _text.size()) {
+          char c = _text[_pos++];
+          if (c == '"') return DeserializationError::Ok;
+          if (c != '\\') { out += c; continue; }
+          if (_pos >= _text.size()) break;
+          char e = _text[_pos++];
+          switch (e) {
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+              if (_pos + 4 > _text.size()) return DeserializationError::IncompleteInput;
+              uint32_t cp = (uint32_t)strtoul(_text.substr(_pos, 4).c_str(), nullptr, 16);
+              _pos += 4;
+              appendUtf8(out, cp);
+              break;
+            }
+            default: out += e; break;
+          }
+        }
+        return DeserializationError::IncompleteInput;
+      }
+
+      DeserializationError::Code number(JsonNode &node)
+      {
+        size_t start = _pos;
+        bool isFloat = false;
+        if (peek() == '-') _pos++;
+        while (_pos < _text.size()) {
+          char c = _text[_pos];
+          if (c >= '0' && c <= '9') { _pos++; continue; }
+          if (c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-') { isFloat = true; _pos++; continue; }
+          break;
+        }
+        std::string token = _text.substr(start, _pos - start);
+        if (isFloat) {
+          node.type = JsonNode::Type::Float;
+          node.real = strtod(token.c_str(), nullptr);
+        }
+        else {
+          node.type = JsonNode::Type::Integer;
+          node.integer = strtoll(token.c_str(), nullptr, 10);
+        }
+        return DeserializationError::Ok;
+      }
+
+      bool literal(const char *word)
+      {
+        size_t len = strlen(word);
+        if (_text.compare(_pos, len, word) != 0) return false;
+        _pos += len;
+        return true;
+      }
+
+      static void appendUtf8(std::string &out, uint32_t cp)
+      {
+        if (cp < 0x80) out += (char)cp;
+        else if (cp < 0x800) {
+          out += (char)(0xC0 | (cp >> 6));
+          out += (char)(0x80 | (cp & 0x3F));
+        }
+        else {
+          out += (char)(0xE0 | (cp >> 12));
+          out += (char)(0x80 | ((cp >> 6) & 0x3F));
+          out += (char)(0x80 | (cp & 0x3F));
+        }
+      }
+
+      char peek() const { return (_pos < _text.size()) ? _text[_pos] : '\0'; }
+      void skipSpace()
+      {
+        while (_pos < _text.size() && isspace((unsigned char)_text[_pos])) _pos++;
+      }
+
+      const std::string &_text;
+      size_t _pos = 0;
+  };
+
+  // Keeps only the parts of node selected by filter, the way ArduinoJson's filter works:
+  // true keeps a whole subtree, an object keeps matching members ("*" matches any), and
+  // an array filter applies its first element to every array element.
+  bool applyFilter(JsonNode &node, const JsonNode &filter)
+  {
+    if (filter.type == JsonNode::Type::Bool) return filter.boolean;
+    if (filter.type == JsonNode::Type::Object && node.type == JsonNode::Type::Object) {
+      JsonNode kept;
+      kept.type = JsonNode::Type::Object;
+      for (size_t i = 0; i < node.keys.size(); i++) {
+        const JsonNode *sub = filter.member(node.keys[i]);
+        if (!sub) sub = filter.member("*");
+        if (sub && applyFilter(node.children[i], *sub)) {
+          kept.keys.push_back(node.keys[i]);
+          kept.children.push_back(std::move(node.children[i]));
+        }
+      }
+      node = std::move(kept);
+      return true;
+    }
+    if (filter.type == JsonNode::Type::Array && node.type == JsonNode::Type::Array) {
+      if (filter.children.empty()) {
+        node.children.clear();
+        return true;
+      }
+      for (JsonNode &element : node.children) {
+        if (!applyFilter(element, filter.children[0])) element = JsonNode();
+      }
+      return true;
+    }
+    return false;
+  }
+
+  void writeString(const std::string &text, std::string &out)
+  {
+    out += '"';
+    for (char c : text) {
+      switch (c) {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:   out += c; break;
+      }
+    }
+    out += '"';
+  }
+
+  void newline(std::string &out, int indent, int depth)
+  {
+    if (!indent) return;
+    out += "\r\n";
+    out.append((size_t)(indent * depth), ' ');
+  }
+
+  void writeJson(const JsonNode &node, std::string &out, int indent, int depth)
+  {
+    char buffer[32];
+    switch (node.type) {
+      case JsonNode::Type::Null:
+        out += "null";
+        break;
+      case JsonNode::Type::Bool:
+        out += node.boolean ? "true" : "false";
+        break;
+      case JsonNode::Type::Integer:
+        snprintf(buffer, sizeof(buffer), "%lld", node.integer);
+        out += buffer;
+        break;
+      case JsonNode::Type::Float:
+        if (std::isnan(node.real) || std::isinf(node.real)) out += "null";
+        else {
+          snprintf(buffer, sizeof(buffer), "%.9g", node.real);
+          out += buffer;
+        }
+        break;
+      case JsonNode::Type::String:
+        writeString(node.text, out);
+        break;
+      case JsonNode::Type::Array:
+      case JsonNode::Type::Object: {
+        bool isObject = (node.type == JsonNode::Type::Object);
+        out += isObject ? '{' : '[';
+        for (size_t i = 0; i < node.children.size(); i++) {
+          if (i) out += ',';
+          newline(out, indent, depth + 1);
+          if (isObject) {
+            writeString(node.keys[i], out);
+            out += indent ? ": " : ":";
+          }
+          writeJson(node.children[i], out, indent, depth + 1);
+        }
+        if (!node.children.empty()) newline(out, indent, depth);
+        out += isObject ? '}' : ']';
+        break;
+      }
+    }
+  }
+
+  DeserializationError parseInto(JsonDocument &doc, const std::string &text, const JsonNode *filter)
+  {
+    doc.clear();
+    Parser parser(text);
+    DeserializationError::Code code = parser.parse(doc.root());
+    if (code != DeserializationError::Ok) {
+      doc.clear();
+      return DeserializationError(code);
+    }
+    if (filter && !applyFilter(doc.root(), *filter)) doc.clear();
+    return DeserializationError();
+  }
+
+  // a byte at a time, each waiting up to the stream's timeout, as ArduinoJson's stream reader
+  // does, up to the end of an object or array at the root rather than the end of the stream
+  std::string drain(Stream &input)
+  {
+    std::string text;
+    char c;
+    int depth = 0;
+    bool quoted = false, escaped = false;
+    while (input.readBytes(&c, 1) == 1) {
+      text += c;
+      if (escaped) escaped = false;
+      else if (quoted) {
+        if (c == '\\') escaped = true;
+        else if (c == '"') quoted = false;
+      }
+      else if (c == '"') quoted = true;
+      else if (c == '{' || c == '[') depth++;
+      else if ((c == '}' || c == ']') && --depth == 0) break;
+    }
+    return text;
+  }
+}
+
+DeserializationError deserializeJson(JsonDocument &doc, Stream &input)
+{
+  return parseInto(doc, drain(input), nullptr);
+}
+
+DeserializationError deserializeJson(JsonDocument &doc, Stream &input, DeserializationOption::Filter filter)
+{
+  return parseInto(doc, drain(input), filter.node());
+}
+
+DeserializationError deserializeJson(JsonDocument &doc, const char *input)
+{
+  return parseInto(doc, input ? std::string(input) : std::string(), nullptr);
+}
+
+DeserializationError deserializeJson(JsonDocument &doc, const String &input)
+{
+  return parseInto(doc, input.str(), nullptr);
+}
+
+size_t serializeJson(const JsonDocument &doc, String &output)
+{
+  std::string out;
+  writeJson(doc.root(), out, 0, 0);
+  output = String(out);
+  return out.size();
+}
+
+size_t serializeJson(const JsonDocument &doc, Print &output)
+{
+  std::string out;
+  writeJson(doc.root(), out, 0, 0);
+  return output.write((const uint8_t *)out.data(), out.size());
+}
+
+size_t serializeJson(const JsonDocument &doc, char *output, size_t size)
+{
+  std::string out;
+  writeJson(doc.root(), out, 0, 0);
+  if (!size) return 0;
+  size_t len = (out.size() < size - 1) ? out.size() : size - 1;
+  memcpy(output, out.data(), len);
+  output[len] = '\0';
+  return len;
+}
+
+size_t serializeJsonPretty(const JsonDocument &doc, Print &output)
+{
+  std::string out;
+  writeJson(doc.root(), out, 2, 0);
+  return output.write((const uint8_t *)out.data(), out.size());
+}
+
+size_t measureJson(const JsonDocument &doc)
+{
+  std::string out;
+  writeJson(doc.root(), out, 0, 0);
+  return out.size();
+}
@@ -0,0 +1,178 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for ArduinoJson (https://github.com/bblanchon/ArduinoJson)
+
+  A small DOM with the ArduinoJson surface the sketch uses: element access through
+  operator[], implicit conversions, the "| default" operator, deserialization from a
+  Stream with an optional filter, and compact serialization.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+#include <string>
+#include <type_traits>
+#include <vector>
+
+struct JsonNode {
+  enum class Type : uint8_t { Null, Bool, Integer, Float, String, Array, Object };
+
+  Type type = Type::Null;
+  bool boolean = false;
+  long long integer = 0;
+  double real = 0.0;
+  std::string text;
+  std::vector<std::string> keys;     // Object member names
+  std::vector<JsonNode> children;    // Array elements or Object member values
+
+  const JsonNode *member(const std::string &key) const;
+  bool isNumber() const { return type == Type::Integer || type == Type::Float || type == Type::Bool; }
+  double number() const;
+};
+
+// Reference to a (possibly not yet existing) element of a document. Reads never
+// create elements; assignment creates the path as needed.
+class JsonVariant {
+  public:
+    typedef void json_variant_tag;
+
+    JsonVariant(JsonNode *root) : _root(root) {}
+
+    JsonVariant operator[](const char *key) const { return child(key); }
+    JsonVariant operator[](const String &key) const { return child(key.c_str()); }
+    JsonVariant operator[](int index) const { return child((size_t)index); }
+    JsonVariant operator[](size_t index) const { return child(index); }
+
+    JsonVariant &operator=(bool value);
+    JsonVariant &operator=(const char *value);
+    JsonVariant &operator=(const String &value) { return *this = value.c_str(); }
+    JsonVariant &operator=(double value);
+    JsonVariant &operator=(float value) { return *this = (double)value; }
+    JsonVariant &operator=(long long value);
+    JsonVariant &operator=(int value) { return *this = (long long)value; }
+    JsonVariant &operator=(unsigned int value) { return *this = (long long)value; }
+    JsonVariant &operator=(long value) { return *this = (long long)value; }
+    JsonVariant &operator=(unsigned long value) { return *this = (long long)value; }
+    JsonVariant &operator=(uint16_t value) { return *this = (long long)value; }
+    JsonVariant &operator=(uint8_t value) { return *this = (long long)value; }
+
+    template <typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value>>
+    operator T() const { return as<T>(); }
+
+    template <typename T>
+    T as() const
+    {
+      if constexpr (std::is_same<T, String>::value) {
+        return asString();
+      }
+      else {
+        const JsonNode *node = resolve();
+        return (node && node->isNumber()) ? (T)node->number() : T();
+      }
+    }
+
+    bool isNull() const { const JsonNode *node = resolve(); return !node || node->type == JsonNode::Type::Null; }
+    size_t size() const { const JsonNode *node = resolve(); return node ? node->children.size() : 0; }
+
+    const JsonNode *resolve() const;
+
+  private:
+    struct PathElement {
+      bool isIndex;
+      std::string key;
+      size_t index;
+    };
+
+    JsonVariant child(const char *key) const;
+    JsonVariant child(size_t index) const;
+    JsonNode *create();
+    String asString() const;
+
+    JsonNode *_root;
+    std::vector<PathElement> _path;
+};
+
+template <typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value>>
+T operator|(const JsonVariant &variant, T defaultValue)
+{
+  const JsonNode *node = variant.resolve();
+  return (node && node->isNumber()) ? (T)node->number() : defaultValue;
+}
+
+inline String operator|(const JsonVariant &variant, const char *defaultValue)
+{
+  const JsonNode *node = variant.resolve();
+  return (node && node->type == JsonNode::Type::String) ? String(node->text) : String(defaultValue);
+}
+
+class JsonDocument {
+  public:
+    JsonDocument() = default;
+    explicit JsonDocument(size_t capacity) { (void)capacity; }
+
+    JsonVariant operator[](const char *key) { return JsonVariant(&_root)[key]; }
+    JsonVariant operator[](const String &key) { return JsonVariant(&_root)[key]; }
+    JsonVariant operator[](int index) { return JsonVariant(&_root)[index]; }
+    JsonVariant as() { return JsonVariant(&_root); }
+
+    void clear() { _root = JsonNode(); }
+    bool isNull() const { return _root.type == JsonNode::Type::Null; }
+    size_t size() const { return _root.children.size(); }
+
+    JsonNode &root() { return _root; }
+    const JsonNode &root() const { return _root; }
+
+  private:
+    JsonNode _root;
+};
+
+template <size_t capacity>
+class StaticJsonDocument : public JsonDocument {
+  public:
+    StaticJsonDocument() : JsonDocument(capacity) {}
+};
+
+#define JSON_OBJECT_SIZE(n) ((n) * 16)
+#define JSON_ARRAY_SIZE(n)  ((n) * 16)
+
+class DeserializationError {
+  public:
+    enum Code { Ok, EmptyInput, IncompleteInput, InvalidInput, NoMemory, TooDeep };
+
+    DeserializationError(Code code = Ok) : _code(code) {}
+    explicit operator bool() const { return _code != Ok; }
+    bool operator==(Code code) const { return _code == code; }
+    Code code() const { return _code; }
+    const char *c_str() const;
+
+  private:
+    Code _code;
+};
+
+namespace DeserializationOption {
+  class Filter {
+    public:
+      explicit Filter(JsonDocument &filter) : _filter(&filter.root()) {}
+      const JsonNode *node() const { return _filter; }
+
+    private:
+      const JsonNode *_filter;
+  };
+}
+
+DeserializationError deserializeJson(JsonDocument &doc, Stream &input);
+DeserializationError deserializeJson(JsonDocument &doc, Stream &input, DeserializationOption::Filter filter);
+DeserializationError deserializeJson(JsonDocument &doc, const char *input);
+DeserializationError deserializeJson(JsonDocument &doc, const String &input);
+
+size_t serializeJson(const JsonDocument &doc, String &output);
+size_t serializeJson(const JsonDocument &doc, Print &output);
+size_t serializeJson(const JsonDocument &doc, char *output, size_t size);
+template <size_t N>
+size_t serializeJson(const JsonDocument &doc, char (&output)[N])
+{
+  return serializeJson(doc, output, N);
+}
+size_t serializeJsonPretty(const JsonDocument &doc, Print &output);
+size_t measureJson(const JsonDocument &doc);
@@ -0,0 +1,73 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for the ESP32 FS library's File and FS classes
+
+  Only LittleFS (see LittleFS.h) is backed. Files and directories live in process memory
+  for the lifetime of the runner, like the flash surviving ESP.restart() on the device;
+  host_runtime.h has the flash controls and statistics. Modes are the stdio ones, "r",
+  "r+", "w", "w+", "a" and "a+".
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+#include <memory>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+struct FileHandle;
+
+class File {
+  public:
+    File() = default;
+    explicit File(std::shared_ptr<FileHandle> handle) : _handle(handle) {}
+
+    size_t write(const uint8_t *buffer, size_t size);
+    size_t write(uint8_t c) { return write(&c, 1); }
+    size_t read(uint8_t *buffer, size_t size);
+    int read();
+    int available();
+    bool seek(uint32_t position, SeekMode mode = SeekSet);
+    size_t position() const;
+    size_t size() const;
+    void flush();
+    void close();
+    explicit operator bool() const { return (bool)_handle; }
+
+    const char *path() const;
+    const char *name() const;   // the last component of path(), as in ESP32 core 2.0 and later
+    bool isDirectory() const;
+    File openNextFile(const char *mode = FILE_READ);
+
+  private:
+    std::shared_ptr<FileHandle> _handle;
+};
+
+class FS {
+  public:
+    File open(const char *path, const char *mode = FILE_READ, bool create = false);
+    File open(const String &path, const char *mode = FILE_READ, bool create = false) { return open(path.c_str(), mode, create); }
+    bool exists(const char *path);
+    bool exists(const String &path) { return exists(path.c_str()); }
+    bool remove(const char *path);
+    bool remove(const String &path) { return remove(path.c_str()); }
+    bool mkdir(const char *path);
+    bool mkdir(const String &path) { return mkdir(path.c_str()); }
+    bool rmdir(const char *path);
+};
+
+}  // namespace fs
+
+using fs::FS;
+using fs::File;
+using fs::SeekMode;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
@@ -0,0 +1,156 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for the ESP32 HTTPClient library
+*/
+
+#include "HTTPClient.h"
+
+void HTTPBodyStream::assign(std::string body, HostNetServer *server, uint32_t timeoutMS)
+{
+  _body = std::move(body);
+  _position = 0;
+  _arrived = 0;
+  _server = _body.empty() ? nullptr : server;
+  if (_server) {
+    _nextBytes = hostNetNextPiece(*_server, _body.size(), _nextAfterMS);
+    _nextMS = millis() + _nextAfterMS;
+  }
+  setTimeout(timeoutMS);
+}
+
+bool HTTPBodyStream::receive()
+{
+  if (!_server || (int32_t)(millis() - _nextMS) < 0) return false;
+  _arrived += _nextBytes;
+  _server->stats.bytesReceived += _nextBytes;
+  _server->stats.blockedMicros += (uint64_t)_nextAfterMS * 1000;
+  if (_arrived == _body.size()) _server = nullptr;
+  else {
+    _nextBytes = hostNetNextPiece(*_server, _body.size() - _arrived, _nextAfterMS);
+    _nextMS = millis() + _nextAfterMS;
+  }
+  return true;
+}
+
+bool HTTPClient::begin(const String &url)
+{
+  _headers.clear();
+  _stream.assign(std::string(), nullptr, 0);
+  _size = -1;
+  _begun = false;
+
+  const int schemeEnd = url.indexOf("://");
+  if (schemeEnd <= 0) return false;
+  _scheme = url.substring(0, schemeEnd);
+  _port = (_scheme == "https") ? 443 : 80;
+
+  String rest = url.substring(schemeEnd + 3);
+  const int pathStart = rest.indexOf('/');
+  String authority = (pathStart < 0) ? rest : rest.substring(0, pathStart);
+  _path = (pathStart < 0) ? String("/") : rest.substring(pathStart);
+
+  const int portStart = authority.indexOf(':');
+  if (portStart >= 0) {
+    _port = (uint16_t)authority.substring(portStart + 1).toInt();
+    authority = authority.substring(0, portStart);
+  }
+  _host = authority;
+  _begun = !_host.isEmpty();
+  return _begun;
+}
+
+void HTTPClient::end()
+{
+  _begun = false;
+  _stream.assign(std::string(), nullptr, 0);
+}
+
+void HTTPClient::addHeader(const String &name, const String &value)
+{
+  _headers.emplace_back(name, value);
+}
+
+int HTTPClient::GET()
+{
+  return sendRequest("GET", String());
+}
+
+int HTTPClient::POST(const String &payload)
+{
+  return sendRequest("POST", payload);
+}
+
+int HTTPClient::sendRequest(const char *method, const String &payload)
+{
+  _stream.assign(std::string(), nullptr, 0);
+  _size = -1;
+  if (!_begun) return HTTPC_ERROR_NOT_CONNECTED;
+  HostNetServer *server = (WiFi.status() == WL_CONNECTED) ? hostNetFind(_host, _port) : nullptr;
+  if (!server) return HTTPC_ERROR_CONNECTION_REFUSED;
+
+  server->stats.requests++;
+  const int code = exchange(*server, method, payload);
+  if (code < 0 || code >= 400) server->stats.failures++;
+  return code;
+}
+
+int HTTPClient::exchange(HostNetServer &server, const char *method, const String &payload)
+{
+  // SYN, SYN-ACK
+  if (!hostNetExchange(server, 0, 0, 0, (uint32_t)_connectTimeoutMS)) {
+    server.stats.connectFailures++;
+    return HTTPC_ERROR_CONNECTION_REFUSED;
+  }
+  server.stats.connects++;
+  // TLS 1.2 full handshake: hellos and certificate chain, then key exchange and finished
+  if (_scheme == "https" &&
+      (!hostNetExchange(server, kTLSClientHelloBytes, kTLSServerHelloBytes, 0, _timeoutMS) ||
+       !hostNetExchange(server, kTLSKeyExchangeBytes, kTLSFinishedBytes, 0, _timeoutMS)))
+    return HTTPC_ERROR_CONNECTION_REFUSED;
+
+  HostHTTPRequest request;
+  request.method = method;
+  request.path = _path;
+  request.headers.emplace_back("Host", _host);
+  request.headers.insert(request.headers.end(), _headers.begin(), _headers.end());
+  request.body = payload;
+  size_t requestBytes = request.method.length() + request.path.length() + 12 + payload.length();
+  for (const auto &header : request.headers) requestBytes += header.first.length() + header.second.length() + 4;
+  if (payload.length()) requestBytes += 24;  // Content-Length
+
+  const HostHTTPResponse response = server.httpRequest(request);
+  // status line and headers arrive after the server's think time, the body as it is read
+  if (!hostNetExchange(server, requestBytes, kResponseHeaderBytes, server.link.serviceMS, _timeoutMS))
+    return HTTPC_ERROR_READ_TIMEOUT;
+  _size = (int)response.body.size();
+  _stream.assign(response.body, &server, _timeoutMS);
+  return response.code;
+}
+
+String HTTPClient::getString()
+{
+  return _stream.readString();
+}
+
+Stream &HTTPClient::getStream()
+{
+  return _stream;
+}
+
+String HTTPClient::errorToString(int error)
+{
+  switch (error) {
+    case HTTPC_ERROR_CONNECTION_REFUSED:  return "connection refused";
+    case HTTPC_ERROR_SEND_HEADER_FAILED:  return "send header failed";
+    case HTTPC_ERROR_SEND_PAYLOAD_FAILED: return "send payload failed";
+    case HTTPC_ERROR_NOT_CONNECTED:       return "not connected";
+    case HTTPC_ERROR_CONNECTION_LOST:     return "connection lost";
+    case HTTPC_ERROR_NO_STREAM:           return "no stream";
+    case HTTPC_ERROR_NO_HTTP_SERVER:      return "no HTTP server";
+    case HTTPC_ERROR_TOO_LESS_RAM:        return "too less ram";
+    case HTTPC_ERROR_ENCODING:            return "Transfer-Encoding not supported";
+    case HTTPC_ERROR_STREAM_WRITE:        return "Stream write error";
+    case HTTPC_ERROR_READ_TIMEOUT:        return "read Timeout";
+    default:                              return String();
+  }
+}
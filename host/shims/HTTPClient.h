@@ -0,0 +1,106 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for the ESP32 HTTPClient library
+
+  Requests go to the stand-in server listening at the URL's host and port (see
+  host_net.h), each on a new connection with the ESP32 client's timeouts; https adds
+  the two round trips of a TLS handshake.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// error codes, as in the ESP32 HTTPClient
+#define HTTPC_ERROR_CONNECTION_REFUSED  (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED  (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED       (-4)
+#define HTTPC_ERROR_CONNECTION_LOST     (-5)
+#define HTTPC_ERROR_NO_STREAM           (-6)
+#define HTTPC_ERROR_NO_HTTP_SERVER      (-7)
+#define HTTPC_ERROR_TOO_LESS_RAM        (-8)
+#define HTTPC_ERROR_ENCODING            (-9)
+#define HTTPC_ERROR_STREAM_WRITE        (-10)
+#define HTTPC_ERROR_READ_TIMEOUT        (-11)
+
+#define HTTPCLIENT_DEFAULT_TCP_TIMEOUT (5000)
+
+typedef enum {
+  HTTP_CODE_OK = 200,
+  HTTP_CODE_NO_CONTENT = 204,
+  HTTP_CODE_BAD_REQUEST = 400,
+  HTTP_CODE_UNAUTHORIZED = 401,
+  HTTP_CODE_NOT_FOUND = 404,
+  HTTP_CODE_TOO_MANY_REQUESTS = 429,
+  HTTP_CODE_INTERNAL_SERVER_ERROR = 500,
+  HTTP_CODE_SERVICE_UNAVAILABLE = 503
+} t_http_codes;
+
+// Read-only stream over a response body, which arrives from the server a piece at a time
+// from when the headers did. Like the ESP32 WiFiClient that HTTPClient::getStream() returns,
+// read() doesn't wait for the next piece; whoever reads waits, up to its own stream timeout,
+// the client's for getString()
+class HTTPBodyStream : public Stream {
+  public:
+    void assign(std::string body, HostNetServer *server, uint32_t timeoutMS);
+    size_t write(uint8_t c) override { (void)c; return 0; }
+    int available() override { return (_position < _arrived || receive()) ? (int)(_arrived - _position) : 0; }
+    int read() override { return (_position < _arrived || receive()) ? (uint8_t)_body[_position++] : -1; }
+    int peek() override { return (_position < _arrived || receive()) ? (uint8_t)_body[_position] : -1; }
+
+  private:
+    // takes the next piece if it has arrived by now
+    bool receive();
+
+    std::string _body;
+    size_t _position = 0;
+    size_t _arrived = 0;
+    size_t _nextBytes = 0;             // the next piece
+    uint32_t _nextAfterMS = 0;         // its wait after the last
+    uint32_t _nextMS = 0;              // millis() it arrives
+    HostNetServer *_server = nullptr;  // nullptr once the body is complete
+};
+
+class HTTPClient {
+  public:
+    bool begin(const String &url);
+    bool begin(WiFiClient &client, const String &url) { (void)client; return begin(url); }
+    void end();
+    void setTimeout(uint16_t timeoutMS) { _timeoutMS = timeoutMS; }
+    void setConnectTimeout(int32_t timeoutMS) { _connectTimeoutMS = timeoutMS; }
+    void addHeader(const String &name, const String &value);
+
+    int GET();
+    int POST(const String &payload);
+    int sendRequest(const char *method, const String &payload);
+
+    int getSize() const { return _size; }
+    String getString();
+    Stream &getStream();
+    static String errorToString(int error);
+
+  private:
+    // wire sizes for the parts of an exchange that aren't built here
+    static constexpr size_t kTLSClientHelloBytes = 250;
+    static constexpr size_t kTLSServerHelloBytes = 4000;  // including the certificate chain
+    static constexpr size_t kTLSKeyExchangeBytes = 150;
+    static constexpr size_t kTLSFinishedBytes = 50;
+    static constexpr size_t kResponseHeaderBytes = 200;
+
+    int exchange(HostNetServer &server, const char *method, const String &payload);
+
+    String _scheme, _host, _path;
+    uint16_t _port = 80;
+    bool _begun = false;
+    uint16_t _timeoutMS = HTTPCLIENT_DEFAULT_TCP_TIMEOUT;
+    int32_t _connectTimeoutMS = HTTPCLIENT_DEFAULT_TCP_TIMEOUT;
+    std::vector<std::pair<String, String>> _headers;
+    int _size = -1;                    // the response's Content-Length
+    HTTPBodyStream _stream;
+};
@@ -0,0 +1,101 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for InfluxDbClient (https://github.com/tobiasschuerg/InfluxDB-Client-for-Arduino)
+*/
+
+#include "InfluxDbClient.h"
+
+#include <HTTPClient.h>
+
+namespace {
+  // Line protocol escaping for measurement names, tag keys/values and field keys
+  String escapeKey(const String &text)
+  {
+    String escaped;
+    for (unsigned int i = 0; i < text.length(); i++) {
+      char c = text[i];
+      if (c == ',' || c == '=' || c == ' ') escaped += '\\';
+      escaped += c;
+    }
+    return escaped;
+  }
+
+  String urlEncode(const String &text)
+  {
+    static const char kHex[] = "0123456789ABCDEF";
+    String encoded;
+    for (unsigned int i = 0; i < text.length(); i++) {
+      unsigned char c = (unsigned char)text[i];
+      if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') encoded += (char)c;
+      else {
+        encoded += '%';
+        encoded += kHex[c >> 4];
+        encoded += kHex[c & 0x0F];
+      }
+    }
+    return encoded;
+  }
+}
+
+void Point::addTag(const String &name, const String &value)
+{
+  _tags.emplace_back(escapeKey(name), escapeKey(value));
+}
+
+void Point::addField(const String &name, const String &value)
+{
+  String quoted = "\"";
+  for (unsigned int i = 0; i < value.length(); i++) {
+    if (value[i] == '"' || value[i] == '\\') quoted += '\\';
+    quoted += value[i];
+  }
+  putField(name, quoted + "\"");
+}
+
+void Point::putField(const String &name, const String &value)
+{
+  _fields.emplace_back(escapeKey(name), value);
+}
+
+String Point::toLineProtocol() const
+{
+  String line = escapeKey(_measurement);
+  for (const auto &tag : _tags) line += "," + tag.first + "=" + tag.second;
+  for (size_t i = 0; i < _fields.size(); i++) {
+    line += (i == 0) ? " " : ",";
+    line += _fields[i].first + "=" + _fields[i].second;
+  }
+  return line;
+}
+
+int InfluxDBClient::request(const char *method, const String &path, const String &body)
+{
+  HTTPClient http;
+  if (!http.begin(_serverUrl + path)) {
+    _lastStatusCode = HTTPC_ERROR_CONNECTION_REFUSED;
+    _lastErrorMessage = "invalid server URL";
+    return _lastStatusCode;
+  }
+  http.setTimeout(_httpOptions._httpReadTimeout);
+  http.addHeader("Authorization", "Token " + _authToken);
+  if (body.length()) http.addHeader("Content-Type", "text/plain; charset=utf-8");
+  _lastStatusCode = http.sendRequest(method, body);
+  // as the library, only an error response's body is read, for its message
+  if (_lastStatusCode < 0) _lastErrorMessage = HTTPClient::errorToString(_lastStatusCode);
+  else _lastErrorMessage = (_lastStatusCode >= 300) ? http.getString() : String();
+  http.end();
+  return _lastStatusCode;
+}
+
+bool InfluxDBClient::validateConnection()
+{
+  return request("GET", "/health", String()) == HTTP_CODE_OK;
+}
+
+bool InfluxDBClient::writePoint(Point &point)
+{
+  if (!point.hasFields()) return false;
+  String path = "/api/v2/write?org=" + urlEncode(_org) + "&bucket=" + urlEncode(_bucket) + "&precision=s";
+  int code = request("POST", path, point.toLineProtocol());
+  return code == HTTP_CODE_NO_CONTENT || code == HTTP_CODE_OK;
+}
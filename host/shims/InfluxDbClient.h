@@ -0,0 +1,73 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for InfluxDbClient (https://github.com/tobiasschuerg/InfluxDB-Client-for-Arduino)
+
+  Talks the InfluxDB v2 HTTP API through the host HTTPClient: GET /health to validate
+  the connection and POST /api/v2/write with line protocol for each point.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+#include <string>
+#include <vector>
+
+class Point {
+  public:
+    explicit Point(const String &measurement) : _measurement(measurement) {}
+
+    void addTag(const String &name, const String &value);
+    void addField(const String &name, float value, int decimalPlaces = 2) { putField(name, String(value, decimalPlaces)); }
+    void addField(const String &name, double value, int decimalPlaces = 2) { putField(name, String(value, decimalPlaces)); }
+    void addField(const String &name, int value) { putField(name, String(value) + "i"); }
+    void addField(const String &name, unsigned int value) { putField(name, String(value) + "i"); }
+    void addField(const String &name, long value) { putField(name, String(value) + "i"); }
+    void addField(const String &name, unsigned long value) { putField(name, String(value) + "i"); }
+    void addField(const String &name, uint8_t value) { putField(name, String(value) + "i"); }
+    void addField(const String &name, uint16_t value) { putField(name, String(value) + "i"); }
+    void addField(const String &name, bool value) { putField(name, value ? "true" : "false"); }
+    void addField(const String &name, const String &value);
+    void addField(const String &name, const char *value) { addField(name, String(value)); }
+    void clearFields() { _fields.clear(); }
+    void clearTags() { _tags.clear(); }
+    bool hasFields() const { return !_fields.empty(); }
+    String toLineProtocol() const;
+
+  private:
+    void putField(const String &name, const String &value);
+
+    String _measurement;
+    std::vector<std::pair<String, String>> _tags;
+    std::vector<std::pair<String, String>> _fields;
+};
+
+// HTTP settings, as in the library; only the read timeout applies here
+class HTTPOptions {
+  public:
+    HTTPOptions &httpReadTimeout(uint16_t timeoutMS) { _httpReadTimeout = timeoutMS; return *this; }
+    uint16_t _httpReadTimeout = 5000;
+};
+
+class InfluxDBClient {
+  public:
+    InfluxDBClient(const String &serverUrl, const String &org, const String &bucket, const String &authToken)
+      : _serverUrl(serverUrl), _org(org), _bucket(bucket), _authToken(authToken) {}
+
+    void setHTTPOptions(const HTTPOptions &options) { _httpOptions = options; }
+    bool validateConnection();
+    bool writePoint(Point &point);
+    bool flushBuffer() { return true; }
+    String pointToLineProtocol(const Point &point) const { return point.toLineProtocol(); }
+    String getServerUrl() const { return _serverUrl; }
+    String getLastErrorMessage() const { return _lastErrorMessage; }
+    int getLastStatusCode() const { return _lastStatusCode; }
+
+  private:
+    int request(const char *method, const String &path, const String &body);
+
+    String _serverUrl, _org, _bucket, _authToken;
+    HTTPOptions _httpOptions;
+    String _lastErrorMessage;
+    int _lastStatusCode = 0;
+};
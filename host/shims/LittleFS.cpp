@@ -0,0 +1,323 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for the ESP32 FS and LittleFS libraries
+*/
+
+#include "LittleFS.h"
+#include "host_runtime.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+fs::LittleFSFS LittleFS;
+
+namespace {
+  // the default partition scheme's spiffs partition, which LittleFS mounts
+  constexpr size_t kPartitionBytes = 0x160000;
+  constexpr size_t kBlockBytes = 4096;
+  constexpr size_t kPageBytes = 256;
+  // rough ESP32 SPI flash and LittleFS costs
+  constexpr uint32_t kOpenUS = 200;
+  constexpr uint32_t kCloseUS = 300;
+  constexpr uint32_t kReadUS = 30;
+  constexpr uint32_t kReadBytesPerUS = 16;
+  constexpr uint32_t kEraseUS = 45000;    // a block
+  constexpr uint32_t kPageWriteUS = 700 + kEraseUS / (kBlockBytes / kPageBytes);
+
+  struct Flash {
+    bool formatted = false;
+    bool mounted = false;
+    bool mountFail = false;
+    std::map<std::string, std::vector<uint8_t>> files;
+    std::set<std::string> directories;
+    HostFlashStats stats;
+  };
+  Flash &flash()
+  {
+    static Flash store;
+    return store;
+  }
+
+  std::string parentOf(const std::string &path)
+  {
+    const size_t slash = path.rfind('/');
+    return (slash == 0 || slash == std::string::npos) ? "/" : path.substr(0, slash);
+  }
+
+  std::string normalized(const char *path)
+  {
+    std::string result = path ? path : "";
+    if (result.empty() || result[0] != '/') result.insert(result.begin(), '/');
+    while (result.size() > 1 && result.back() == '/') result.pop_back();
+    return result;
+  }
+}
+
+namespace fs {
+
+struct FileHandle {
+  std::string path;
+  std::string name;
+  bool directory = false;
+  bool readable = false, writable = false, append = false;
+  size_t position = 0;
+  std::vector<std::string> listing;   // a directory's entries, for openNextFile()
+  size_t next = 0;
+
+  std::vector<uint8_t> *data()
+  {
+    auto it = flash().files.find(path);
+    return (it == flash().files.end()) ? nullptr : &it->second;
+  }
+};
+
+size_t File::write(const uint8_t *buffer, size_t size)
+{
+  std::vector<uint8_t> *data = _handle ? _handle->data() : nullptr;
+  if (!data || !_handle->writable || !buffer) return 0;
+  if (_handle->append) _handle->position = data->size();
+  // space is taken a block at a time
+  const size_t end = _handle->position + size;
+  if (end > data->size() && LittleFS.usedBytes() - (data->size() + kBlockBytes - 1) / kBlockBytes * kBlockBytes
+      + (end + kBlockBytes - 1) / kBlockBytes * kBlockBytes > kPartitionBytes)
+    return 0;
+  if (end > data->size()) data->resize(end);
+  memcpy(data->data() + _handle->position, buffer, size);
+  _handle->position = end;
+  flash().stats.writes++;
+  flash().stats.bytesWritten += size;
+  delayMicroseconds((size + kPageBytes - 1) / kPageBytes * kPageWriteUS);
+  return size;
+}
+
+size_t File::read(uint8_t *buffer, size_t size)
+{
+  std::vector<uint8_t> *data = _handle ? _handle->data() : nullptr;
+  if (!data || !_handle->readable || !buffer || _handle->position >= data->size()) return 0;
+  if (size > data->size() - _handle->position) size = data->size() - _handle->position;
+  memcpy(buffer, data->data() + _handle->position, size);
+  _handle->position += size;
+  flash().stats.reads++;
+  flash().stats.bytesRead += size;
+  delayMicroseconds(kReadUS + size / kReadBytesPerUS);
+  return size;
+}
+
+int File::read()
+{
+  uint8_t c;
+  return read(&c, 1) ? c : -1;
+}
+
+int File::available()
+{
+  std::vector<uint8_t> *data = _handle ? _handle->data() : nullptr;
+  return (data && _handle->position < data->size()) ? data->size() - _handle->position : 0;
+}
+
+bool File::seek(uint32_t position, SeekMode mode)
+{
+  std::vector<uint8_t> *data = _handle ? _handle->data() : nullptr;
+  if (!data) return false;
+  const size_t base = (mode == SeekCur) ? _handle->position : (mode == SeekEnd) ? data->size() : 0;
+  if (base + position > data->size()) return false;
+  _handle->position = base + position;
+  return true;
+}
+
+size_t File::position() const
+{
+  return _handle ? _handle->position : 0;
+}
+
+size_t File::size() const
+{
+  std::vector<uint8_t> *data = _handle ? _handle->data() : nullptr;
+  return data ? data->size() : 0;
+}
+
+void File::flush()
+{
+  if (_handle && _handle->writable) delayMicroseconds(kCloseUS);
+}
+
+void File::close()
+{
+  if (!_handle) return;
+  flush();
+  _handle.reset();
+}
+
+const char *File::path() const
+{
+  return _handle ? _handle->path.c_str() : nullptr;
+}
+
+const char *File::name() const
+{
+  return _handle ? _handle->name.c_str() : nullptr;
+}
+
+bool File::isDirectory() const
+{
+  return _handle && _handle->directory;
+}
+
+File File::openNextFile(const char *mode)
+{
+  if (!_handle || !_handle->directory || _handle->next >= _handle->listing.size()) return File();
+  return LittleFS.open(_handle->listing[_handle->next++].c_str(), mode);
+}
+
+File FS::open(const char *path, const char *mode, bool create)
+{
+  Flash &store = flash();
+  if (!store.mounted || !path || !mode) return File();
+  const std::string name = normalized(path);
+  auto handle = std::make_shared<FileHandle>();
+  handle->path = name;
+  handle->name = name.substr(name.rfind('/') + 1);
+  store.stats.opens++;
+  delayMicroseconds(kOpenUS);
+
+  if (store.directories.count(name)) {
+    if (mode[0] != 'r') return File();
+    handle->directory = true;
+    // littlefs lists a directory in name order
+    for (const auto &entry : store.directories)
+      if (entry != name && parentOf(entry) == name) handle->listing.push_back(entry);
+    for (const auto &entry : store.files)
+      if (parentOf(entry.first) == name) handle->listing.push_back(entry.first);
+    std::sort(handle->listing.begin(), handle->listing.end());
+    return File(handle);
+  }
+
+  const bool plus = strchr(mode, '+') != nullptr;
+  auto it = store.files.find(name);
+  if (mode[0] == 'r') {
+    if (it == store.files.end()) return File();
+    handle->readable = true;
+    handle->writable = plus;
+  }
+  else if (mode[0] == 'w' || mode[0] == 'a') {
+    const std::string parent = parentOf(name);
+    if (!store.directories.count(parent)) {
+      if (!create) return File();
+      // create makes the missing directories
+      for (std::string directory = parent; !store.directories.count(directory); directory = parentOf(directory))
+        store.directories.insert(directory);
+    }
+    std::vector<uint8_t> &data = store.files[name];
+    if (mode[0] == 'w') data.clear();
+    handle->writable = true;
+    handle->readable = plus;
+    handle->append = (mode[0] == 'a');
+    if (handle->append) handle->position = data.size();
+  }
+  else
+    return File();
+  return File(handle);
+}
+
+bool FS::exists(const char *path)
+{
+  const std::string name = normalized(path);
+  return flash().mounted && (flash().files.count(name) || flash().directories.count(name));
+}
+
+bool FS::remove(const char *path)
+{
+  if (!flash().mounted) return false;
+  delayMicroseconds(kCloseUS);
+  return flash().files.erase(normalized(path)) > 0;
+}
+
+bool FS::mkdir(const char *path)
+{
+  const std::string name = normalized(path);
+  Flash &store = flash();
+  if (!store.mounted || store.files.count(name) || !store.directories.count(parentOf(name))) return false;
+  store.directories.insert(name);
+  return true;
+}
+
+bool FS::rmdir(const char *path)
+{
+  const std::string name = normalized(path);
+  Flash &store = flash();
+  if (!store.mounted || name == "/" || !store.directories.count(name)) return false;
+  for (const auto &entry : store.files)
+    if (parentOf(entry.first) == name) return false;
+  for (const auto &entry : store.directories)
+    if (entry != name && parentOf(entry) == name) return false;
+  store.directories.erase(name);
+  return true;
+}
+
+bool LittleFSFS::begin(bool formatOnFail, const char *basePath, uint8_t maxOpenFiles, const char *partitionLabel)
+{
+  (void)basePath;
+  (void)maxOpenFiles;
+  (void)partitionLabel;
+  Flash &store = flash();
+  if (store.mountFail) return false;
+  if (!store.formatted) {
+    if (!formatOnFail) return false;
+    format();
+  }
+  store.mounted = true;
+  return true;
+}
+
+void LittleFSFS::end()
+{
+  flash().mounted = false;
+}
+
+bool LittleFSFS::format()
+{
+  Flash &store = flash();
+  if (store.mountFail) return false;
+  store.files.clear();
+  store.directories = {"/"};
+  store.formatted = true;
+  // littlefs erases blocks as it needs them; a format writes the two superblocks
+  delayMicroseconds(2 * kEraseUS);
+  return true;
+}
+
+size_t LittleFSFS::totalBytes()
+{
+  return kPartitionBytes;
+}
+
+size_t LittleFSFS::usedBytes()
+{
+  // a block per directory, and each file's data in whole blocks
+  size_t used = flash().directories.size() * kBlockBytes;
+  for (const auto &entry : flash().files) used += (entry.second.size() + kBlockBytes - 1) / kBlockBytes * kBlockBytes;
+  return used;
+}
+
+}  // namespace fs
+
+const HostFlashStats &hostFlashStats() { return flash().stats; }
+void hostFlashStatsReset() { flash().stats = HostFlashStats(); }
+
+void hostFlashErase()
+{
+  Flash &store = flash();
+  store.files.clear();
+  store.directories.clear();
+  store.formatted = false;
+  store.mounted = false;
+}
+
+void hostFlashMountFailSet(bool fail)
+{
+  flash().mountFail = fail;
+  if (fail) flash().mounted = false;
+}
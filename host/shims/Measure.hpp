@@ -0,0 +1,69 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for Measure (https://github.com/disquisitioner/Measure)
+
+  Accumulates running total, count, min, max and current value for a series, and
+  retains the most recent N values in FIFO order. Retained values are right aligned:
+  the newest value is member N-1 and the oldest retained one is member N-getStored().
+  clear() restarts the running statistics but keeps the retained values, which is how
+  the sketch keeps graph history across report intervals.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+template <uint16_t N = 0>
+class Measure {
+  public:
+    Measure() { clear(); deleteRetained(); }
+
+    void include(float value)
+    {
+      _current = value;
+      _total += value;
+      if (_count == 0 || value < _min) _min = value;
+      if (_count == 0 || value > _max) _max = value;
+      _count++;
+
+      if (N > 0) {
+        for (uint16_t i = 1; i < N; i++) _retained[i - 1] = _retained[i];
+        _retained[N - 1] = value;
+        if (_stored < N) _stored++;
+      }
+    }
+
+    float getCurrent() const { return _current; }
+    float getTotal() const { return _total; }
+    float getAverage() const { return _count ? _total / _count : 0.0f; }
+    float getMin() const { return _min; }
+    float getMax() const { return _max; }
+    uint32_t getCount() const { return _count; }
+
+    uint16_t getCapacity() const { return N; }
+    uint16_t getStored() const { return _stored; }
+    float getMember(uint16_t index) const { return (index < N) ? _retained[index] : 0.0f; }
+
+    void clear()
+    {
+      _total = 0.0f;
+      _min = 0.0f;
+      _max = 0.0f;
+      _count = 0;
+    }
+
+    void deleteRetained()
+    {
+      for (uint16_t i = 0; i < (N > 0 ? N : 1); i++) _retained[i] = 0.0f;
+      _stored = 0;
+    }
+
+  private:
+    float _current = 0.0f;
+    float _total = 0.0f;
+    float _min = 0.0f;
+    float _max = 0.0f;
+    uint32_t _count = 0;
+    uint16_t _stored = 0;
+    float _retained[N > 0 ? N : 1];
+};
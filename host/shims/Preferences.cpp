@@ -0,0 +1,81 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for the ESP32 Preferences (NVS) library
+*/
+
+#include "Preferences.h"
+
+#include <map>
+
+namespace {
+  std::map<std::string, std::map<std::string, std::string>> &nvsStore()
+  {
+    static std::map<std::string, std::map<std::string, std::string>> store;
+    return store;
+  }
+}
+
+bool Preferences::begin(const char *name, bool readOnly, const char *partitionLabel)
+{
+  (void)partitionLabel;
+  if (_started || !name) return false;
+  _namespace = name;
+  _readOnly = readOnly;
+  _started = true;
+  return true;
+}
+
+void Preferences::end()
+{
+  _started = false;
+}
+
+bool Preferences::clear()
+{
+  if (!_started || _readOnly) return false;
+  nvsStore()[_namespace].clear();
+  return true;
+}
+
+bool Preferences::remove(const char *key)
+{
+  if (!_started || _readOnly) return false;
+  return nvsStore()[_namespace].erase(key) > 0;
+}
+
+bool Preferences::isKey(const char *key)
+{
+  std::string raw;
+  return getRaw(key, raw);
+}
+
+String Preferences::getString(const char *key, const String defaultValue)
+{
+  std::string raw;
+  return getRaw(key, raw) ? String(raw) : defaultValue;
+}
+
+size_t Preferences::getBytes(const char *key, void *buffer, size_t maxLen)
+{
+  std::string raw;
+  if (!getRaw(key, raw) || raw.size() > maxLen) return 0;
+  memcpy(buffer, raw.data(), raw.size());
+  return raw.size();
+}
+
+size_t Preferences::putValue(const char *key, const void *value, size_t len)
+{
+  if (!_started || _readOnly || !key) return 0;
+  nvsStore()[_namespace][key].assign((const char *)value, len);
+  return len;
+}
+
+bool Preferences::getRaw(const char *key, std::string &raw)
+{
+  if (!_started || !key) return false;
+  auto &entries = nvsStore()[_namespace];
+  auto it = entries.find(key);
+  if (it == entries.end()) return false;
+  raw = it->second;
+  return true;
+}
@@ -0,0 +1,56 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for the ESP32 Preferences (NVS) library
+
+  Namespaces live in process memory for the lifetime of the runner, which matches
+  NVS surviving ESP.restart() on the device.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+#include <string>
+
+class Preferences {
+  public:
+    bool begin(const char *name, bool readOnly = false, const char *partitionLabel = nullptr);
+    void end();
+    bool clear();
+    bool remove(const char *key);
+    bool isKey(const char *key);
+
+    size_t putUChar(const char *key, uint8_t value) { return putValue(key, &value, sizeof(value)); }
+    size_t putUShort(const char *key, uint16_t value) { return putValue(key, &value, sizeof(value)); }
+    size_t putUInt(const char *key, uint32_t value) { return putValue(key, &value, sizeof(value)); }
+    size_t putFloat(const char *key, float value) { return putValue(key, &value, sizeof(value)); }
+    size_t putBool(const char *key, bool value) { return putValue(key, &value, sizeof(value)); }
+    size_t putString(const char *key, const String &value) { return putValue(key, value.c_str(), value.length()); }
+    size_t putBytes(const char *key, const void *value, size_t len) { return putValue(key, value, len); }
+
+    uint8_t getUChar(const char *key, uint8_t defaultValue = 0) { return getValue(key, defaultValue); }
+    uint16_t getUShort(const char *key, uint16_t defaultValue = 0) { return getValue(key, defaultValue); }
+    uint32_t getUInt(const char *key, uint32_t defaultValue = 0) { return getValue(key, defaultValue); }
+    float getFloat(const char *key, float defaultValue = NAN) { return getValue(key, defaultValue); }
+    bool getBool(const char *key, bool defaultValue = false) { return getValue(key, defaultValue); }
+    String getString(const char *key, const String defaultValue = String());
+    size_t getBytes(const char *key, void *buffer, size_t maxLen);
+
+  private:
+    size_t putValue(const char *key, const void *value, size_t len);
+    bool getRaw(const char *key, std::string &raw);
+
+    template <typename T>
+    T getValue(const char *key, T defaultValue)
+    {
+      std::string raw;
+      if (!getRaw(key, raw) || raw.size() != sizeof(T)) return defaultValue;
+      T value;
+      memcpy(&value, raw.data(), sizeof(T));
+      return value;
+    }
+
+    std::string _namespace;
+    bool _started = false;
+    bool _readOnly = false;
+};
@@ -0,0 +1,95 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for PubSubClient (https://github.com/knolleary/pubsubclient)
+*/
+
+#include "PubSubClient.h"
+
+#include <cstring>
+
+namespace {
+  constexpr size_t kConnAckBytes = 4;
+  constexpr size_t kDisconnectBytes = 2;
+
+  size_t fieldLength(const char *text)
+  {
+    return text ? 2 + strlen(text) : 0;
+  }
+}
+
+PubSubClient &PubSubClient::setServer(const char *domain, uint16_t port)
+{
+  _domain = domain;
+  _port = port;
+  return *this;
+}
+
+bool PubSubClient::setBufferSize(uint16_t size)
+{
+  if (!size) return false;
+  _bufferSize = size;
+  return true;
+}
+
+bool PubSubClient::connect(const char *id, const char *user, const char *pass)
+{
+  if (connected()) return true;
+  if (!_client || !_client->connect(_domain.c_str(), _port)) {
+    _state = MQTT_CONNECT_FAILED;
+    return false;
+  }
+  HostNetServer &server = *_client->hostServer();
+  server.stats.requests++;
+
+  // fixed header, protocol name and level, flags, keep alive, then the payload fields
+  const size_t connectBytes = 2 + 10 + fieldLength(id) + fieldLength(user) + fieldLength(pass);
+  if (!hostNetExchange(server, connectBytes, kConnAckBytes, server.link.serviceMS, _socketTimeout * 1000UL)) {
+    server.stats.failures++;
+    _state = MQTT_CONNECTION_TIMEOUT;
+    _client->stop();
+    return false;
+  }
+  const uint8_t code = server.mqttConnect(id ? id : "", user ? user : "", pass ? pass : "");
+  if (code) {
+    server.stats.failures++;
+    _state = code;
+    _client->stop();
+    return false;
+  }
+  _state = MQTT_CONNECTED;
+  return true;
+}
+
+void PubSubClient::disconnect()
+{
+  if (_client && _client->connected()) {
+    const uint8_t packet[kDisconnectBytes] = {0xE0, 0x00};
+    _client->write(packet, sizeof(packet));
+    _client->stop();
+  }
+  _state = MQTT_DISCONNECTED;
+}
+
+bool PubSubClient::publish(const char *topic, const char *payload, bool retained)
+{
+  if (!connected()) return false;
+  const size_t payloadLength = payload ? strlen(payload) : 0;
+  const size_t length = MQTT_MAX_HEADER_SIZE + 2 + strlen(topic) + payloadLength;
+  if (length > _bufferSize) return false;
+
+  HostNetServer &server = *_client->hostServer();
+  server.stats.requests++;
+  hostNetSend(server, length);
+  server.mqttPublish(topic, payload ? payload : "", retained);
+  return true;
+}
+
+bool PubSubClient::connected()
+{
+  if (!_client) return false;
+  if (!_client->connected()) {
+    if (_state == MQTT_CONNECTED) _state = MQTT_CONNECTION_LOST;
+    return false;
+  }
+  return _state == MQTT_CONNECTED;
+}
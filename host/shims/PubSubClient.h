@@ -0,0 +1,62 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for PubSubClient (https://github.com/knolleary/pubsubclient)
+
+  MQTT 3.1.1 client over a WiFiClient, talking to the stand-in broker listening at the
+  server address (see host_net.h). CONNECT waits for CONNACK up to the socket timeout;
+  QoS 0 PUBLISH only waits for the bytes to be sent, and is refused locally when the
+  packet doesn't fit the buffer, as in the library.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+#define MQTT_MAX_PACKET_SIZE 256
+#define MQTT_KEEPALIVE 15
+#define MQTT_SOCKET_TIMEOUT 15
+#define MQTT_MAX_HEADER_SIZE 5
+
+// state()
+#define MQTT_CONNECTION_TIMEOUT     -4
+#define MQTT_CONNECTION_LOST        -3
+#define MQTT_CONNECT_FAILED         -2
+#define MQTT_DISCONNECTED           -1
+#define MQTT_CONNECTED               0
+#define MQTT_CONNECT_BAD_PROTOCOL    1
+#define MQTT_CONNECT_BAD_CLIENT_ID   2
+#define MQTT_CONNECT_UNAVAILABLE     3
+#define MQTT_CONNECT_BAD_CREDENTIALS 4
+#define MQTT_CONNECT_UNAUTHORIZED    5
+
+class PubSubClient {
+  public:
+    PubSubClient() = default;
+    explicit PubSubClient(WiFiClient &client) : _client(&client) {}
+
+    PubSubClient &setServer(const char *domain, uint16_t port);
+    PubSubClient &setClient(WiFiClient &client) { _client = &client; return *this; }
+    PubSubClient &setKeepAlive(uint16_t keepAlive) { _keepAlive = keepAlive; return *this; }
+    PubSubClient &setSocketTimeout(uint16_t timeout) { _socketTimeout = timeout; return *this; }
+    bool setBufferSize(uint16_t size);
+    uint16_t getBufferSize() const { return _bufferSize; }
+
+    bool connect(const char *id) { return connect(id, nullptr, nullptr); }
+    bool connect(const char *id, const char *user, const char *pass);
+    void disconnect();
+    bool publish(const char *topic, const char *payload) { return publish(topic, payload, false); }
+    bool publish(const char *topic, const char *payload, bool retained);
+    bool loop() { return connected(); }
+    bool connected();
+    int state() const { return _state; }
+
+  private:
+    WiFiClient *_client = nullptr;
+    String _domain;
+    uint16_t _port = 1883;
+    uint16_t _keepAlive = MQTT_KEEPALIVE;
+    uint16_t _socketTimeout = MQTT_SOCKET_TIMEOUT;
+    uint16_t _bufferSize = MQTT_MAX_PACKET_SIZE;
+    int _state = MQTT_DISCONNECTED;
+};
@@ -0,0 +1,25 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for the ESP32 SPI library
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+#define FSPI 1
+#define HSPI 2
+#define VSPI 3
+
+class SPIClass {
+  public:
+    explicit SPIClass(uint8_t bus = HSPI) : _bus(bus) {}
+    void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1)
+    {
+      (void)sck; (void)miso; (void)mosi; (void)ss;
+    }
+    void end() {}
+
+  private:
+    uint8_t _bus;
+};
@@ -0,0 +1,97 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for Sensirion Core (https://github.com/Sensirion/arduino-core)
+*/
+
+#include "SensirionCore.h"
+
+#include <cstdio>
+
+uint8_t sensirionCRC8(const uint8_t *data, size_t length)
+{
+  uint8_t crc = 0xFF;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+SensirionI2CTxFrame SensirionI2CTxFrame::createWithUInt16Command(uint16_t command, uint8_t buffer[], size_t bufferSize)
+{
+  SensirionI2CTxFrame frame(buffer, bufferSize);
+  if (bufferSize >= 2) {
+    buffer[0] = (uint8_t)(command >> 8);
+    buffer[1] = (uint8_t)(command & 0xFF);
+    frame._index = 2;
+  }
+  return frame;
+}
+
+uint16_t SensirionI2CTxFrame::addUInt16(uint16_t data)
+{
+  if (_index + 3 > _bufferSize) return WriteError | NotEnoughDataError;
+  _buffer[_index++] = (uint8_t)(data >> 8);
+  _buffer[_index++] = (uint8_t)(data & 0xFF);
+  _buffer[_index] = sensirionCRC8(&_buffer[_index - 2], 2);
+  _index++;
+  return NoError;
+}
+
+uint16_t SensirionI2CCommunication::sendFrame(uint8_t address, SensirionI2CTxFrame &frame, TwoWire &i2cBus)
+{
+  i2cBus.beginTransmission(address);
+  i2cBus.write(frame._buffer, frame._index);
+  switch (i2cBus.endTransmission()) {
+    case 0:  return NoError;
+    case 2:  return WriteError | I2cAddressNack;
+    case 3:  return WriteError | I2cDataNack;
+    default: return WriteError | I2cOtherError;
+  }
+}
+
+uint16_t sensirionI2CWriteCommand(TwoWire &wire, uint8_t address, uint16_t command,
+                                  const uint16_t *args, size_t argCount)
+{
+  uint8_t buffer[2 + 3 * 4];
+  if (argCount > 4) return WriteError | NotEnoughDataError;
+  SensirionI2CTxFrame frame = SensirionI2CTxFrame::createWithUInt16Command(command, buffer, sizeof(buffer));
+  for (size_t i = 0; i < argCount; i++) frame.addUInt16(args[i]);
+  return SensirionI2CCommunication::sendFrame(address, frame, wire);
+}
+
+uint16_t sensirionI2CReadWords(TwoWire &wire, uint8_t address, uint16_t *words, size_t wordCount)
+{
+  size_t expected = wordCount * 3;
+  size_t received = wire.requestFrom(address, expected);
+  if (received < expected) {
+    while (wire.available()) wire.read();
+    return ReadError | NotEnoughDataError;
+  }
+  uint16_t error = NoError;
+  for (size_t i = 0; i < wordCount; i++) {
+    uint8_t frame[3];
+    for (uint8_t b = 0; b < 3; b++) frame[b] = (uint8_t)wire.read();
+    if (sensirionCRC8(frame, 2) != frame[2]) error = ReadError | CRCError;
+    words[i] = (uint16_t)((frame[0] << 8) | frame[1]);
+  }
+  return error;
+}
+
+void errorToString(uint16_t error, char errorMessage[], size_t errorMessageSize)
+{
+  const char *text = "Error processing error";
+  if (error == NoError) text = "No error";
+  else {
+    switch (error & 0x00FF) {
+      case CRCError:           text = "Wrong CRC found"; break;
+      case NotEnoughDataError: text = "Not enough data received"; break;
+      case I2cAddressNack:     text = "Sent I2C address not acknowledged"; break;
+      case I2cDataNack:        text = "Sent I2C data not acknowledged"; break;
+      case I2cOtherError:      text = "I2C error"; break;
+    }
+  }
+  snprintf(errorMessage, errorMessageSize, "%s", text);
+}
@@ -0,0 +1,60 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for Sensirion Core (https://github.com/Sensirion/arduino-core)
+
+  Command level I2C framing shared by the SEN5x and SCD4x drivers: 16 bit commands,
+  16 bit data words each followed by a CRC-8 (polynomial 0x31, init 0xFF), and the
+  Sensirion error code layout (high byte: failing phase, low byte: cause). The error
+  enums, SensirionI2CTxFrame and SensirionI2CCommunication carry the library's names, so
+  sketch code that builds here builds against the real library too.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+
+enum HighLevelError : uint16_t {
+  NoError = 0x0000,
+  WriteError = 0x0100,
+  ReadError = 0x0200,
+};
+
+enum LowLevelError : uint16_t {
+  CRCError = 0x01,
+  NotEnoughDataError = 0x03,
+  I2cAddressNack = 0x05,
+  I2cDataNack = 0x06,
+  I2cOtherError = 0x07,
+};
+
+uint8_t sensirionCRC8(const uint8_t *data, size_t length);
+
+// a command and its CRC protected argument words, in a caller's buffer
+class SensirionI2CTxFrame {
+  public:
+    SensirionI2CTxFrame(uint8_t buffer[], size_t bufferSize) : _buffer(buffer), _bufferSize(bufferSize) {}
+    static SensirionI2CTxFrame createWithUInt16Command(uint16_t command, uint8_t buffer[], size_t bufferSize);
+    uint16_t addUInt16(uint16_t data);
+
+  private:
+    friend class SensirionI2CCommunication;
+    uint8_t *_buffer;
+    size_t _bufferSize;
+    size_t _index = 0;
+};
+
+class SensirionI2CCommunication {
+  public:
+    // returns 0 or a WriteError code
+    static uint16_t sendFrame(uint8_t address, SensirionI2CTxFrame &frame, TwoWire &i2cBus);
+};
+
+// Sends a command with optional argument words; returns 0 or a Sensirion error code
+uint16_t sensirionI2CWriteCommand(TwoWire &wire, uint8_t address, uint16_t command,
+                                  const uint16_t *args = nullptr, size_t argCount = 0);
+
+// Reads CRC protected data words; returns 0 or a Sensirion error code
+uint16_t sensirionI2CReadWords(TwoWire &wire, uint8_t address, uint16_t *words, size_t wordCount);
+
+void errorToString(uint16_t error, char errorMessage[], size_t errorMessageSize);
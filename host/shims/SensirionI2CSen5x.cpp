@@ -0,0 +1,78 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for SensirionI2CSen5x (https://github.com/Sensirion/arduino-i2c-sen5x)
+*/
+
+#include "SensirionI2CSen5x.h"
+
+namespace {
+  constexpr uint16_t kCmdDeviceReset = 0xD304;
+  constexpr uint16_t kCmdStartMeasurement = 0x0021;
+  constexpr uint16_t kCmdStopMeasurement = 0x0104;
+  constexpr uint16_t kCmdReadDataReady = 0x0202;
+  constexpr uint16_t kCmdReadMeasuredValues = 0x03C4;
+
+  float scaledUnsigned(uint16_t raw, float scale)
+  {
+    return (raw == 0xFFFF) ? NAN : raw / scale;
+  }
+
+  float scaledSigned(uint16_t raw, float scale)
+  {
+    return (raw == 0x7FFF) ? NAN : (int16_t)raw / scale;
+  }
+}
+
+uint16_t SensirionI2CSen5x::command(uint16_t command, uint32_t executionMS)
+{
+  if (!_i2cBus) return WriteError | I2cOtherError;
+  uint16_t error = sensirionI2CWriteCommand(*_i2cBus, SEN5X_I2C_ADDRESS, command);
+  delay(executionMS);
+  return error;
+}
+
+uint16_t SensirionI2CSen5x::deviceReset()
+{
+  return command(kCmdDeviceReset, 200);
+}
+
+uint16_t SensirionI2CSen5x::startMeasurement()
+{
+  return command(kCmdStartMeasurement, 50);
+}
+
+uint16_t SensirionI2CSen5x::stopMeasurement()
+{
+  return command(kCmdStopMeasurement, 200);
+}
+
+uint16_t SensirionI2CSen5x::readDataReady(bool &dataReady)
+{
+  uint16_t error = command(kCmdReadDataReady, 20);
+  if (error) return error;
+  uint16_t word = 0;
+  error = sensirionI2CReadWords(*_i2cBus, SEN5X_I2C_ADDRESS, &word, 1);
+  dataReady = (word & 0x00FF) != 0;
+  return error;
+}
+
+uint16_t SensirionI2CSen5x::readMeasuredValues(float &massConcentrationPm1p0, float &massConcentrationPm2p5,
+                                               float &massConcentrationPm4p0, float &massConcentrationPm10p0,
+                                               float &ambientHumidity, float &ambientTemperature,
+                                               float &vocIndex, float &noxIndex)
+{
+  uint16_t error = command(kCmdReadMeasuredValues, 20);
+  if (error) return error;
+  uint16_t words[8] = {};
+  error = sensirionI2CReadWords(*_i2cBus, SEN5X_I2C_ADDRESS, words, 8);
+  if (error) return error;
+  massConcentrationPm1p0 = scaledUnsigned(words[0], 10.0f);
+  massConcentrationPm2p5 = scaledUnsigned(words[1], 10.0f);
+  massConcentrationPm4p0 = scaledUnsigned(words[2], 10.0f);
+  massConcentrationPm10p0 = scaledUnsigned(words[3], 10.0f);
+  ambientHumidity = scaledSigned(words[4], 100.0f);
+  ambientTemperature = scaledSigned(words[5], 200.0f);
+  vocIndex = scaledSigned(words[6], 10.0f);
+  noxIndex = scaledSigned(words[7], 10.0f);
+  return NoError;
+}
@@ -0,0 +1,34 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for SensirionI2CSen5x (https://github.com/Sensirion/arduino-i2c-sen5x)
+
+  Speaks the SEN5x command set over Wire with the datasheet execution delays, so
+  the sketch talks to whatever is attached to the host I2C bus.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <SensirionCore.h>
+
+constexpr uint8_t SEN5X_I2C_ADDRESS = 0x69;
+
+class SensirionI2CSen5x {
+  public:
+    void begin(TwoWire &i2cBus) { _i2cBus = &i2cBus; }
+
+    uint16_t deviceReset();
+    uint16_t startMeasurement();
+    uint16_t stopMeasurement();
+    uint16_t readDataReady(bool &dataReady);
+    uint16_t readMeasuredValues(float &massConcentrationPm1p0, float &massConcentrationPm2p5,
+                                float &massConcentrationPm4p0, float &massConcentrationPm10p0,
+                                float &ambientHumidity, float &ambientTemperature, float &vocIndex,
+                                float &noxIndex);
+
+  private:
+    uint16_t command(uint16_t command, uint32_t executionMS);
+
+    TwoWire *_i2cBus = nullptr;
+};
@@ -0,0 +1,76 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for SensirionI2cScd4x (https://github.com/Sensirion/arduino-i2c-scd4x)
+*/
+
+#include "SensirionI2cScd4x.h"
+
+uint16_t SensirionI2cScd4x::command(uint16_t command, uint32_t executionMS, const uint16_t *args, size_t argCount)
+{
+  if (!_i2cBus) return WriteError | I2cOtherError;
+  uint16_t error = sensirionI2CWriteCommand(*_i2cBus, _i2cAddress, command, args, argCount);
+  delay(executionMS);
+  return error;
+}
+
+uint16_t SensirionI2cScd4x::startPeriodicMeasurement()
+{
+  return command(START_PERIODIC_MEASUREMENT_CMD_ID, 0);
+}
+
+uint16_t SensirionI2cScd4x::startLowPowerPeriodicMeasurement()
+{
+  return command(START_LOW_POWER_PERIODIC_MEASUREMENT_CMD_ID, 0);
+}
+
+uint16_t SensirionI2cScd4x::stopPeriodicMeasurement()
+{
+  return command(STOP_PERIODIC_MEASUREMENT_CMD_ID, 500);
+}
+
+uint16_t SensirionI2cScd4x::setSensorAltitude(uint16_t sensorAltitude)
+{
+  return command(SET_SENSOR_ALTITUDE_CMD_ID, 1, &sensorAltitude, 1);
+}
+
+uint16_t SensirionI2cScd4x::getDataReadyStatus(bool &dataReadyStatus)
+{
+  uint16_t error = command(GET_DATA_READY_STATUS_RAW_CMD_ID, 1);
+  if (error) return error;
+  uint16_t word = 0;
+  error = sensirionI2CReadWords(*_i2cBus, _i2cAddress, &word, 1);
+  dataReadyStatus = (word & 0x07FF) != 0;
+  return error;
+}
+
+uint16_t SensirionI2cScd4x::readMeasurement(uint16_t &co2Concentration, float &temperature, float &relativeHumidity)
+{
+  uint16_t error = command(READ_MEASUREMENT_RAW_CMD_ID, 1);
+  if (error) return error;
+  uint16_t words[3] = {};
+  error = sensirionI2CReadWords(*_i2cBus, _i2cAddress, words, 3);
+  if (error) return error;
+  co2Concentration = words[0];
+  temperature = -45.0f + 175.0f * words[1] / 65535.0f;
+  relativeHumidity = 100.0f * words[2] / 65535.0f;
+  return NoError;
+}
+
+uint16_t SensirionI2cScd4x::measureSingleShot()
+{
+  return command(MEASURE_SINGLE_SHOT_CMD_ID, 5000);
+}
+
+uint16_t SensirionI2cScd4x::wakeUp()
+{
+  if (!_i2cBus) return WriteError | I2cOtherError;
+  // the sensor does not acknowledge wake_up
+  sensirionI2CWriteCommand(*_i2cBus, _i2cAddress, WAKE_UP_CMD_ID);
+  delay(30);
+  return NoError;
+}
+
+uint16_t SensirionI2cScd4x::reinit()
+{
+  return command(REINIT_CMD_ID, 30);
+}
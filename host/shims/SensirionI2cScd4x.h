@@ -0,0 +1,50 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for SensirionI2cScd4x (https://github.com/Sensirion/arduino-i2c-scd4x)
+
+  Speaks the SCD4x command set over Wire with the datasheet execution delays, so
+  the sketch talks to whatever is attached to the host I2C bus.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <SensirionCore.h>
+
+#define SCD40_I2C_ADDR_62 0x62
+#define SCD41_I2C_ADDR_62 0x62
+
+// command ids, as the library's header names them
+typedef enum {
+  START_PERIODIC_MEASUREMENT_CMD_ID = 0x21B1,
+  START_LOW_POWER_PERIODIC_MEASUREMENT_CMD_ID = 0x21AC,
+  STOP_PERIODIC_MEASUREMENT_CMD_ID = 0x3F86,
+  SET_SENSOR_ALTITUDE_CMD_ID = 0x2427,
+  GET_DATA_READY_STATUS_RAW_CMD_ID = 0xE4B8,
+  READ_MEASUREMENT_RAW_CMD_ID = 0xEC05,
+  MEASURE_SINGLE_SHOT_CMD_ID = 0x219D,
+  WAKE_UP_CMD_ID = 0x36F6,
+  REINIT_CMD_ID = 0x3646,
+} CmdId;
+
+class SensirionI2cScd4x {
+  public:
+    void begin(TwoWire &i2cBus, uint8_t i2cAddress) { _i2cBus = &i2cBus; _i2cAddress = i2cAddress; }
+
+    uint16_t startPeriodicMeasurement();
+    uint16_t startLowPowerPeriodicMeasurement();
+    uint16_t stopPeriodicMeasurement();
+    uint16_t setSensorAltitude(uint16_t sensorAltitude);
+    uint16_t getDataReadyStatus(bool &dataReadyStatus);
+    uint16_t readMeasurement(uint16_t &co2Concentration, float &temperature, float &relativeHumidity);
+    uint16_t measureSingleShot();
+    uint16_t wakeUp();
+    uint16_t reinit();
+
+  private:
+    uint16_t command(uint16_t command, uint32_t executionMS, const uint16_t *args = nullptr, size_t argCount = 0);
+
+    TwoWire *_i2cBus = nullptr;
+    uint8_t _i2cAddress = SCD41_I2C_ADDR_62;
+};
@@ -0,0 +1,1078 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for TFT_eSPI (https://github.com/Bodmer/TFT_eSPI)
+*/
+
+#include "TFT_eSPI.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+  // VLW fonts store every field as a big endian 32 bit value
+  uint32_t readInt32(const uint8_t *p)
+  {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+  }
+
+  constexpr uint32_t kVLWHeaderBytes = 24;
+  constexpr uint32_t kVLWMetricsBytes = 28;
+  constexpr uint8_t kGLCDWidth = 6;   // built in font 1 cell, used when no smooth font is loaded
+  constexpr uint8_t kGLCDHeight = 8;
+
+  // ILI9341 traffic, see TFTStats
+  constexpr uint8_t kWindowBytes = 11;
+  constexpr uint8_t kPixelBytes = 2;
+  constexpr uint8_t kReadBytes = 4;
+
+  constexpr float kDegToRad = 0.0174532925f;
+  constexpr float kLoAlphaThreshold = 1.0f / 32.0f;
+  constexpr float kHiAlphaThreshold = 1.0f - kLoAlphaThreshold;
+  constexpr float kPixelAlphaGain = 255.0f;
+
+  // fractional part of sqrt(num) as 0-255, the anti-aliasing coverage TFT_eSPI uses
+  uint8_t sqrtFraction(uint32_t num)
+  {
+    if (num > 0x40000000) return 0;
+    uint32_t bsh = 0x00004000;
+    uint32_t fpr = 0;
+    uint32_t osh = 0;
+    while (num > bsh) {
+      bsh <<= 2;
+      osh++;
+    }
+    do {
+      uint32_t bod = bsh + fpr;
+      if (num >= bod) {
+        num -= bod;
+        fpr = bsh + bod;
+      }
+      num <<= 1;
+    } while (bsh >>= 1);
+    return (uint8_t)(fpr >> osh);
+  }
+
+  // distance from a pixel to a wedge line, less the radius taper at that point
+  float wedgeLineDistance(float xpax, float ypay, float bax, float bay, float dr)
+  {
+    float h = fmaxf(fminf((xpax * bax + ypay * bay) / (bax * bax + bay * bay), 1.0f), 0.0f);
+    float dx = xpax - bax * h, dy = ypay - bay * h;
+    return sqrtf(dx * dx + dy * dy) + h * dr;
+  }
+}
+
+TFT_eSPI::TFT_eSPI(int16_t w, int16_t h)
+  : _width(w), _height(h), _initWidth(w), _initHeight(h)
+{
+}
+
+void TFT_eSPI::setRotation(uint8_t rotation)
+{
+  _rotation = rotation % 4;
+  if (_rotation & 1) {
+    _width = _initHeight;
+    _height = _initWidth;
+  }
+  else {
+    _width = _initWidth;
+    _height = _initHeight;
+  }
+  if (_framebufferEnabled) _framebuffer.assign((size_t)_width * _height, TFT_BLACK);
+}
+
+void TFT_eSPI::hostFramebufferEnable(bool enable)
+{
+  _framebufferEnabled = enable;
+  if (enable) _framebuffer.assign((size_t)_width * _height, TFT_BLACK);
+  else _framebuffer.clear();
+}
+
+// Panel access. Callers clip, so windows are always on the panel.
+
+void TFT_eSPI::setWindow(int32_t x0, int32_t y0, int32_t x1, int32_t y1)
+{
+  _winX0 = _winX = x0;
+  _winY0 = _winY = y0;
+  _winX1 = x1;
+  _winY1 = y1;
+  _stats.windows++;
+  _stats.bytesWritten += kWindowBytes;
+}
+
+void TFT_eSPI::pushColor(uint16_t color)
+{
+  if (_framebufferEnabled) _framebuffer[(size_t)_winY * _width + _winX] = color;
+  _stats.pixelsWritten++;
+  _stats.bytesWritten += kPixelBytes;
+  if (++_winX > _winX1) {
+    _winX = _winX0;
+    if (++_winY > _winY1) _winY = _winY0;
+  }
+}
+
+void TFT_eSPI::pushBlock(uint16_t color, uint32_t len)
+{
+  _stats.pixelsWritten += len;
+  _stats.bytesWritten += (uint64_t)len * kPixelBytes;
+  const int32_t winW = _winX1 - _winX0 + 1;
+  const int32_t winH = _winY1 - _winY0 + 1;
+  if (_framebufferEnabled) {
+    // row by row from the current write position, wrapping within the window
+    int32_t x = _winX, y = _winY;
+    for (uint32_t left = len; left; ) {
+      const uint32_t run = std::min<uint32_t>(left, (uint32_t)(_winX1 - x + 1));
+      uint16_t *row = _framebuffer.data() + (size_t)y * _width + x;
+      std::fill(row, row + run, color);
+      left -= run;
+      x = _winX0;
+      if (++y > _winY1) y = _winY0;
+    }
+  }
+  const uint64_t offset = (uint64_t)(_winY - _winY0) * winW + (_winX - _winX0) + len;
+  _winX = _winX0 + (int32_t)(offset % winW);
+  _winY = _winY0 + (int32_t)(offset / winW % winH);
+}
+
+uint16_t TFT_eSPI::readPixel(int32_t x, int32_t y)
+{
+  if (x < 0 || y < 0 || x >= _width || y >= _height) return 0;
+  _stats.windows++;
+  _stats.pixelsRead++;
+  _stats.bytesWritten += kWindowBytes + 1;  // window then RAMRD
+  _stats.bytesRead += kReadBytes;
+  return _framebufferEnabled ? _framebuffer[(size_t)y * _width + x] : TFT_BLACK;
+}
+
+uint16_t TFT_eSPI::alphaBlend(uint8_t alpha, uint16_t fgc, uint16_t bgc)
+{
+  // Split out and blend 5 bit red and blue channels
+  uint32_t rxb = bgc & 0xF81F;
+  rxb += ((fgc & 0xF81F) - rxb) * (alpha >> 2) >> 6;
+  // Split out and blend 6 bit green channel
+  uint32_t xgx = bgc & 0x07E0;
+  xgx += ((fgc & 0x07E0) - xgx) * alpha >> 8;
+  return (rxb & 0xF81F) | (xgx & 0x07E0);
+}
+
+bool TFT_eSPI::clipWindow(int32_t *x0, int32_t *y0, int32_t *x1, int32_t *y1) const
+{
+  if (*x0 < 0) *x0 = 0;
+  if (*y0 < 0) *y0 = 0;
+  if (*x1 >= _width) *x1 = _width - 1;
+  if (*y1 >= _height) *y1 = _height - 1;
+  return (*x0 <= *x1) && (*y0 <= *y1);
+}
+
+// Graphics primitives
+
+void TFT_eSPI::drawPixel(int32_t x, int32_t y, uint32_t color)
+{
+  if (!_rasterize) return;
+  if (x < 0 || y < 0 || x >= _width || y >= _height) return;
+  setWindow(x, y, x, y);
+  pushColor((uint16_t)color);
+}
+
+uint16_t TFT_eSPI::drawPixel(int32_t x, int32_t y, uint32_t color, uint8_t alpha, uint32_t bgColor)
+{
+  if (!_rasterize) return 0;
+  if (bgColor == kTFTNoBackground) bgColor = readPixel(x, y);
+  uint16_t blended = alphaBlend(alpha, (uint16_t)color, (uint16_t)bgColor);
+  drawPixel(x, y, blended);
+  return blended;
+}
+
+void TFT_eSPI::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color)
+{
+  if (!_rasterize) return;
+  if (w <= 0 || h <= 0) return;
+  int32_t x1 = x + w - 1;
+  int32_t y1 = y + h - 1;
+  if (!clipWindow(&x, &y, &x1, &y1)) return;
+  setWindow(x, y, x1, y1);
+  pushBlock((uint16_t)color, (uint32_t)(x1 - x + 1) * (uint32_t)(y1 - y + 1));
+}
+
+void TFT_eSPI::fillScreen(uint32_t color)
+{
+  if (!_rasterize) return;
+  _stats.fillScreens++;
+  fillRect(0, 0, _width, _height, color);
+}
+
+void TFT_eSPI::drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color)
+{
+  fillRect(x, y, w, 1, color);
+}
+
+void TFT_eSPI::drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color)
+{
+  fillRect(x, y, 1, h, color);
+}
+
+// Bresenham, emitted as horizontal or vertical runs like TFT_eSPI
+void TFT_eSPI::drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color)
+{
+  if (!_rasterize) return;
+  bool steep = abs(y1 - y0) > abs(x1 - x0);
+  if (steep) {
+    std::swap(x0, y0);
+    std::swap(x1, y1);
+  }
+  if (x0 > x1) {
+    std::swap(x0, x1);
+    std::swap(y0, y1);
+  }
+
+  int32_t dx = x1 - x0, dy = abs(y1 - y0);
+  int32_t err = dx >> 1, ystep = (y0 < y1) ? 1 : -1, xs = x0, dlen = 0;
+
+  for (; x0 <= x1; x0++) {
+    dlen++;
+    err -= dy;
+    if (err < 0) {
+      if (steep) {
+        if (dlen == 1) drawPixel(y0, xs, color);
+        else drawFastVLine(y0, xs, dlen, color);
+      }
+      else {
+        if (dlen == 1) drawPixel(xs, y0, color);
+        else drawFastHLine(xs, y0, dlen, color);
+      }
+      dlen = 0;
+      y0 += ystep;
+      xs = x0 + 1;
+      err += dx;
+    }
+  }
+  if (dlen) {
+    if (steep) drawFastVLine(y0, xs, dlen, color);
+    else drawFastHLine(xs, y0, dlen, color);
+  }
+}
+
+void TFT_eSPI::drawCircleHelper(int32_t x0, int32_t y0, int32_t r, uint8_t cornerName, uint32_t color)
+{
+  if (r <= 0) return;
+  int32_t f = 1 - r;
+  int32_t ddFx = 1;
+  int32_t ddFy = -2 * r;
+  int32_t xe = 0;
+  int32_t xs = 0;
+  int32_t len = 0;
+
+  while (xe < r--) {
+    while (f < 0) {
+      ++xe;
+      f += (ddFx += 2);
+    }
+    f += (ddFy += 2);
+
+    if (xe - xs == 1) {
+      if (cornerName & 0x1) { drawPixel(x0 - xe, y0 - r, color); drawPixel(x0 - r, y0 - xe, color); }
+      if (cornerName & 0x2) { drawPixel(x0 + xe, y0 - r, color); drawPixel(x0 + r, y0 - xe, color); }
+      if (cornerName & 0x4) { drawPixel(x0 + xe, y0 + r, color); drawPixel(x0 + r, y0 + xe, color); }
+      if (cornerName & 0x8) { drawPixel(x0 - xe, y0 + r, color); drawPixel(x0 - r, y0 + xe, color); }
+    }
+    else {
+      len = xe - xs++;
+      if (cornerName & 0x1) { drawFastHLine(x0 - xe, y0 - r, len, color); drawFastVLine(x0 - r, y0 - xe, len, color); }
+      if (cornerName & 0x2) { drawFastHLine(x0 + xs, y0 - r, len, color); drawFastVLine(x0 + r, y0 - xe, len, color); }
+      if (cornerName & 0x4) { drawFastHLine(x0 + xs, y0 + r, len, color); drawFastVLine(x0 + r, y0 + xs, len, color); }
+      if (cornerName & 0x8) { drawFastHLine(x0 - xe, y0 + r, len, color); drawFastVLine(x0 - r, y0 + xs, len, color); }
+    }
+    xs = xe;
+  }
+}
+
+void TFT_eSPI::fillCircleHelper(int32_t x0, int32_t y0, int32_t r, uint8_t cornerName, int32_t delta, uint32_t color)
+{
+  int32_t f = 1 - r;
+  int32_t ddFx = 1;
+  int32_t ddFy = -r - r;
+  int32_t y = 0;
+
+  delta++;
+  while (y < r) {
+    if (f >= 0) {
+      if (cornerName & 0x1) drawFastHLine(x0 - y, y0 + r, y + y + delta, color);
+      if (cornerName & 0x2) drawFastHLine(x0 - y, y0 - r, y + y + delta, color);
+      r--;
+      ddFy += 2;
+      f += ddFy;
+    }
+    y++;
+    ddFx += 2;
+    f += ddFx;
+    if (cornerName & 0x1) drawFastHLine(x0 - r, y0 + y, r + r + delta, color);
+    if (cornerName & 0x2) drawFastHLine(x0 - r, y0 - y, r + r + delta, color);
+  }
+}
+
+void TFT_eSPI::drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color)
+{
+  drawFastHLine(x + r, y, w - r - r, color);
+  drawFastHLine(x + r, y + h - 1, w - r - r, color);
+  drawFastVLine(x, y + r, h - r - r, color);
+  drawFastVLine(x + w - 1, y + r, h - r - r, color);
+  drawCircleHelper(x + r, y + r, r, 1, color);
+  drawCircleHelper(x + w - r - 1, y + r, r, 2, color);
+  drawCircleHelper(x + w - r - 1, y + h - r - 1, r, 4, color);
+  drawCircleHelper(x + r, y + h - r - 1, r, 8, color);
+}
+
+void TFT_eSPI::fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color)
+{
+  fillRect(x, y + r, w, h - r - r, color);
+  fillCircleHelper(x + r, y + h - r - 1, r, 1, w - r - r - 1, color);
+  fillCircleHelper(x + r, y + r, r, 2, w - r - r - 1, color);
+}
+
+void TFT_eSPI::fillTriangle(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint32_t color)
+{
+  if (!_rasterize) return;
+  int32_t a, b, y, last;
+
+  // Sort coordinates by Y order (y2 >= y1 >= y0)
+  if (y0 > y1) { std::swap(y0, y1); std::swap(x0, x1); }
+  if (y1 > y2) { std::swap(y2, y1); std::swap(x2, x1); }
+  if (y0 > y1) { std::swap(y0, y1); std::swap(x0, x1); }
+
+  if (y0 == y2) {
+    a = b = x0;
+    if (x1 < a) a = x1;
+    else if (x1 > b) b = x1;
+    if (x2 < a) a = x2;
+    else if (x2 > b) b = x2;
+    drawFastHLine(a, y0, b - a + 1, color);
+    return;
+  }
+
+  int32_t dx01 = x1 - x0, dy01 = y1 - y0, dx02 = x2 - x0, dy02 = y2 - y0;
+  int32_t dx12 = x2 - x1, dy12 = y2 - y1, sa = 0, sb = 0;
+
+  last = (y1 == y2) ? y1 : y1 - 1;
+  for (y = y0; y <= last; y++) {
+    a = x0 + sa / dy01;
+    b = x0 + sb / dy02;
+    sa += dx01;
+    sb += dx02;
+    if (a > b) std::swap(a, b);
+    drawFastHLine(a, y, b - a + 1, color);
+  }
+
+  sa = dx12 * (y - y1);
+  sb = dx02 * (y - y0);
+  for (; y <= y2; y++) {
+    a = x1 + sa / dy12;
+    b = x0 + sb / dy02;
+    sa += dx12;
+    sb += dx02;
+    if (a > b) std::swap(a, b);
+    drawFastHLine(a, y, b - a + 1, color);
+  }
+}
+
+// Anti-aliased primitives
+
+void TFT_eSPI::drawSmoothArc(int32_t x, int32_t y, int32_t r, int32_t ir, uint32_t startAngle, uint32_t endAngle,
+                             uint32_t fgColor, uint32_t bgColor, bool roundEnds)
+{
+  if (!_rasterize) return;
+  _stats.smoothArcs++;
+  if (endAngle != startAngle && (startAngle != 0 || endAngle != 360)) {
+    float sx = -sinf(startAngle * kDegToRad);
+    float sy = +cosf(startAngle * kDegToRad);
+    float ex = -sinf(endAngle * kDegToRad);
+    float ey = +cosf(endAngle * kDegToRad);
+
+    if (roundEnds) {
+      drawSpot(sx * (r + ir) / 2.0f + x, sy * (r + ir) / 2.0f + y, (r - ir) / 2.0f, fgColor, bgColor);
+      drawSpot(ex * (r + ir) / 2.0f + x, ey * (r + ir) / 2.0f + y, (r - ir) / 2.0f, fgColor, bgColor);
+    }
+    else {
+      drawWedgeLine(sx * ir + x, sy * ir + y, sx * r + x, sy * r + y, 0.3f, 0.3f, fgColor, bgColor);
+      drawWedgeLine(ex * ir + x, ey * ir + y, ex * r + x, ey * r + y, 0.3f, 0.3f, fgColor, bgColor);
+    }
+    drawArc(x, y, r, ir, startAngle, endAngle, fgColor, bgColor);
+  }
+  else {
+    drawArc(x, y, r, ir, 0, 360, fgColor, bgColor);
+  }
+}
+
+// Angles are clockwise from 6 o'clock. Each row of one quadrant is scanned once; the
+// arc's start and end are tested as U16.16 slopes so the four quadrants share the scan.
+void TFT_eSPI::drawArc(int32_t x, int32_t y, int32_t r, int32_t ir, uint32_t startAngle, uint32_t endAngle,
+                       uint32_t fgColor, uint32_t bgColor, bool smoothArc)
+{
+  if (!_rasterize) return;
+  if (endAngle > 360) endAngle = 360;
+  if (startAngle > 360) startAngle = 360;
+  if (startAngle == endAngle) return;
+  if (r < ir) std::swap(r, ir);
+  if (r <= 0 || ir < 0) return;
+
+  if (endAngle < startAngle) {
+    // arc sweeps through 6 o'clock so draw in two parts
+    if (startAngle < 360) drawArc(x, y, r, ir, startAngle, 360, fgColor, bgColor, smoothArc);
+    if (endAngle == 0) return;
+    startAngle = 0;
+  }
+  _stats.arcs++;
+
+  int32_t xs = 0;
+  uint8_t alpha = 0;
+
+  uint32_t r2 = r * r;        // outer arc radius^2
+  if (smoothArc) r++;         // outer AA zone radius
+  uint32_t r1 = r * r;        // outer AA radius^2
+  int16_t w = r - ir;         // width of arc (r - ir + 1)
+  uint32_t r3 = ir * ir;      // inner arc radius^2
+  if (smoothArc) ir--;        // inner AA zone radius
+  uint32_t r4 = ir * ir;      // inner AA radius^2
+
+  //     1 | 2
+  //    ---+---    arc quadrant index
+  //     0 | 3
+  uint32_t startSlope[4] = {0, 0, 0xFFFFFFFF, 0};
+  uint32_t endSlope[4] = {0, 0xFFFFFFFF, 0, 0};
+  constexpr float minDivisor = 1.0f / 0x8000;
+
+  float fabscos = fabsf(cosf(startAngle * kDegToRad));
+  float fabssin = fabsf(sinf(startAngle * kDegToRad));
+  uint32_t slope = (uint32_t)((fabscos / (fabssin + minDivisor)) * (float)(1UL << 16));
+
+  if (startAngle <= 90) {
+    startSlope[0] = slope;
+  }
+  else if (startAngle <= 180) {
+    startSlope[1] = slope;
+  }
+  else if (startAngle <= 270) {
+    startSlope[1] = 0xFFFFFFFF;
+    startSlope[2] = slope;
+  }
+  else {
+    startSlope[1] = 0xFFFFFFFF;
+    startSlope[2] = 0;
+    startSlope[3] = slope;
+  }
+
+  fabscos = fabsf(cosf(endAngle * kDegToRad));
+  fabssin = fabsf(sinf(endAngle * kDegToRad));
+  slope = (uint32_t)((fabscos / (fabssin + minDivisor)) * (float)(1UL << 16));
+
+  if (endAngle <= 90) {
+    endSlope[0] = slope;
+    endSlope[1] = 0;
+    startSlope[2] = 0;
+  }
+  else if (endAngle <= 180) {
+    endSlope[1] = slope;
+    startSlope[2] = 0;
+  }
+  else if (endAngle <= 270) {
+    endSlope[2] = slope;
+  }
+  else {
+    endSlope[3] = slope;
+  }
+
+  for (int32_t cy = r - 1; cy > 0; cy--) {
+    uint32_t len[4] = {0, 0, 0, 0};
+    int32_t xst[4] = {-1, -1, -1, -1};
+    uint32_t dy2 = (r - cy) * (r - cy);
+
+    // find and track arc zone start point
+    while ((uint32_t)((r - xs) * (r - xs)) + dy2 >= r1) xs++;
+
+    for (int32_t cx = xs; cx < r; cx++) {
+      uint32_t hyp = (r - cx) * (r - cx) + dy2;
+
+      if (hyp > r2) {
+        alpha = ~sqrtFraction(hyp);  // outer AA zone
+      }
+      else if (hyp >= r3) {
+        // within the arc fill zone, extend each quadrant's run
+        slope = ((r - cy) << 16) / (r - cx);
+        if (slope <= startSlope[0] && slope >= endSlope[0]) { xst[0] = cx; len[0]++; }
+        if (slope >= startSlope[1] && slope <= endSlope[1]) { xst[1] = cx; len[1]++; }
+        if (slope <= startSlope[2] && slope >= endSlope[2]) { xst[2] = cx; len[2]++; }
+        if (slope <= endSlope[3] && slope >= startSlope[3]) { xst[3] = cx; len[3]++; }
+        continue;
+      }
+      else {
+        if (hyp <= r4) break;          // skip inner pixels
+        alpha = sqrtFraction(hyp);     // inner AA zone
+      }
+
+      if (alpha < 16) continue;
+
+      uint16_t pcol = alphaBlend(alpha, (uint16_t)fgColor, (uint16_t)bgColor);
+      slope = ((r - cy) << 16) / (r - cx);
+      if (slope <= startSlope[0] && slope >= endSlope[0]) drawPixel(x + cx - r, y - cy + r, pcol);  // BL
+      if (slope >= startSlope[1] && slope <= endSlope[1]) drawPixel(x + cx - r, y + cy - r, pcol);  // TL
+      if (slope <= startSlope[2] && slope >= endSlope[2]) drawPixel(x - cx + r, y + cy - r, pcol);  // TR
+      if (slope <= endSlope[3] && slope >= startSlope[3]) drawPixel(x - cx + r, y - cy + r, pcol);  // BR
+    }
+    if (len[0]) drawFastHLine(x + xst[0] - len[0] + 1 - r, y - cy + r, len[0], fgColor);  // BL
+    if (len[1]) drawFastHLine(x + xst[1] - len[1] + 1 - r, y + cy - r, len[1], fgColor);  // TL
+    if (len[2]) drawFastHLine(x - xst[2] + r, y + cy - r, len[2], fgColor);               // TR
+    if (len[3]) drawFastHLine(x - xst[3] + r, y - cy + r, len[3], fgColor);               // BR
+  }
+
+  // centre lines
+  if (startAngle == 0 || endAngle == 360) drawFastVLine(x, y + r - w, w, fgColor);  // bottom
+  if (startAngle <= 90 && endAngle >= 90) drawFastHLine(x - r + 1, y, w, fgColor);  // left
+  if (startAngle <= 180 && endAngle >= 180) drawFastVLine(x, y - r + 1, w, fgColor); // top
+  if (startAngle <= 270 && endAngle >= 270) drawFastHLine(x + r - w, y, w, fgColor); // right
+}
+
+void TFT_eSPI::fillSmoothCircle(int32_t x, int32_t y, int32_t r, uint32_t color, uint32_t bgColor)
+{
+  if (!_rasterize) return;
+  if (r <= 0) return;
+  _stats.smoothCircles++;
+
+  drawFastHLine(x - r, y, 2 * r + 1, color);
+  int32_t xs = 1;
+  int32_t cx = 0;
+  int32_t r1 = r * r;
+  r++;
+  int32_t r2 = r * r;
+
+  for (int32_t cy = r - 1; cy > 0; cy--) {
+    int32_t dy2 = (r - cy) * (r - cy);
+    for (cx = xs; cx < r; cx++) {
+      int32_t hyp2 = (r - cx) * (r - cx) + dy2;
+      if (hyp2 <= r1) break;
+      if (hyp2 >= r2) continue;
+
+      uint8_t alpha = ~sqrtFraction(hyp2);
+      if (alpha > 246) break;
+      xs = cx;
+      if (alpha < 9) continue;
+
+      if (bgColor == kTFTNoBackground) {
+        // background has to be read for every quadrant
+        drawPixel(x + cx - r, y + cy - r, color, alpha, bgColor);
+        drawPixel(x - cx + r, y + cy - r, color, alpha, bgColor);
+        drawPixel(x - cx + r, y - cy + r, color, alpha, bgColor);
+        drawPixel(x + cx - r, y - cy + r, color, alpha, bgColor);
+      }
+      else {
+        uint16_t pcol = drawPixel(x + cx - r, y + cy - r, color, alpha, bgColor);
+        drawPixel(x - cx + r, y + cy - r, pcol);
+        drawPixel(x - cx + r, y - cy + r, pcol);
+        drawPixel(x + cx - r, y - cy + r, pcol);
+      }
+    }
+    drawFastHLine(x + cx - r, y + cy - r, 2 * (r - cx) + 1, color);
+    drawFastHLine(x + cx - r, y - cy + r, 2 * (r - cx) + 1, color);
+  }
+}
+
+void TFT_eSPI::drawSmoothRoundRect(int32_t x, int32_t y, int32_t r, int32_t ir, int32_t w, int32_t h,
+                                   uint32_t fgColor, uint32_t bgColor, uint8_t quadrants)
+{
+  if (!_rasterize) return;
+  if (r < ir) std::swap(r, ir);
+  if (r <= 0 || ir < 0) return;
+  _stats.smoothRoundRects++;
+
+  w -= 2 * r;
+  h -= 2 * r;
+  if (w < 0) w = 0;
+  if (h < 0) h = 0;
+
+  x += r;
+  y += r;
+
+  uint16_t t = r - ir + 1;
+  int32_t xs = 0;
+  int32_t cx = 0;
+
+  int32_t r2 = r * r;   // outer arc radius^2
+  r++;
+  int32_t r1 = r * r;   // outer AA zone radius^2
+  int32_t r3 = ir * ir; // inner arc radius^2
+  ir--;
+  int32_t r4 = ir * ir; // inner AA zone radius^2
+
+  uint8_t alpha = 0;
+
+  for (int32_t cy = r - 1; cy > 0; cy--) {
+    int32_t len = 0;
+    int32_t lxst = 0;
+    int32_t rxst = 0;
+    int32_t dy2 = (r - cy) * (r - cy);
+
+    while ((r - xs) * (r - xs) + dy2 >= r1) xs++;
+
+    for (cx = xs; cx < r; cx++) {
+      int32_t hyp = (r - cx) * (r - cx) + dy2;
+
+      if (hyp > r2) {
+        alpha = ~sqrtFraction(hyp);
+      }
+      else if (hyp >= r3) {
+        rxst = cx;
+        len++;
+        continue;
+      }
+      else {
+        if (hyp <= r4) break;
+        alpha = sqrtFraction(hyp);
+      }
+
+      if (alpha < 16) continue;
+
+      // TFT_eSPI blends against bgColor here even when it is the "read" sentinel
+      uint16_t pcol = alphaBlend(alpha, (uint16_t)fgColor, (uint16_t)bgColor);
+      if (quadrants & 0x8) drawPixel(x + cx - r, y - cy + r + h, pcol);      // BL
+      if (quadrants & 0x1) drawPixel(x + cx - r, y + cy - r, pcol);          // TL
+      if (quadrants & 0x2) drawPixel(x - cx + r + w, y + cy - r, pcol);      // TR
+      if (quadrants & 0x4) drawPixel(x - cx + r + w, y - cy + r + h, pcol);  // BR
+    }
+    lxst = rxst - len + 1;
+    if (quadrants & 0x8) drawFastHLine(x + lxst - r, y - cy + r + h, len, fgColor);
+    if (quadrants & 0x1) drawFastHLine(x + lxst - r, y + cy - r, len, fgColor);
+    if (quadrants & 0x2) drawFastHLine(x - rxst + r + w, y + cy - r, len, fgColor);
+    if (quadrants & 0x4) drawFastHLine(x - rxst + r + w, y - cy + r + h, len, fgColor);
+  }
+
+  // sides
+  if ((quadrants & 0xC) == 0xC) fillRect(x, y + r - t + h, w + 1, t, fgColor);  // bottom
+  if ((quadrants & 0x9) == 0x9) fillRect(x - r + 1, y, t, h + 1, fgColor);      // left
+  if ((quadrants & 0x3) == 0x3) fillRect(x, y - r + 1, w + 1, t, fgColor);      // top
+  if ((quadrants & 0x6) == 0x6) fillRect(x + r - t + w, y, t, h + 1, fgColor);  // right
+}
+
+void TFT_eSPI::fillSmoothRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color,
+                                   uint32_t bgColor)
+{
+  if (!_rasterize) return;
+  _stats.smoothRoundRects++;
+  int32_t xs = 0;
+  int32_t cx = 0;
+
+  // limit radius to half width or height
+  if (r < 0) r = 0;
+  if (r > w / 2) r = w / 2;
+  if (r > h / 2) r = h / 2;
+
+  y += r;
+  h -= 2 * r;
+  fillRect(x, y, w, h, color);
+
+  h--;
+  x += r;
+  w -= 2 * r + 1;
+
+  int32_t r1 = r * r;
+  r++;
+  int32_t r2 = r * r;
+
+  for (int32_t cy = r - 1; cy > 0; cy--) {
+    int32_t dy2 = (r - cy) * (r - cy);
+    for (cx = xs; cx < r; cx++) {
+      int32_t hyp2 = (r - cx) * (r - cx) + dy2;
+      if (hyp2 <= r1) break;
+      if (hyp2 >= r2) continue;
+
+      uint8_t alpha = ~sqrtFraction(hyp2);
+      if (alpha > 246) break;
+      xs = cx;
+      if (alpha < 9) continue;
+
+      drawPixel(x + cx - r, y + cy - r, color, alpha, bgColor);
+      drawPixel(x - cx + r + w, y + cy - r, color, alpha, bgColor);
+      drawPixel(x - cx + r + w, y - cy + r + h, color, alpha, bgColor);
+      drawPixel(x + cx - r, y - cy + r + h, color, alpha, bgColor);
+    }
+    drawFastHLine(x + cx - r, y + cy - r, 2 * (r - cx) + 1 + w, color);
+    drawFastHLine(x + cx - r, y - cy + r + h, 2 * (r - cx) + 1 + w, color);
+  }
+}
+
+void TFT_eSPI::drawWideLine(float ax, float ay, float bx, float by, float wd, uint32_t fgColor, uint32_t bgColor)
+{
+  drawWedgeLine(ax, ay, bx, by, wd / 2.0f, wd / 2.0f, fgColor, bgColor);
+}
+
+// Scans the line's bounding box outwards from the start row, writing each row's
+// covered pixels through one address window and stopping a row at its trailing edge.
+void TFT_eSPI::drawWedgeLine(float ax, float ay, float bx, float by, float aw, float bw, uint32_t fgColor,
+                             uint32_t bgColor)
+{
+  if (!_rasterize) return;
+  if ((aw < 0.0f) || (bw < 0.0f)) return;
+  if ((fabsf(ax - bx) < 0.01f) && (fabsf(ay - by) < 0.01f)) bx += 0.01f;  // avoid divide by zero
+  _stats.wedgeLines++;
+
+  int32_t x0 = (int32_t)floorf(fminf(ax - aw, bx - bw));
+  int32_t x1 = (int32_t)ceilf(fmaxf(ax + aw, bx + bw));
+  int32_t y0 = (int32_t)floorf(fminf(ay - aw, by - bw));
+  int32_t y1 = (int32_t)ceilf(fmaxf(ay + aw, by + bw));
+  if (!clipWindow(&x0, &y0, &x1, &y1)) return;
+
+  int32_t ys = (int32_t)ay;
+  if ((ax - aw) > (bx - bw)) ys = (int32_t)by;
+
+  const float rdt = aw - bw;
+  const float ar = aw + 0.5f;
+  const float bax = bx - ax, bay = by - ay;
+  float alpha = 1.0f;
+  uint16_t bg = (uint16_t)bgColor;
+
+  auto scanRow = [&](int32_t yp, int32_t &xs) {
+    bool newWindow = true;
+    bool endX = false;
+    const float ypay = yp - ay;
+    for (int32_t xp = xs; xp <= x1; xp++) {
+      if (endX && alpha <= kLoAlphaThreshold) break;  // past the right hand edge
+      alpha = ar - wedgeLineDistance(xp - ax, ypay, bax, bay, rdt);
+      if (alpha <= kLoAlphaThreshold) continue;
+      if (!endX) {
+        endX = true;
+        xs = xp;
+      }
+      if (alpha > kHiAlphaThreshold) {
+        if (newWindow) {
+          setWindow(xp, yp, x1, yp);
+          newWindow = false;
+        }
+        pushColor((uint16_t)fgColor);
+        continue;
+      }
+      if (bgColor == kTFTNoBackground) {
+        bg = readPixel(xp, yp);
+        newWindow = true;
+      }
+      if (newWindow) {
+        setWindow(xp, yp, x1, yp);
+        newWindow = false;
+      }
+      pushColor(alphaBlend((uint8_t)(alpha * kPixelAlphaGain), (uint16_t)fgColor, bg));
+    }
+  };
+
+  int32_t xs = x0;
+  for (int32_t yp = ys; yp <= y1; yp++) scanRow(yp, xs);
+  xs = x0;
+  for (int32_t yp = ys - 1; yp >= y0; yp--) scanRow(yp, xs);
+}
+
+// Smooth fonts
+
+void TFT_eSPI::loadFont(const uint8_t array[])
+{
+  if (!array) return;
+  unloadFont();
+
+  _font.data = array;
+  _font.gCount = (uint16_t)readInt32(array);
+  // array + 4: encoder version, array + 8: font size in points, array + 12: unused
+  _font.ascent = (int16_t)readInt32(array + 16);
+  _font.descent = (int16_t)readInt32(array + 20);
+  _font.maxAscent = _font.ascent;
+  _font.maxDescent = _font.descent;
+
+  _glyphs.resize(_font.gCount);
+  uint32_t metrics = kVLWHeaderBytes;
+  uint32_t bitmap = kVLWHeaderBytes + (uint32_t)_font.gCount * kVLWMetricsBytes;
+  for (uint16_t g = 0; g < _font.gCount; g++, metrics += kVLWMetricsBytes) {
+    Glyph &glyph = _glyphs[g];
+    glyph.unicode = (uint16_t)readInt32(array + metrics);
+    glyph.height = (uint8_t)readInt32(array + metrics + 4);
+    glyph.width = (uint8_t)readInt32(array + metrics + 8);
+    glyph.xAdvance = (uint8_t)readInt32(array + metrics + 12);
+    glyph.dY = (int16_t)readInt32(array + metrics + 16);
+    glyph.dX = (int8_t)readInt32(array + metrics + 20);
+    glyph.bitmap = bitmap;
+    bitmap += (uint32_t)glyph.width * glyph.height;
+
+    // Same descent rule as TFT_eSPI: ignore control and UTF-8 lead range glyphs
+    if (((int16_t)glyph.height - glyph.dY) > (int16_t)_font.maxDescent) {
+      if ((glyph.unicode > 0x20 && glyph.unicode < 0x7F) || glyph.unicode > 0xA0) {
+        _font.maxDescent = (uint16_t)(glyph.height - glyph.dY);
+      }
+    }
+  }
+
+  _font.yAdvance = _font.maxAscent + _font.maxDescent;
+  _font.spaceWidth = (uint16_t)((_font.ascent + _font.descent) * 2 / 7);
+  _fontLoaded = true;
+  _stats.fontLoads++;
+  _stats.fontMetricBytes += (uint32_t)_font.gCount * kVLWMetricsBytes;
+}
+
+void TFT_eSPI::unloadFont()
+{
+  if (_fontLoaded) _stats.fontUnloads++;
+  _glyphs.clear();
+  _font = SmoothFont();
+  _fontLoaded = false;
+}
+
+int16_t TFT_eSPI::fontHeight() const
+{
+  return _fontLoaded ? (int16_t)_font.yAdvance : (int16_t)(kGLCDHeight * _textSize);
+}
+
+bool TFT_eSPI::getUnicodeIndex(uint16_t unicode, uint16_t *index) const
+{
+  for (uint16_t i = 0; i < _glyphs.size(); i++) {
+    if (_glyphs[i].unicode == unicode) {
+      *index = i;
+      return true;
+    }
+  }
+  return false;
+}
+
+uint16_t TFT_eSPI::decodeUTF8(const uint8_t *buf, uint16_t *index, uint16_t remaining)
+{
+  uint16_t c = buf[(*index)++];
+  if ((c & 0x80) == 0x00) return c;
+  if (((c & 0xE0) == 0xC0) && (remaining > 1)) {
+    return ((c & 0x1F) << 6) | (buf[(*index)++] & 0x3F);
+  }
+  if (((c & 0xF0) == 0xE0) && (remaining > 2)) {
+    c = ((c & 0x0F) << 12) | ((buf[(*index)++] & 0x3F) << 6);
+    return c | (buf[(*index)++] & 0x3F);
+  }
+  return c;
+}
+
+int16_t TFT_eSPI::textWidth(const char *string)
+{
+  if (!string) return 0;
+  const uint8_t *bytes = (const uint8_t *)string;
+  uint16_t len = (uint16_t)strlen(string);
+
+  if (!_fontLoaded) return (int16_t)(len * kGLCDWidth * _textSize);
+
+  int16_t width = 0;
+  uint16_t n = 0;
+  while (n < len) {
+    uint16_t unicode = decodeUTF8(bytes, &n, len - n);
+    uint16_t g = 0;
+    if (getUnicodeIndex(unicode, &g)) {
+      const Glyph &glyph = _glyphs[g];
+      if (width == 0 && glyph.dX < 0) width -= glyph.dX;
+      if (n < len) width += glyph.xAdvance;
+      else width += glyph.dX + glyph.width;
+    }
+    else {
+      width += _font.spaceWidth + 1;
+    }
+  }
+  return width;
+}
+
+// Text drawing
+
+// One smooth font glyph at the cursor: fully opaque runs as spans, partially covered
+// pixels one at a time (read from the panel when no background colour is set, i.e.
+// foreground == background), and with background fill the rest of the glyph cell.
+void TFT_eSPI::drawGlyph(uint16_t code)
+{
+  uint16_t fg = _textColor;
+  uint16_t bg = _textBgColor;
+  const bool getBG = (fg == bg);
+
+  if (_lastCursorX != _cursorX) {
+    _bgCursorX = _cursorX;
+    _lastCursorX = _cursorX;
+  }
+
+  if (code < 0x21) {
+    if (code == 0x20) {
+      if (_textBgFill) fillRect(_bgCursorX, _cursorY, (_cursorX + _font.spaceWidth) - _bgCursorX, _font.yAdvance, bg);
+      _cursorX += _font.spaceWidth;
+      _bgCursorX = _cursorX;
+      _lastCursorX = _cursorX;
+      return;
+    }
+    if (code == '\n') {
+      _cursorX = 0;
+      _bgCursorX = 0;
+      _lastCursorX = 0;
+      _cursorY += _font.yAdvance;
+      return;
+    }
+  }
+
+  uint16_t g = 0;
+  if (!getUnicodeIndex(code, &g)) {
+    // code point not in the font: TFT_eSPI draws an outline box in its place
+    int32_t bx = _cursorX, by = _cursorY + _font.maxAscent - _font.ascent;
+    drawFastHLine(bx, by, _font.spaceWidth, fg);
+    drawFastHLine(bx, by + _font.ascent - 1, _font.spaceWidth, fg);
+    drawFastVLine(bx, by, _font.ascent, fg);
+    drawFastVLine(bx + _font.spaceWidth - 1, by, _font.ascent, fg);
+    _cursorX += _font.spaceWidth + 1;
+    _bgCursorX = _cursorX;
+    _lastCursorX = _cursorX;
+    return;
+  }
+
+  const Glyph &glyph = _glyphs[g];
+  _stats.glyphs++;
+  if (_wrapX && (_cursorX + glyph.width + glyph.dX > _width)) {
+    _cursorY += _font.yAdvance;
+    _cursorX = 0;
+    _bgCursorX = 0;
+  }
+  if (_wrapY && ((_cursorY + _font.yAdvance) >= _height)) _cursorY = 0;
+  if (_cursorX == 0) _cursorX -= glyph.dX;
+
+  const uint8_t *bitmap = _font.data + glyph.bitmap;
+  const int32_t cy = _cursorY + _font.maxAscent - glyph.dY;
+  const int32_t cx = _cursorX + glyph.dX;
+
+  int32_t fxs = cx;
+  uint32_t fl = 0;
+  int32_t bxs = cx;
+  uint32_t bl = 0;
+  int32_t bx = 0;
+  int32_t fillWidth = 0;
+
+  if (_textBgFill) {
+    // area above the glyph, to its left and to its right
+    fillWidth = (_cursorX + glyph.xAdvance) - _bgCursorX;
+    if (fillWidth > 0) {
+      int32_t fillHeight = _font.maxAscent - glyph.dY;
+      if (fillHeight > 0) fillRect(_bgCursorX, _cursorY, fillWidth, fillHeight, bg);
+    }
+    else {
+      fillWidth = 0;
+    }
+    if (_bgCursorX < cx) fillRect(_bgCursorX, cy, cx - _bgCursorX, glyph.height, bg);
+    if (_bgCursorX > cx) bx = _bgCursorX - cx;
+    if (cx + glyph.width < _cursorX + glyph.xAdvance) {
+      fillRect(cx + glyph.width, cy, (_cursorX + glyph.xAdvance) - (cx + glyph.width), glyph.height, bg);
+    }
+  }
+
+  for (int32_t y = 0; y < glyph.height; y++) {
+    for (int32_t x = 0; x < glyph.width; x++) {
+      uint8_t pixel = bitmap[x + glyph.width * y];
+      if (pixel) {
+        if (bl) {
+          drawFastHLine(bxs, y + cy, bl, bg);
+          bl = 0;
+        }
+        if (pixel != 0xFF) {
+          if (fl) {
+            if (fl == 1) drawPixel(fxs, y + cy, fg);
+            else drawFastHLine(fxs, y + cy, fl, fg);
+            fl = 0;
+          }
+          if (getBG) bg = readPixel(x + cx, y + cy);
+          drawPixel(x + cx, y + cy, alphaBlend(pixel, fg, bg));
+        }
+        else {
+          if (fl == 0) fxs = x + cx;
+          fl++;
+        }
+      }
+      else {
+        if (fl) {
+          drawFastHLine(fxs, y + cy, fl, fg);
+          fl = 0;
+        }
+        if (_textBgFill && x >= bx) {
+          if (bl == 0) bxs = x + cx;
+          bl++;
+        }
+      }
+    }
+    if (fl) {
+      drawFastHLine(fxs, y + cy, fl, fg);
+      fl = 0;
+    }
+    if (bl) {
+      drawFastHLine(bxs, y + cy, bl, bg);
+      bl = 0;
+    }
+  }
+
+  // area below the glyph
+  if (fillWidth > 0) {
+    int32_t fillHeight = (_cursorY + _font.yAdvance) - (cy + glyph.height);
+    if (fillHeight > 0) fillRect(_bgCursorX, cy + glyph.height, fillWidth, fillHeight, bg);
+  }
+
+  _cursorX += glyph.xAdvance;
+  _bgCursorX = _cursorX;
+  _lastCursorX = _cursorX;
+}
+
+// The return value matches TFT_eSPI: the rendered width, or the padding width if larger.
+// Without a smooth font the built in GLCD font is not available here, so each character
+// cell is written as a block of background colour (as opaque GLCD text is, pixel count
+// wise) or skipped for transparent text.
+int16_t TFT_eSPI::drawString(const char *string, int32_t x, int32_t y)
+{
+  if (!string) return 0;
+  if (!_rasterize) {
+    const int16_t width = textWidth(string);
+    return (_textPadding > width) ? (int16_t)_textPadding : width;
+  }
+  _stats.strings++;
+
+  const int16_t width = textWidth(string);
+  const int16_t height = fontHeight();
+  const int16_t baseline = _fontLoaded ? (int16_t)_font.maxAscent : height;
+
+  switch (_textDatum) {
+    case TC_DATUM: x -= width / 2; break;
+    case TR_DATUM: x -= width; break;
+    case ML_DATUM: y -= height / 2; break;
+    case MC_DATUM: x -= width / 2; y -= height / 2; break;
+    case MR_DATUM: x -= width; y -= height / 2; break;
+    case BL_DATUM: y -= height; break;
+    case BC_DATUM: x -= width / 2; y -= height; break;
+    case BR_DATUM: x -= width; y -= height; break;
+    case L_BASELINE: y -= baseline; break;
+    case C_BASELINE: x -= width / 2; y -= baseline; break;
+    case R_BASELINE: x -= width; y -= baseline; break;
+  }
+
+  const uint16_t len = (uint16_t)strlen(string);
+  if (_fontLoaded) {
+    setCursor((int16_t)x, (int16_t)y);
+    const bool bgFill = _textBgFill;
+    if (_textPadding && !_textBgFill) _textBgFill = true;
+    uint16_t n = 0;
+    while (n < len) drawGlyph(decodeUTF8((const uint8_t *)string, &n, len - n));
+    _textBgFill = bgFill;
+  }
+  else if (_textColor != _textBgColor) {
+    for (uint16_t i = 0; i < len; i++) {
+      fillRect(x + i * kGLCDWidth * _textSize, y, kGLCDWidth * _textSize, kGLCDHeight * _textSize, _textBgColor);
+    }
+  }
+
+  return (_textPadding > width) ? (int16_t)_textPadding : width;
+}
+
+int16_t TFT_eSPI::drawFloat(float value, uint8_t decimals, int32_t x, int32_t y)
+{
+  char text[24];
+  if (decimals > 7) decimals = 7;
+  snprintf(text, sizeof(text), "%.*f", decimals, (double)value);
+  return drawString(text, x, y);
+}
+
+int16_t TFT_eSPI::drawNumber(long value, int32_t x, int32_t y)
+{
+  char text[24];
+  snprintf(text, sizeof(text), "%ld", value);
+  return drawString(text, x, y);
+}
@@ -0,0 +1,266 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for TFT_eSPI (https://github.com/Bodmer/TFT_eSPI)
+
+  Panel geometry comes from the same TFT_eSPI_Setups header the device build uses.
+  Smooth (VLW) fonts are parsed exactly as TFT_eSPI parses them so that textWidth()
+  and fontHeight(), which the sketch uses for layout, return device values.
+
+  Primitives are rasterized with TFT_eSPI's own algorithms (anti-aliased edges pixel by
+  pixel, solid spans as blocks, glyph alpha runs, background reads where TFT_eSPI reads
+  the panel) down to setWindow()/pushColor()/pushBlock()/readPixel(), which record what
+  would have crossed the SPI bus. hostStats() returns the totals. With
+  hostFramebufferEnable() the pixels themselves are kept in RGB565 memory as well, and
+  readPixel() returns them, so anti-aliased edges blend the way they do on the panel.
+  hostRasterizeEnable(false) skips drawing altogether.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+#include <vector>
+
+// Colour order values referenced by the setup header
+#define TFT_RGB 0
+#define TFT_BGR 1
+
+#include "FNK0103F_2.8_240x320_ILI9341.h"
+
+#ifndef SPI_READ_FREQUENCY
+  #define SPI_READ_FREQUENCY SPI_FREQUENCY
+#endif
+
+// Default colour definitions (RGB565)
+#define TFT_BLACK       0x0000
+#define TFT_NAVY        0x000F
+#define TFT_DARKGREEN   0x03E0
+#define TFT_DARKCYAN    0x03EF
+#define TFT_MAROON      0x7800
+#define TFT_PURPLE      0x780F
+#define TFT_OLIVE       0x7BE0
+#define TFT_LIGHTGREY   0xD69A
+#define TFT_DARKGREY    0x7BEF
+#define TFT_BLUE        0x001F
+#define TFT_GREEN       0x07E0
+#define TFT_CYAN        0x07FF
+#define TFT_RED         0xF800
+#define TFT_MAGENTA     0xF81F
+#define TFT_YELLOW      0xFFE0
+#define TFT_WHITE       0xFFFF
+#define TFT_ORANGE      0xFDA0
+#define TFT_GREENYELLOW 0xB7E0
+#define TFT_PINK        0xFE19
+#define TFT_BROWN       0x9A60
+#define TFT_GOLD        0xFEA0
+#define TFT_SILVER      0xC618
+#define TFT_SKYBLUE     0x867D
+#define TFT_VIOLET      0x915C
+#define TFT_TRANSPARENT 0x0120
+
+// Text datums
+#define TL_DATUM 0
+#define TC_DATUM 1
+#define TR_DATUM 2
+#define ML_DATUM 3
+#define CL_DATUM 3
+#define MC_DATUM 4
+#define CC_DATUM 4
+#define MR_DATUM 5
+#define CR_DATUM 5
+#define BL_DATUM 6
+#define BC_DATUM 7
+#define BR_DATUM 8
+#define L_BASELINE 9
+#define C_BASELINE 10
+#define R_BASELINE 11
+
+// Sentinel meaning "read the background from the screen" for anti-aliased primitives
+constexpr uint32_t kTFTNoBackground = 0x00FFFFFF;
+
+// Host build: panel traffic since the last hostStatsReset(). Byte counts follow the
+// ILI9341 command stream TFT_eSPI generates: an address window is CASET + 4, RASET + 4
+// and RAMWR (11 bytes), a pixel is 2 bytes, and a pixel read is a window plus RAMRD
+// followed by a dummy byte and 3 colour bytes clocked in at SPI_READ_FREQUENCY.
+struct TFTStats {
+  uint64_t windows = 0;           // address windows set
+  uint64_t pixelsWritten = 0;
+  uint64_t pixelsRead = 0;
+  uint64_t bytesWritten = 0;
+  uint64_t bytesRead = 0;
+  uint32_t fillScreens = 0;
+  uint32_t fontLoads = 0;
+  uint32_t fontUnloads = 0;
+  uint32_t fontMetricBytes = 0;   // glyph metrics parsed by loadFont()
+  uint32_t smoothArcs = 0;        // drawSmoothArc()
+  uint32_t arcs = 0;              // drawArc(), including the ones drawSmoothArc() makes
+  uint32_t smoothCircles = 0;     // fillSmoothCircle()
+  uint32_t smoothRoundRects = 0;  // drawSmoothRoundRect() and fillSmoothRoundRect()
+  uint32_t wedgeLines = 0;        // drawWedgeLine()/drawWideLine(), including arc ends
+  uint32_t strings = 0;
+  uint32_t glyphs = 0;
+
+  // time the bus spends clocking these bytes, in microseconds
+  double spiMicros() const
+  {
+    return bytesWritten * 8e6 / SPI_FREQUENCY + bytesRead * 8e6 / SPI_READ_FREQUENCY;
+  }
+};
+
+class TFT_eSPI {
+  public:
+    TFT_eSPI(int16_t w = TFT_WIDTH, int16_t h = TFT_HEIGHT);
+    virtual ~TFT_eSPI() = default;
+
+    void init(uint8_t tc = 0) { (void)tc; }
+    void begin(uint8_t tc = 0) { init(tc); }
+    void setRotation(uint8_t rotation);
+    uint8_t getRotation() const { return _rotation; }
+    int16_t width() const { return _width; }
+    int16_t height() const { return _height; }
+
+    // Panel access
+    void setWindow(int32_t x0, int32_t y0, int32_t x1, int32_t y1);
+    void pushColor(uint16_t color);
+    void pushBlock(uint16_t color, uint32_t len);
+    uint16_t readPixel(int32_t x, int32_t y);
+    static uint16_t alphaBlend(uint8_t alpha, uint16_t fgc, uint16_t bgc);
+
+    // Graphics primitives
+    virtual void drawPixel(int32_t x, int32_t y, uint32_t color);
+    uint16_t drawPixel(int32_t x, int32_t y, uint32_t color, uint8_t alpha, uint32_t bgColor = kTFTNoBackground);
+    virtual void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+    void fillScreen(uint32_t color);
+    void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color);
+    void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color);
+    void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
+    void drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color);
+    void fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color);
+    void fillTriangle(int32_t x0, int32_t y0, int32_t x1, int32_t y1, int32_t x2, int32_t y2, uint32_t color);
+
+    // Anti-aliased primitives
+    void drawSmoothArc(int32_t x, int32_t y, int32_t r, int32_t ir, uint32_t startAngle, uint32_t endAngle,
+                       uint32_t fgColor, uint32_t bgColor, bool roundEnds = false);
+    void drawArc(int32_t x, int32_t y, int32_t r, int32_t ir, uint32_t startAngle, uint32_t endAngle,
+                 uint32_t fgColor, uint32_t bgColor, bool smoothArc = true);
+    void fillSmoothCircle(int32_t x, int32_t y, int32_t r, uint32_t color, uint32_t bgColor = kTFTNoBackground);
+    void drawSmoothRoundRect(int32_t x, int32_t y, int32_t r, int32_t ir, int32_t w, int32_t h,
+                             uint32_t fgColor, uint32_t bgColor = kTFTNoBackground, uint8_t quadrants = 0xF);
+    void fillSmoothRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t color,
+                             uint32_t bgColor = kTFTNoBackground);
+    void drawWideLine(float ax, float ay, float bx, float by, float wd, uint32_t fgColor,
+                      uint32_t bgColor = kTFTNoBackground);
+    void drawWedgeLine(float ax, float ay, float bx, float by, float aw, float bw, uint32_t fgColor,
+                       uint32_t bgColor = kTFTNoBackground);
+    void drawSpot(float ax, float ay, float r, uint32_t fgColor, uint32_t bgColor = kTFTNoBackground)
+    {
+      drawWedgeLine(ax, ay, ax, ay, r, r, fgColor, bgColor);
+    }
+
+    // Text
+    void setTextColor(uint16_t color) { _textColor = color; _textBgColor = color; _textBgFill = false; }
+    void setTextColor(uint16_t fgColor, uint16_t bgColor, bool bgFill = false)
+    {
+      _textColor = fgColor;
+      _textBgColor = bgColor;
+      _textBgFill = bgFill;
+    }
+    void setTextDatum(uint8_t datum) { _textDatum = datum; }
+    uint8_t getTextDatum() const { return _textDatum; }
+    void setTextPadding(uint16_t padding) { _textPadding = padding; }
+    void setTextWrap(bool wrapX, bool wrapY = false) { _wrapX = wrapX; _wrapY = wrapY; }
+    void setTextSize(uint8_t size) { _textSize = size ? size : 1; }
+    void setCursor(int16_t x, int16_t y) { _cursorX = x; _cursorY = y; }
+
+    void loadFont(const uint8_t array[]);
+    void unloadFont();
+    bool fontLoaded() const { return _fontLoaded; }
+    int16_t fontHeight() const;
+    int16_t textWidth(const String &string) { return textWidth(string.c_str()); }
+    int16_t textWidth(const char *string);
+
+    int16_t drawString(const String &string, int32_t x, int32_t y) { return drawString(string.c_str(), x, y); }
+    int16_t drawString(const char *string, int32_t x, int32_t y);
+    int16_t drawFloat(float value, uint8_t decimals, int32_t x, int32_t y);
+    int16_t drawNumber(long value, int32_t x, int32_t y);
+
+    static uint16_t color565(uint8_t r, uint8_t g, uint8_t b)
+    {
+      return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+    }
+
+    // Host build: panel traffic accounting
+    const TFTStats &hostStats() const { return _stats; }
+    void hostStatsReset() { _stats = TFTStats(); }
+
+    // Host build: RGB565 framebuffer, width() x height() in the current rotation and
+    // cleared to black when enabled or rotated. nullptr while disabled (the default,
+    // which keeps long simulations fast).
+    void hostFramebufferEnable(bool enable);
+    const uint16_t *hostFramebuffer() const { return _framebuffer.empty() ? nullptr : _framebuffer.data(); }
+
+    // Host build: disabled, drawing returns before rasterizing and records nothing; text
+    // layout (textWidth(), fontHeight(), drawString()'s width) still works. For runners
+    // that only need the sketch's logic, screen costs are paq_screen_bench's
+    void hostRasterizeEnable(bool enable) { _rasterize = enable; }
+
+  protected:
+    // Smooth font metrics, laid out the way TFT_eSPI's Smooth_font.cpp keeps them
+    struct SmoothFont {
+      const uint8_t *data = nullptr;
+      uint16_t gCount = 0;
+      uint16_t yAdvance = 0;
+      uint16_t spaceWidth = 0;
+      int16_t ascent = 0;
+      int16_t descent = 0;
+      uint16_t maxAscent = 0;
+      uint16_t maxDescent = 0;
+    };
+    struct Glyph {
+      uint16_t unicode;
+      uint8_t height;
+      uint8_t width;
+      uint8_t xAdvance;
+      int16_t dY;
+      int8_t dX;
+      uint32_t bitmap;  // offset of the 8 bit alpha bitmap within the font array
+    };
+
+    uint16_t decodeUTF8(const uint8_t *buf, uint16_t *index, uint16_t remaining);
+    bool getUnicodeIndex(uint16_t unicode, uint16_t *index) const;
+    void drawGlyph(uint16_t code);
+    void drawCircleHelper(int32_t x0, int32_t y0, int32_t r, uint8_t cornerName, uint32_t color);
+    void fillCircleHelper(int32_t x0, int32_t y0, int32_t r, uint8_t cornerName, int32_t delta, uint32_t color);
+    bool clipWindow(int32_t *x0, int32_t *y0, int32_t *x1, int32_t *y1) const;
+
+    int16_t _width;
+    int16_t _height;
+    int16_t _initWidth;
+    int16_t _initHeight;
+    uint8_t _rotation = 0;
+
+    uint16_t _textColor = TFT_WHITE;
+    uint16_t _textBgColor = TFT_BLACK;
+    bool _textBgFill = false;
+    uint8_t _textDatum = TL_DATUM;
+    uint16_t _textPadding = 0;
+    uint8_t _textSize = 1;
+    bool _wrapX = true;
+    bool _wrapY = false;
+    int32_t _cursorX = 0;
+    int32_t _cursorY = 0;
+    int32_t _bgCursorX = 0;
+    int32_t _lastCursorX = 0;
+
+    // current address window and write position within it
+    int32_t _winX0 = 0, _winY0 = 0, _winX1 = 0, _winY1 = 0;
+    int32_t _winX = 0, _winY = 0;
+    TFTStats _stats;
+    bool _framebufferEnabled = false;
+    bool _rasterize = true;
+    std::vector<uint16_t> _framebuffer;
+
+    bool _fontLoaded = false;
+    SmoothFont _font;
+    std::vector<Glyph> _glyphs;
+};
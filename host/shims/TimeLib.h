@@ -0,0 +1,16 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for TimeLib (https://github.com/PaulStoffregen/Time)
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+#include <ctime>
+
+// day of the week for a unix time, Sunday is day 1
+inline int weekday(time_t t)
+{
+  return (int)(((t / 86400) + 4) % 7) + 1;  // 1970-01-01 was a Thursday
+}
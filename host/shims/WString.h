@@ -0,0 +1,133 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for the Arduino String class
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+// Number bases accepted by the integer constructors
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+// Arduino String semantics on top of std::string. Numbers are formatted the way the
+// ESP32 core formats them (floats with two decimals, unsigned char as a number, char
+// as a character) so that debug output and network payloads match the device.
+class String {
+  public:
+    String() = default;
+    String(const char *cstr) : _buffer(cstr ? cstr : "") {}
+    String(const char *cstr, size_t length) : _buffer(cstr ? std::string(cstr, length) : std::string()) {}
+    String(const std::string &str) : _buffer(str) {}
+    String(std::string &&str) : _buffer(std::move(str)) {}
+    explicit String(char c) : _buffer(1, c) {}
+    explicit String(unsigned char value, unsigned char base = 10) : _buffer(formatUnsigned(value, base)) {}
+    explicit String(int value, unsigned char base = 10) : _buffer(formatSigned(value, base)) {}
+    explicit String(unsigned int value, unsigned char base = 10) : _buffer(formatUnsigned(value, base)) {}
+    explicit String(long value, unsigned char base = 10) : _buffer(formatSigned(value, base)) {}
+    explicit String(unsigned long value, unsigned char base = 10) : _buffer(formatUnsigned(value, base)) {}
+    explicit String(long long value, unsigned char base = 10) : _buffer(formatSigned(value, base)) {}
+    explicit String(unsigned long long value, unsigned char base = 10) : _buffer(formatUnsigned(value, base)) {}
+    explicit String(float value, unsigned int decimalPlaces = 2) : _buffer(formatFloat(value, decimalPlaces)) {}
+    explicit String(double value, unsigned int decimalPlaces = 2) : _buffer(formatFloat(value, decimalPlaces)) {}
+
+    // ArduinoJson variants convert with String(doc["key"]); see ArduinoJson.h
+    template <typename T, typename = typename std::decay_t<T>::json_variant_tag>
+    explicit String(const T &variant) : String(variant.template as<String>()) {}
+
+    unsigned int length() const { return (unsigned int)_buffer.length(); }
+    bool isEmpty() const { return _buffer.empty(); }
+    const char *c_str() const { return _buffer.c_str(); }
+    const std::string &str() const { return _buffer; }
+    bool reserve(unsigned int size) { _buffer.reserve(size); return true; }
+
+    char operator[](unsigned int index) const { return index < _buffer.length() ? _buffer[index] : 0; }
+    char &operator[](unsigned int index) { return _buffer[index]; }
+    char charAt(unsigned int index) const { return (*this)[index]; }
+
+    bool concat(const String &s) { _buffer += s._buffer; return true; }
+    bool concat(const char *cstr) { if (cstr) _buffer += cstr; return true; }
+    bool concat(char c) { _buffer += c; return true; }
+    template <typename T>
+    bool concat(T value) { _buffer += String(value)._buffer; return true; }
+
+    String &operator+=(const String &rhs) { concat(rhs); return *this; }
+    String &operator+=(const char *cstr) { concat(cstr); return *this; }
+    String &operator+=(char c) { concat(c); return *this; }
+    template <typename T>
+    String &operator+=(T value) { concat(value); return *this; }
+
+    bool equals(const String &s) const { return _buffer == s._buffer; }
+    bool equals(const char *cstr) const { return _buffer == (cstr ? cstr : ""); }
+    bool equalsIgnoreCase(const String &s) const {
+      return _buffer.size() == s._buffer.size() && std::equal(_buffer.begin(), _buffer.end(), s._buffer.begin(),
+        [](char a, char b) { return std::tolower((unsigned char)a) == std::tolower((unsigned char)b); });
+    }
+    bool operator==(const String &rhs) const { return equals(rhs); }
+    bool operator==(const char *cstr) const { return equals(cstr); }
+    bool operator!=(const String &rhs) const { return !equals(rhs); }
+    bool operator!=(const char *cstr) const { return !equals(cstr); }
+    bool operator<(const String &rhs) const { return _buffer < rhs._buffer; }
+    bool startsWith(const String &prefix) const { return _buffer.compare(0, prefix._buffer.length(), prefix._buffer) == 0; }
+    bool endsWith(const String &suffix) const {
+      return _buffer.length() >= suffix._buffer.length() &&
+        _buffer.compare(_buffer.length() - suffix._buffer.length(), suffix._buffer.length(), suffix._buffer) == 0;
+    }
+
+    int indexOf(char c, unsigned int from = 0) const { return toIndex(_buffer.find(c, from)); }
+    int indexOf(const String &s, unsigned int from = 0) const { return toIndex(_buffer.find(s._buffer, from)); }
+    int lastIndexOf(char c) const { return toIndex(_buffer.rfind(c)); }
+
+    String substring(unsigned int beginIndex) const {
+      return beginIndex < _buffer.length() ? String(_buffer.substr(beginIndex)) : String();
+    }
+    String substring(unsigned int beginIndex, unsigned int endIndex) const {
+      if (beginIndex > endIndex) std::swap(beginIndex, endIndex);
+      if (beginIndex >= _buffer.length()) return String();
+      return String(_buffer.substr(beginIndex, endIndex - beginIndex));
+    }
+
+    void remove(unsigned int index) { if (index < _buffer.length()) _buffer.erase(index); }
+    void remove(unsigned int index, unsigned int count) { if (index < _buffer.length()) _buffer.erase(index, count); }
+    void replace(const String &find, const String &replacement);
+    void trim();
+    void toLowerCase();
+    void toUpperCase();
+
+    long toInt() const { return std::strtol(_buffer.c_str(), nullptr, 10); }
+    float toFloat() const { return std::strtof(_buffer.c_str(), nullptr); }
+    double toDouble() const { return std::strtod(_buffer.c_str(), nullptr); }
+
+  private:
+    static int toIndex(size_t pos) { return pos == std::string::npos ? -1 : (int)pos; }
+    static std::string formatUnsigned(unsigned long long value, unsigned char base);
+    static std::string formatSigned(long long value, unsigned char base);
+    static std::string formatFloat(double value, unsigned int decimalPlaces);
+
+    std::string _buffer;
+};
+
+// Concatenation, following the overload set of the core's StringSumHelper
+inline String operator+(const String &lhs, const String &rhs) { String s(lhs); s.concat(rhs); return s; }
+inline String operator+(const String &lhs, const char *rhs) { String s(lhs); s.concat(rhs); return s; }
+inline String operator+(const char *lhs, const String &rhs) { String s(lhs); s.concat(rhs); return s; }
+inline String operator+(const String &lhs, char rhs) { String s(lhs); s.concat(rhs); return s; }
+inline String operator+(const String &lhs, unsigned char rhs) { String s(lhs); s.concat(String(rhs)); return s; }
+inline String operator+(const String &lhs, int rhs) { String s(lhs); s.concat(String(rhs)); return s; }
+inline String operator+(const String &lhs, unsigned int rhs) { String s(lhs); s.concat(String(rhs)); return s; }
+inline String operator+(const String &lhs, long rhs) { String s(lhs); s.concat(String(rhs)); return s; }
+inline String operator+(const String &lhs, unsigned long rhs) { String s(lhs); s.concat(String(rhs)); return s; }
+inline String operator+(const String &lhs, long long rhs) { String s(lhs); s.concat(String(rhs)); return s; }
+inline String operator+(const String &lhs, unsigned long long rhs) { String s(lhs); s.concat(String(rhs)); return s; }
+inline String operator+(const String &lhs, float rhs) { String s(lhs); s.concat(String(rhs)); return s; }
+inline String operator+(const String &lhs, double rhs) { String s(lhs); s.concat(String(rhs)); return s; }
+inline bool operator==(const char *lhs, const String &rhs) { return rhs.equals(lhs); }
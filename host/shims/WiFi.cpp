@@ -0,0 +1,129 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for the ESP32 WiFi library
+*/
+
+#include "WiFi.h"
+#include "host_runtime.h"
+
+WiFiClass WiFi;
+
+namespace {
+  bool wifiAvailable = true;
+}
+
+void hostWiFiAvailableSet(bool available)
+{
+  wifiAvailable = available;
+  if (!available) WiFi.disconnect();
+}
+
+bool hostWiFiAvailable()
+{
+  return wifiAvailable;
+}
+
+String IPAddress::toString() const
+{
+  return String(_octets[0]) + "." + _octets[1] + "." + _octets[2] + "." + _octets[3];
+}
+
+bool WiFiClass::mode(wifi_mode_t mode)
+{
+  _mode = mode;
+  if (mode == WIFI_MODE_NULL) _connected = false;
+  return true;
+}
+
+bool WiFiClass::setHostname(const char *hostname)
+{
+  _hostname = hostname;
+  return true;
+}
+
+wl_status_t WiFiClass::status()
+{
+  if (!wifiAvailable) _connected = false;
+  return _connected ? WL_CONNECTED : WL_DISCONNECTED;
+}
+
+bool WiFiClass::begin(const char *ssid, const char *passphrase)
+{
+  (void)ssid; (void)passphrase;
+  if (_mode == WIFI_MODE_NULL) _mode = WIFI_MODE_STA;
+  _connected = wifiAvailable;
+  return _connected;
+}
+
+bool WiFiClass::reconnect()
+{
+  return begin();
+}
+
+bool WiFiClass::disconnect(bool wifiOff, bool eraseAP)
+{
+  (void)eraseAP;
+  _connected = false;
+  if (wifiOff) _mode = WIFI_MODE_NULL;
+  return true;
+}
+
+int8_t WiFiClass::RSSI()
+{
+  return _connected ? -55 : 0;
+}
+
+String WiFiClass::SSID()
+{
+  return _connected ? String("host-sim") : String();
+}
+
+IPAddress WiFiClass::localIP()
+{
+  return _connected ? IPAddress(127, 0, 0, 1) : IPAddress();
+}
+
+IPAddress WiFiClass::softAPIP()
+{
+  return IPAddress(192, 168, 4, 1);
+}
+
+int WiFiClient::connect(const char *host, uint16_t port)
+{
+  stop();
+  HostNetServer *server = (WiFi.status() == WL_CONNECTED) ? hostNetFind(host, port) : nullptr;
+  // nothing listening: refused right away
+  if (!server) return 0;
+  // SYN, SYN-ACK
+  if (!hostNetExchange(*server, 0, 0, 0, _connectTimeoutMS)) {
+    server->stats.connectFailures++;
+    return 0;
+  }
+  server->stats.connects++;
+  _server = server;
+  return 1;
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port)
+{
+  return connect(ip.toString().c_str(), port);
+}
+
+uint8_t WiFiClient::connected()
+{
+  if (WiFi.status() != WL_CONNECTED) _server = nullptr;
+  return _server != nullptr;
+}
+
+size_t WiFiClient::write(uint8_t c)
+{
+  return write(&c, 1);
+}
+
+size_t WiFiClient::write(const uint8_t *buffer, size_t size)
+{
+  (void)buffer;
+  if (!connected()) return 0;
+  hostNetSend(*_server, size);
+  return size;
+}
@@ -0,0 +1,91 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for the ESP32 WiFi library
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include "host_net.h"
+
+typedef enum {
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum {
+  WIFI_MODE_NULL = 0,
+  WIFI_MODE_STA,
+  WIFI_MODE_AP,
+  WIFI_MODE_APSTA
+} wifi_mode_t;
+
+#define WIFI_OFF   WIFI_MODE_NULL
+#define WIFI_STA   WIFI_MODE_STA
+#define WIFI_AP    WIFI_MODE_AP
+#define WIFI_AP_STA WIFI_MODE_APSTA
+
+class IPAddress {
+  public:
+    IPAddress() = default;
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : _octets{a, b, c, d} {}
+    uint8_t operator[](int index) const { return _octets[index]; }
+    String toString() const;
+
+  private:
+    uint8_t _octets[4] = {0, 0, 0, 0};
+};
+
+class WiFiClass {
+  public:
+    bool mode(wifi_mode_t mode);
+    wifi_mode_t getMode() const { return _mode; }
+    bool setHostname(const char *hostname);
+    const char *getHostname() const { return _hostname.c_str(); }
+    wl_status_t status();
+    bool begin(const char *ssid = nullptr, const char *passphrase = nullptr);
+    bool reconnect();
+    bool disconnect(bool wifiOff = false, bool eraseAP = false);
+    int8_t RSSI();
+    String SSID();
+    IPAddress localIP();
+    IPAddress softAPIP();
+
+  private:
+    wifi_mode_t _mode = WIFI_MODE_NULL;
+    String _hostname;
+    bool _connected = false;
+};
+extern WiFiClass WiFi;
+
+// TCP client, connecting to stand-in servers on the host network (see host_net.h)
+class WiFiClient : public Stream {
+  public:
+    virtual ~WiFiClient() = default;
+    virtual int connect(const char *host, uint16_t port);
+    virtual int connect(IPAddress ip, uint16_t port);
+    void setConnectTimeout(uint32_t timeoutMS) { _connectTimeoutMS = timeoutMS; }
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int read(uint8_t *buffer, size_t size) { (void)buffer; (void)size; return -1; }
+    int peek() override { return -1; }
+    virtual uint8_t connected();
+    virtual void stop() { _server = nullptr; }
+    explicit operator bool() { return connected(); }
+
+    // the stand-in server this client is connected to, or nullptr
+    HostNetServer *hostServer() const { return _server; }
+
+  private:
+    static constexpr uint32_t kConnectTimeoutMS = 3000;  // WIFI_CLIENT_DEF_CONN_TIMEOUT_MS
+
+    HostNetServer *_server = nullptr;
+    uint32_t _connectTimeoutMS = kConnectTimeoutMS;
+};
@@ -0,0 +1,44 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for WiFiManager
+*/
+
+#include "WiFiManager.h"
+#include "host_runtime.h"
+
+WiFiManagerParameter::WiFiManagerParameter(const char *custom)
+  : _label(custom)
+{
+}
+
+WiFiManagerParameter::WiFiManagerParameter(const char *id, const char *label, const char *defaultValue, int length)
+  : _id(id), _label(label), _length(length)
+{
+  setValue(defaultValue, length);
+}
+
+void WiFiManagerParameter::setValue(const char *defaultValue, int length)
+{
+  _length = length;
+  _value = String(defaultValue ? defaultValue : "");
+  if (length > 0 && _value.length() > (unsigned int)length) {
+    _value = _value.substring(0, length);
+  }
+}
+
+bool WiFiManager::autoConnect(const char *apName, const char *apPassword)
+{
+  (void)apName; (void)apPassword;
+  if (WiFi.getMode() == WIFI_MODE_NULL) WiFi.mode(WIFI_MODE_STA);
+  if (hostWiFiAvailable() && WiFi.begin()) return true;
+
+  delay(_connectTimeoutSeconds * 1000);
+  if (_apCallback) _apCallback(this);
+  delay(_configPortalTimeoutSeconds * 1000);
+  return false;
+}
+
+void WiFiManager::hostPortalSave()
+{
+  if (_saveParamsCallback) _saveParamsCallback();
+}
@@ -0,0 +1,67 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for WiFiManager (https://github.com/tzapu/WiFiManager)
+
+  autoConnect() succeeds when the host WiFi link is available. Otherwise it blocks for
+  the connect timeout, announces the configuration portal through the AP callback and
+  then blocks for the portal timeout, as the library does when nobody configures it.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <WiFi.h>
+
+#include <functional>
+#include <vector>
+
+class WiFiManagerParameter {
+  public:
+    explicit WiFiManagerParameter(const char *custom);
+    WiFiManagerParameter(const char *id, const char *label, const char *defaultValue, int length);
+
+    const char *getID() const { return _id.c_str(); }
+    const char *getLabel() const { return _label.c_str(); }
+    const char *getValue() const { return _value.c_str(); }
+    int getValueLength() const { return _length; }
+    void setValue(const char *defaultValue, int length);
+
+  private:
+    String _id, _label, _value;
+    int _length = 0;
+};
+
+class WiFiManager {
+  public:
+    void setAPCallback(std::function<void(WiFiManager *)> callback) { _apCallback = callback; }
+    void setSaveParamsCallback(std::function<void()> callback) { _saveParamsCallback = callback; }
+    void setBreakAfterConfig(bool shouldBreak) { (void)shouldBreak; }
+    void setConnectTimeout(unsigned long seconds) { _connectTimeoutSeconds = seconds; }
+    void setConfigPortalTimeout(unsigned long seconds) { _configPortalTimeoutSeconds = seconds; }
+    void setConfigPortalBlocking(bool shouldBlock) { (void)shouldBlock; }
+    void setDebugOutput(bool debug) { (void)debug; }
+    void setTitle(String title) { _title = title; }
+    void setMenu(std::vector<const char *> &menu) { _menu = menu; }
+    bool addParameter(WiFiManagerParameter *p) { _parameters.push_back(p); return true; }
+    std::vector<WiFiManagerParameter *> &getParameters() { return _parameters; }
+
+    bool autoConnect(const char *apName, const char *apPassword = nullptr);
+    void startWebPortal() { _webPortalActive = true; }
+    void stopWebPortal() { _webPortalActive = false; }
+    bool getWebPortalActive() const { return _webPortalActive; }
+    bool process() { return _webPortalActive; }
+    void resetSettings() {}
+
+    // host only: simulate a user pressing "save" in the portal
+    void hostPortalSave();
+
+  private:
+    std::function<void(WiFiManager *)> _apCallback;
+    std::function<void()> _saveParamsCallback;
+    std::vector<WiFiManagerParameter *> _parameters;
+    std::vector<const char *> _menu;
+    String _title;
+    unsigned long _connectTimeoutSeconds = 0;
+    unsigned long _configPortalTimeoutSeconds = 0;
+    bool _webPortalActive = false;
+};
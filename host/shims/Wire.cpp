@@ -0,0 +1,134 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for the ESP32 Wire (I2C) library
+*/
+
+#include "Wire.h"
+#include "host_runtime.h"
+
+TwoWire Wire;
+
+namespace {
+  constexpr uint8_t kI2CAddressCount = 128;
+  constexpr uint8_t kBitsPerByte = 9;  // 8 data bits plus ACK
+  constexpr uint8_t kEndTransmissionTimeout = 5;
+
+  I2CDevice *devices[kI2CAddressCount] = {};
+  HostI2CStats stats;
+}
+
+void hostI2CAttach(uint8_t address, I2CDevice *device)
+{
+  if (address < kI2CAddressCount) devices[address] = device;
+}
+
+const HostI2CStats &hostI2CStats() { return stats; }
+void hostI2CStatsReset() { stats = HostI2CStats(); }
+
+bool TwoWire::begin(int sda, int scl, uint32_t frequency)
+{
+  _sda = sda;
+  _scl = scl;
+  if (frequency) _frequency = frequency;
+  _begun = true;
+  return true;
+}
+
+bool hostI2CPinRead(uint8_t pin, int &level)
+{
+  if (Wire._sda < 0 || pin != Wire._sda) return false;
+  level = Wire.busHeld() ? LOW : HIGH;
+  return true;
+}
+
+bool hostI2CPinWrite(uint8_t pin, uint8_t level)
+{
+  if (Wire._scl < 0 || pin != Wire._scl) return false;
+  if (level == HIGH && Wire._sclLevel == LOW) {
+    for (I2CDevice *device : devices) {
+      if (device) device->i2cClock();
+    }
+  }
+  Wire._sclLevel = level;
+  return true;
+}
+
+bool TwoWire::busHeld() const
+{
+  for (const I2CDevice *device : devices) {
+    if (device && device->i2cHoldsBus()) return true;
+  }
+  return false;
+}
+
+// start, address byte and payload at the bus clock
+void TwoWire::busTime(size_t bytes)
+{
+  const uint32_t us = (uint32_t)(((bytes + 1) * kBitsPerByte * 1000000ULL + _frequency - 1) / _frequency);
+  stats.busMicros += us;
+  delayMicroseconds(us);
+}
+
+void TwoWire::beginTransmission(uint8_t address)
+{
+  _address = address;
+  _txLength = 0;
+}
+
+size_t TwoWire::write(uint8_t c)
+{
+  if (!_begun || _txLength >= kBufferLength) return 0;
+  _txBuffer[_txLength++] = c;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t *buffer, size_t size)
+{
+  size_t written = 0;
+  while (written < size && write(buffer[written])) written++;
+  return written;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop)
+{
+  (void)sendStop;
+  stats.transactions++;
+  if (busHeld()) {
+    stats.timeouts++;
+    stats.busMicros += (uint64_t)_timeOutMS * 1000;
+    delay(_timeOutMS);
+    return kEndTransmissionTimeout;
+  }
+  I2CDevice *device = (_address < kI2CAddressCount) ? devices[_address] : nullptr;
+  if (!device) {
+    busTime(0);
+    stats.nacks++;
+    return 2;
+  }
+  busTime(_txLength);
+  stats.bytes += _txLength;
+  const uint8_t result = device->i2cWrite(_txBuffer, _txLength);
+  if (result) stats.nacks++;
+  return result;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, size_t size, bool sendStop)
+{
+  (void)sendStop;
+  stats.transactions++;
+  _rxIndex = 0;
+  _rxLength = 0;
+  if (size > kBufferLength) size = kBufferLength;
+  if (busHeld()) {
+    stats.timeouts++;
+    stats.busMicros += (uint64_t)_timeOutMS * 1000;
+    delay(_timeOutMS);
+    return 0;
+  }
+  I2CDevice *device = (address < kI2CAddressCount) ? devices[address] : nullptr;
+  _rxLength = device ? device->i2cRead(_rxBuffer, size) : 0;
+  busTime(_rxLength);
+  stats.bytes += _rxLength;
+  if (!_rxLength) stats.nacks++;
+  return (uint8_t)_rxLength;
+}
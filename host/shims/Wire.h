@@ -0,0 +1,71 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for the ESP32 Wire (I2C) library
+
+  Addresses with no I2CDevice attached (see hostI2CAttach()) NACK. Each transaction
+  takes the time its bytes need on the bus at the configured clock (delay() time, so it
+  shows on the virtual clock), and a device holding SDA low makes every transaction wait
+  out the ESP32 Wire timeout and fail.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+// A simulated device on the bus
+class I2CDevice {
+  public:
+    virtual ~I2CDevice() = default;
+    // write transaction addressed to the device; returns the endTransmission() code
+    // (0 ACK, 2 address NACK, 3 data NACK)
+    virtual uint8_t i2cWrite(const uint8_t *data, size_t length) = 0;
+    // read transaction; fills up to length bytes and returns how many were sent, 0 when
+    // the address is not acknowledged
+    virtual size_t i2cRead(uint8_t *data, size_t length) = 0;
+    // true while the device holds SDA low
+    virtual bool i2cHoldsBus() const { return false; }
+    // a clock pulse on SCL outside a transaction, as from a bus clear
+    virtual void i2cClock() {}
+};
+
+class TwoWire : public Stream {
+  public:
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+    bool end() { _begun = false; return true; }
+    bool setClock(uint32_t frequency) { _frequency = frequency; return true; }
+    uint32_t getClock() const { return _frequency; }
+    void setTimeOut(uint16_t timeOutMS) { _timeOutMS = timeOutMS; }
+    uint16_t getTimeOut() const { return _timeOutMS; }
+
+    void beginTransmission(uint8_t address);
+    uint8_t endTransmission(bool sendStop = true);
+    uint8_t requestFrom(uint8_t address, size_t size, bool sendStop = true);
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+    int available() override { return (int)(_rxLength - _rxIndex); }
+    int read() override { return (_rxIndex < _rxLength) ? _rxBuffer[_rxIndex++] : -1; }
+    int peek() override { return (_rxIndex < _rxLength) ? _rxBuffer[_rxIndex] : -1; }
+
+  private:
+    static constexpr size_t kBufferLength = 128;  // ESP32 I2C_BUFFER_LENGTH
+
+    bool busHeld() const;
+    void busTime(size_t bytes);
+    friend bool hostI2CPinRead(uint8_t pin, int &level);
+    friend bool hostI2CPinWrite(uint8_t pin, uint8_t level);
+
+    bool _begun = false;
+    int _sda = -1, _scl = -1;
+    uint8_t _sclLevel = HIGH;
+    uint8_t _address = 0;
+    uint32_t _frequency = 100000;
+    uint16_t _timeOutMS = 50;
+    uint8_t _txBuffer[kBufferLength];
+    size_t _txLength = 0;
+    uint8_t _rxBuffer[kBufferLength];
+    size_t _rxLength = 0;
+    size_t _rxIndex = 0;
+};
+extern TwoWire Wire;
@@ -0,0 +1,55 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for XPT2046_Touchscreen
+*/
+
+#include "XPT2046_Touchscreen.h"
+#include "host_runtime.h"
+
+#include <deque>
+
+namespace {
+  struct PendingTouch {
+    TS_Point point;
+    uint64_t atMicros;
+  };
+  std::deque<PendingTouch> pendingTouches;
+
+  bool touchDown()
+  {
+    return !pendingTouches.empty() && pendingTouches.front().atMicros <= hostClockMicros();
+  }
+}
+
+void hostTouchPress(uint16_t rawX, uint16_t rawY)
+{
+  hostTouchPressAt(rawX, rawY, hostClockMicros());
+}
+
+void hostTouchPressAt(uint16_t rawX, uint16_t rawY, uint64_t atMicros)
+{
+  pendingTouches.push_back({TS_Point(rawX, rawY, 1000), atMicros});
+}
+
+void hostTouchClear()
+{
+  pendingTouches.clear();
+}
+
+bool XPT2046_Touchscreen::tirqTouched()
+{
+  return touchDown();
+}
+
+bool XPT2046_Touchscreen::touched()
+{
+  return touchDown();
+}
+
+TS_Point XPT2046_Touchscreen::getPoint()
+{
+  if (!touchDown()) return TS_Point();
+  TS_Point p = pendingTouches.front().point;
+  pendingTouches.pop_front();
+  return p;
+}
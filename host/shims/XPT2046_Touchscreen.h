@@ -0,0 +1,34 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for XPT2046_Touchscreen
+                (https://github.com/PaulStoffregen/XPT2046_Touchscreen)
+
+  Presses are queued by the runner with hostTouchPress() or hostTouchPressAt() in raw
+  12 bit coordinates.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <SPI.h>
+
+class TS_Point {
+  public:
+    TS_Point() = default;
+    TS_Point(int16_t x, int16_t y, int16_t z) : x(x), y(y), z(z) {}
+    int16_t x = 0, y = 0, z = 0;
+};
+
+class XPT2046_Touchscreen {
+  public:
+    XPT2046_Touchscreen(uint8_t csPin, uint8_t tirqPin = 255) : _csPin(csPin), _tirqPin(tirqPin) {}
+    bool begin(SPIClass &spi) { (void)spi; return true; }
+    void setRotation(uint8_t rotation) { _rotation = rotation % 4; }
+    bool tirqTouched();
+    bool touched();
+    TS_Point getPoint();
+
+  private:
+    uint8_t _csPin, _tirqPin;
+    uint8_t _rotation = 1;
+};
@@ -0,0 +1,39 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for the ESP-IDF task watchdog (esp_task_wdt.h)
+
+  Each task (see freertos/task.h) subscribes, feeds and checks itself; the functions
+  act on the calling task. When it is subscribed, a delay() that finds more than
+  timeout_ms of its virtual time since its last esp_task_wdt_reset() counts a trip and
+  "panics" by throwing HostRestart, as ESP.restart() does. Runners that advance the
+  clock between loop() calls stand for loop() spinning, which would feed the watchdog,
+  so that time never counts. See hostTaskWDTStats().
+*/
+
+#pragma once
+
+#include <cstdint>
+
+#include "freertos/task.h"
+
+typedef int esp_err_t;
+#ifndef ESP_OK
+  #define ESP_OK                0
+  #define ESP_ERR_INVALID_ARG   0x102
+  #define ESP_ERR_INVALID_STATE 0x103
+  #define ESP_ERR_NOT_FOUND     0x105
+#endif
+
+struct esp_task_wdt_config_t {
+  uint32_t timeout_ms;
+  uint32_t idle_core_mask;
+  bool trigger_panic;
+};
+
+esp_err_t esp_task_wdt_init(const esp_task_wdt_config_t *config);
+esp_err_t esp_task_wdt_reconfigure(const esp_task_wdt_config_t *config);
+esp_err_t esp_task_wdt_deinit();
+esp_err_t esp_task_wdt_add(TaskHandle_t task);
+esp_err_t esp_task_wdt_delete(TaskHandle_t task);
+esp_err_t esp_task_wdt_status(TaskHandle_t task);
+esp_err_t esp_task_wdt_reset();
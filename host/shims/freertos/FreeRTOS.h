@@ -0,0 +1,27 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for FreeRTOS (freertos/FreeRTOS.h)
+
+  The types and constants the sketch uses with the task API (freertos/task.h), and the
+  core the calling task runs on: 1, the Arduino loop task's, unless it is a task
+  created with xTaskCreatePinnedToCore().
+*/
+
+#pragma once
+
+#include <cstdint>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdFAIL 0
+#define pdPASS 1
+// the ESP32 Arduino core's 1000 Hz tick
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFF)
+#define portNUM_PROCESSORS 2
+
+BaseType_t xPortGetCoreID();
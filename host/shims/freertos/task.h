@@ -0,0 +1,25 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build stand-in for the FreeRTOS task API (freertos/task.h)
+
+  xTaskCreatePinnedToCore() fails unless a runner has called hostTasksEnable(). Then
+  each task is a host thread with its own virtual clock, and only one runs at a time:
+  whenever a task's clock moves, in delay(), delayMicroseconds() or a runner's
+  hostClockAdvanceMicros(), the task furthest behind takes over (see host_runtime.h).
+  Stack size and priority are ignored. A task waiting in ulTaskNotifyTake() sleeps like
+  delay() until its timeout, unless another task's xTaskNotifyGive() wakes it at the
+  notifying task's time.
+*/
+
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+typedef void *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char *name, uint32_t stackDepth, void *parameter,
+  UBaseType_t priority, TaskHandle_t *createdTask, BaseType_t coreID);
+TaskHandle_t xTaskGetCurrentTaskHandle();
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait);
@@ -0,0 +1,110 @@
+/*
+  Project:      Powered Air Quality
+  Description:  simulated network for the host build's TCP, HTTP and MQTT stand-ins
+*/
+
+#include "host_net.h"
+#include "host_runtime.h"
+
+#include <algorithm>
+#include <map>
+
+namespace {
+  constexpr uint32_t kRetransmitTimeoutMS = 1000;  // initial TCP retransmission timeout
+
+  std::map<std::pair<std::string, uint16_t>, HostNetServer *> &listeners()
+  {
+    static std::map<std::pair<std::string, uint16_t>, HostNetServer *> servers;
+    return servers;
+  }
+
+  uint32_t transferMS(const HostNetServer &server, size_t bytes)
+  {
+    if (!server.link.bytesPerSecond) return 0;
+    return (uint32_t)((bytes * 1000ULL + server.link.bytesPerSecond - 1) / server.link.bytesPerSecond);
+  }
+
+  // delay() that also charges the wait to the server
+  void wait(HostNetServer &server, uint32_t ms)
+  {
+    server.stats.blockedMicros += (uint64_t)ms * 1000;
+    delay(ms);
+  }
+}
+
+String HostHTTPRequest::header(const String &name) const
+{
+  for (const auto &entry : headers) {
+    if (entry.first.equalsIgnoreCase(name)) return entry.second;
+  }
+  return String();
+}
+
+bool HostNetServer::packetLost()
+{
+  if (!link.lossPercent) return false;
+  // xorshift32
+  lossSeed ^= lossSeed << 13;
+  lossSeed ^= lossSeed >> 17;
+  lossSeed ^= lossSeed << 5;
+  return (lossSeed % 100) < link.lossPercent;
+}
+
+void hostNetListen(const String &host, uint16_t port, HostNetServer *server)
+{
+  const auto key = std::make_pair(std::string(host.c_str()), port);
+  if (server) listeners()[key] = server;
+  else listeners().erase(key);
+}
+
+HostNetServer *hostNetFind(const String &host, uint16_t port)
+{
+  const auto found = listeners().find(std::make_pair(std::string(host.c_str()), port));
+  return (found == listeners().end()) ? nullptr : found->second;
+}
+
+void hostNetReset()
+{
+  listeners().clear();
+}
+
+bool hostNetExchange(HostNetServer &server, size_t bytesOut, size_t bytesIn, uint32_t serverMS, uint32_t timeoutMS)
+{
+  uint32_t elapsedMS = 0;
+  uint32_t retransmitMS = kRetransmitTimeoutMS;
+  while (server.packetLost()) {
+    if (elapsedMS + retransmitMS >= timeoutMS) {
+      wait(server, timeoutMS - elapsedMS);
+      return false;
+    }
+    wait(server, retransmitMS);
+    elapsedMS += retransmitMS;
+    retransmitMS *= 2;
+  }
+  const uint32_t exchangeMS = server.link.rttMS + serverMS + transferMS(server, bytesOut + bytesIn);
+  if (elapsedMS + exchangeMS > timeoutMS) {
+    wait(server, timeoutMS - elapsedMS);
+    return false;
+  }
+  wait(server, exchangeMS);
+  server.stats.bytesSent += bytesOut;
+  server.stats.bytesReceived += bytesIn;
+  return true;
+}
+
+void hostNetSend(HostNetServer &server, size_t bytes)
+{
+  wait(server, transferMS(server, bytes));
+  server.stats.bytesSent += bytes;
+}
+
+size_t hostNetNextPiece(const HostNetServer &server, size_t bytesLeft, uint32_t &afterMS)
+{
+  const HostNetLink &link = server.link;
+  if (!link.dripBytes) {
+    afterMS = transferMS(server, bytesLeft);
+    return bytesLeft;
+  }
+  afterMS = link.dripIntervalMS;
+  return std::min((size_t)link.dripBytes, bytesLeft);
+}
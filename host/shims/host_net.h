@@ -0,0 +1,96 @@
+/*
+  Project:      Powered Air Quality
+  Description:  simulated network for the host build's TCP, HTTP and MQTT stand-ins
+
+  Stand-in servers listen at a host name and port with hostNetListen(); WiFiClient,
+  HTTPClient and PubSubClient connect to them instead of the internet, and anything not
+  listening refuses connections. Every packet exchange waits out the server's link
+  conditions with delay(), so on the virtual clock the time a request blocks the sketch
+  is deterministic: round trip time, server think time, transfer at the link
+  throughput, retransmission after loss (1 s timeout, doubling) and slow drip bodies,
+  which arrive piece by piece as the sketch reads them, all bounded by the client's own
+  timeouts.
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// Conditions on the path between the device and one server
+struct HostNetLink {
+  uint32_t rttMS = 2;                  // round trip time
+  uint32_t serviceMS = 0;              // server think time before it answers a request
+  uint8_t lossPercent = 0;             // chance a packet exchange is lost and retransmitted
+  uint32_t bytesPerSecond = 1000000;   // throughput once data flows
+  uint32_t dripBytes = 0;              // slow drip: when non-zero, response bodies arrive
+  uint32_t dripIntervalMS = 0;         //   dripBytes at a time, dripIntervalMS apart
+};
+
+struct HostNetStats {
+  uint32_t connects = 0;
+  uint32_t connectFailures = 0;        // refused by the server or timed out
+  uint32_t requests = 0;               // HTTP requests and MQTT packets
+  uint32_t failures = 0;               // timeouts, HTTP status >= 400, refused MQTT packets
+  uint64_t bytesSent = 0;
+  uint64_t bytesReceived = 0;
+  uint64_t blockedMicros = 0;          // time the device waited on this server
+};
+
+struct HostHTTPRequest {
+  String method;
+  String path;                         // including the query string
+  std::vector<std::pair<String, String>> headers;
+  String body;
+
+  String header(const String &name) const;
+};
+
+struct HostHTTPResponse {
+  int code;
+  std::string body;
+};
+
+class HostNetServer {
+  public:
+    virtual ~HostNetServer() = default;
+
+    virtual HostHTTPResponse httpRequest(const HostHTTPRequest &request) { (void)request; return {404, ""}; }
+    // MQTT CONNECT; returns the CONNACK code (0 accepted, 3 unavailable, 4 bad credentials, 5 not authorized)
+    virtual uint8_t mqttConnect(const String &clientID, const String &user, const String &password)
+    {
+      (void)clientID; (void)user; (void)password;
+      return 3;
+    }
+    virtual void mqttPublish(const String &topic, const String &payload, bool retained)
+    {
+      (void)topic; (void)payload; (void)retained;
+    }
+
+    // true if the next packet exchange is lost; deterministic for a given lossSeed
+    bool packetLost();
+
+    HostNetLink link;
+    HostNetStats stats;
+    uint32_t lossSeed = 0x9E3779B9;
+};
+
+// Starts (or with nullptr stops) a server listening at host:port
+void hostNetListen(const String &host, uint16_t port, HostNetServer *server);
+// The server listening at host:port, or nullptr
+HostNetServer *hostNetFind(const String &host, uint16_t port);
+// Stops every server
+void hostNetReset();
+
+// Waits out one exchange with server: bytesOut to it, serverMS of think time, bytesIn
+// back. Returns false if it did not complete within timeoutMS.
+bool hostNetExchange(HostNetServer &server, size_t bytesOut, size_t bytesIn, uint32_t serverMS, uint32_t timeoutMS);
+// Waits for bytes to be accepted for sending, without waiting for a reply
+void hostNetSend(HostNetServer &server, size_t bytes);
+// The next piece of a response body with bytesLeft still to come: all of it, or under the
+// link's slow drip the next dripBytes. Returns its size and sets afterMS to how long after
+// the last piece it arrives
+size_t hostNetNextPiece(const HostNetServer &server, size_t bytesLeft, uint32_t &afterMS);
@@ -0,0 +1,105 @@
+/*
+  Project:      Powered Air Quality
+  Description:  host build controls used by runners to drive and observe the sketch
+
+  The Arduino stand-ins in this directory keep their device state here: the clock,
+  serial output, GPIO/LEDC levels, the WiFi link, the I2C bus and pending touchscreen
+  input.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+
+class I2CDevice;
+
+// Thrown by ESP.restart() so a runner can decide whether to exit or "reboot"
+struct HostRestart : std::exception {
+  const char *what() const noexcept override { return "ESP.restart()"; }
+};
+
+// clock. Real (steady) time by default. In virtual mode millis()/micros() only move
+// when the sketch calls delay()/delayMicroseconds() or a runner advances the clock,
+// which lets a runner skip idle time between deadlines. Time is kept in 64 bits;
+// millis() and micros() wrap like the device's 32 bit counters.
+void hostClockVirtualSet(bool isVirtual);
+bool hostClockIsVirtual();
+uint64_t hostClockMicros();
+void hostClockAdvanceMicros(uint64_t us);
+// sets the virtual clock, also backwards, for runners that interleave the timelines of
+// several simulated devices
+void hostClockVirtualJump(uint64_t us);
+
+// FreeRTOS tasks (see freertos/task.h), off by default so xTaskCreatePinnedToCore()
+// fails and the sketch runs single core. Enabled, on the virtual clock only, each task
+// has its own clock and the runner's thread is the Arduino loop task on core 1;
+// hostClockMicros() and millis() are the calling task's. Disabling deletes the tasks,
+// as does a restart. hostTasksWakeMicros() is the earliest clock of the other tasks,
+// UINT64_MAX without any; a runner advancing past it lets them run first.
+void hostTasksEnable(bool enabled);
+uint64_t hostTasksWakeMicros();
+
+// serial console
+void hostSerialMute(bool muted);
+uint32_t hostSerialLines();  // lines written since start, muted or not
+
+// value returned by esp_random(), which the sketch uses to seed random()
+void hostRandomSeedSet(uint32_t seed);
+
+// task watchdog (see esp_task_wdt.h); trips are panics, thrown as HostRestart
+struct HostTaskWDTStats {
+  uint32_t feeds = 0;
+  uint32_t trips = 0;
+};
+const HostTaskWDTStats &hostTaskWDTStats();
+
+// GPIO and LEDC observation/injection
+void hostButtonSet(uint8_t pin, bool pressed);
+uint32_t hostLedcDuty(uint8_t pin);
+uint32_t hostLedcTone(uint8_t pin);
+
+// WiFi link; when unavailable WiFiManager::autoConnect() fails and status() is disconnected
+void hostWiFiAvailableSet(bool available);
+bool hostWiFiAvailable();
+
+// flash, the LittleFS partition (see FS.h). File operations take rough ESP32 SPI flash times
+// on the calling task's clock: an open or close commits metadata, reads pay per call and
+// per byte, writes per 256 byte page including its share of a sector erase. Stats count
+// since the last reset. Erasing leaves an empty, unformatted partition; a mount failure
+// stands for a partition table without a LittleFS partition.
+struct HostFlashStats {
+  uint32_t opens = 0;
+  uint32_t reads = 0;       // read() calls
+  uint32_t writes = 0;      // write() calls
+  uint64_t bytesRead = 0;
+  uint64_t bytesWritten = 0;
+};
+const HostFlashStats &hostFlashStats();
+void hostFlashStatsReset();
+void hostFlashErase();
+void hostFlashMountFailSet(bool fail);
+
+// I2C bus; attach a simulated device at a 7 bit address (nullptr detaches). Stats count
+// every Wire transaction since the last reset.
+struct HostI2CStats {
+  uint32_t transactions = 0;
+  uint32_t nacks = 0;       // address or data NACKs, including reads that returned nothing
+  uint32_t timeouts = 0;    // transactions that waited out a held bus
+  uint64_t bytes = 0;
+  uint64_t busMicros = 0;   // time on the bus, timeouts included
+};
+void hostI2CAttach(uint8_t address, I2CDevice *device);
+const HostI2CStats &hostI2CStats();
+void hostI2CStatsReset();
+// the bus pins given to Wire.begin(), driven as GPIO by a bus clear: SDA reads LOW while a
+// device holds it, and each rising SCL edge clocks the attached devices (I2CDevice::i2cClock())
+bool hostI2CPinRead(uint8_t pin, int &level);
+bool hostI2CPinWrite(uint8_t pin, uint8_t level);
+
+// touchscreen; queues one press at raw XPT2046 coordinates, consumed by getPoint(), now
+// or from a time on the virtual clock; hostTouchClear() drops the queued presses
+void hostTouchPress(uint16_t rawX, uint16_t rawY);
+void hostTouchPressAt(uint16_t rawX, uint16_t rawY, uint64_t atMicros);
+void hostTouchClear();
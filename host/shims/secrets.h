@@ -0,0 +1,42 @@
+/*
+  Project:		Powered Air Quality
+  Description:	placeholder credentials for the host build; see secrets_template.h
+
+  Endpoints point at localhost so nothing leaves the machine running the host build.
+*/
+
+#pragma once
+
+#include <WString.h>
+
+// Configuration Step 1: default device latitude, longitude, altitude
+const String kDefaultAltitude = "0";
+const String kDefaultLatitude = "47.6062";
+const String kDefaultLongitude = "-122.3321";
+
+// Configuration Step 2: Open Weather Map credential
+const String OWMKey = "host-owm-key";
+
+// Configuration Step 3: default endpoint path
+const String kDefaultSite = "host";
+const String kDefaultLocation = "indoor";
+const String kDefaultRoom = "lab";
+
+// Configuration Step 4: default MQTT broker information
+const String kDefaultMQTTBroker = "127.0.0.1";
+const String kDefaultMQTTPort = "1883";
+const String kDefaultMQTTUser = "host";
+const String kDefaultMQTTPassword = "host";
+
+// Configuration Step 5: default Influxdb connection parameters
+const String kDefaultInfluxAddress = "127.0.0.1";
+const String kDefaultInfluxPort = "8086";
+const String kDefaultInfluxOrg = "host";
+const String kDefaultInfluxBucket = "paq";
+const String kDefaultInfluxEnvMeasurement = "weather";
+const String kDefaultInfluxDevMeasurement = "device";
+const String influxKey = "host-influx-token";
+
+// Configuration Step 6: ThingSpeak channel parameters
+#define THINGS_CHANID 1234567
+#define THINGS_APIKEY "HOST-THINGSPEAK-KEY"
@@ -0,0 +1,9 @@
+/*
+  Project:      Powered Air Quality
+  Description:  compiles powered_air_quality.ino as C++ for the host build
+*/
+
+#include <Arduino.h>
+#include "sketch_prototypes.h"
+
+#include "../powered_air_quality.ino"
@@ -0,0 +1,100 @@
+/*
+  Project:      Powered Air Quality
+  Description:  function prototypes for powered_air_quality.ino in the host build
+*/
+
+#ifndef SKETCH_PROTOTYPES_H
+  #define SKETCH_PROTOTYPES_H
+
+  #include <Arduino.h>
+
+  // the Arduino builder generates these from the sketch; keep in step with it
+  class WiFiManager;
+  struct UIEvent;
+  struct ConfigSnapshot;
+
+  void setup();
+  void loop();
+  void screenUpdate(uint8_t screenCurrent);
+  void screenHelperAlert(const String &messageText, uint16_t fgColor, uint16_t bgColor, uint16_t borderColor);
+  bool sampleEvaluate();
+  void samplePost(uint8_t& numSamples);
+  uint8_t networkRSSISimulate();
+  void networkWiFiManagerBuildParameters();
+  void networkWiFiManagerRefreshParameterValues();
+  void networkWiFiMgrSaveParamsCallback();
+  void networkWiFiMgrAPCallback(WiFiManager *myWiFiManager);
+  bool networkWiFiManagerOpen();
+  void networkWiFiManagerSaveParameterValues();
+  void networkStartWiFiMgrPortal();
+  uint8_t networkRSSIRead();
+  void networkDisconnect();
+  bool nvconfigRead();
+  void nvconfigDefaultsLoad();
+  void nvconfigWrite(const ConfigSnapshot& config);
+  void deviceErasePrefsAndReboot();
+  void checkButtonPress();
+  uint8_t taskAdd(const char* name, void (*function)(), uint32_t periodMS);
+  void schedulerTasksAdd();
+  void workerTasksAdd();
+  void workerSetup();
+  void workerLoop();
+  void loopTimingReceive();
+  void configSnapshotTake(ConfigSnapshot& config);
+  void configSend();
+  void configReceive();
+  bool workerResultsShow();
+  void uiEventShow(const UIEvent& event);
+  void uiEventSend(uint8_t type);
+  void samplePublish();
+  void taskAlertEndRun();
+  void taskPortalTimeoutRun();
+  void taskSampleRun();
+  void taskSensorPollRun();
+  void taskSensorRecoverRun();
+  void taskPMAcquireRun();
+  void loopTimingSend();
+  void taskScreenSaverRun();
+  void taskReportRun();
+  void taskOWMRun();
+  void sampleStep();
+  void sampleAlign();
+  void samplePeriodSet(uint32_t periodMS);
+  bool sensorReadDue([[maybe_unused]] uint32_t timeLastReadMS, [[maybe_unused]] uint32_t readMinMS);
+  void alertStart(uint32_t lengthMS);
+  void OWMForecastSimulate();
+  boolean OWMForecastRead();
+  void OWMAirPollutionSimulate();
+  bool OWMAirPollutionRead();
+  bool sensorInit();
+  uint8_t sensorRead();
+  bool sensorWarmingUp([[maybe_unused]] uint8_t channel);
+  void sensorWarmupStart(uint8_t sensor);
+  bool sensorBusClear();
+  uint32_t sensorRecoverStep();
+  bool sensorSEN54Init();
+  bool sensorSEN5xStart();
+  void sensorSEN54Simulate(float& simulatedPM25, float& simulatedVOCIndex);
+  bool sensorSEN554Read();
+  bool sensorSCD4xInit();
+  bool sensorSCD4xConfigure();
+  bool sensorSCD4xPeriodicStart();
+  void sensorSCD4xSimulate(uint8_t mode, uint8_t cycles, float& simulatedTempF, float& simulatedHumidity,
+    uint16_t& simulatedCO2);
+  void sensorSCD4xSimulate(float& simulatedTempF, float& simulatedHumidity, uint16_t& simulatedCO2);
+  uint8_t sensorSCD4xRead();
+  uint16_t sensorCommandSend(uint8_t address, uint16_t command);
+  void sensorSEN5xAcquire();
+  void sensorSEN5xFilter(float pm25, float VOCIndex);
+  String deviceGetID(String prefix);
+  void deviceRestart();
+  void textSplitTwoLines(const String &s, String &line1, String &line2, uint16_t maxWidthPixels);
+  float pm25toAQI_US(float pm25);
+  float fmap(float x, float xmin, float xmax, float ymin, float ymax);
+  float randomFloatRange(uint16_t min, uint16_t max);
+  void alertHandle();
+  uint16_t getWarningColor(uint8_t datatype, float datavalue);
+  uint16_t getWarningTextColor(uint8_t datatype, float datavalue);
+  void debugMessage(String messageText, uint8_t messageLevel);
+
+#endif  // #ifdef SKETCH_PROTOTYPES_H
@@ -0,0 +1,14 @@
+/*
+  Project:      Powered Air Quality
+  Description:  pass/fail checks for the host tools (see test_check.h)
+*/
+
+#include "test_check.h"
+
+#include <cstdio>
+
+bool check(bool ok, const char *what)
+{
+  if (!ok) printf("FAIL: %s\n", what);
+  return ok;
+}
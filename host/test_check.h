@@ -0,0 +1,13 @@
+/*
+  Project:      Powered Air Quality
+  Description:  pass/fail checks for the host tools (paq_sample_rate, paq_history, paq_sample_log,
+                paq_extrema_bench)
+*/
+
+#ifndef TEST_CHECK_H
+  #define TEST_CHECK_H
+
+  // prints "FAIL: what" unless ok; returns ok so a tool can and checks into its result
+  bool check(bool ok, const char *what);
+
+#endif  // #ifdef TEST_CHECK_H
@@ -0,0 +1,131 @@
+/*
+  Project Name:   Powered Air Quality
+  Description:    loop() phase latency histograms (see loop_timing.h)
+*/
+
+#include "Arduino.h"
+
+#include "loop_timing.h"
+
+const char* const loopPhaseName[kLoopPhaseCount] = {"alerts", "portal", "touch", "button", "sensor", "screensaver",
+  "network"};
+
+namespace {
+  LoopPhaseTiming phases[kLoopPhaseCount];
+  LoopTimingWorst worst = {0, 0, "", 0};
+
+  uint8_t loopCore = 1;         // loopTimingStart()'s; calls from the other core are ignored
+  uint32_t phaseStartUS = 0;    // current phase
+  uint32_t stepStartUS = 0;     // current named step within it
+  uint32_t longestStepUS = 0;
+  const char* longestStep = nullptr;
+
+  uint8_t bucketOf(uint32_t us)
+  {
+    const uint8_t bucket = (us < 2) ? 0 : (uint8_t)(31 - __builtin_clz(us));
+    return (bucket < kLoopTimingBuckets) ? bucket : kLoopTimingBuckets - 1;
+  }
+}
+
+void loopTimingStart()
+{
+  loopCore = xPortGetCoreID();
+  phaseStartUS = stepStartUS = micros();
+  longestStepUS = 0;
+  longestStep = nullptr;
+}
+
+void loopTimingCause(const char* cause)
+{
+  if (xPortGetCoreID() != loopCore) return;
+  const uint32_t nowUS = micros();
+  if (nowUS - stepStartUS >= longestStepUS) {
+    longestStepUS = nowUS - stepStartUS;
+    longestStep = cause;
+  }
+  stepStartUS = nowUS;
+}
+
+void loopTimingPhaseEnd(uint8_t phase)
+{
+  if (xPortGetCoreID() != loopCore) return;
+  const uint32_t nowUS = micros();
+  const uint32_t durationUS = nowUS - phaseStartUS;
+  // time after the last named step belongs to the phase itself
+  if (nowUS - stepStartUS >= longestStepUS) longestStep = loopPhaseName[phase];
+
+  LoopPhaseTiming& timing = phases[phase];
+  timing.histogram[bucketOf(durationUS)]++;
+  timing.count++;
+  if (durationUS >= timing.maxUS) {
+    timing.maxUS = durationUS;
+    timing.maxCause = longestStep;
+  }
+  if (durationUS >= worst.durationUS) {
+    worst = {durationUS, phase, longestStep, millis()};
+  }
+
+  phaseStartUS = stepStartUS = nowUS;
+  longestStepUS = 0;
+  longestStep = nullptr;
+}
+
+uint8_t loopTimingCore()
+{
+  return loopCore;
+}
+
+void loopTimingReset()
+{
+  for (LoopPhaseTiming& timing : phases) timing = LoopPhaseTiming();
+}
+
+const LoopPhaseTiming& loopTimingPhase(uint8_t phase)
+{
+  return phases[phase];
+}
+
+uint32_t loopTimingPercentileUS(uint8_t phase, float fraction)
+{
+  return loopTimingPercentileUS(phases[phase], fraction);
+}
+
+uint32_t loopTimingPercentileUS(const LoopPhaseTiming& timing, float fraction)
+{
+  if (!timing.count) return 0;
+  const uint32_t rank = (uint32_t)ceilf(fraction * timing.count);
+  uint32_t seen = 0;
+  for (uint8_t bucket = 0; bucket < kLoopTimingBuckets; bucket++) {
+    seen += timing.histogram[bucket];
+    if (seen >= rank && seen) {
+      const uint32_t upperUS = (bucket == kLoopTimingBuckets - 1) ? timing.maxUS : (2UL << bucket) - 1;
+      return (upperUS < timing.maxUS) ? upperUS : timing.maxUS;
+    }
+  }
+  return timing.maxUS;
+}
+
+const LoopTimingWorst& loopTimingWorst()
+{
+  return worst;
+}
+
+void loopTimingSnapshotTake(LoopTimingSnapshot& snapshot)
+{
+  for (uint8_t phase = 0; phase < kLoopPhaseCount; phase++) snapshot.phases[phase] = phases[phase];
+  snapshot.worst = worst;
+}
+
+String loopTimingReport()
+{
+  String report = "loop() phase timing since last report (us): phase, runs, p50, p99, max (cause)";
+  for (uint8_t phase = 0; phase < kLoopPhaseCount; phase++) {
+    const LoopPhaseTiming& timing = phases[phase];
+    report += String("\n  ") + loopPhaseName[phase] + ", " + timing.count + ", " + loopTimingPercentileUS(phase, 0.5f)
+      + ", " + loopTimingPercentileUS(phase, 0.99f) + ", " + timing.maxUS
+      + (timing.count ? String(" (") + timing.maxCause + ")" : String());
+  }
+  report += String("\n  worst since boot: ") + worst.durationUS + " us in " + loopPhaseName[worst.phase] + " ("
+    + worst.cause + ") at " + worst.atMS + " ms";
+  return report;
+}
@@ -0,0 +1,58 @@
+/*
+  Project:      Powered Air Quality
+  Description:  loop() phase latency histograms and worst case tracking
+*/
+
+#ifndef LOOP_TIMING_H
+  #define LOOP_TIMING_H
+
+  #include <Arduino.h>
+
+  // the phases of loop(), in order
+  enum loopPhase : uint8_t { phaseAlerts, phasePortal, phaseTouch, phaseButton, phaseSensor, phaseScreenSaver,
+    phaseNetwork, kLoopPhaseCount };
+  extern const char* const loopPhaseName[kLoopPhaseCount];
+
+  constexpr uint8_t kLoopTimingBuckets = 26; // last bucket starts at 2^25 us, 33.5 s
+
+  // histogram bucket 0 is < 2us, bucket b holds [2^b, 2^(b+1)) us, the last is open ended
+  struct LoopPhaseTiming {
+    uint32_t histogram[kLoopTimingBuckets];
+    uint32_t count;
+    uint32_t maxUS;
+    const char* maxCause;
+  };
+
+  struct LoopTimingWorst {
+    uint32_t durationUS;
+    uint8_t phase;
+    const char* cause;
+    uint32_t atMS;      // millis() when the phase ended
+  };
+
+  // loop()'s figures, copied for a report on the other core, see loopTimingQueue in dual_core.h
+  struct LoopTimingSnapshot {
+    LoopPhaseTiming phases[kLoopPhaseCount];
+    LoopTimingWorst worst;
+    float idlePercent;  // loop()'s scheduler's, see schedulerIdlePercent()
+  };
+
+  void loopTimingStart();
+  // ignored from the worker core
+  void loopTimingPhaseEnd(uint8_t phase);
+  // names the step just done; the longest step of a phase's longest run is its cause
+  void loopTimingCause(const char* cause);
+  void loopTimingReset();
+  // the core loop() runs on, as of the last loopTimingStart()
+  uint8_t loopTimingCore();
+
+  const LoopPhaseTiming& loopTimingPhase(uint8_t phase);
+  // duration below which fraction of the phase's runs fell, at bucket resolution
+  uint32_t loopTimingPercentileUS(uint8_t phase, float fraction);
+  uint32_t loopTimingPercentileUS(const LoopPhaseTiming& timing, float fraction);
+  const LoopTimingWorst& loopTimingWorst();
+  // from loop()'s core; idlePercent is left to the caller
+  void loopTimingSnapshotTake(LoopTimingSnapshot& snapshot);
+  String loopTimingReport();
+
+#endif  // #ifdef LOOP_TIMING_H
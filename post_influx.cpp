@@ -11,22 +11,34 @@
 #include "powered_air_quality.h"  // overall header info for Powered Air Quality
 #include "secrets.h"              // private credentials for network, MQTT, weather provider
 #include "data.h"                 // Overall data and metadata naming scheme
+#include "loop_timing.h"          // loop() phase latency, reported with device data
+#include "blocking_budget.h"      // blocking budget, also reported with device data
+#include "scheduler.h"            // idle time, also reported with device data
+#include "dual_core.h"            // worker task
+#include "sample_rate.h"          // sample durations, also reported with device data
+#include "sensor_health.h"        // sensor health, also reported with device data
+#include "sample_history.h"       // the graph window's extrema, reported with environment data
+#include "history_tiers.h"        // the last 24 hours, reported with environment data
 
 // Only compile if InfluxDB enabled
 #ifdef INFLUX
   #include <InfluxDbClient.h>
 
-  // Shared helper function
+  // Shared helper function and globals
   extern void debugMessage(String messageText, uint8_t messageLevel);
+  extern LoopTimingSnapshot loopTimingReported;
 
   // Post data to Influx DB using the connection established during setup
-  boolean post_influx(float temperatureF, float humidity, uint16_t co2, float pm25, float vocIndex, uint8_t rssi)
+  // A value with no readings over the report interval (NAN) is left out
+  boolean post_influx(float temperatureF, float humidity, float co2, float pm25, float vocIndex, uint8_t rssi)
   {
+    BudgetScope budget(budgetInflux, "post_influx");
     bool success = false;
 
     // InfluxDB client instance
     String influxURL = "http://" + influxdbConfig.host + ":" + influxdbConfig.port;
     InfluxDBClient dbclient(influxURL, influxdbConfig.org, influxdbConfig.bucket, influxKey);
+    dbclient.setHTTPOptions(HTTPOptions().httpReadTimeout(timeNetworkReadMS));
 
     // InfluxDB Data point, binds to InfluxDB 'measurement' to use for data. See config.h for value used
     Point dbenvdata(influxdbConfig.envMeasurement);
@@ -58,11 +70,34 @@
 
       dbenvdata.clearFields();
       // Report sensor readings
-      dbenvdata.addField(VALUE_KEY_PM25, pm25);
-      dbenvdata.addField(VALUE_KEY_TEMPERATURE, temperatureF);
-      dbenvdata.addField(VALUE_KEY_HUMIDITY, humidity);
-      dbenvdata.addField(VALUE_KEY_VOC, vocIndex);
-      dbenvdata.addField(VALUE_KEY_CO2, co2);
+      if (!isnan(pm25)) dbenvdata.addField(VALUE_KEY_PM25, pm25);
+      if (!isnan(temperatureF)) dbenvdata.addField(VALUE_KEY_TEMPERATURE, temperatureF);
+      if (!isnan(humidity)) dbenvdata.addField(VALUE_KEY_HUMIDITY, humidity);
+      if (!isnan(vocIndex)) dbenvdata.addField(VALUE_KEY_VOC, vocIndex);
+      if (!isnan(co2)) dbenvdata.addField(VALUE_KEY_CO2, (uint16_t)co2);
+      // the range over the graphs' window
+      const HistoryRange co2Window = sampleHistory.extrema(historyCO2);
+      const HistoryRange pm25Window = sampleHistory.extrema(historyPM25);
+      if (co2Window.valid) {
+        dbenvdata.addField(String(VALUE_KEY_CO2) + "_min", (uint16_t)co2Window.minValue);
+        dbenvdata.addField(String(VALUE_KEY_CO2) + "_max", (uint16_t)co2Window.maxValue);
+      }
+      if (pm25Window.valid) {
+        dbenvdata.addField(String(VALUE_KEY_PM25) + "_min", pm25Window.minValue);
+        dbenvdata.addField(String(VALUE_KEY_PM25) + "_max", pm25Window.maxValue);
+      }
+      // the last 24 hours, from the history tiers' running totals
+      HistorySpan co2Day, pm25Day;
+      if (historyTiers.window(kTierDay, historyCO2, millis(), co2Day)) {
+        dbenvdata.addField(String(VALUE_KEY_CO2) + "_24h_min", (uint16_t)co2Day.minValue);
+        dbenvdata.addField(String(VALUE_KEY_CO2) + "_24h_max", (uint16_t)co2Day.maxValue);
+        dbenvdata.addField(String(VALUE_KEY_CO2) + "_24h_mean", co2Day.mean);
+      }
+      if (historyTiers.window(kTierDay, historyPM25, millis(), pm25Day)) {
+        dbenvdata.addField(String(VALUE_KEY_PM25) + "_24h_min", pm25Day.minValue);
+        dbenvdata.addField(String(VALUE_KEY_PM25) + "_24h_max", pm25Day.maxValue);
+        dbenvdata.addField(String(VALUE_KEY_PM25) + "_24h_mean", pm25Day.mean);
+      }
       // Write point to InfluxDB host
       if (dbclient.writePoint(dbenvdata)) {
         debugMessage(String("InfluxDB environment update success"), 1);
@@ -77,6 +112,36 @@
       dbdevdata.clearFields();
       // Report device readings
       dbdevdata.addField(VALUE_KEY_RSSI, rssi);
+      // loop() phase latency over the report interval, as of loop()'s last snapshot
+      for (uint8_t phase = 0; phase < kLoopPhaseCount; phase++) {
+        const String key = String(VALUE_KEY_LOOP) + "_" + loopPhaseName[phase];
+        dbdevdata.addField(key + "_p50_us", loopTimingPercentileUS(loopTimingReported.phases[phase], 0.5f));
+        dbdevdata.addField(key + "_p99_us", loopTimingPercentileUS(loopTimingReported.phases[phase], 0.99f));
+        dbdevdata.addField(key + "_max_us", loopTimingReported.phases[phase].maxUS);
+      }
+      dbdevdata.addField(String(VALUE_KEY_LOOP) + "_idle_pct", loopTimingReported.idlePercent);
+      if (dualCoreSplit())
+        dbdevdata.addField(String(VALUE_KEY_WORKER) + "_idle_pct", schedulerIdlePercent());
+      // sample start to completion over the report interval
+      const SampleTimeStats& sampleTime = sampleTimeStats();
+      dbdevdata.addField(String(VALUE_KEY_SAMPLE) + "_avg_ms", sampleTime.samples ? sampleTime.totalMS / sampleTime.samples : 0);
+      dbdevdata.addField(String(VALUE_KEY_SAMPLE) + "_max_ms", sampleTime.maxMS);
+      // sensor health now, and read failures and recoveries since boot
+      for (uint8_t sensor = 0; sensor < kSensorCount; sensor++) {
+        const String key = sensorName[sensor];
+        dbdevdata.addField(key + "_health", sensorHealthStateName[sensorHealth(sensor).state]);
+        dbdevdata.addField(key + "_read_failures", sensorHealth(sensor).readFailures);
+        dbdevdata.addField(key + "_recoveries", sensorHealth(sensor).recoveries);
+      }
+      dbdevdata.addField(String(VALUE_KEY_LOOP) + "_worst_us", loopTimingReported.worst.durationUS);
+      dbdevdata.addField(String(VALUE_KEY_LOOP) + "_worst_cause", String(loopPhaseName[loopTimingReported.worst.phase])
+        + ":" + loopTimingReported.worst.cause);
+      // blocking budget overruns and worst spans since boot
+      for (uint8_t subsystem = 0; subsystem < kBudgetCount; subsystem++) {
+        const String key = String(VALUE_KEY_BUDGET) + "_" + budgetName[subsystem];
+        dbdevdata.addField(key + "_overruns", budgetStats(subsystem).overruns);
+        dbdevdata.addField(key + "_worst_ms", budgetStats(subsystem).worstMS);
+      }
       // Write point via connection to InfluxDB host
       if (dbclient.writePoint(dbdevdata)) {
         debugMessage(String("InfluxDB device update success"), 1);
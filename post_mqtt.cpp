@@ -29,6 +29,7 @@
     }
     else {
       mqtt.setServer(mqttBrokerConfig.host.c_str(), mqttBrokerConfig.port);
+      mqtt.setSocketTimeout(timeNetworkReadMS / 1000);
       if (mqttBrokerConfig.user.length() > 0) {
         connected = mqtt.connect(endpointPath.deviceID.c_str(), mqttBrokerConfig.user.c_str(), mqttBrokerConfig.password.c_str());
       }
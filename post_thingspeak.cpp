@@ -9,13 +9,14 @@
 #include "config.h"               // hardware and internet configuration parameters
 #include "powered_air_quality.h"  // PAQ main header
 #include "secrets.h"              // ThingSpeak private credentials
+#include "blocking_budget.h"
 
 #ifdef THINGSPEAK
   // Shared helper function(s)
   extern void debugMessage(String messageText, uint8_t messageLevel);
 
   bool post_thingspeak(float pm25, float co2, float temperatureF, float humidity, float voc, float aqi) {  
-    
+    BudgetScope budget(budgetThingSpeak, "post_thingspeak");
     HTTPClient http;
 
     // explicitly use unencrypted HTTP on port 80
@@ -25,21 +26,23 @@
         debugMessage("ThingSpeak HTTP initialization failed", 1);
         return false;
     }
+    http.setConnectTimeout(timeNetworkReadMS);
+    http.setTimeout(timeNetworkReadMS);
 
     http.addHeader("Content-Type","application/x-www-form-urlencoded");
 
     String requestBody;
     requestBody.reserve(256);
 
-    requestBody =
-      "api_key=" + String(THINGS_APIKEY) +
-      "&field1=" + String(pm25) +
-      "&field2=" + String(co2) +
-      "&field3=" + String(temperatureF) +
-      "&field4=" + String(humidity) +
-      "&field5=" + String(voc) +
-      "&field7=" + String(aqi) +
-      "&field8=" + String(endpointPath.deviceID);
+    // a value with no readings over the report interval (NAN) is left out
+    requestBody = "api_key=" + String(THINGS_APIKEY);
+    if (!isnan(pm25)) requestBody += "&field1=" + String(pm25);
+    if (!isnan(co2)) requestBody += "&field2=" + String((uint16_t)co2);
+    if (!isnan(temperatureF)) requestBody += "&field3=" + String(temperatureF);
+    if (!isnan(humidity)) requestBody += "&field4=" + String(humidity);
+    if (!isnan(voc)) requestBody += "&field5=" + String(voc);
+    if (!isnan(aqi)) requestBody += "&field7=" + String(aqi);
+    requestBody += "&field8=" + String(endpointPath.deviceID);
 
     int httpCode = http.POST(requestBody);
 
@@ -49,7 +52,13 @@
       return false;
     }
 
-    String response = http.getString();
+    // up to its Content-Length when there is one, reading to the end of the stream waits out
+    // its timeout
+    BudgetStream body(budgetThingSpeak, http.getStream());
+    String response;
+    char c;
+    for (int left = http.getSize(); left && body.readBytes(&c, 1) == 1; left--)
+      response += c;
     http.end();
 
     // ThingSpeak returns HTTP 200 and the new entry ID
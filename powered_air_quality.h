@@ -29,6 +29,14 @@
   #define TEMP_DATA 5  // Temperature data 
   #define HUM_DATA  6  // Humidity data
 
+// Bit flags for the fields a sample accepted, see sensorRead(). A reading that fails range
+// validation skips only its own field, the sample keeps the rest
+#define SAMPLE_VALID_TEMP 0b00001
+#define SAMPLE_VALID_HUM  0b00010
+#define SAMPLE_VALID_CO2  0b00100
+#define SAMPLE_VALID_PM25 0b01000
+#define SAMPLE_VALID_VOC  0b10000
+
 // Use bit flags to aggregate overall daily weather conditions, only used internally
 #define WX_CLEAR  0b0001
 #define WX_CLOUDY 0b0010
@@ -9,6 +9,17 @@
 #include "powered_air_quality.h"  // global data structures
 #include "secrets.h"              // private credentials for network, MQTT
 #include "data.h"
+#include "sensor_trace.h"        // raw sensor reading record/replay
+#include "loop_timing.h"         // loop() phase latency histograms
+#include "blocking_budget.h"     // per subsystem blocking budgets and task watchdog
+#include "scheduler.h"           // deadline scheduler for loop()
+#include "dual_core.h"           // sensing and reporting on the other core
+#include "sample_rate.h"          // adaptive sample pace, time weighted averages
+#include "decimation.h"           // filters the SEN5x readings between samples
+#include "sensor_health.h"        // per sensor health and recovery in place
+#include "sample_history.h"       // fixed point sample history for the graphs
+#include "history_tiers.h"        // minute, 5 minute and hourly history
+#include "sample_log.h"           // samples on flash, the graphs' history across reboots
 
 // #include <math.h>
 #include <HTTPClient.h>           // used to access Open Weather Map
@@ -108,7 +119,7 @@ XPT2046_Touchscreen touchscreen(pinTouchCS,pinTouchIRQ);
 #endif
 
 #ifdef INFLUX
-  extern bool post_influx(float temperatureF, float humidity, uint16_t co2, float pm25, float vocIndex, uint8_t rssi);
+  extern bool post_influx(float temperatureF, float humidity, float co2, float pm25, float vocIndex, uint8_t rssi);
 #endif
 
 #ifdef MQTT
@@ -121,7 +132,7 @@ XPT2046_Touchscreen touchscreen(pinTouchCS,pinTouchIRQ);
   extern bool mqttPublishValue(String key, const String& payload);
 
   #ifdef HASSIO_MQTT
-    extern bool hassio_mqtt_publish(float pm25, float co2, float temperatureF, float humidity, float aqi);
+    extern bool hassio_mqtt_publish(float pm25, float co2, float temperatureF, float humidity, float vocIndex, float aqi);
   #endif
 #endif
 
@@ -132,14 +143,56 @@ OpenWeatherMapAirQuality owmAirQuality;
 SiteForecast owmSiteForecast;
 influxConfig influxdbConfig; // available globally for nvconfig use
 MqttConfig mqttBrokerConfig; // available globally for nvconfig use
+// loop()'s copy of the settings above, which the web portal shows and saves; the worker reports
+// with the globals, updated between its passes, see configReceive()
+ConfigSnapshot portalConfig;
 
 // Utility class used to streamline accumulating sensor values, averages, min/max &c.  Each
 // instance contains storage to retain points for subsequent processing, which are used
 // here to graph recent data. The size of that retatined data is based on the
 // kSampleCapacity value defined in config.h.
 Measure<kSampleCapacity> totalTemperatureF, totalHumidity, totalCO2, totalVOCIndex, totalPM25;
+// samplePost()'s averages over the report interval, weighted by how long each reading held
+// as samples can be unevenly spaced (see sample_rate.h)
+TimeWeightedMean meanTemperatureF, meanHumidity, meanCO2, meanVOCIndex, meanPM25;
+// SEN5x readings between samples, see taskPMAcquireRun()
+DecimationFilter filterPM25, filterVOCIndex;
+// the graphs' longer view, appended after each sample
+SampleHistory sampleHistory;
+// minimum, maximum and mean by minute, 5 minutes and hour, fed with the Measures above
+HistoryTiers historyTiers;
 
 uint32_t timeLastReportMS = 0;  // timestamp for last report to network endpoints
+uint32_t timeLastSampleMS = -(timeSensorSampleMS); // forces immediate sample in loop()
+bool sensorReadPending = false; // a sample is in progress, see sensorRead()
+uint8_t sensorRecovering = kSensorCount; // the sensor a recovery attempt is in progress for, see sensorRecoverStep()
+uint8_t sensorRecoverStage = 0;  // its next step
+uint32_t timeSensorPollMS = 0;  // when loop() next advances the sample in progress
+uint32_t timeSampleStartMS = 0; // when the sample in progress started
+uint32_t timeSCD4xReadyMS = 0;  // when a read that waited found the SCD4x measurement, else 0
+bool scd4xFirstShot = false;    // the SCD4x first measures single shot, see sensorSCD4xConfigure()
+uint32_t timeSCD4xFirstShotMS = 0;
+uint32_t timeLastSCD4xReadMS = 0, timeLastSEN5xReadMS = 0; // last successful reads, see sensorReadDue()
+uint32_t timeChannelInitMS[kSensorChannelCount] = {}; // warm-up counts from here, see sensorWarmingUp()
+bool channelMeasured[kSensorChannelCount] = {};      // a valid reading since then ended the warm-up
+uint32_t timeLastInputMS = 0;   // timestamp for last user input (screensaver), set at end of setup()
+uint8_t numSamples = 0;         // Number of sensor readings over reporting interval
+uint8_t sampleValid = 0;        // SAMPLE_VALID_ flags of the fields the sample in progress accepted
+
+// loop()'s scheduler tasks, see schedulerTasksAdd(), and the worker's, see workerTasksAdd()
+uint8_t taskAlertEnd = kSchedulerTaskMax, taskPortalTimeout = kSchedulerTaskMax, taskScreenSaver = kSchedulerTaskMax;
+uint8_t taskSample = kSchedulerTaskMax, taskSensorPoll = kSchedulerTaskMax, taskReport = kSchedulerTaskMax,
+  taskOWM = kSchedulerTaskMax, taskPMAcquire = kSchedulerTaskMax, taskSensorRecover = kSchedulerTaskMax;
+
+// the worker's copy of loop()'s newest timing figures, which its reports include, see loopTimingReceive()
+LoopTimingSnapshot loopTimingReported = {{}, {0, 0, "", 0}, 0.0f};
+
+// Open Weather Map data is current, see taskOWMRun()
+bool owmAirQualityValid = false;
+bool owmForecastValid = false;
+
+// what the screens show, loop()'s copy of the worker's latest sample snapshot (see dual_core.h)
+SampleSnapshot screenData;
 
 // alert management
 uint32_t alertStartMS = 0;
@@ -147,12 +200,20 @@ uint32_t alertLengthMS = 0;
 bool alertScreen = false;
 bool alertSound = false;
 
+#ifdef HARDWARE_SIMULATE
+  // sensorSCD4xSimulate() mode and cycle count used by sensorSCD4xRead()
+  uint8_t simulateSCD4xMode = 1;
+  uint8_t simulateSCD4xCycles = 10;
+#endif
+
 void setup() {
-  // config Serial first for debugMessage()
-  #ifdef DEBUG
+  // config Serial first for debugMessage() and sensor trace lines
+  #if defined(DEBUG) || defined(SENSOR_TRACE)
     Serial.begin(115200);
     // wait for serial port connection
     while (!Serial);
+  #endif
+  #ifdef DEBUG
     // Display key configuration parameters
     debugMessage(String("Starting Powered Air Quality with ") + (timeSensorSampleMS/1000) + String(" second sample interval"),1);
     #if defined(MQTT) || defined(INFLUX) || defined(HASSIO_MQTT) || defined(THINGSPEAK)
@@ -187,56 +248,72 @@ void setup() {
   ledcAttach(pinAudio, audioFrequency, audioResolution);
 
   // get configuration data before calling sensorInit() to load altitude value
-  if(!nvconfigRead()) {
-    // no configuration parameters in non-volatile storage, so write defaults
+  const bool nvconfigFound = nvconfigRead();
+  if (!nvconfigFound)
     nvconfigDefaultsLoad();
-    nvconfigWrite();
-  }   
+  configSnapshotTake(portalConfig);
+  // no configuration parameters in non-volatile storage, so write defaults
+  if (!nvconfigFound)
+    nvconfigWrite(portalConfig);
+
+  // the graphs' history from before the reboot, before the worker starts appending to it
+  if (sampleLogBegin())
+    sampleLogRebuild(sampleHistory, timeLogRebuildMS);
+  debugMessage(sampleLogReport(),1);
 
   // initialize sensor(s)
-  if( !sensorInit()) {
-    // error often occurs after firmware flash/reset
+  // a sensor that fails, often after firmware flash/reset, recovers in place, see sensorRecoverStep()
+  const bool sensorInitFailed = !sensorInit();
+  if (sensorInitFailed) {
+    // ALERT: 5 second screen alert, timed once the alert end task is added below
+    alertScreen = true;
     display.loadFont(Roboto_Regular_24);
-    deviceReboot("Sensor failure, rebooting", 5000);
+    screenHelperAlert("Sensor failure, recovering",TFT_WHITE,TFT_BLACK,TFT_RED);
     display.unloadFont();
   }
   networkWiFiManagerOpen();
+  // after the (blocking) WiFiManager config portal, which can outlast the watchdog
+  budgetWatchdogBegin();
+  timeLastInputMS = millis();
+  schedulerTasksAdd();
+  if (sensorInitFailed) alertStart(5000);
+  // sensing and reporting on the other core, or in loop() if the worker task can't start
+  if (!dualCoreStart(workerSetup, workerLoop))
+    workerTasksAdd();
 }
 
 void loop() {
-  static uint8_t numSamples               = 0;  // Number of sensor readings over reporting interval
-  static uint32_t timeLastSampleMS        = -(timeSensorSampleMS); // forces immediate sample in loop() 
-  static uint32_t timeLastInputMS         = millis();  // timestamp for last user input (screensaver)
   uint16_t calibratedX, calibratedY;
 
   // order of operation
-  // 0 - update current alerts
-  // 1 - feed cycles to web portal
-  // 2 - handle touchscreen input
-  // 3 - handle button press
-  // 4 - read sensor
-  // 5 - update screen saver
-  // 6 - network endpoint(s) write?
-
-  // update current alerts
-  alertHandle();
+  // 0 - run the tasks that are due: alert end, web portal timeout, screen saver, loop timing,
+  //     see schedulerTasksAdd(); and, running single core, the worker's, see workerTasksAdd()
+  // 1 - show the worker's sample snapshots and alerts
+  // 2 - feed cycles to web portal
+  // 3 - handle touchscreen input
+  // 4 - handle button press
+  // 5 - idle until the next deadline, for at most timeLoopIdleMaxMS so input stays responsive
+  // each phase is timed, see loop_timing.h; tasks end their own phase
+  budgetWatchdogFeed();
+  loopTimingStart();
+
+  schedulerRun();
+
+  if (workerResultsShow())
+    loopTimingPhaseEnd(phaseSensor);
 
   // feed processor cycles to the web portal if needed
   if (wfm.getWebPortalActive()) {
     wfm.process();
+    loopTimingCause("wfm.process");
 
     if (saveWFMConfig) {
       networkWiFiManagerSaveParameterValues();
       saveWFMConfig = false;
       networkWiFiManagerRefreshParameterValues();
     }
-
-    if (wfmPortalRunning &&
-        millis() - wfmPortalStartMS > timeWebPortalTimeOutMS) {
-      wfm.stopWebPortal();
-      wfmPortalRunning = false;
-    }
   }
+  loopTimingPhaseEnd(phasePortal);
 
   // is there user input to process?
   bool touchEvent = false;
@@ -279,54 +356,390 @@ void loop() {
       screenCurrent = sMain;
     }
     screenUpdate(screenCurrent);
+    loopTimingCause("screenUpdate");
     timeLastInputMS = millis();
+    schedulerAt(taskScreenSaver, timeLastInputMS + timeScreenSaverStartMS + 1);
   }
+  loopTimingPhaseEnd(phaseTouch);
 
   // (reset) button press that needs to be handled?
   checkButtonPress();
+  loopTimingPhaseEnd(phaseButton);
 
-    // is it time to read the sensor?
-  if ((millis() - timeLastSampleMS) >= timeSensorSampleMS) {
-    // Read sensor(s)
-    if (sensorRead()) {
-      numSamples++;
-      // IMPROVEMENT: evaluate whether the screen actually needs updated based on changed data
-      screenUpdate(screenCurrent);
-      if (sampleEvaluate()) {
-        // ALERT: 5 second, sound, LED, and screen
-        alertLengthMS = 5000;
-        alertStartMS = millis();
-        alertScreen = true;
-        alertSound = true;
-        ledcWriteTone(pinAudio, audioFrequency);
-        display.loadFont(Roboto_Regular_24);
-        screenHelperAlert("CO2 rising rapidly", TFT_WHITE,TFT_BLACK,TFT_RED);
-        display.unloadFont();
-      }
-    }
-    else {
+  schedulerIdle(timeLoopIdleMaxMS);
+}
+
+uint8_t taskAdd(const char* name, void (*function)(), uint32_t periodMS)
+// schedulerAdd(), logging a full task table, which would leave the task never running
+{
+  const uint8_t task = schedulerAdd(name, function, periodMS);
+  if (task == kSchedulerTaskMax)
+    debugMessage(String("Scheduler task table full, ") + name + " not added",1);
+  return task;
+}
+
+void schedulerTasksAdd()
+// registers loop()'s time driven work with the scheduler; called at the end of setup()
+{
+  schedulerClear();
+  taskAlertEnd = taskAdd("alert end", taskAlertEndRun, 0);
+  taskPortalTimeout = taskAdd("portal timeout", taskPortalTimeoutRun, 0);
+  taskScreenSaver = taskAdd("screen saver", taskScreenSaverRun, 0);
+
+  schedulerAt(taskScreenSaver, timeLastInputMS + timeScreenSaverStartMS + 1);
+  if (alertLengthMS)
+    schedulerAt(taskAlertEnd, alertStartMS + alertLengthMS + 1);
+}
+
+void workerTasksAdd()
+// registers sensing and reporting with the calling core's scheduler, the worker task's, or
+// loop()'s when running single core
+{
+  // equal deadlines run in this order, e.g. a sample before the report due with it
+  #ifndef HARDWARE_SIMULATE
+    taskPMAcquire = taskAdd("pm acquire", taskPMAcquireRun, timeSEN5xAcquireMS);
+  #endif
+  taskSample = taskAdd("sample", taskSampleRun, timeSensorSampleMS);
+  taskSensorPoll = taskAdd("sensor poll", taskSensorPollRun, 0);
+  taskSensorRecover = taskAdd("sensor recover", taskSensorRecoverRun, 0);
+  taskReport = taskAdd("report", taskReportRun, timeReportMS);
+  taskOWM = taskAdd("owm", taskOWMRun, timeOWMRenewMS);
+
+  const uint32_t nowMS = millis();
+  sensorReadPending = false;       // sampling starts over, after a restart too
+  sensorRecovering = kSensorCount; // and a recovery attempt with the next sample
+  sensorRecoverStage = 0;
+  timeSCD4xReadyMS = 0;
+  timeLastSCD4xReadMS = nowMS - timeSCD4xReadMinMS;
+  timeLastSEN5xReadMS = nowMS - timeSEN5xReadMinMS;
+  sampleRateReset();
+  filterPM25.reset();
+  filterVOCIndex.reset();
+  schedulerAt(taskPMAcquire, nowMS);
+  schedulerAt(taskSample, nowMS);  // first sample right away
+  schedulerAt(taskReport, nowMS + timeReportMS);
+  schedulerAt(taskOWM, nowMS);
+}
+
+void workerSetup()
+// runs once in the worker task, on coreWorker
+{
+  schedulerClear();
+  workerTasksAdd();
+  budgetWatchdogAdd();
+}
+
+void workerLoop()
+// the worker task's loop(): its due tasks, then idle until the next deadline
+{
+  budgetWatchdogFeed();
+  loopTimingReceive();
+  configReceive();
+  schedulerRun();
+  // woken early by loop(), see dualCoreWorkerWake()
+  schedulerIdle(timeWorkerIdleMaxMS, true);
+}
+
+void loopTimingReceive()
+// keeps the newest of loop()'s timing figures for the worker's reports, see loopTimingSend()
+{
+  while (loopTimingQueue.pop(loopTimingReported));
+}
+
+void configSnapshotTake(ConfigSnapshot& config)
+// copies the settings the worker reports with; only before the worker starts, after that
+// loop() keeps its own in portalConfig
+{
+  config.altitude = hardwareData.altitude;
+  config.latitude = hardwareData.latitude;
+  config.longitude = hardwareData.longitude;
+  config.endpointPath = endpointPath;
+  config.mqttBrokerConfig = mqttBrokerConfig;
+  config.influxdbConfig = influxdbConfig;
+}
+
+void configSend()
+// hands the worker the settings saved in the web portal, see configReceive()
+{
+  if (!configQueue.push(portalConfig))
+    debugMessage("Config queue full, saved settings apply after a restart",1);
+  if (!dualCoreSplit())
+    configReceive();
+  dualCoreWorkerWake();
+}
+
+void configReceive()
+// applies the newest settings saved in the web portal, between the worker's passes so no
+// report is using the old ones
+{
+  ConfigSnapshot config;
+  bool received = false;
+  while (configQueue.pop(config))
+    received = true;
+  if (!received)
+    return;
+  hardwareData.altitude = config.altitude;
+  hardwareData.latitude = config.latitude;
+  hardwareData.longitude = config.longitude;
+  endpointPath = config.endpointPath;
+  mqttBrokerConfig = config.mqttBrokerConfig;
+  influxdbConfig = config.influxdbConfig;
+  debugMessage("Settings from the web portal applied",1);
+}
+
+bool workerResultsShow()
+// redraws the screen for the worker's newest sample snapshot and shows its alerts;
+// returns true if there was anything to show
+{
+  bool shown = false;
+  if (sampleQueue.pop(screenData)) {
+    // only the newest snapshot is drawn
+    while (sampleQueue.pop(screenData));
+    // IMPROVEMENT: evaluate whether the screen actually needs updated based on changed data
+    screenUpdate(screenCurrent);
+    loopTimingCause("screenUpdate");
+    // the worker's next report includes them, so they needn't wake it
+    loopTimingSend();
+    shown = true;
+  }
+  UIEvent event;
+  while (uiEventQueue.pop(event)) {
+    uiEventShow(event);
+    shown = true;
+  }
+  return shown;
+}
+
+void uiEventShow(const UIEvent& event)
+{
+  switch (event.type) {
+    case uiEventCO2Rising:
+      // ALERT: 5 second, sound, LED, and screen
+      alertStart(5000);
+      alertScreen = true;
+      alertSound = true;
+      ledcWriteTone(pinAudio, audioFrequency);
+      display.loadFont(Roboto_Regular_24);
+      screenHelperAlert("CO2 rising rapidly", TFT_WHITE,TFT_BLACK,TFT_RED);
+      display.unloadFont();
+      break;
+    case uiEventReadFail:
       // ALERT: 5 second screen alert, no sound or LEDs
       alertScreen = true;
-      alertLengthMS = 5000;
-      alertStartMS = millis();
+      alertStart(5000);
       display.loadFont(Roboto_Regular_24);
       screenHelperAlert("Sensor read fail", TFT_WHITE,TFT_BLACK,TFT_YELLOW);
       display.unloadFont();
-    }
-    // Save last sample time
-    timeLastSampleMS = millis();
+      break;
+    case uiEventNoSamples:
+      // ALERT: 5 second, sound, LED, and screen
+      alertStart(5000);
+      alertScreen = true;
+      alertSound = true;
+      ledcWriteTone(pinAudio, audioFrequency);
+      display.loadFont(Roboto_Regular_24);
+      screenHelperAlert("No samples available", TFT_WHITE,TFT_BLACK,TFT_RED);
+      display.unloadFont();
+      break;
+    case uiEventReported:
+      // loop()'s histograms and scheduler statistics cover one report interval, like the worker's
+      debugMessage(loopTimingReport(),1);
+      loopTimingReset();
+      if (dualCoreSplit()) {
+        debugMessage(schedulerReport(),1);
+        schedulerStatsReset();
+      }
+      break;
   }
+}
+
+void uiEventSend(uint8_t type)
+// from the worker, see uiEventShow()
+{
+  if (!uiEventQueue.push({type}))
+    debugMessage("UI event queue full, event dropped",1);
+}
+
+void samplePublish()
+// sends loop() a snapshot of everything the screens show, see dual_core.h
+{
+  SampleSnapshot snapshot;
+  snapshot.temperatureF = totalTemperatureF;
+  snapshot.humidity = totalHumidity;
+  snapshot.co2 = totalCO2;
+  snapshot.vocIndex = totalVOCIndex;
+  snapshot.pm25 = totalPM25;
+  snapshot.owmAirQuality = owmAirQuality;
+  snapshot.owmSiteForecast = owmSiteForecast;
+  snapshot.owmAirQualityValid = owmAirQualityValid;
+  snapshot.owmForecastValid = owmForecastValid;
+  snapshot.lastReportMS = timeLastReportMS;
+  snapshot.historyEnd = sampleHistory.appended();
+  for (uint8_t channel = 0; channel < kHistoryChannelCount; channel++)
+    snapshot.historyRange[channel] = sampleHistory.extrema(channel);
+  for (uint8_t channel = 0; channel < kSensorChannelCount; channel++)
+    snapshot.warmingUp[channel] = sensorWarmingUp(channel);
+  if (!sampleQueue.push(snapshot))
+    debugMessage("Sample queue full, snapshot dropped",1);
+}
+
+void taskAlertEndRun()
+{
+  alertHandle();
+  loopTimingPhaseEnd(phaseAlerts);
+}
 
-  // is it time to enable the screensaver?
-  if ((millis() - timeLastInputMS) > timeScreenSaverStartMS) {
-    ledcWrite(TFT_BL, screenBLLow);
+void taskPortalTimeoutRun()
+{
+  if (wfmPortalRunning) {
+    wfm.stopWebPortal();
+    wfmPortalRunning = false;
   }
+  loopTimingPhaseEnd(phasePortal);
+}
 
-  // is it time to write to the network endpoints?
-  if ((millis() - timeLastReportMS) >= timeReportMS) {
-    samplePost(numSamples);
-    timeLastReportMS = millis();
+void taskSampleRun()
+// starts a sample every timeSensorSampleMS, or as samplePeriodSet() paces it, on schedule
+// however long the reads take
+{
+  if (sensorReadPending)
+    debugMessage("Previous sample still in progress, sample skipped",1);
+  else {
+    timeSampleStartMS = millis();
+    sampleStep();
   }
+  loopTimingPhaseEnd(phaseSensor);
+}
+
+void taskSensorPollRun()
+{
+  sampleStep();
+  loopTimingPhaseEnd(phaseSensor);
+}
+
+void taskSensorRecoverRun()
+// advances a recovery attempt that sensorRead() started, see sensorRecoverStep()
+{
+  budgetStart(budgetSensors);
+  const uint32_t waitMS = sensorRecoverStep();
+  budgetEnd(budgetSensors, "sensorRecoverStep");
+  if (waitMS)
+    schedulerAt(taskSensorRecover, millis() + waitMS);
+  loopTimingPhaseEnd(phaseSensor);
+}
+
+void taskPMAcquireRun()
+// reads each SEN5x measurement between samples, or replays those recorded; simulated
+// readings are one per sample
+{
+  budgetStart(budgetSensors);
+  sensorSEN5xAcquire();
+  budgetEnd(budgetSensors, "sensorSEN5xAcquire");
+  loopTimingPhaseEnd(phaseSensor);
+}
+
+void loopTimingSend()
+// sends the worker loop()'s timing figures, in answer to each of its sample snapshots; the
+// copy is cheap next to a phase, so it's named as a step of the phase rather than timed as one
+{
+  LoopTimingSnapshot snapshot;
+  loopTimingSnapshotTake(snapshot);
+  snapshot.idlePercent = schedulerIdlePercent();
+  // a full queue leaves the worker with figures a sample older
+  loopTimingQueue.push(snapshot);
+  if (!dualCoreSplit())
+    loopTimingReceive();
+  loopTimingCause("loopTimingSend");
+}
+
+void taskScreenSaverRun()
+{
+  ledcWrite(TFT_BL, screenBLLow);
+  loopTimingPhaseEnd(phaseScreenSaver);
+}
+
+void taskReportRun()
+{
+  samplePost(numSamples);
+  timeLastReportMS = millis();
+  samplePublish();  // the screens show the time since the last report
+  loopTimingPhaseEnd(phaseNetwork);
+}
+
+void taskOWMRun()
+// fetches Open Weather Map air pollution and forecast data for the screens every
+// timeOWMRenewMS, retrying sooner after a failure
+{
+  owmAirQualityValid = OWMAirPollutionRead();
+  owmForecastValid = OWMForecastRead();
+  if (!owmAirQualityValid || !owmForecastValid)
+    schedulerAt(taskOWM, millis() + timeOWMRetryMS);
+  samplePublish();
+  loopTimingPhaseEnd(phaseNetwork);
+}
+
+void sampleStep()
+// advances the sample in progress, and handles its result once it completes
+{
+  // Read sensor(s), a step at a time so touch and the portal stay responsive
+  uint8_t sensorResult = sensorRead();
+  loopTimingCause("sensorRead");
+  if (sensorResult == readPending) {
+    schedulerAt(taskSensorPoll, timeSensorPollMS);
+    return;
+  }
+  // loop() draws the new values and any alert, see workerResultsShow(). A failed read that
+  // accepted some fields (sampleValid) still counts, samplePost() averages each field over
+  // its own readings
+  if (sensorResult == readSuccess || sampleValid) {
+    numSamples++;
+    const float values[kHistoryChannelCount] = {totalTemperatureF.getCurrent(), totalHumidity.getCurrent(),
+      totalCO2.getCurrent(), totalPM25.getCurrent(), totalVOCIndex.getCurrent()};
+    sampleHistory.append(values, sampleValid);
+    sampleLogAppend(values, sampleValid);
+    #ifdef SAMPLE_ADAPTIVE
+      samplePeriodSet(sampleRateNext());
+    #endif
+    samplePublish();
+    if (sampleEvaluate())
+      uiEventSend(uiEventCO2Rising);
+  }
+  if (sensorResult != readSuccess)
+    uiEventSend(uiEventReadFail);
+  // Save completed sample time
+  timeLastSampleMS = millis();
+  sampleTimeRecord(timeLastSampleMS - timeSampleStartMS);
+  sampleAlign();
+}
+
+void sampleAlign()
+// moves the next sample, by less than timeSCD4xReadMinMS, to when the periodic SCD4x has its
+// next measurement, if this sample waited for one. The sensor measures on its own cadence,
+// so a sample started out of step with it spends most of its time polling data-ready. A pace
+// faster than the sensor measures, or one SAMPLE_ADAPTIVE picks, is left as it is
+{
+  bool paced = schedulerTask(taskSample).periodMS < timeSCD4xReadMinMS;
+  #ifdef SAMPLE_ADAPTIVE
+    paced = true;
+  #endif
+  if (!timeSCD4xReadyMS || paced) {
+    timeSCD4xReadyMS = 0;
+    return;
+  }
+  const uint32_t dueMS = schedulerTask(taskSample).dueMS;
+  const uint32_t measurements = (dueMS - timeSCD4xReadyMS + timeSCD4xReadMinMS - 1) / timeSCD4xReadMinMS;
+  schedulerAt(taskSample, timeSCD4xReadyMS + measurements * timeSCD4xReadMinMS);
+  timeSCD4xReadyMS = 0;
+}
+
+void samplePeriodSet(uint32_t periodMS)
+// paces taskSample, counting the new period from the start of the sample just taken
+{
+  if (periodMS == schedulerTask(taskSample).periodMS)
+    return;
+  schedulerPeriod(taskSample, periodMS);
+  schedulerAt(taskSample, timeSampleStartMS + periodMS);
+  debugMessage(String("Sample period now ") + (periodMS / 1000) + " seconds",2);
 }
 
 void screenUpdate(uint8_t screenCurrent) 
@@ -560,10 +973,32 @@ bool sampleEvaluate()
  * @note Endpoint support is controlled via compile-time flags
  *       (THINGSPEAK, INFLUX, MQTT, HASSIO_MQTT).
  * @note The sample counter is reset regardless of whether reporting succeeds.
+ * @note Runs on the worker task when dual core; alerts and the end of the report
+ *       reach loop() as UI events, see uiEventShow().
  */
 void samplePost(uint8_t& numSamples)
 {
   debugMessage(String("samplePost() start"),1);
+  debugMessage(budgetReport(),1);
+  debugMessage(schedulerReport(),1);
+  #ifdef SAMPLE_ADAPTIVE
+    debugMessage(sampleRateReport(),1);
+    sampleRateStatsReset();
+  #endif
+  debugMessage(String("samples took ") + (sampleTimeStats().samples ? sampleTimeStats().totalMS / sampleTimeStats().samples : 0)
+    + " ms on average, " + sampleTimeStats().maxMS + " ms at most",1);
+  debugMessage(sensorHealthReport(),1);
+  debugMessage(sampleLogReport(),1);
+  debugMessage(String("readings per field: temperature ") + meanTemperatureF.count() + ", humidity " + meanHumidity.count()
+    + ", CO2 " + meanCO2.count() + ", PM2.5 " + meanPM25.count() + ", VOC " + meanVOCIndex.count() + " of " + numSamples + " samples",1);
+  HistorySpan co2Day, pm25Day;
+  if (historyTiers.window(kTierDay, historyCO2, millis(), co2Day) && historyTiers.window(kTierDay, historyPM25, millis(), pm25Day))
+    debugMessage(String("last 24 hours: CO2 ") + co2Day.minValue + "-" + co2Day.maxValue + " ppm, mean " + co2Day.mean + "; PM2.5 "
+      + pm25Day.minValue + "-" + pm25Day.maxValue + " ug/m3, mean " + pm25Day.mean,1);
+  const HistoryRange co2Window = sampleHistory.extrema(historyCO2);
+  if (co2Window.valid)
+    debugMessage(String("graph window: CO2 ") + co2Window.minValue + "-" + co2Window.maxValue + " ppm over the last "
+      + sampleHistory.available(sampleHistory.appended()) + " samples",1);
 
   // do we have samples to process?
   if (numSamples) {
@@ -572,16 +1007,19 @@ void samplePost(uint8_t& numSamples)
       // attemot to reconnect to WiFi if needed
       if (WiFi.status() != WL_CONNECTED) {
         WiFi.reconnect();
+        loopTimingCause("WiFi.reconnect");
       }
 
       if (WiFi.status() == WL_CONNECTED) {
-        // Get averaged sample values from Measure class objects for endPoint reporting
-        float avgTemperatureF = totalTemperatureF.getAverage();
-        float avgHumidity = totalHumidity.getAverage();
-        uint16_t avgCO2 = totalCO2.getAverage();
-        float avgVOC = totalVOCIndex.getAverage();
-        float avgPM25 = totalPM25.getAverage();
-        float aqi = pm25toAQI_US(avgPM25);
+        // Get time weighted averages of the sample values for endPoint reporting, each over
+        // its own readings; NAN for a field with none this interval, which endpoints skip
+        const uint32_t nowMS = millis();
+        float avgTemperatureF = meanTemperatureF.count() ? meanTemperatureF.average(nowMS) : NAN;
+        float avgHumidity = meanHumidity.count() ? meanHumidity.average(nowMS) : NAN;
+        float avgCO2 = meanCO2.count() ? truncf(meanCO2.average(nowMS)) : NAN;  // whole ppm
+        float avgVOC = meanVOCIndex.count() ? meanVOCIndex.average(nowMS) : NAN;
+        float avgPM25 = meanPM25.count() ? meanPM25.average(nowMS) : NAN;
+        float aqi = isnan(avgPM25) ? NAN : pm25toAQI_US(avgPM25);
 
         debugMessage(String("Averages being sent to endpoints for the last ") + (timeReportMS/60000) + " minutes",2);
         debugMessage(String("PM2.5: ") + avgPM25 + "ppm, CO2: " + avgCO2 + "ppm, " + avgTemperatureF + "F, humidity: " + avgHumidity + "%", 2);
@@ -590,17 +1028,20 @@ void samplePost(uint8_t& numSamples)
         hardwareData.rssi = networkRSSIRead();
 
         #ifdef THINGSPEAK
-          if (!post_thingspeak(avgPM25, avgCO2, avgTemperatureF, avgHumidity, avgVOC, pm25toAQI_US(avgPM25)) ) {
+          if (!post_thingspeak(avgPM25, avgCO2, avgTemperatureF, avgHumidity, avgVOC, aqi) ) {
             debugMessage(String("ERROR: Did not write to ThingSpeak"),1);
           }
+          loopTimingCause("post_thingspeak");
         #endif
 
         #ifdef INFLUX
           if (!post_influx(avgTemperatureF, avgHumidity, avgCO2 , avgPM25, avgVOC, hardwareData.rssi))
             debugMessage(String("ERROR: Did not write to InfluxDB"),1);
+          loopTimingCause("post_influx");
         #endif
 
         #ifdef MQTT
+          budgetStart(budgetMQTT);
           if(mqttConnect()) {
             // publish device data
             const char* topic;
@@ -608,12 +1049,12 @@ void samplePost(uint8_t& numSamples)
             // publish hardware data
             mqttPublishValue(VALUE_KEY_RSSI, String(hardwareData.rssi));
 
-            // publish sensor data
-            mqttPublishValue(VALUE_KEY_TEMPERATURE, String(avgTemperatureF));
-            mqttPublishValue(VALUE_KEY_HUMIDITY, String(avgHumidity));
-            mqttPublishValue(VALUE_KEY_PM25, String(avgPM25));
-            mqttPublishValue(VALUE_KEY_VOC, String(avgVOC));
-            mqttPublishValue(VALUE_KEY_CO2, String(avgCO2));
+            // publish sensor data, those with readings this interval
+            if (!isnan(avgTemperatureF)) mqttPublishValue(VALUE_KEY_TEMPERATURE, String(avgTemperatureF));
+            if (!isnan(avgHumidity)) mqttPublishValue(VALUE_KEY_HUMIDITY, String(avgHumidity));
+            if (!isnan(avgPM25)) mqttPublishValue(VALUE_KEY_PM25, String(avgPM25));
+            if (!isnan(avgVOC)) mqttPublishValue(VALUE_KEY_VOC, String(avgVOC));
+            if (!isnan(avgCO2)) mqttPublishValue(VALUE_KEY_CO2, String((uint16_t)avgCO2));
 
             #ifdef HASSIO_MQTT
               debugMessage("Establishing MQTT for Home Assistant",1);
@@ -625,6 +1066,8 @@ void samplePost(uint8_t& numSamples)
 
             mqtt.disconnect();
           }
+          budgetEnd(budgetMQTT, "mqtt");
+          loopTimingCause("mqtt");
         #endif
       }
       else {
@@ -633,15 +1076,7 @@ void samplePost(uint8_t& numSamples)
     #endif
   }      
   else {
-    // ALERT: 5 second, sound, LED, and screen
-    alertLengthMS = 5000;
-    alertStartMS = millis();
-    alertScreen = true;
-    alertSound = true;
-    ledcWriteTone(pinAudio, audioFrequency);
-    display.loadFont(Roboto_Regular_24);
-    screenHelperAlert("No samples available", TFT_WHITE,TFT_BLACK,TFT_RED);
-    display.unloadFont();
+    uiEventSend(uiEventNoSamples);
     debugMessage(String("samplePost() no samples to process this cycle"),1);
   }
   // Reset sample counters
@@ -651,6 +1086,17 @@ void samplePost(uint8_t& numSamples)
   totalCO2.clear();
   totalVOCIndex.clear();
   totalPM25.clear();
+  const uint32_t clearMS = millis();
+  meanTemperatureF.clear(clearMS);
+  meanHumidity.clear(clearMS);
+  meanCO2.clear(clearMS);
+  meanVOCIndex.clear(clearMS);
+  meanPM25.clear(clearMS);
+  // scheduler statistics were reported above and in the InfluxDB device point; loop() prints
+  // and resets its own when it sees uiEventReported
+  schedulerStatsReset();
+  sampleTimeStatsReset();
+  uiEventSend(uiEventReported);
   debugMessage(String("samplePost() end"), 1);
 }
 
@@ -671,9 +1117,9 @@ void networkWiFiManagerBuildParameters()
     return;
   }
 
-  dtostrf(hardwareData.latitude, 0, 5, wfmLatitudeStr);
-  dtostrf(hardwareData.longitude, 0, 5, wfmLongitudeStr);
-  utoa(hardwareData.altitude, wfmAltitudeStr, 10);
+  dtostrf(portalConfig.latitude, 0, 5, wfmLatitudeStr);
+  dtostrf(portalConfig.longitude, 0, 5, wfmLongitudeStr);
+  utoa(portalConfig.altitude, wfmAltitudeStr, 10);
 
   pHintText = new WiFiManagerParameter(
     "<small>*If you want to connect to already connected AP, leave SSID and password fields empty</small>"
@@ -707,7 +1153,7 @@ void networkWiFiManagerBuildParameters()
   pDeviceID = new WiFiManagerParameter(
     "deviceID",
     "Optional: Give this device a unique name",
-    endpointPath.deviceID.c_str(),
+    portalConfig.endpointPath.deviceID.c_str(),
     30
   );
 
@@ -722,21 +1168,21 @@ void networkWiFiManagerBuildParameters()
   pDeviceSite = new WiFiManagerParameter(
     "deviceSite",
     "What is a single number or word to describe the building this device is in?",
-    endpointPath.site.c_str(),
+    portalConfig.endpointPath.site.c_str(),
     20
   );
 
   pDeviceLocation = new WiFiManagerParameter(
     "deviceLocation",
     "Is the device indoors or outdoors",
-    endpointPath.location.c_str(),
+    portalConfig.endpointPath.location.c_str(),
     20
   );
 
   pDeviceRoom = new WiFiManagerParameter(
     "deviceRoom",
     "What is a good name for the room this device is in?",
-    endpointPath.room.c_str(),
+    portalConfig.endpointPath.room.c_str(),
     20
   );
 
@@ -746,7 +1192,7 @@ void networkWiFiManagerBuildParameters()
 #endif
 
 #ifdef MQTT
-  utoa(mqttBrokerConfig.port, wfmMqttPortStr, 10);
+  utoa(portalConfig.mqttBrokerConfig.port, wfmMqttPortStr, 10);
 
   pMQTTHeader = new WiFiManagerParameter(
     "<h3 style='margin-top:20px;'>MQTT parameters</h3><hr>"
@@ -755,7 +1201,7 @@ void networkWiFiManagerBuildParameters()
   pMqttBroker = new WiFiManagerParameter(
     "mqttBroker",
     "MQTT broker address",
-    mqttBrokerConfig.host.c_str(),
+    portalConfig.mqttBrokerConfig.host.c_str(),
     30
   );
 
@@ -769,14 +1215,14 @@ void networkWiFiManagerBuildParameters()
   pMqttUser = new WiFiManagerParameter(
     "mqttUser",
     "MQTT username",
-    mqttBrokerConfig.user.c_str(),
+    portalConfig.mqttBrokerConfig.user.c_str(),
     20
   );
 
   pMqttPassword = new WiFiManagerParameter(
     "mqttPassword",
     "MQTT password for username",
-    mqttBrokerConfig.password.c_str(),
+    portalConfig.mqttBrokerConfig.password.c_str(),
     20
   );
 
@@ -788,7 +1234,7 @@ void networkWiFiManagerBuildParameters()
 #endif
 
 #ifdef INFLUX
-  utoa(influxdbConfig.port, wfmInfluxPortStr, 10);
+  utoa(portalConfig.influxdbConfig.port, wfmInfluxPortStr, 10);
 
   pInfluxHeader = new WiFiManagerParameter(
     "<h3 style='margin-top:20px;'>Influxdb parameters</h3><hr>"
@@ -797,7 +1243,7 @@ void networkWiFiManagerBuildParameters()
   pInfluxBroker = new WiFiManagerParameter(
     "influxBroker",
     "influxdb server address",
-    influxdbConfig.host.c_str(),
+    portalConfig.influxdbConfig.host.c_str(),
     30
   );
 
@@ -811,28 +1257,28 @@ void networkWiFiManagerBuildParameters()
   pInfluxOrg = new WiFiManagerParameter(
     "influxOrg",
     "influx organization name",
-    influxdbConfig.org.c_str(),
+    portalConfig.influxdbConfig.org.c_str(),
     20
   );
 
   pInfluxBucket = new WiFiManagerParameter(
     "influxBucket",
     "influx bucket name",
-    influxdbConfig.bucket.c_str(),
+    portalConfig.influxdbConfig.bucket.c_str(),
     20
   );
 
   pInfluxEnvMeasurement = new WiFiManagerParameter(
     "influxEnvment",
     "influx environment measurement",
-    influxdbConfig.envMeasurement.c_str(),
+    portalConfig.influxdbConfig.envMeasurement.c_str(),
     20
   );
 
   pInfluxDevMeasurement = new WiFiManagerParameter(
     "influxDevment",
     "influx device measurement",
-    influxdbConfig.devMeasurement.c_str(),
+    portalConfig.influxdbConfig.devMeasurement.c_str(),
     20
   );
 
@@ -850,9 +1296,9 @@ void networkWiFiManagerBuildParameters()
 
 void networkWiFiManagerRefreshParameterValues()
 {
-  dtostrf(hardwareData.latitude, 0, 5, wfmLatitudeStr);
-  dtostrf(hardwareData.longitude, 0, 5, wfmLongitudeStr);
-  utoa(hardwareData.altitude, wfmAltitudeStr, 10);
+  dtostrf(portalConfig.latitude, 0, 5, wfmLatitudeStr);
+  dtostrf(portalConfig.longitude, 0, 5, wfmLongitudeStr);
+  utoa(portalConfig.altitude, wfmAltitudeStr, 10);
 
   if (pDeviceLatitude) {
     pDeviceLatitude->setValue(wfmLatitudeStr, 16);
@@ -867,28 +1313,28 @@ void networkWiFiManagerRefreshParameterValues()
   }
 
   if (pDeviceID) {
-    pDeviceID->setValue(endpointPath.deviceID.c_str(), 30);
+    pDeviceID->setValue(portalConfig.endpointPath.deviceID.c_str(), 30);
   }
 
 #if defined(MQTT) || defined(INFLUX) || defined(HASSIO_MQTT)
   if (pDeviceSite) {
-    pDeviceSite->setValue(endpointPath.site.c_str(), 20);
+    pDeviceSite->setValue(portalConfig.endpointPath.site.c_str(), 20);
   }
 
   if (pDeviceLocation) {
-    pDeviceLocation->setValue(endpointPath.location.c_str(), 20);
+    pDeviceLocation->setValue(portalConfig.endpointPath.location.c_str(), 20);
   }
 
   if (pDeviceRoom) {
-    pDeviceRoom->setValue(endpointPath.room.c_str(), 20);
+    pDeviceRoom->setValue(portalConfig.endpointPath.room.c_str(), 20);
   }
 #endif
 
 #ifdef MQTT
-  utoa(mqttBrokerConfig.port, wfmMqttPortStr, 10);
+  utoa(portalConfig.mqttBrokerConfig.port, wfmMqttPortStr, 10);
 
   if (pMqttBroker) {
-    pMqttBroker->setValue(mqttBrokerConfig.host.c_str(), 30);
+    pMqttBroker->setValue(portalConfig.mqttBrokerConfig.host.c_str(), 30);
   }
 
   if (pMqttPort) {
@@ -896,19 +1342,19 @@ void networkWiFiManagerRefreshParameterValues()
   }
 
   if (pMqttUser) {
-    pMqttUser->setValue(mqttBrokerConfig.user.c_str(), 20);
+    pMqttUser->setValue(portalConfig.mqttBrokerConfig.user.c_str(), 20);
   }
 
   if (pMqttPassword) {
-    pMqttPassword->setValue(mqttBrokerConfig.password.c_str(), 20);
+    pMqttPassword->setValue(portalConfig.mqttBrokerConfig.password.c_str(), 20);
   }
 #endif
 
 #ifdef INFLUX
-  utoa(influxdbConfig.port, wfmInfluxPortStr, 10);
+  utoa(portalConfig.influxdbConfig.port, wfmInfluxPortStr, 10);
 
   if (pInfluxBroker) {
-    pInfluxBroker->setValue(influxdbConfig.host.c_str(), 30);
+    pInfluxBroker->setValue(portalConfig.influxdbConfig.host.c_str(), 30);
   }
 
   if (pInfluxPort) {
@@ -916,19 +1362,19 @@ void networkWiFiManagerRefreshParameterValues()
   }
 
   if (pInfluxOrg) {
-    pInfluxOrg->setValue(influxdbConfig.org.c_str(), 20);
+    pInfluxOrg->setValue(portalConfig.influxdbConfig.org.c_str(), 20);
   }
 
   if (pInfluxBucket) {
-    pInfluxBucket->setValue(influxdbConfig.bucket.c_str(), 20);
+    pInfluxBucket->setValue(portalConfig.influxdbConfig.bucket.c_str(), 20);
   }
 
   if (pInfluxEnvMeasurement) {
-    pInfluxEnvMeasurement->setValue(influxdbConfig.envMeasurement.c_str(), 20);
+    pInfluxEnvMeasurement->setValue(portalConfig.influxdbConfig.envMeasurement.c_str(), 20);
   }
 
   if (pInfluxDevMeasurement) {
-    pInfluxDevMeasurement->setValue(influxdbConfig.devMeasurement.c_str(), 20);
+    pInfluxDevMeasurement->setValue(portalConfig.influxdbConfig.devMeasurement.c_str(), 20);
   }
 #endif
 }
@@ -984,7 +1430,10 @@ bool networkWiFiManagerOpen()
   saveWFMConfig = false;
 
   String parameterText = hardwareDeviceType + " setup";
+  budgetStart(budgetWiFi);
   bool connected = wfm.autoConnect(parameterText.c_str()); // anonymous ap
+  // over budget when the config portal ran, which is expected on first boot
+  budgetEnd(budgetWiFi, "wfm.autoConnect");
   // connected = wfm.autoConnect(hardwareDeviceType + " AP","password"); // password protected AP
 
   if (saveWFMConfig) {
@@ -1013,42 +1462,44 @@ void networkWiFiManagerSaveParameterValues()
   // IMPROVEMENT: Need to implement range checking
   debugMessage("getting (new) config parameters from web configuration portal", 2);
 
-  hardwareData.altitude =
+  portalConfig.altitude =
     static_cast<uint16_t>(strtoul(pDeviceAltitude->getValue(), nullptr, 10));
 
-  hardwareData.latitude =
+  portalConfig.latitude =
     strtof(pDeviceLatitude->getValue(), nullptr);
 
-  hardwareData.longitude =
+  portalConfig.longitude =
     strtof(pDeviceLongitude->getValue(), nullptr);
 
-  endpointPath.deviceID = pDeviceID->getValue();
+  portalConfig.endpointPath.deviceID = pDeviceID->getValue();
 
   #if defined(MQTT) || defined(INFLUX) || defined(HASSIO_MQTT)
-    endpointPath.site = pDeviceSite->getValue();
-    endpointPath.location = pDeviceLocation->getValue();
-    endpointPath.room = pDeviceRoom->getValue();
+    portalConfig.endpointPath.site = pDeviceSite->getValue();
+    portalConfig.endpointPath.location = pDeviceLocation->getValue();
+    portalConfig.endpointPath.room = pDeviceRoom->getValue();
   #endif
 
   #ifdef MQTT
-    mqttBrokerConfig.host = pMqttBroker->getValue();
-    mqttBrokerConfig.port =
+    portalConfig.mqttBrokerConfig.host = pMqttBroker->getValue();
+    portalConfig.mqttBrokerConfig.port =
       static_cast<uint16_t>(strtoul(pMqttPort->getValue(), nullptr, 10));
-    mqttBrokerConfig.user = pMqttUser->getValue();
-    mqttBrokerConfig.password = pMqttPassword->getValue();
+    portalConfig.mqttBrokerConfig.user = pMqttUser->getValue();
+    portalConfig.mqttBrokerConfig.password = pMqttPassword->getValue();
   #endif
 
   #ifdef INFLUX
-    influxdbConfig.host = pInfluxBroker->getValue();
-    influxdbConfig.port =
+    portalConfig.influxdbConfig.host = pInfluxBroker->getValue();
+    portalConfig.influxdbConfig.port =
       static_cast<uint16_t>(strtoul(pInfluxPort->getValue(), nullptr, 10));
-    influxdbConfig.org = pInfluxOrg->getValue();
-    influxdbConfig.bucket = pInfluxBucket->getValue();
-    influxdbConfig.envMeasurement = pInfluxEnvMeasurement->getValue();
-    influxdbConfig.devMeasurement = pInfluxDevMeasurement->getValue();
+    portalConfig.influxdbConfig.org = pInfluxOrg->getValue();
+    portalConfig.influxdbConfig.bucket = pInfluxBucket->getValue();
+    portalConfig.influxdbConfig.envMeasurement = pInfluxEnvMeasurement->getValue();
+    portalConfig.influxdbConfig.devMeasurement = pInfluxDevMeasurement->getValue();
   #endif
 
-  nvconfigWrite();
+  nvconfigWrite(portalConfig);
+  // the worker's reports pick them up between its passes
+  configSend();
 }
 
 void networkStartWiFiMgrPortal()
@@ -1065,8 +1516,7 @@ void networkStartWiFiMgrPortal()
     return;
   }
 
-  alertLengthMS = 5000;
-  alertStartMS = millis();
+  alertStart(5000);
   alertScreen = true;
 
   display.loadFont(Roboto_Regular_24);
@@ -1095,6 +1545,7 @@ void networkStartWiFiMgrPortal()
   wfm.startWebPortal();
   wfmPortalRunning = true;
   wfmPortalStartMS = millis();
+  schedulerAt(taskPortalTimeout, wfmPortalStartMS + timeWebPortalTimeOutMS + 1);
 
   debugMessage(String("web portal active at ") + WiFi.localIP().toString(), 2);
   debugMessage(String("networkStartWiFiMgrPortal end()"), 1);
@@ -1244,36 +1695,36 @@ void nvconfigDefaultsLoad()
   debugMessage("nvconfigDefaultsLoad() end",1);  
 }
 
-void nvconfigWrite()
+void nvconfigWrite(const ConfigSnapshot& config)
 // write configuration parameters to non-volatile storage
 {
   debugMessage("nvconfigWrite() start",1);
   nvConfig.begin("config", false); // read-write
 
   // general parameters
-  nvConfig.putUShort("altitude", hardwareData.altitude);
-  nvConfig.putFloat("latitude",hardwareData.latitude);
-  nvConfig.putFloat("longitude", hardwareData.longitude);
-  nvConfig.putString("deviceID", endpointPath.deviceID);
+  nvConfig.putUShort("altitude", config.altitude);
+  nvConfig.putFloat("latitude",config.latitude);
+  nvConfig.putFloat("longitude", config.longitude);
+  nvConfig.putString("deviceID", config.endpointPath.deviceID);
 
   // general endpoint parameters
-  nvConfig.putString("site", endpointPath.site);
-  nvConfig.putString("location", endpointPath.location);
-  nvConfig.putString("room", endpointPath.room);
+  nvConfig.putString("site", config.endpointPath.site);
+  nvConfig.putString("location", config.endpointPath.location);
+  nvConfig.putString("room", config.endpointPath.room);
 
   // MQTT parameters
-  nvConfig.putString("mqttHost",  mqttBrokerConfig.host);
-  nvConfig.putUShort("mqttPort",  mqttBrokerConfig.port);
-  nvConfig.putString("mqttUser",  mqttBrokerConfig.user);
-  nvConfig.putString("mqttPassword",  mqttBrokerConfig.password);
+  nvConfig.putString("mqttHost",  config.mqttBrokerConfig.host);
+  nvConfig.putUShort("mqttPort",  config.mqttBrokerConfig.port);
+  nvConfig.putString("mqttUser",  config.mqttBrokerConfig.user);
+  nvConfig.putString("mqttPassword",  config.mqttBrokerConfig.password);
 
   // Influx parameters
-  nvConfig.putString("influxHost",  influxdbConfig.host);
-  nvConfig.putUShort("influxPort",  influxdbConfig.port);
-  nvConfig.putString("influxOrg",   influxdbConfig.org);
-  nvConfig.putString("influxBucket",influxdbConfig.bucket);
-  nvConfig.putString("influxEnv",influxdbConfig.envMeasurement);
-  nvConfig.putString("influxDev", influxdbConfig.devMeasurement);
+  nvConfig.putString("influxHost",  config.influxdbConfig.host);
+  nvConfig.putUShort("influxPort",  config.influxdbConfig.port);
+  nvConfig.putString("influxOrg",   config.influxdbConfig.org);
+  nvConfig.putString("influxBucket",config.influxdbConfig.bucket);
+  nvConfig.putString("influxEnv",config.influxdbConfig.envMeasurement);
+  nvConfig.putString("influxDev", config.influxdbConfig.devMeasurement);
 
   nvConfig.end();
   debugMessage("nvconfigWrite() end",1);
@@ -1296,7 +1747,7 @@ void nvconfigWrite()
     wfm.resetSettings();
 
     debugMessage("deviceErasePrefsAndReboot() end, rebooting...",2);
-    ESP.restart();
+    deviceRestart();
   }
 
 void checkButtonPress() {
@@ -1399,6 +1850,7 @@ boolean OWMForecastRead()
     OWMForecastSimulate();
     return true;
   #else
+    BudgetScope budget(budgetOWM, "OWMForecastRead");
     HTTPClient http;
     // Attempt to connect to OWM service for 3-hour forecast data
     static String serverPath = kOWMServer + kOWMForecastPath + 
@@ -1408,6 +1860,8 @@ boolean OWMForecastRead()
           debugMessage("OWM weather forecast connection failed",1);
       return false;
     }
+    http.setConnectTimeout(timeNetworkReadMS);
+    http.setTimeout(timeNetworkReadMS);
 
     // Successfully connected, see if forecast data was returned
     httpResponseCode = http.GET();
@@ -1421,8 +1875,14 @@ boolean OWMForecastRead()
     debugMessage("OWM HTTP GET success",2);
 
     // Obtain the HTTP GET result payload and convert to a JSON doc
-    DeserializationError error = deserializeJson(doc,http.getStream());
+    BudgetStream body(budgetOWM, http.getStream());
+    DeserializationError error = deserializeJson(doc,body);
     http.end();   
+    // a body cut off at the transfer limit doesn't parse
+    if (error) {
+      debugMessage(String("OWM Forecast deserializeJson error message: ") + error.c_str(),1);
+      return false;
+    }
 
     /*
     * Print the full payload (to assist in development)
@@ -1531,74 +1991,67 @@ bool OWMAirPollutionRead()
     OWMAirPollutionSimulate();
     return true;
   #else
-    static int32_t timeLastOWMUpdateMS = -(timeOWMRenewMS); // forces immediate sample at first run
-    
-    debugMessage(String("OWMAirPollutionRead() start"),1);
-    // is it time for new OWM data?
-    if (millis() - timeLastOWMUpdateMS > timeOWMRenewMS)
-    {
-      // attemot to reconnect to WiFi if needed
-      if (WiFi.status() != WL_CONNECTED) {
-        WiFi.reconnect();
-      }
+    BudgetScope budget(budgetOWM, "OWMAirPollutionRead");
+    // attemot to reconnect to WiFi if needed
+    if (WiFi.status() != WL_CONNECTED) {
+      WiFi.reconnect();
+    }
 
     // http://api.openweathermap.org/data/2.5/air_pollution?lat={lat}&lon={lon}&appid={API key}
     String serverPath = kOWMServer + kOWMAQMPath +
      "lat=" + hardwareData.latitude + "&lon=" + hardwareData.longitude + "&APPID=" + OWMKey;
 
-      HTTPClient http;
-      if (!http.begin(serverPath)) {
-        debugMessage("OWM AirPollution URL malformed or HTTP client didn't initialize",1);
-        return false;
-      }
-
-      int httpResponseCode = http.GET();
-      if (httpResponseCode != HTTP_CODE_OK) {
-        debugMessage(String("OWM AirPollution HTTP GET error: ") + HTTPClient::errorToString(httpResponseCode),1);
-        http.end();
-        return false;
-      }
-
-      // Filter: only parse what we need (saves RAM)
-      JsonDocument filter;
-      filter["list"][0]["main"]["aqi"] = true;
-      filter["list"][0]["components"]["pm2_5"] = true;
-
-      JsonDocument doc;
-      const DeserializationError error = deserializeJson(
-        doc,
-        http.getStream(),
-        DeserializationOption::Filter(filter)
-      );
+    HTTPClient http;
+    if (!http.begin(serverPath)) {
+      debugMessage("OWM AirPollution URL malformed or HTTP client didn't initialize",1);
+      return false;
+    }
+    http.setConnectTimeout(timeNetworkReadMS);
+    http.setTimeout(timeNetworkReadMS);
 
+    int httpResponseCode = http.GET();
+    if (httpResponseCode != HTTP_CODE_OK) {
+      debugMessage(String("OWM AirPollution HTTP GET error: ") + HTTPClient::errorToString(httpResponseCode),1);
       http.end();
+      return false;
+    }
 
-      if (error) {
-        debugMessage(String("OWM AirPollution deserializeJson error message: ") + error.c_str(), 1);
-        return false;
-      }
+    // Filter: only parse what we need (saves RAM)
+    JsonDocument filter;
+    filter["list"][0]["main"]["aqi"] = true;
+    filter["list"][0]["components"]["pm2_5"] = true;
+
+    JsonDocument doc;
+    BudgetStream body(budgetOWM, http.getStream());
+    const DeserializationError error = deserializeJson(
+      doc,
+      body,
+      DeserializationOption::Filter(filter)
+    );
 
-      // owmAirQuality.lon = (float) doc["coord"]["lon"];
-      // owmAirQuality.lat = (float) doc["coord"]["lat"];
-      owmAirQuality.aqi  = doc["list"][0]["main"]["aqi"] | 0;
-      // owmAirQuality.co = (float) list_0_components["co"];
-      // owmAirQuality.no = (float) list_0_components["no"];
-      // owmAirQuality.no2 = (float) list_0_components["no2"];
-      // owmAirQuality.o3 = (float) list_0_components["o3"];
-      // owmAirQuality.so2 = (float) list_0_components["so2"];
-      owmAirQuality.pm25 = doc["list"][0]["components"]["pm2_5"] | NAN;
-      // owmAirQuality.pm10 = (float) list_0_components["pm10"];
-      // owmAirQuality.nh3 = (float) list_0_components["nh3"];
-      debugMessage(String("OWM Air Pollution PM2.5 is ") + owmAirQuality.pm25 + "μg/m3, AQI is " + owmAirQuality.aqi + " of 5",1);
-
-      timeLastOWMUpdateMS = millis();
-      debugMessage(String("OWMAirPollutionRead() end"),1);
-      return true;
+    http.end();
+
+    if (error) {
+      debugMessage(String("OWM AirPollution deserializeJson error message: ") + error.c_str(), 1);
+      return false;
     }
-  #endif
 
-  debugMessage(String("OWMAirPollutionRead() end"), 1);
-  return true;
+    // owmAirQuality.lon = (float) doc["coord"]["lon"];
+    // owmAirQuality.lat = (float) doc["coord"]["lat"];
+    owmAirQuality.aqi  = doc["list"][0]["main"]["aqi"] | 0;
+    // owmAirQuality.co = (float) list_0_components["co"];
+    // owmAirQuality.no = (float) list_0_components["no"];
+    // owmAirQuality.no2 = (float) list_0_components["no2"];
+    // owmAirQuality.o3 = (float) list_0_components["o3"];
+    // owmAirQuality.so2 = (float) list_0_components["so2"];
+    owmAirQuality.pm25 = doc["list"][0]["components"]["pm2_5"] | NAN;
+    // owmAirQuality.pm10 = (float) list_0_components["pm10"];
+    // owmAirQuality.nh3 = (float) list_0_components["nh3"];
+    debugMessage(String("OWM Air Pollution PM2.5 is ") + owmAirQuality.pm25 + "μg/m3, AQI is " + owmAirQuality.aqi + " of 5",1);
+
+    debugMessage(String("OWMAirPollutionRead() end"),1);
+    return true;
+  #endif
 }
 
 bool sensorInit()
@@ -1614,34 +2067,208 @@ bool sensorInit()
   }
   if (!pmSuccess) {
     debugMessage("PM sensor init failed",1);
-    success = false;
   }
+  // channels warm up while loop() runs, see sensorWarmingUp(); a failed sensor is recovered
+  // later, see sensorRecoverStep()
+  sensorHealthInit(sensorSCD4x, success);
+  sensorHealthInit(sensorSEN5x, pmSuccess);
+  if (success)
+    sensorWarmupStart(sensorSCD4x);
+  if (pmSuccess)
+    sensorWarmupStart(sensorSEN5x);
+
+  return (success && pmSuccess);
+}
+
+void sensorWarmupStart(uint8_t sensor)
+// a sensor's channels warm up from now, after its initialization or recovery
+{
+  const uint32_t nowMS = millis();
+  if (sensor == sensorSCD4x) {
+    timeChannelInitMS[channelCO2] = nowMS;
+    channelMeasured[channelCO2] = false;
+  }
+  else {
+    timeChannelInitMS[channelPM] = nowMS;
+    timeChannelInitMS[channelVOC] = nowMS;
+  }
+}
+
+bool sensorWarmingUp([[maybe_unused]] uint8_t channel)
+// true until a sensor channel's readings are valid after sensorInit() or a recovery, see
+// timeSensorWarmupMS; the CO2 channel's first valid reading ends it early
+{
+  #if defined(HARDWARE_SIMULATE) || defined(SENSOR_TRACE_REPLAY)
+    return false;
+  #else
+    return !channelMeasured[channel] && (millis() - timeChannelInitMS[channel]) < timeSensorWarmupMS[channel];
+  #endif
+}
+
+bool sensorBusClear()
+// Frees the I2C bus from a device holding SDA low mid-transfer, which no transaction can
+// end: clocks SCL until the device lets go, up to kSensorBusClearPulses, then sends a STOP.
+// Returns true if SDA is released
+{
+  if (digitalRead(pinSensorSDA) == HIGH)
+    return true;
+  debugMessage("I2C SDA held low, clearing the bus",1);
+  Wire.end();
+  pinMode(pinSensorSDA, INPUT_PULLUP);
+  pinMode(pinSensorSCL, OUTPUT_OPEN_DRAIN);
+  for (uint8_t pulse = 0; pulse < kSensorBusClearPulses && digitalRead(pinSensorSDA) == LOW; pulse++) {
+    digitalWrite(pinSensorSCL, LOW);
+    delayMicroseconds(5);
+    digitalWrite(pinSensorSCL, HIGH);
+    delayMicroseconds(5);
+  }
+  // STOP: SDA rises while SCL is high
+  pinMode(pinSensorSDA, OUTPUT_OPEN_DRAIN);
+  digitalWrite(pinSensorSDA, LOW);
+  delayMicroseconds(5);
+  digitalWrite(pinSensorSDA, HIGH);
+  delayMicroseconds(5);
+  pinMode(pinSensorSDA, INPUT_PULLUP);
+  const bool released = (digitalRead(pinSensorSDA) == HIGH);
+  Wire.begin(pinSensorSDA, pinSensorSCL);
+  debugMessage(released ? "I2C bus cleared" : "I2C SDA still held low",1);
+  return released;
+}
+
+uint32_t sensorRecoverStep()
+// A recovery attempt, when sensorHealthRecoveryDue(), a step at a time like sensorSCD4xRead()
+// so the sensor's execution times don't block: frees the bus if a device holds it and stops
+// (SCD4x) or resets (SEN5x) the sensor, then once that has executed starts it again as
+// sensorSCD4xInit() and sensorSEN54Init() do. Returns the wait before the next step, 0 once
+// the attempt is over. Its channels warm up again on success
+{
+  const uint8_t sensor = sensorRecovering;
+  bool success = false;
+  if (!sensorRecoverStage)
+    debugMessage(String(sensorName[sensor]) + " recovery attempt " + (sensorHealth(sensor).attempts + 1),1);
+
+  #if defined(HARDWARE_SIMULATE) || defined(SENSOR_TRACE_REPLAY)
+    success = (sensor == sensorSCD4x) ? sensorSCD4xInit() : sensorSEN54Init();
+  #else
+    if (!sensorRecoverStage) {
+      uint16_t error = 0;
+      success = sensorBusClear();
+      if (success && sensor == sensorSCD4x) {
+        co2Sensor.begin(Wire, SCD41_I2C_ADDR_62);
+        error = sensorCommandSend(SCD41_I2C_ADDR_62, STOP_PERIODIC_MEASUREMENT_CMD_ID);
+      }
+      else if (success) {
+        pmSensor.begin(Wire);
+        error = sensorCommandSend(SEN5X_I2C_ADDRESS, kSEN5xDeviceResetCmd);
+      }
+      if (success && !error) {
+        sensorRecoverStage = 1;
+        return (sensor == sensorSCD4x) ? timeSCD4xStopMS : timeSEN5xResetMS;
+      }
+      if (error) {
+        char errorMessage[256];
+        errorToString(error, errorMessage, 256);
+        debugMessage(String(errorMessage) + " stopping " + sensorName[sensor] + " for recovery",1);
+      }
+      success = false;
+    }
+    else
+      success = (sensor == sensorSCD4x) ? sensorSCD4xConfigure() : sensorSEN5xStart();
+  #endif
+
+  sensorRecovering = kSensorCount;
+  sensorRecoverStage = 0;
   if (success) {
-    #ifndef HARDWARE_SIMULATE
-      // Explicit delay as SEN54 takes 6-7 seconds for valid VOC index values
-      delay(7000);
-    #endif
+    sensorWarmupStart(sensor);
+    if (sensor == sensorSEN5x) {
+      filterPM25.reset();
+      filterVOCIndex.reset();
+    }
   }
+  sensorHealthRecovery(sensor, success);
+  return 0;
+}
 
-  return success;
+bool sensorReadDue([[maybe_unused]] uint32_t timeLastReadMS, [[maybe_unused]] uint32_t readMinMS)
+// with SAMPLE_ADAPTIVE a sensor is read no more often than it measures, the sample keeping
+// its previous reading in between (see sensorRead()); otherwise every sample reads every
+// sensor
+{
+  #ifdef SAMPLE_ADAPTIVE
+    return (millis() - timeLastReadMS) >= readMinMS;
+  #else
+    return true;
+  #endif
 }
 
-bool sensorRead()
-// Generalized entry point for reading sensor values
+uint8_t sensorRead()
+// Generalized entry point for reading sensor values. Returns readPending while the SCD4x
+// read is waiting on its data-ready flag; loop() calls again at timeSensorPollMS. Both
+// sensors share the I2C bus, so their waits overlap rather than add up: the SCD4x read
+// starts first, the SEN5x is read while the SCD4x converts, then the SCD4x result is
+// collected. A sensor that is recovering (see sensor_health.h) isn't read, failing the
+// sample, and a recovery attempt that is due starts with the sample
 {
-  bool success = false;  // default setting for the final #ifndef
+  static bool pmPending = false;  // the SEN5x is yet to be read this sample
+  static bool pmSuccess = true;   // its result, while the SCD4x read is pending
+  static bool co2Skipped = false; // the SCD4x isn't read this sample
+  static bool co2Due = true;      // it has measured since its last read, see sensorReadDue()
+  // SAMPLE_VALID_ fields each sensor's last read accepted, which a sample that doesn't read
+  // it carries
+  static uint8_t co2Accepted = 0, pmAccepted = 0;
+  if (!sensorReadPending) {
+    // one recovery at a time, its steps run apart from the sample, see taskSensorRecoverRun()
+    for (uint8_t sensor = 0; sensor < kSensorCount && sensorRecovering == kSensorCount; sensor++)
+      if (sensorHealthRecoveryDue(sensor)) {
+        sensorRecovering = sensor;
+        schedulerAt(taskSensorRecover, millis());
+      }
+    pmPending = sensorHealthReadable(sensorSEN5x) && sensorReadDue(timeLastSEN5xReadMS, timeSEN5xReadMinMS);
+    pmSuccess = sensorHealthReadable(sensorSEN5x);
+    co2Skipped = !sensorHealthReadable(sensorSCD4x);
+    co2Due = sensorReadDue(timeLastSCD4xReadMS, timeSCD4xReadMinMS);
+    sampleValid = 0;
+    if (!co2Skipped && !co2Due)
+      sampleValid |= co2Accepted;
+    if (pmSuccess && !pmPending)
+      sampleValid |= pmAccepted;
+  }
+
+  uint8_t co2Result = co2Skipped ? readFailure : readSuccess;
+  if (!co2Skipped && (sensorReadPending || co2Due)) {
+    budgetStart(budgetSensors);
+    co2Result = sensorSCD4xRead();
+    budgetEnd(budgetSensors, "sensorSCD4xRead");
+    if (co2Result == readSuccess)
+      timeLastSCD4xReadMS = millis();
+    else if (co2Result == readFailure)
+      debugMessage("SCD40 read failed",1);
+    if (co2Result != readPending) {
+      sensorHealthRead(sensorSCD4x, co2Result == readSuccess);
+      co2Accepted = sampleValid & (SAMPLE_VALID_TEMP | SAMPLE_VALID_HUM | SAMPLE_VALID_CO2);
+    }
+  }
 
-  bool pmSuccess = sensorSEN554Read();
-  if (!pmSuccess)
-    debugMessage("SEN54 read failed",1);
+  // SEN5x reads in a single transfer, in the SCD4x read's first wait, or its first after
+  // the SEN5x warm-up
+  if (pmPending && (!sensorWarmingUp(channelPM) || co2Result != readPending)) {
+    pmPending = false;
+    budgetStart(budgetSensors);
+    pmSuccess = sensorSEN554Read();
+    budgetEnd(budgetSensors, "sensorSEN554Read");
+    if (pmSuccess)
+      timeLastSEN5xReadMS = millis();
+    else
+      debugMessage("SEN54 read failed",1);
+    sensorHealthRead(sensorSEN5x, pmSuccess);
+    pmAccepted = sampleValid & (SAMPLE_VALID_PM25 | SAMPLE_VALID_VOC);
+  }
 
-  success = sensorSCD4xRead();
-  if (!success)
-    debugMessage("SCD40 read failed",1);
-  if (!pmSuccess)
-    success = false;
+  sensorReadPending = (co2Result == readPending);
+  if (sensorReadPending)
+    return readPending;
 
-  return success;
+  return (co2Result == readSuccess && pmSuccess) ? readSuccess : readFailure;
 }
 
 bool sensorSEN54Init()
@@ -1650,7 +2277,7 @@ bool sensorSEN54Init()
 
   debugMessage("sensorSEN54Init() start",1);
 
-  #ifdef HARDWARE_SIMULATE
+  #if defined(HARDWARE_SIMULATE) || defined(SENSOR_TRACE_REPLAY)
     success = true;
   #else
     uint16_t error;
@@ -1664,23 +2291,27 @@ bool sensorSEN54Init()
       errorToString(error, errorMessage, 256);
       debugMessage(String(errorMessage) + " error during SEN5x reset", 1);
     }
-    else {
-      // start measurement
-      error = pmSensor.startMeasurement();
-      if (error) {
-        errorToString(error, errorMessage, 256);
-        debugMessage(String(errorMessage) + " error during SEN5x startMeasurement", 2);
-      }
-      else {
-        debugMessage("SEN5X starting periodic measurements",2);
-        success = true;
-      }
-    }
+    else
+      success = sensorSEN5xStart();
   #endif
   debugMessage("sensorSEN54Init() end",1);
   return success;
 }
 
+bool sensorSEN5xStart()
+// starts the reset SEN5x measuring, after sensorSEN54Init() or a recovery's reset
+{
+  char errorMessage[256];
+  uint16_t error = pmSensor.startMeasurement();
+  if (error) {
+    errorToString(error, errorMessage, 256);
+    debugMessage(String(errorMessage) + " error during SEN5x startMeasurement", 2);
+    return false;
+  }
+  debugMessage("SEN5X starting periodic measurements",2);
+  return true;
+}
+
 void sensorSEN54Simulate(float& simulatedPM25, float& simulatedVOCIndex)
 // Description: Simulates sensor reading from SEN54 sensor
 // Parameters: NA
@@ -1702,56 +2333,141 @@ void sensorSEN54Simulate(float& simulatedPM25, float& simulatedVOCIndex)
   debugMessage("sensorSEN54Simulate() end",1);
 }
 
+void sensorSEN5xAcquire()
+// Description: Passes a new SEN5x measurement, if there is one, to the decimation filters
+//              that sensorSEN554Read() takes the sample's values from. A replay passes
+//              every SEN5x reading recorded before the next SCD4x reading, the next sample's
+// Parameters: none
+// Output : NA
+{
+  #if defined(SENSOR_TRACE_REPLAY)
+    SensorTraceRecord record;
+    while (sensorTraceReplayNextBefore(traceSEN5x, traceSCD4x, record)) {
+      if (record.error)
+        debugMessage(String("replayed SEN5x acquire error ") + record.error,2);
+      else
+        sensorSEN5xFilter(record.pm25, record.vocIndex);
+    }
+  #elif !defined(HARDWARE_SIMULATE)
+    if (sensorWarmingUp(channelPM) || !sensorHealthReadable(sensorSEN5x))
+      return;
+
+    bool dataReady = false;
+    uint16_t error = pmSensor.readDataReady(dataReady);
+    if (error || !dataReady)
+      return;
+    float pm1 = NAN, pm25 = NAN, pm4 = NAN, pm10 = NAN, humidity = NAN, temperatureC = NAN, VOCIndex = NAN, NOxIndex = NAN;
+    error = pmSensor.readMeasuredValues(pm1, pm25, pm4, pm10, humidity, temperatureC, VOCIndex, NOxIndex);
+    sensorTraceWrite({millis(), traceSEN5x, error, 0, temperatureC, humidity, pm1, pm25, pm4, pm10, VOCIndex, NOxIndex});
+    if (error) {
+      debugMessage(String("SEN5x acquire error ") + error,2);
+      return;
+    }
+    sensorSEN5xFilter(pm25, VOCIndex);
+  #endif
+}
+
+void sensorSEN5xFilter(float pm25, float VOCIndex)
+// passes one SEN5x reading to the decimation filters. Out of range values are left out,
+// as sensorSEN554Read() would reject them
+{
+  if (pm25 >= sensorPMMin && pm25 <= sensorPMMax)
+    filterPM25.include(pm25);
+  if (!sensorWarmingUp(channelVOC) && VOCIndex >= sensorVOCMin && VOCIndex <= sensorVOCMax)
+    filterVOCIndex.include(VOCIndex);
+}
+
 bool sensorSEN554Read() 
 // Description: Retrieves values from SEN54 sensor
 // Parameters: none
-// Output : range validated pm25 and VOCIndex values, NAN NOxIndex value from SEN54
-// Improvement : Add support for checking isDataReady flag (see SCD40 read) 
+// Output : range validated pm25 and VOCIndex values, NAN NOxIndex value from SEN54. The
+//          hardware and replay builds take them from the readings sensorSEN5xAcquire()
+//          filtered since the last sample; hardware only reads the sensor itself when
+//          there are none
+// Improvement : NA
 {
   bool success = false;
   float pm25 = 0.0f;
   float VOCIndex = 0.0f;
-  float NOxIndex = 0.0f;
 
   debugMessage("sensorSEN554Read() start",1);
 
+  // no valid measurement yet, which is not a failure
+  if (sensorWarmingUp(channelPM)) {
+    debugMessage("SEN5x warming up, PM and VOC not yet valid",1);
+    return true;
+  }
+  // VOC index is not yet valid, PM is
+  bool vocValid = !sensorWarmingUp(channelVOC);
+
   #ifdef HARDWARE_SIMULATE
     sensorSEN54Simulate(pm25, VOCIndex);
     success = true;
   #else
-    uint16_t error;
-    char errorMessage[256];
-    float pm1, pm4, pm10, temperatureC, humidity = 0.0f; // read and discard
-
-    error = pmSensor.readMeasuredValues(pm1, pm25, pm4, pm10, humidity, temperatureC, VOCIndex, NOxIndex);
-    if (error) {
-      errorToString(error, errorMessage, 256);
-      debugMessage(String(errorMessage) + " error during SEN5x read",2);
-    }
-    else
+    if (filterPM25.count()) {
+      debugMessage(String("SEN5x ") + filterPM25.count() + " readings since the last sample",2);
+      pm25 = filterPM25.take();
+      vocValid = vocValid && filterVOCIndex.count();
+      VOCIndex = filterVOCIndex.take();
       success = true;
+    }
+    else {
+      #ifdef SENSOR_TRACE_REPLAY
+        debugMessage("sensor trace has no SEN5x readings for this sample",1);
+      #else
+        char errorMessage[256];
+        float pm1 = NAN, pm4 = NAN, pm10 = NAN, temperatureC = NAN, humidity = NAN, NOxIndex = NAN; // traced, otherwise discarded
+        uint16_t error = pmSensor.readMeasuredValues(pm1, pm25, pm4, pm10, humidity, temperatureC, VOCIndex, NOxIndex);
+        sensorTraceWrite({millis(), traceSEN5x, error, 0, temperatureC, humidity, pm1, pm25, pm4, pm10, VOCIndex, NOxIndex});
+        if (error) {
+          errorToString(error, errorMessage, 256);
+          debugMessage(String(errorMessage) + " error during SEN5x read",2);
+        }
+        else
+          success = true;
+      #endif
+    }
   #endif
 
-  // range valid returned sensor values, even simulation values can be OOB
-  if (pm25 < sensorPMMin || pm25 > sensorPMMax) {
-    success = false;
+  // range valid returned sensor values, even simulation values can be OOB. A value out of
+  // range is skipped, the reading's other is kept
+  bool pmValid = success;
+  const bool vocExpected = success && vocValid;
+  vocValid = vocExpected;
+  if (pmValid && (pm25 < sensorPMMin || pm25 > sensorPMMax)) {
+    pmValid = false;
     debugMessage(String("SEN5x PM2.5 reading: ") + pm25 + " is out of datasheet range",2);
   }
 
-  if (VOCIndex < sensorVOCMin || VOCIndex > sensorVOCMax) {
-    success = false;
+  if (vocValid && (VOCIndex < sensorVOCMin || VOCIndex > sensorVOCMax)) {
+    vocValid = false;
     debugMessage(String("SEN5x VOC index reading: ") + VOCIndex + " is out of datasheet range",2);
   }
 
-  // valid measurement, update globals
-  if (success) {
+  // valid values, update globals
+  const uint32_t nowMS = millis();
+  if (pmValid) {
     totalPM25.include(pm25);
-    totalVOCIndex.include(VOCIndex);
-
+    meanPM25.include(pm25, nowMS);
+    historyTiers.include(historyPM25, pm25, nowMS);
+    sampleRateInclude(channelPM, pm25, nowMS);
+    sampleValid |= SAMPLE_VALID_PM25;
     debugMessage(String("sensorSEN554Read() updating pm25: ") + totalPM25.getCurrent() + "ppm, total: " + totalPM25.getTotal(),2);
+  }
+  if (vocValid) {
+    totalVOCIndex.include(VOCIndex);
+    meanVOCIndex.include(VOCIndex, nowMS);
+    historyTiers.include(historyVOCIndex, VOCIndex, nowMS);
+    sampleRateInclude(channelVOC, VOCIndex, nowMS);
+    sampleValid |= SAMPLE_VALID_VOC;
     debugMessage(String("sensorSEN554Read() updating vocIndex: ") + totalVOCIndex.getCurrent() + ", total: " + totalVOCIndex.getTotal(),2);
-    debugMessage(String("sensorSEN554Read() NOxIndex is NAN"),2);
   }
+  else if (success && !vocExpected)
+    debugMessage("SEN5x warming up, VOC index not yet valid",1);
+  if (success)
+    debugMessage(String("sensorSEN554Read() NOxIndex is NAN"),2);
+  // a full reading: PM2.5 and, once valid, the VOC index
+  success = pmValid && (vocValid == vocExpected);
 
   debugMessage("sensorSEN554Read() end",1);
   return(success);
@@ -1764,7 +2480,7 @@ bool sensorSCD4xInit()
 
   debugMessage("sensorSCD4xInit() start",1);
 
-  #ifdef HARDWARE_SIMULATE
+  #if defined(HARDWARE_SIMULATE) || defined(SENSOR_TRACE_REPLAY)
     success = true;
   #else
     uint16_t error;
@@ -1779,36 +2495,69 @@ bool sensorSCD4xInit()
       errorToString(error, errorMessage, 256);
       debugMessage(String(errorMessage) + " executing SCD4X stopPeriodicMeasurement()",1);
     }
-    else {
-      // modify configuration settings while not in active measurement mode
-      error = co2Sensor.setSensorAltitude(hardwareData.altitude);  // optimizes CO2 reading
-      if (!error)
-        debugMessage(String("SCD4X altitude set to ") + hardwareData.altitude + " meters",2);
-      else {
-        errorToString(error, errorMessage, 256);
-        debugMessage(String(errorMessage) + " executing SCD4X setSensorAltitude()",1);
-      }
-      // Start Measurement.  For high power mode, with a fixed update interval of 5 seconds
-      // (the typical usage mode), use startPeriodicMeasurement().  For low power mode, with
-      // a longer fixed sample interval of 30 seconds, use startLowPowerPeriodicMeasurement()
-      // uint16_t error = co2Sensor.startPeriodicMeasurement();
-      error = co2Sensor.startLowPowerPeriodicMeasurement();
-      if (error) {
-        errorToString(error, errorMessage, 256);
-        debugMessage(String(errorMessage) + " executing SCD4X startLowPowerPeriodicMeasurement()",2);
-      }
-      else
-      {
-        debugMessage("SCD4X starting low power periodic measurements",2);
-        success = true;
-      }
-    }
+    else
+      success = sensorSCD4xConfigure();
   #endif
 
   debugMessage("sensorSCD4xInit() end",1);
   return success;
 }
 
+bool sensorSCD4xConfigure()
+// sets up and starts the stopped SCD4X, after sensorSCD4xInit() or a recovery's stop
+{
+  bool success = false;
+  uint16_t error;
+  char errorMessage[256];
+
+  // modify configuration settings while not in active measurement mode
+  error = co2Sensor.setSensorAltitude(hardwareData.altitude);  // optimizes CO2 reading
+  if (!error)
+    debugMessage(String("SCD4X altitude set to ") + hardwareData.altitude + " meters",2);
+  else {
+    errorToString(error, errorMessage, 256);
+    debugMessage(String(errorMessage) + " executing SCD4X setSensorAltitude()",1);
+  }
+  #ifdef SCD4X_SINGLE_SHOT
+    // the sensor stays idle, each sample starts a measurement, see sensorSCD4xRead()
+    debugMessage("SCD4X idle between single shot measurements",2);
+    success = true;
+  #else
+  // the first periodic measurement takes timeSCD4xReadMinMS; a single shot measurement,
+  // which sensorSCD4xRead() collects before it starts them, has the first CO2 reading in
+  // timeSCD4xSingleShotMS
+  scd4xFirstShot = !sensorCommandSend(SCD41_I2C_ADDR_62, MEASURE_SINGLE_SHOT_CMD_ID);
+  if (scd4xFirstShot) {
+    timeSCD4xFirstShotMS = millis();
+    debugMessage("SCD4X first measurement single shot",2);
+    success = true;
+  }
+  else
+    success = sensorSCD4xPeriodicStart();
+  #endif
+  return success;
+}
+
+#ifndef SCD4X_SINGLE_SHOT
+bool sensorSCD4xPeriodicStart()
+// starts the SCD4X measuring on its own cadence
+{
+  char errorMessage[256];
+  // Start Measurement.  For high power mode, with a fixed update interval of 5 seconds
+  // (the typical usage mode), use startPeriodicMeasurement().  For low power mode, with
+  // a longer fixed sample interval of 30 seconds, use startLowPowerPeriodicMeasurement()
+  // uint16_t error = co2Sensor.startPeriodicMeasurement();
+  uint16_t error = co2Sensor.startLowPowerPeriodicMeasurement();
+  if (error) {
+    errorToString(error, errorMessage, 256);
+    debugMessage(String(errorMessage) + " executing SCD4X startLowPowerPeriodicMeasurement()",2);
+    return false;
+  }
+  debugMessage("SCD4X starting low power periodic measurements",2);
+  return true;
+}
+#endif
+
 // Description: Simulates temp, humidity, and CO2 values from Sensirion SCD4X sensor
 // Parameters:
 //  mode
@@ -1917,85 +2666,181 @@ uint16_t& simulatedCO2)
 sensorSCD4xSimulate(0, 0, simulatedTempF, simulatedHumidity, simulatedCO2);
 }
 
-bool sensorSCD4xRead()
-// Description: Retrieves values from SCD4x sensor
+uint16_t sensorCommandSend(uint8_t address, uint16_t command)
+// sends a Sensirion command without arguments, e.g. the SCD41 measure_single_shot. The
+// libraries' calls send the same frame then wait out its execution time in delay(); this
+// returns at once, and the sensor doesn't answer on the bus until that time has passed
+{
+  uint8_t buffer[2];
+  SensirionI2CTxFrame txFrame = SensirionI2CTxFrame::createWithUInt16Command(command, buffer, sizeof(buffer));
+  return SensirionI2CCommunication::sendFrame(address, txFrame, Wire);
+}
+
+uint8_t sensorSCD4xRead()
+// Description: Retrieves values from SCD4x sensor, without blocking on its data-ready flag
 // Parameters: none
-// Output : range validated tempF, humidity, and CO2 values from SCD4x
+// Output : readPending until the sensor has data or co2SensorReadFailureLimit polls have
+//          failed, then readSuccess with range validated tempF, humidity, and CO2 values
+//          or readFailure. With SCD4X_SINGLE_SHOT the read starts a measurement and
+//          reads it once timeSCD4xSingleShotMS has passed, without polling data-ready
 // Improvement : NA  
 {
   bool success = false;
   float temperatureF = 0.0f;
   float humidity = 0.0f;
   uint16_t co2 = 0;
+  uint16_t error = 0;
+  float temperatureC = 0.0f;
 
-  debugMessage("sensorSCD4xRead() start",1);
+  if (!sensorReadPending)
+    debugMessage("sensorSCD4xRead() start",1);
 
   #ifdef HARDWARE_SIMULATE
     success = true;
-    sensorSCD4xSimulate(1, 10, temperatureF, humidity, co2);
+    sensorSCD4xSimulate(simulateSCD4xMode, simulateSCD4xCycles, temperatureF, humidity, co2);
+    temperatureC = (temperatureF-32)/1.8;
+  #elif defined(SENSOR_TRACE_REPLAY)
+    SensorTraceRecord record;
+    if (!sensorTraceReplayNext(traceSCD4x, record)) {
+      debugMessage("sensor trace has no more SCD4x readings",1);
+      error = kSensorErrorNotReady;
+    }
+    else {
+      error = record.error;
+      co2 = record.co2;
+      temperatureC = record.temperatureC;
+      humidity = record.humidity;
+      if (error)
+        debugMessage(String("replayed error ") + error + " during SCD4x read",1);
+      else {
+        success = true;
+        temperatureF = (temperatureC*1.8)+32;
+      }
+    }
   #else
-    uint16_t error;
-    uint8_t errorCount = 0;
+    static bool polling = false;  // a read is in progress
+    static uint8_t polls = 0;     // data-ready polls so far
     char errorMessage[256];
-    float temperatureC = 0.0f;
-
-    // Loop attempting to read Measurement
-    while((errorCount < co2SensorReadFailureLimit) && (!success)) {
-      delay(100);
-      errorCount++;
-      // Is data ready to be read?
-      bool isDataReady = false;
-      error = co2Sensor.getDataReadyStatus(isDataReady);
-      if (error) {
+
+    // start a read. Single shot measures from here; periodic measurements are made on the
+    // sensor's own cadence, so the first poll is now
+    if (!polling) {
+      polls = 0;
+      #ifdef SCD4X_SINGLE_SHOT
+        // the measurement is done by its deadline, read it then
+        error = sensorCommandSend(SCD41_I2C_ADDR_62, MEASURE_SINGLE_SHOT_CMD_ID);
+        timeSensorPollMS = millis() + timeSCD4xSingleShotMS;
+        polling = !error;
+        if (polling)
+          return readPending;
+        debugMessage(String("SCD4x single shot start failed: ") + error,1);
+      #else
+        polling = true;
+        // the first measurement is a single shot, see sensorSCD4xConfigure(); read it once done
+        const uint32_t firstShotDueMS = timeSCD4xFirstShotMS + timeSCD4xSingleShotMS;
+        if (scd4xFirstShot && (int32_t)(millis() - firstShotDueMS) < 0) {
+          timeSensorPollMS = firstShotDueMS;
+          return readPending;
+        }
+      #endif
+    }
+    if (polling) {
+      polls++;
+      // Is data ready to be read? Single shot reads past the deadline; a late measurement
+      // fails the read, which polls again
+      bool isDataReady = true;
+      #ifndef SCD4X_SINGLE_SHOT
+        if (!scd4xFirstShot)
+          error = co2Sensor.getDataReadyStatus(isDataReady);
+        if (error) {
           errorToString(error, errorMessage, 256);
           debugMessage(String("Error trying to execute getDataReadyStatus(): ") + errorMessage,1);
-          continue; // Back to the top of the loop
-      }
-      if (!isDataReady) {
-          continue; // Back to the top of the loop
-      }
-
-      error = co2Sensor.readMeasurement(co2, temperatureC, humidity);
-      if (error) {
+        }
+      #endif
+      if (!error && isDataReady) {
+        error = co2Sensor.readMeasurement(co2, temperatureC, humidity);
+        if (error) {
           errorToString(error, errorMessage, 256);
           debugMessage(String("SCD40 executing readMeasurement(): ") + errorMessage,1);
+        }
+        else {
+          success = true;
+          temperatureF = (temperatureC*1.8)+32;
+          // the measurement came in since the last poll, see sampleAlign()
+          #ifndef SCD4X_SINGLE_SHOT
+            if (polls > 1)
+              timeSCD4xReadyMS = millis();
+          #endif
+        }
       }
-      else {
-        success = true;
-        temperatureF = (temperatureC*1.8)+32;
+      #ifndef SCD4X_SINGLE_SHOT
+        // periodic measurements start after the first, the next a full interval on, and
+        // sampleAlign() moves the next sample to it
+        if (scd4xFirstShot) {
+          scd4xFirstShot = false;
+          sensorSCD4xPeriodicStart();
+          timeSCD4xReadyMS = millis();
+        }
+      #endif
+
+      // not yet, poll again later; until the first measurement that is not a failure
+      if (!success && (polls < co2SensorReadFailureLimit || sensorWarmingUp(channelCO2))) {
+        timeSensorPollMS = millis() + timeSCD4xPollMS;
+        return readPending;
       }
+      polling = false;
     }
+    if (!success && !error)
+      error = kSensorErrorNotReady;
   #endif
 
-  // validate returned sensor values, even simulation can generate OOB values
+  sensorTraceWrite({millis(), traceSCD4x, error, co2, temperatureC, humidity, NAN, NAN, NAN, NAN, NAN, NAN});
 
-  if (co2 < sensorCO2Min || co2 > sensorCO2Max) {
-    success = false;
+  // validate returned sensor values, even simulation can generate OOB values. A value out
+  // of range is skipped, the reading's others are kept
+  uint8_t valid = success ? (SAMPLE_VALID_TEMP | SAMPLE_VALID_HUM | SAMPLE_VALID_CO2) : 0;
+
+  if (success && (co2 < sensorCO2Min || co2 > sensorCO2Max)) {
+    valid &= ~SAMPLE_VALID_CO2;
     debugMessage(String("SCD4x CO2 reading: ") + co2 + " is out of datasheet range",2);
   }
 
-  if (temperatureF < sensorTempFMin || temperatureF > sensorTempFMax) {
-    success = false;
+  if (success && (temperatureF < sensorTempFMin || temperatureF > sensorTempFMax)) {
+    valid &= ~SAMPLE_VALID_TEMP;
     debugMessage(String("SCD4x temperatureF reading: ") + temperatureF + " is out of datasheet range",2);
   }
 
-  if (humidity < sensorHumidityMin || humidity > sensorHumidityMax) {
-    success = false;
+  if (success && (humidity < sensorHumidityMin || humidity > sensorHumidityMax)) {
+    valid &= ~SAMPLE_VALID_HUM;
     debugMessage(String("SCD4x humidity reading: ") + humidity + " is out of datasheet range",2);
   }
 
-  // valid measurement, update globals
-  if (success) {
+  // valid values, update globals
+  const uint32_t nowMS = millis();
+  if (valid & SAMPLE_VALID_TEMP) {
     totalTemperatureF.include(temperatureF);
-    totalHumidity.include(humidity);
-    totalCO2.include(co2);
-
+    meanTemperatureF.include(temperatureF, nowMS);
+    historyTiers.include(historyTemperatureF, temperatureF, nowMS);
     debugMessage(String("SCD4x temp ") + totalTemperatureF.getCurrent() + "F, total across samples: " + totalTemperatureF.getTotal(),2);
+  }
+  if (valid & SAMPLE_VALID_HUM) {
+    totalHumidity.include(humidity);
+    meanHumidity.include(humidity, nowMS);
+    historyTiers.include(historyHumidity, humidity, nowMS);
     debugMessage(String("SCD4x humidity ") + totalHumidity.getCurrent() + ", total across samples: " + totalHumidity.getTotal(),2);
+  }
+  if (valid & SAMPLE_VALID_CO2) {
+    totalCO2.include(co2);
+    meanCO2.include(co2, nowMS);
+    historyTiers.include(historyCO2, co2, nowMS);
+    sampleRateInclude(channelCO2, co2, nowMS);
+    channelMeasured[channelCO2] = true;
     debugMessage(String("SCD4x CO2 ") + totalCO2.getCurrent() + "ppm, total: " + totalCO2.getTotal(),2);
   }
+  sampleValid |= valid;
+  success = (valid == (SAMPLE_VALID_TEMP | SAMPLE_VALID_HUM | SAMPLE_VALID_CO2));
   debugMessage("sensorSCD4xRead() end",1);
-  return(success);
+  return(success ? readSuccess : readFailure);
 }
 
 String deviceGetID(String prefix)
@@ -2010,26 +2855,12 @@ String deviceGetID(String prefix)
   }
 }
 
-void deviceReboot(String messageText, uint16_t timeAlertMS)
+void deviceRestart()
+// writes the sample log's page being filled, from the worker task that owns the log, then
+// restarts the device
 {
-  debugMessage("deviceReboot() start",1);
-  display.loadFont(Roboto_Regular_18);
-  screenHelperAlert(messageText,TFT_WHITE,TFT_BLACK,TFT_RED);
-  display.unloadFont();
-  networkDisconnect();
-
-  uint32_t timeRebootStartMS = millis();
-
-  while (millis() - timeRebootStartMS < timeAlertMS)
-  {
-    #ifndef HARDWARE_SIMULATE
-      ledcWriteTone(pinAudio, audioFrequency);
-      delay(500);
-      ledcWriteTone(pinAudio,0);
-      delay(500);
-    #endif
-  }
-  debugMessage("deviceReboot() end",1);
+  if (!dualCoreWorkerRun(sampleLogFlush, timeRestartFlushMS))
+    debugMessage("worker busy, sample log page not written before restart",1);
   ESP.restart();
 }
 
@@ -2195,6 +3026,14 @@ float randomFloatRange(uint16_t min, uint16_t max) {
   return min + (randomFixed / 100.0f);
 }
 
+void alertStart(uint32_t lengthMS)
+// starts an alert's timer; callers set alertScreen/alertSound and show the alert, alertHandle() ends it
+{
+  alertLengthMS = lengthMS;
+  alertStartMS = millis();
+  schedulerAt(taskAlertEnd, alertStartMS + alertLengthMS + 1); // alertHandle() tests with >
+}
+
 void alertHandle() {
   // is there an alert to handle?
   if (alertLengthMS) {
@@ -0,0 +1,96 @@
+/*
+  Project Name:   Powered Air Quality
+  Description:    compact fixed point history of samples for the graphs (see sample_history.h)
+*/
+
+#include "Arduino.h"
+
+#include "sample_history.h"
+
+int16_t historyStored(uint8_t channel, float value)
+{
+  if (channel >= kHistoryChannelCount || isnan(value)) return kHistoryMissing;
+  const float scaled = roundf(value * kHistoryScale[channel]);
+  return (scaled >= INT16_MAX) ? INT16_MAX : (scaled <= INT16_MIN + 1) ? INT16_MIN + 1 : (int16_t)scaled;
+}
+
+void SampleHistory::append(const float values[kHistoryChannelCount], uint8_t valid)
+{
+  const uint32_t sample = _appended.load(std::memory_order_relaxed);
+  int16_t stored[kHistoryChannelCount];
+  for (uint8_t channel = 0; channel < kHistoryChannelCount; channel++)
+    stored[channel] = (valid & (1 << channel)) ? historyStored(channel, values[channel]) : kHistoryMissing;
+  store(sample, stored);
+  for (uint8_t channel = 0; channel < kHistoryChannelCount; channel++)
+    _extrema[channel].include(sample, _values[channel], stored[channel] != kHistoryMissing);
+  _appended.store(sample + 1, std::memory_order_release);
+}
+
+void SampleHistory::preset(uint32_t count)
+{
+  for (uint8_t channel = 0; channel < kHistoryChannelCount; channel++)
+    for (uint16_t slot = 0; slot < kHistoryCapacity; slot++) _values[channel][slot] = kHistoryMissing;
+  for (auto& extrema : _extrema) extrema.clear();
+  _appended.store(count, std::memory_order_release);
+}
+
+void SampleHistory::store(uint32_t sample, const int16_t stored[kHistoryChannelCount])
+{
+  const uint16_t slot = sample % kHistoryCapacity;
+  for (uint8_t channel = 0; channel < kHistoryChannelCount; channel++) _values[channel][slot] = stored[channel];
+}
+
+void SampleHistory::extremaRebuild()
+{
+  const uint32_t end = appended();
+  for (uint8_t channel = 0; channel < kHistoryChannelCount; channel++) {
+    _extrema[channel].clear();
+    for (uint32_t sample = end - available(end); sample < end; sample++)
+      _extrema[channel].include(sample, _values[channel], _values[channel][sample % kHistoryCapacity] != kHistoryMissing);
+  }
+}
+
+uint16_t SampleHistory::available(uint32_t end) const
+{
+  return (end < kHistoryWindow) ? end : kHistoryWindow;
+}
+
+bool SampleHistory::span(uint8_t channel, uint32_t first, uint32_t end, float& minValue, float& maxValue, float& mean) const
+{
+  if (channel >= kHistoryChannelCount || end <= first) return false;
+  int16_t low = INT16_MAX, high = INT16_MIN;
+  int32_t total = 0;
+  uint16_t count = 0;
+  // in order, in at most two runs around the ring's end
+  uint16_t slot = first % kHistoryCapacity;
+  uint32_t remaining = end - first;
+  while (remaining) {
+    const uint16_t run = (remaining < (uint32_t)(kHistoryCapacity - slot)) ? remaining : kHistoryCapacity - slot;
+    const int16_t *value = &_values[channel][slot];
+    for (uint16_t i = 0; i < run; i++, value++) {
+      if (*value == kHistoryMissing) continue;
+      if (*value < low) low = *value;
+      if (*value > high) high = *value;
+      total += *value;
+      count++;
+    }
+    remaining -= run;
+    slot = 0;
+  }
+  if (!count) return false;
+  minValue = low / kHistoryScale[channel];
+  maxValue = high / kHistoryScale[channel];
+  mean = (float)total / count / kHistoryScale[channel];
+  return true;
+}
+
+HistoryRange SampleHistory::extrema(uint8_t channel) const
+{
+  HistoryRange range;
+  int16_t low, high;
+  if (channel >= kHistoryChannelCount || !_extrema[channel].extrema(_values[channel], low, high)) return range;
+  range.minValue = low / kHistoryScale[channel];
+  range.maxValue = high / kHistoryScale[channel];
+  range.valid = true;
+  return range;
+}
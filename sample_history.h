@@ -0,0 +1,67 @@
+/*
+  Project:      Powered Air Quality
+  Description:  compact fixed point history of samples for the graphs
+*/
+
+#ifndef SAMPLE_HISTORY_H
+  #define SAMPLE_HISTORY_H
+
+  #include <Arduino.h>
+  #include <atomic>
+
+  #include "config.h"
+  #include "sliding_extrema.h"
+
+  enum historyChannel : uint8_t { historyTemperatureF, historyHumidity, historyCO2, historyPM25,
+    historyVOCIndex, kHistoryChannelCount };
+  // stored value = value x scale, by historyChannel; the order matches the SAMPLE_VALID_ flags
+  constexpr float kHistoryScale[kHistoryChannelCount] = {10.0f, 10.0f, 1.0f, 10.0f, 1.0f};
+  constexpr int16_t kHistoryMissing = INT16_MIN;
+  // samples appended while a graph is drawn, at most, see available()
+  constexpr uint16_t kHistoryGuard = 16;
+  // samples a graph draws, at most
+  constexpr uint16_t kHistoryWindow = kHistoryCapacity - kHistoryGuard;
+
+  // a channel's minimum and maximum over the samples a graph draws
+  struct HistoryRange {
+    float minValue = 0.0f;
+    float maxValue = 0.0f;
+    bool valid = false;     // false if they are all missing
+  };
+
+  // a value of a historyChannel as stored, saturating short of kHistoryMissing; NAN is missing
+  int16_t historyStored(uint8_t channel, float value);
+
+  // kHistoryCapacity samples of every channel, one writer (the worker) and lock-free readers
+  class SampleHistory {
+    public:
+      // writer only; values by historyChannel, those without their bit in valid stored as missing
+      void append(const float values[kHistoryChannelCount], uint8_t valid);
+      // writer only, before readers start: count samples appended, all missing until store()
+      // fills them in, in any order
+      void preset(uint32_t count);
+      void store(uint32_t sample, const int16_t stored[kHistoryChannelCount]);
+      // writer only, after store(): the extrema of the samples stored
+      void extremaRebuild();
+      // samples appended since boot; readers use the samples before it
+      uint32_t appended() const { return _appended.load(std::memory_order_acquire); }
+      // how many samples, ending before end (an appended() value), can be read safely
+      uint16_t available(uint32_t end) const;
+      // the minimum, maximum and mean of samples [first, end) of a channel, missing values left
+      // out; false if all are missing
+      bool span(uint8_t channel, uint32_t first, uint32_t end, float& minValue, float& maxValue,
+        float& mean) const;
+      // writer only: a channel over the samples available(appended()) draws, in constant time,
+      // kept by append() with a monotonic deque minimum and maximum; the worker publishes it
+      // with each sample, so the graphs scale without a scan
+      HistoryRange extrema(uint8_t channel) const;
+
+    private:
+      int16_t _values[kHistoryChannelCount][kHistoryCapacity];
+      SlidingExtrema<kHistoryWindow, kHistoryCapacity> _extrema[kHistoryChannelCount];
+      std::atomic<uint32_t> _appended{0};
+  };
+
+  extern SampleHistory sampleHistory;
+
+#endif  // #ifdef SAMPLE_HISTORY_H
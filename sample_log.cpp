@@ -0,0 +1,514 @@
+/*
+  Project Name:   Powered Air Quality
+  Description:    append-only log of samples on flash (see sample_log.h)
+*/
+
+#include "Arduino.h"
+#include <LittleFS.h>
+
+#include "sample_log.h"
+#include "series_codec.h"
+
+namespace {
+  constexpr const char *kLogDirectory = "/samples";
+  constexpr uint16_t kIndexPerSegment = kLogSegmentPages / kLogIndexStride;
+  static_assert(kLogSegmentPages % kLogIndexStride == 0, "segments hold whole index strides");
+
+  struct LogPage {
+    uint32_t timeS;         // of the first record
+    uint32_t lastS;         // of the last
+    uint32_t offset;        // the first record's, from the segment's first
+    uint16_t records;
+    uint16_t headerCRC;     // of the fields above
+    uint16_t dataCRC;
+    uint8_t data[kLogPageBytes - 18];
+  };
+  static_assert(sizeof(LogPage) == kLogPageBytes, "a log page is a flash page");
+  constexpr size_t kHeaderBytes = offsetof(LogPage, data);
+
+  struct Segment {
+    uint32_t number;        // its file, see segmentPath()
+    uint32_t firstRecord;
+    uint32_t records;
+    uint16_t pages;         // on flash, never 0
+  };
+  // the first page with a good header of each stride of kLogIndexStride pages
+  struct IndexEntry {
+    uint32_t timeS;
+    uint32_t offset;
+  };
+
+  // on flash, oldest first from segments[segmentFirst]
+  Segment segments[kLogSegments];
+  uint8_t segmentFirst = 0, segmentCount = 0;
+  bool segmentSealed = false;   // the newest takes no more pages: its tail is torn, or a write failed
+  // by segments[] slot
+  IndexEntry segmentIndex[kLogSegments][kIndexPerSegment];
+  uint32_t firstRecord = 0;     // the oldest on flash
+  uint32_t writtenEnd = 0;      // one past the newest on flash, the page being filled's first
+  // the page being filled
+  LogPage page;
+  SeriesEncoder encoder;
+  bool pageNewSegment = false;  // goes into a new segment
+  File segmentFile;             // the newest segment, open for appending from its first page write
+  bool mounted = false;
+  uint32_t clockS = 0, clockRemainderMS = 0, clockLastMS = 0;
+  SampleLogStats stats = {0, 0, 0, 0, 0, 0};
+
+  uint8_t slotOf(uint8_t position) { return (segmentFirst + position) % kLogSegments; }
+  Segment& segmentAt(uint8_t position) { return segments[slotOf(position)]; }
+  uint16_t segmentStrides(const Segment& segment) { return (segment.pages + kLogIndexStride - 1) / kLogIndexStride; }
+
+  String segmentPath(uint32_t number)
+  {
+    char path[32];
+    snprintf(path, sizeof(path), "%s/%08lx.log", kLogDirectory, (unsigned long)number);
+    return String(path);
+  }
+
+  // a segment's number from its file name, false for anything else
+  bool segmentNumber(const char *name, uint32_t& number)
+  {
+    char *end = nullptr;
+    number = strtoul(name, &end, 16);
+    return end != name && !strcmp(end, ".log");
+  }
+
+  uint16_t crc16(const void *bytes, size_t length)
+  {
+    // CRC-16/CCITT-FALSE
+    const uint8_t *byte = (const uint8_t *)bytes;
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < length; i++) {
+      crc ^= (uint16_t)byte[i] << 8;
+      for (uint8_t bit = 0; bit < 8; bit++) crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+  }
+
+  bool headerGood(const LogPage& logPage)
+  {
+    return logPage.headerCRC == crc16(&logPage, offsetof(LogPage, headerCRC));
+  }
+
+  // a page of the segment at position, its header only or all of it; false if the file or
+  // the header can't be read, or the header fails its CRC
+  bool pageRead(File& file, uint16_t number, LogPage& logPage, bool whole)
+  {
+    const size_t bytes = whole ? sizeof(LogPage) : kHeaderBytes;
+    if (!file.seek((uint32_t)number * sizeof(LogPage)) || file.read((uint8_t *)&logPage, bytes) != bytes) return false;
+    if (headerGood(logPage)) return true;
+    stats.crcErrors++;
+    return false;
+  }
+
+  void recordMissing(SampleLogRecord& record)
+  {
+    record.timeS = 0;
+    for (int16_t& value : record.values) value = kHistoryMissing;
+  }
+
+  // count records of a whole page from skip; a page that fails its CRC reads as missing
+  uint16_t pageDecode(const LogPage& logPage, uint32_t skip, SampleLogRecord records[], uint16_t count, bool checked)
+  {
+    const bool good = !checked || logPage.dataCRC == crc16(logPage.data, sizeof(logPage.data));
+    if (!good) stats.crcErrors++;
+    SeriesDecoder decoder;
+    decoder.begin(logPage.data, sizeof(logPage.data), logPage.records);
+    uint16_t read = 0;
+    SampleLogRecord record;
+    for (uint32_t i = 0; i < logPage.records && read < count; i++) {
+      if (!good || !decoder.next(record.timeS, record.values)) recordMissing(record);
+      if (i >= skip) records[read++] = record;
+    }
+    return read;
+  }
+
+  // the first record of a page at or after timeS, logPage.records if there is none
+  uint16_t pageFind(const LogPage& logPage, uint32_t timeS)
+  {
+    SeriesDecoder decoder;
+    decoder.begin(logPage.data, sizeof(logPage.data), logPage.records);
+    SampleLogRecord record;
+    for (uint16_t i = 0; decoder.next(record.timeS, record.values); i++) {
+      if (record.timeS >= timeS) return i;
+    }
+    return logPage.records;
+  }
+
+  // the position of the segment holding a record on flash
+  uint8_t segmentOf(uint32_t record)
+  {
+    uint8_t low = 0, high = segmentCount - 1;
+    while (low < high) {
+      const uint8_t middle = (low + high + 1) / 2;
+      if (segmentAt(middle).firstRecord <= record) low = middle;
+      else high = middle - 1;
+    }
+    return low;
+  }
+
+  // the last stride of the segment at position whose index entry passes, the first if none
+  template <typename Before>
+  uint16_t strideOf(uint8_t position, Before before)
+  {
+    const IndexEntry *index = segmentIndex[slotOf(position)];
+    uint16_t low = 1, high = segmentStrides(segmentAt(position));
+    while (low < high) {
+      const uint16_t middle = (low + high) / 2;
+      if (before(index[middle])) low = middle + 1;
+      else high = middle;
+    }
+    return low - 1;
+  }
+
+  void segmentDeleteOldest()
+  {
+    LittleFS.remove(segmentPath(segmentAt(0).number));
+    segmentFirst = (segmentFirst + 1) % kLogSegments;
+    segmentCount--;
+    firstRecord = segmentCount ? segmentAt(0).firstRecord : writtenEnd;
+  }
+
+  // a new newest segment, deleting the oldest to make room
+  void segmentStart()
+  {
+    segmentFile.close();
+    const uint32_t number = segmentCount ? segmentAt(segmentCount - 1).number + 1 : 0;
+    const size_t segmentBytes = (size_t)kLogSegmentPages * kLogPageBytes;
+    while (segmentCount >= kLogSegments
+        || (segmentCount > 1 && LittleFS.totalBytes() - LittleFS.usedBytes() < segmentBytes))
+      segmentDeleteOldest();
+    segmentAt(segmentCount) = {number, writtenEnd, 0, 0};
+    segmentCount++;
+    segmentSealed = false;
+  }
+
+  // writes the page being filled to the newest segment, syncing it so it survives a reset; a
+  // segment's file stays open across its pages, see sampleLogFlush()
+  void pageWrite()
+  {
+    if (!mounted || !encoder.count()) return;
+    if (pageNewSegment) segmentStart();
+    const uint8_t position = segmentCount - 1;
+    Segment& segment = segmentAt(position);
+
+    page.records = encoder.count();
+    memset(page.data + encoder.bytesUsed(), 0, sizeof(page.data) - encoder.bytesUsed());
+    page.headerCRC = crc16(&page, offsetof(LogPage, headerCRC));
+    page.dataCRC = crc16(page.data, sizeof(page.data));
+    if (!segmentFile) segmentFile = LittleFS.open(segmentPath(segment.number), FILE_APPEND);
+    const size_t written = segmentFile ? segmentFile.write((const uint8_t *)&page, sizeof(page)) : 0;
+    // a flush commits the page
+    if (written == sizeof(page)) segmentFile.flush();
+    encoder.begin(page.data, sizeof(page.data));
+
+    if (written == sizeof(page)) {
+      if (segment.pages % kLogIndexStride == 0)
+        segmentIndex[slotOf(position)][segment.pages / kLogIndexStride] = {page.timeS, page.offset};
+      segment.pages++;
+      segment.records += page.records;
+      writtenEnd += page.records;
+      stats.pages++;
+      return;
+    }
+    // the page is lost, and the next starts a new segment
+    stats.writeFailures++;
+    segmentSealed = true;
+    segmentFile.close();
+    if (!segment.pages) {
+      LittleFS.remove(segmentPath(segment.number));
+      segmentCount--;
+    }
+  }
+
+  // starts the page being filled, with a record at timeS
+  void pageStart(uint32_t timeS)
+  {
+    const Segment *last = segmentCount ? &segmentAt(segmentCount - 1) : nullptr;
+    pageNewSegment = !last || segmentSealed || last->pages >= kLogSegmentPages;
+    page.timeS = timeS;
+    page.offset = pageNewSegment ? 0 : last->records;
+    encoder.begin(page.data, sizeof(page.data));
+  }
+
+  // a stale file in the log's directory: a segment older than first, or one too short to
+  // hold a page; false if there is none
+  bool staleFind(uint32_t first, String& path)
+  {
+    File directory = LittleFS.open(kLogDirectory);
+    bool found = false;
+    for (File file = directory.openNextFile(); file && !found; file = directory.openNextFile()) {
+      uint32_t number;
+      if (segmentNumber(file.name(), number) && (number < first || file.size() < sizeof(LogPage))) {
+        path = String(kLogDirectory) + "/" + file.name();
+        found = true;
+      }
+      file.close();
+    }
+    directory.close();
+    return found;
+  }
+}
+
+bool sampleLogBegin()
+{
+  // nothing carries over from a previous setup(), as on the device
+  segmentFile.close();
+  segmentFirst = segmentCount = 0;
+  segmentSealed = false;
+  firstRecord = writtenEnd = 0;
+  encoder.begin(page.data, sizeof(page.data));
+  clockS = clockRemainderMS = 0;
+  clockLastMS = millis();
+  stats = SampleLogStats{0, 0, 0, 0, 0, 0};
+
+  mounted = LittleFS.begin(true);
+  if (mounted && !LittleFS.exists(kLogDirectory)) mounted = LittleFS.mkdir(kLogDirectory);
+  if (!mounted) return false;
+
+  // the newest kLogSegments segments that hold a page, in order
+  uint32_t numbers[kLogSegments];
+  uint8_t found = 0;
+  File directory = LittleFS.open(kLogDirectory);
+  for (File file = directory.openNextFile(); file; file = directory.openNextFile()) {
+    uint32_t number;
+    const bool segment = segmentNumber(file.name(), number) && file.size() >= sizeof(LogPage);
+    file.close();
+    if (!segment || (found == kLogSegments && number < numbers[0])) continue;
+    if (found == kLogSegments) {
+      memmove(numbers, numbers + 1, (kLogSegments - 1) * sizeof(numbers[0]));
+      found--;
+    }
+    uint8_t position = found++;
+    for (; position && numbers[position - 1] > number; position--) numbers[position] = numbers[position - 1];
+    numbers[position] = number;
+  }
+  directory.close();
+  String stale;
+  while (staleFind(found ? numbers[0] : 0, stale)) LittleFS.remove(stale);
+
+  // each segment's index and records, and the newest record's time, where the clock carries on
+  IndexEntry previous = {0, 0};
+  uint32_t lastS = 0;
+  for (uint8_t position = 0; position < found; position++) {
+    File file = LittleFS.open(segmentPath(numbers[position]), FILE_READ);
+    const size_t size = file.size();
+    const uint16_t pages = (size / sizeof(LogPage) < kLogSegmentPages) ? size / sizeof(LogPage) : kLogSegmentPages;
+    Segment& segment = segments[position];
+    segment = {numbers[position], writtenEnd, 0, pages};
+    LogPage logPage;
+    for (uint16_t stride = 0; stride < segmentStrides(segment); stride++) {
+      // a stride whose headers all fail keeps the entry before it
+      IndexEntry& entry = segmentIndex[position][stride];
+      entry = (stride ? segmentIndex[position][stride - 1] : IndexEntry{previous.timeS, 0});
+      for (uint16_t number = stride * kLogIndexStride; number < (stride + 1) * kLogIndexStride && number < pages; number++) {
+        if (pageRead(file, number, logPage, false)) {
+          entry = {logPage.timeS, logPage.offset};
+          break;
+        }
+      }
+    }
+    previous = segmentIndex[position][segmentStrides(segment) - 1];
+    // the newest good page ends the segment's records
+    for (uint16_t number = pages; number-- > 0; ) {
+      if (!pageRead(file, number, logPage, false)) continue;
+      segment.records = logPage.offset + logPage.records;
+      lastS = logPage.lastS;
+      break;
+    }
+    // a torn last page, from a write cut off by a reset
+    if (position == found - 1) segmentSealed = (size != (size_t)pages * sizeof(LogPage));
+    file.close();
+    writtenEnd += segment.records;
+  }
+  segmentCount = found;
+  firstRecord = 0;
+  if (found) clockS = lastS + 1;
+  return true;
+}
+
+uint32_t sampleLogTimeS()
+{
+  const uint32_t nowMS = millis();
+  clockRemainderMS += nowMS - clockLastMS;
+  clockLastMS = nowMS;
+  clockS += clockRemainderMS / 1000;
+  clockRemainderMS %= 1000;
+  return clockS;
+}
+
+void sampleLogAppend(const float values[kHistoryChannelCount], uint8_t valid)
+{
+  if (!mounted) return;
+  int16_t stored[kHistoryChannelCount];
+  for (uint8_t channel = 0; channel < kHistoryChannelCount; channel++)
+    stored[channel] = (valid & (1 << channel)) ? historyStored(channel, values[channel]) : kHistoryMissing;
+  const uint32_t timeS = sampleLogTimeS();
+  stats.appended++;
+  if (!encoder.count() || !encoder.append(timeS, stored)) {
+    // the page is full
+    pageWrite();
+    pageStart(timeS);
+    encoder.append(timeS, stored);
+  }
+  page.lastS = timeS;
+}
+
+void sampleLogFlush()
+{
+  pageWrite();
+  segmentFile.close();
+}
+
+uint32_t sampleLogFirst()
+{
+  return firstRecord;
+}
+
+uint32_t sampleLogEnd()
+{
+  return writtenEnd + encoder.count();
+}
+
+uint16_t sampleLogRead(uint32_t first, SampleLogRecord records[], uint16_t count)
+{
+  if (!mounted || first < firstRecord) return 0;
+  uint16_t read = 0;
+  LogPage logPage;
+  while (read < count && first < writtenEnd) {
+    const uint8_t position = segmentOf(first);
+    const Segment& segment = segmentAt(position);
+    uint32_t offset = first - segment.firstRecord;
+    const uint16_t stride = strideOf(position, [offset](const IndexEntry& entry) { return entry.offset <= offset; });
+    File file = LittleFS.open(segmentPath(segment.number), FILE_READ);
+    for (uint16_t number = stride * kLogIndexStride; number < segment.pages && read < count; number++) {
+      if (!pageRead(file, number, logPage, false)) continue;
+      // the records of pages that failed before this one
+      for (; offset < logPage.offset && read < count; offset++) recordMissing(records[read++]);
+      if (read == count || offset >= logPage.offset + logPage.records) continue;
+      if (!pageRead(file, number, logPage, true)) break;
+      const uint16_t got = pageDecode(logPage, offset - logPage.offset, records + read, count - read, true);
+      read += got;
+      offset += got;
+    }
+    file.close();
+    // and those of pages that failed at the segment's end
+    for (; offset < segment.records && read < count; offset++) recordMissing(records[read++]);
+    first = segment.firstRecord + offset;
+  }
+  if (read < count && first >= writtenEnd && first < sampleLogEnd()) {
+    page.records = encoder.count();
+    read += pageDecode(page, first - writtenEnd, records + read, count - read, false);
+  }
+  return read;
+}
+
+uint32_t sampleLogFind(uint32_t timeS)
+{
+  if (!mounted) return sampleLogEnd();
+  auto before = [timeS](const IndexEntry& entry) { return entry.timeS < timeS; };
+  // the segments whose first page starts before timeS, then the strides of the last of them
+  uint8_t low = 0, high = segmentCount;
+  while (low < high) {
+    const uint8_t middle = (low + high) / 2;
+    if (before(segmentIndex[slotOf(middle)][0])) low = middle + 1;
+    else high = middle;
+  }
+  uint32_t found = writtenEnd;
+  if (low) {
+    const uint8_t position = low - 1;
+    const Segment& segment = segmentAt(position);
+    const uint16_t stride = strideOf(position, before);
+    // the last page starting before timeS holds the record, or the page after it starts with it
+    File file = LittleFS.open(segmentPath(segment.number), FILE_READ);
+    LogPage logPage;
+    int32_t candidate = -1;
+    found = segment.firstRecord + segment.records;
+    for (uint16_t number = stride * kLogIndexStride; number < segment.pages; number++) {
+      if (!pageRead(file, number, logPage, false)) continue;
+      if (logPage.timeS >= timeS) {
+        found = segment.firstRecord + logPage.offset;
+        break;
+      }
+      candidate = number;
+    }
+    if (candidate >= 0 && pageRead(file, candidate, logPage, true)) {
+      if (logPage.dataCRC != crc16(logPage.data, sizeof(logPage.data))) stats.crcErrors++;
+      else {
+        const uint16_t i = pageFind(logPage, timeS);
+        if (i < logPage.records) found = segment.firstRecord + logPage.offset + i;
+      }
+    }
+    file.close();
+  }
+  else if (segmentCount)
+    found = firstRecord;
+  if (found < writtenEnd) return found;
+
+  // the page being filled
+  page.records = encoder.count();
+  return writtenEnd + pageFind(page, timeS);
+}
+
+uint32_t sampleLogRebuild(SampleHistory& history, uint32_t budgetMS)
+{
+  const uint32_t startMS = millis();
+  const uint32_t end = sampleLogEnd();
+  const uint32_t count = (end - firstRecord < kHistoryCapacity) ? end - firstRecord : kHistoryCapacity;
+  if (!mounted || !count) return 0;
+  // record base is sample 0; newest first, so what the budget leaves out is the oldest
+  const uint32_t base = end - count;
+  history.preset(count);
+  SampleLogRecord record;
+  auto restore = [&](const LogPage& logPage, uint32_t pageFirst, bool checked) {
+    const bool good = !checked || logPage.dataCRC == crc16(logPage.data, sizeof(logPage.data));
+    if (!good) {
+      stats.crcErrors++;
+      return;
+    }
+    SeriesDecoder decoder;
+    decoder.begin(logPage.data, sizeof(logPage.data), logPage.records);
+    for (uint32_t i = 0; decoder.next(record.timeS, record.values); i++) {
+      if (pageFirst + i >= base) history.store(pageFirst + i - base, record.values);
+    }
+  };
+
+  page.records = encoder.count();
+  restore(page, writtenEnd, false);
+  uint32_t reached = writtenEnd;
+  LogPage logPage;
+  for (uint8_t position = segmentCount; position-- > 0 && reached > base; ) {
+    const Segment& segment = segmentAt(position);
+    File file = LittleFS.open(segmentPath(segment.number), FILE_READ);
+    for (uint16_t number = segment.pages; number-- > 0 && reached > base; ) {
+      if (millis() - startMS >= budgetMS) break;
+      if (!pageRead(file, number, logPage, true)) continue;
+      restore(logPage, segment.firstRecord + logPage.offset, true);
+      reached = segment.firstRecord + logPage.offset;
+    }
+    file.close();
+    if (millis() - startMS >= budgetMS) break;
+    reached = segment.firstRecord;
+  }
+  history.extremaRebuild();
+  stats.rebuilt = end - ((reached > base) ? reached : base);
+  stats.rebuildMS = millis() - startMS;
+  return stats.rebuilt;
+}
+
+const SampleLogStats& sampleLogStats()
+{
+  return stats;
+}
+
+String sampleLogReport()
+{
+  if (!mounted) return String("sample log: no LittleFS partition");
+  uint32_t pages = 0;
+  for (uint8_t position = 0; position < segmentCount; position++) pages += segmentAt(position).pages;
+  return String("sample log: ") + (sampleLogEnd() - firstRecord) + " records in " + pages + " pages, "
+    + (uint32_t)segmentCount + " segments, at " + clockS + " s; " + stats.appended + " appended, " + stats.pages
+    + " pages written, " + stats.writeFailures + " write failures, " + stats.crcErrors + " CRC errors; "
+    + stats.rebuilt + " samples rebuilt in " + stats.rebuildMS + " ms";
+}
@@ -0,0 +1,56 @@
+/*
+  Project:      Powered Air Quality
+  Description:  append-only log of samples on flash, so the graphs survive a reboot
+*/
+
+#ifndef SAMPLE_LOG_H
+  #define SAMPLE_LOG_H
+
+  #include <Arduino.h>
+
+  #include "config.h"
+  #include "sample_history.h"
+
+  // a record as read back; on flash, records are coded a variable number to a page (see
+  // series_codec.h), not stored at a fixed size
+  struct SampleLogRecord {
+    uint32_t timeS;                           // log seconds, counting on across reboots, power off left out
+    int16_t values[kHistoryChannelCount];     // by historyChannel, as stored by sample_history.h
+  };
+
+  struct SampleLogStats {
+    uint32_t appended;        // records since boot
+    uint32_t pages;           // page writes since boot
+    uint32_t writeFailures;
+    uint32_t crcErrors;       // pages read back with a bad CRC
+    uint32_t rebuilt;         // samples restored by sampleLogRebuild()
+    uint32_t rebuildMS;
+  };
+
+  // Only the worker task uses the log after setup()
+
+  // mounts the LittleFS partition, formatting it if it has none, and reads the segments and
+  // their index; false without a partition, and the log then does nothing
+  bool sampleLogBegin();
+  // a sample, values by historyChannel, those without their bit in valid logged as missing;
+  // compressed into a page in RAM, written and synced to flash when full, so a reboot loses the page
+  void sampleLogAppend(const float values[kHistoryChannelCount], uint8_t valid);
+  // writes the page being filled, at the cost of the rest of it, and closes the newest
+  // segment's file, which otherwise stays open across page writes; e.g. before a restart
+  void sampleLogFlush();
+  // the log's time now, log seconds
+  uint32_t sampleLogTimeS();
+  // record numbers: the oldest, and one past the newest, the page being filled included
+  uint32_t sampleLogFirst();
+  uint32_t sampleLogEnd();
+  // the first record at or after timeS, sampleLogEnd() if there is none
+  uint32_t sampleLogFind(uint32_t timeS);
+  // up to count records from first, returns how many were read; a record of a page that
+  // fails its CRC reads back with a time of 0 and every field missing
+  uint16_t sampleLogRead(uint32_t first, SampleLogRecord records[], uint16_t count);
+  // restores the newest records into history, for at most budgetMS; returns how many
+  uint32_t sampleLogRebuild(SampleHistory& history, uint32_t budgetMS);
+  const SampleLogStats& sampleLogStats();
+  String sampleLogReport();
+
+#endif  // #ifdef SAMPLE_LOG_H
@@ -0,0 +1,151 @@
+/*
+  Project Name:   Powered Air Quality
+  Description:    adaptive sample pace and time weighted averages (see sample_rate.h)
+*/
+
+#include "Arduino.h"
+
+#include "sample_rate.h"
+
+namespace {
+  struct ChannelRate {
+    bool valid;             // has a previous reading
+    float value;
+    uint32_t timeMS;
+    float perMinute;        // absolute rate of change at the last reading
+  };
+  ChannelRate channels[kSensorChannelCount];
+  uint32_t periodMS = timeSensorSampleMS;
+  uint8_t flatCount = 0;
+  SampleRateStats stats = {0, 0, 0, 0};
+  SampleTimeStats timeStats = {0, 0, 0};
+}
+
+void TimeWeightedMean::include(float value, uint32_t nowMS)
+{
+  const uint32_t gapMS = nowMS - _lastMS;
+  if (_valid && gapMS <= kSampleHoldMaxMS) {
+    // the part since clear() of the line from the previous reading to this one
+    const uint32_t beforeMS = ((int32_t)(_startMS - _lastMS) > 0) ? _startMS - _lastMS : 0;
+    if (beforeMS < gapMS) {
+      const double startValue = _value + ((double)value - _value) * beforeMS / gapMS;
+      _area += (startValue + value) / 2 * (gapMS - beforeMS);
+      _spanMS += gapMS - beforeMS;
+    }
+  }
+  _valid = true;
+  _value = value;
+  _lastMS = nowMS;
+  _count++;
+}
+
+float TimeWeightedMean::average(uint32_t nowMS) const
+{
+  if (!_count) return 0.0f;
+  // the last reading holds until now
+  uint32_t heldMS = nowMS - _lastMS;
+  if (heldMS > kSampleHoldMaxMS) heldMS = kSampleHoldMaxMS;
+  if (!(_spanMS + heldMS)) return _value;  // a single reading, just taken
+  return (_area + (double)_value * heldMS) / (_spanMS + heldMS);
+}
+
+void TimeWeightedMean::clear(uint32_t nowMS)
+{
+  // the span from the last reading to the next one still counts, from nowMS on
+  _startMS = nowMS;
+  _area = 0.0;
+  _spanMS = 0;
+  _count = 0;
+}
+
+void sampleRateReset()
+{
+  for (ChannelRate& channel : channels) channel = ChannelRate();
+  periodMS = timeSensorSampleMS;
+  flatCount = 0;
+}
+
+void sampleRateInclude(uint8_t channel, float value, uint32_t nowMS)
+{
+  if (channel >= kSensorChannelCount) return;
+  ChannelRate& rate = channels[channel];
+  const uint32_t elapsedMS = nowMS - rate.timeMS;
+  if (rate.valid && elapsedMS)
+    rate.perMinute = fabsf(value - rate.value) * 60000.0f / elapsedMS;
+  rate.valid = true;
+  rate.value = value;
+  rate.timeMS = nowMS;
+}
+
+uint32_t sampleRateNext()
+{
+  bool fast = false, flat = true;
+  for (uint8_t channel = 0; channel < kSensorChannelCount; channel++) {
+    if (channels[channel].perMinute >= kSampleFastPerMinute[channel]) fast = true;
+    if (channels[channel].perMinute >= kSampleFlatPerMinute[channel]) flat = false;
+  }
+
+  const uint32_t previousMS = periodMS;
+  if (fast) {
+    periodMS = timeSampleFastMS;
+    flatCount = 0;
+  }
+  else if (!flat) {
+    periodMS = timeSensorSampleMS;
+    flatCount = 0;
+  }
+  else {
+    // leaving fast sampling doesn't wait for the flat count
+    if (periodMS < timeSensorSampleMS) periodMS = timeSensorSampleMS;
+    if (++flatCount >= kSampleFlatCount) {
+      periodMS = (2 * periodMS < timeSampleSlowMS) ? 2 * periodMS : timeSampleSlowMS;
+      flatCount = 0;
+    }
+  }
+
+  stats.samples++;
+  if (periodMS == timeSampleFastMS) stats.fastSamples++;
+  if (periodMS > timeSensorSampleMS) stats.slowSamples++;
+  if (periodMS != previousMS) stats.changes++;
+  return periodMS;
+}
+
+uint32_t sampleRatePeriodMS()
+{
+  return periodMS;
+}
+
+const SampleRateStats& sampleRateStats()
+{
+  return stats;
+}
+
+void sampleRateStatsReset()
+{
+  stats = SampleRateStats{0, 0, 0, 0};
+}
+
+String sampleRateReport()
+{
+  return String("sample period ") + (periodMS / 1000) + " s, " + stats.fastSamples + " fast and "
+    + stats.slowSamples + " slow of " + stats.samples + " samples, " + stats.changes + " changes; CO2 "
+    + channels[channelCO2].perMinute + " ppm/min, PM2.5 " + channels[channelPM].perMinute + " ug/m3/min, VOC "
+    + channels[channelVOC].perMinute + "/min";
+}
+
+void sampleTimeRecord(uint32_t durationMS)
+{
+  timeStats.samples++;
+  timeStats.totalMS += durationMS;
+  if (durationMS > timeStats.maxMS) timeStats.maxMS = durationMS;
+}
+
+const SampleTimeStats& sampleTimeStats()
+{
+  return timeStats;
+}
+
+void sampleTimeStatsReset()
+{
+  timeStats = SampleTimeStats{0, 0, 0};
+}
@@ -0,0 +1,65 @@
+/*
+  Project:      Powered Air Quality
+  Description:  adaptive sample pace, and time weighted averages for unevenly spaced samples
+*/
+
+#ifndef SAMPLE_RATE_H
+  #define SAMPLE_RATE_H
+
+  #include <Arduino.h>
+
+  #include "config.h"
+
+  constexpr uint32_t kSampleHoldMaxMS = 2 * timeSampleSlowMS;
+
+  // the integral of a line joined between readings, the last held until average(), over the
+  // time covered; readings further apart than kSampleHoldMaxMS are not joined
+  class TimeWeightedMean {
+    public:
+      void include(float value, uint32_t nowMS);
+      // the time weighted average since clear(nowMS); 0 with no readings since, as
+      // Measure::getAverage()
+      float average(uint32_t nowMS) const;
+      uint32_t count() const { return _count; }
+      // starts a new interval at nowMS
+      void clear(uint32_t nowMS);
+
+    private:
+      double _area = 0.0;     // value x ms since _startMS, up to _lastMS
+      uint32_t _spanMS = 0;   // ms covered by _area
+      uint32_t _startMS = 0;
+      bool _valid = false;    // _value and _lastMS hold the most recent reading
+      float _value = 0.0f;
+      uint32_t _lastMS = 0;
+      uint32_t _count = 0;    // readings since _startMS
+  };
+
+  struct SampleRateStats {
+    uint32_t samples;
+    uint32_t fastSamples;   // periods of timeSampleFastMS
+    uint32_t slowSamples;   // periods longer than timeSensorSampleMS
+    uint32_t changes;       // period changes
+  };
+
+  void sampleRateReset();
+  // a fresh reading of a sensorChannel
+  void sampleRateInclude(uint8_t channel, float value, uint32_t nowMS);
+  // the period until the next sample, after a sample completes: timeSampleFastMS while a
+  // channel changes fast, doubling up to timeSampleSlowMS while all are flat
+  uint32_t sampleRateNext();
+  uint32_t sampleRatePeriodMS();
+  const SampleRateStats& sampleRateStats();
+  void sampleRateStatsReset();
+  String sampleRateReport();
+
+  struct SampleTimeStats {
+    uint32_t samples;
+    uint32_t totalMS;
+    uint32_t maxMS;
+  };
+
+  void sampleTimeRecord(uint32_t durationMS);
+  const SampleTimeStats& sampleTimeStats();
+  void sampleTimeStatsReset();
+
+#endif  // #ifdef SAMPLE_RATE_H
@@ -0,0 +1,242 @@
+/*
+  Project Name:   Powered Air Quality
+  Description:    deadline scheduler for loop() (see scheduler.h)
+*/
+
+#include "Arduino.h"
+
+#include "scheduler.h"
+
+namespace {
+  // one per core, see scheduler.h
+  struct SchedulerTable {
+    SchedulerTask tasks[kSchedulerTaskMax];
+    uint8_t taskCount = 0;
+    uint8_t heap[kSchedulerTaskMax];  // task ids, earliest deadline at heap[0]
+    uint8_t heapSize = 0;
+    SchedulerStats stats = {0, 0, 0};
+  };
+  SchedulerTable tables[portNUM_PROCESSORS];
+
+  // the calling core's
+  SchedulerTable& table()
+  {
+    return tables[xPortGetCoreID()];
+  }
+
+  // deadline a is before deadline b, allowing for millis() wrapping
+  bool before(uint32_t a, uint32_t b)
+  {
+    return (int32_t)(a - b) < 0;
+  }
+
+  // task a runs before task b; equal deadlines run in the order the tasks were added
+  bool earlier(const SchedulerTable& t, uint8_t a, uint8_t b)
+  {
+    return before(t.tasks[a].dueMS, t.tasks[b].dueMS) || (t.tasks[a].dueMS == t.tasks[b].dueMS && a < b);
+  }
+
+  void heapSet(SchedulerTable& t, uint8_t index, uint8_t task)
+  {
+    t.heap[index] = task;
+    t.tasks[task].heapIndex = index;
+  }
+
+  void heapUp(SchedulerTable& t, uint8_t index)
+  {
+    const uint8_t task = t.heap[index];
+    while (index > 0) {
+      const uint8_t parent = (index - 1) / 2;
+      if (!earlier(t, task, t.heap[parent])) break;
+      heapSet(t, index, t.heap[parent]);
+      index = parent;
+    }
+    heapSet(t, index, task);
+  }
+
+  void heapDown(SchedulerTable& t, uint8_t index)
+  {
+    const uint8_t task = t.heap[index];
+    for (;;) {
+      uint8_t child = 2 * index + 1;
+      if (child >= t.heapSize) break;
+      if (child + 1 < t.heapSize && earlier(t, t.heap[child + 1], t.heap[child])) child++;
+      if (!earlier(t, t.heap[child], task)) break;
+      heapSet(t, index, t.heap[child]);
+      index = child;
+    }
+    heapSet(t, index, task);
+  }
+
+  void heapRemove(SchedulerTable& t, uint8_t task)
+  {
+    const uint8_t index = t.tasks[task].heapIndex;
+    t.tasks[task].heapIndex = kSchedulerTaskMax;
+    t.heapSize--;
+    if (index == t.heapSize) return;
+    // the last entry fills the hole, then moves whichever way its deadline calls for
+    const uint8_t moved = t.heap[t.heapSize];
+    heapSet(t, index, moved);
+    heapUp(t, index);
+    heapDown(t, t.tasks[moved].heapIndex);
+  }
+
+  bool queued(const SchedulerTable& t, uint8_t task)
+  {
+    return task < t.taskCount && t.tasks[task].heapIndex < kSchedulerTaskMax;
+  }
+}
+
+void schedulerClear()
+{
+  SchedulerTable& t = table();
+  t.taskCount = 0;
+  t.heapSize = 0;
+  schedulerStatsReset();
+}
+
+uint8_t schedulerAdd(const char* name, void (*function)(), uint32_t periodMS)
+{
+  SchedulerTable& t = table();
+  if (t.taskCount == kSchedulerTaskMax) return kSchedulerTaskMax;
+  SchedulerTask& task = t.tasks[t.taskCount];
+  task = SchedulerTask();
+  task.name = name;
+  task.function = function;
+  task.periodMS = periodMS;
+  task.heapIndex = kSchedulerTaskMax;
+  return t.taskCount++;
+}
+
+void schedulerAt(uint8_t task, uint32_t dueMS)
+{
+  SchedulerTable& t = table();
+  if (task >= t.taskCount) return;
+  if (queued(t, task)) heapRemove(t, task);
+  t.tasks[task].dueMS = dueMS;
+  heapSet(t, t.heapSize, task);
+  t.heapSize++;
+  heapUp(t, t.heapSize - 1);
+}
+
+void schedulerPeriod(uint8_t task, uint32_t periodMS)
+{
+  SchedulerTable& t = table();
+  if (task >= t.taskCount) return;
+  t.tasks[task].periodMS = periodMS;
+}
+
+void schedulerCancel(uint8_t task)
+{
+  SchedulerTable& t = table();
+  if (queued(t, task)) heapRemove(t, task);
+}
+
+bool schedulerQueued(uint8_t task)
+{
+  return queued(table(), task);
+}
+
+uint32_t schedulerRun()
+{
+  SchedulerTable& t = table();
+  // each task at most once per call, so a task that requeues itself as due can't spin here
+  for (uint8_t ran = 0; ran < t.taskCount && t.heapSize; ran++) {
+    const uint32_t nowMS = millis();
+    const uint8_t id = t.heap[0];
+    SchedulerTask& task = t.tasks[id];
+    if (before(nowMS, task.dueMS)) break;
+
+    const uint32_t lateMS = nowMS - task.dueMS;
+    if (lateMS > task.lateMaxMS) task.lateMaxMS = lateMS;
+    // requeue before running, so the task can move or cancel its next deadline
+    if (task.periodMS) {
+      // the next period after now, on the task's original cadence
+      const uint32_t missed = lateMS / task.periodMS;
+      task.skipped += missed;
+      schedulerAt(id, task.dueMS + (missed + 1) * task.periodMS);
+    }
+    else
+      heapRemove(t, id);
+
+    const uint32_t startUS = micros();
+    task.function();
+    const uint32_t busyUS = micros() - startUS;
+    task.runs++;
+    task.busyUS += busyUS;
+    if (busyUS > task.busyMaxUS) task.busyMaxUS = busyUS;
+  }
+  return schedulerIdleMS();
+}
+
+uint32_t schedulerIdleMS()
+{
+  const SchedulerTable& t = table();
+  if (!t.heapSize) return kSchedulerIdleForever;
+  const uint32_t nowMS = millis();
+  const uint32_t dueMS = t.tasks[t.heap[0]].dueMS;
+  return before(nowMS, dueMS) ? dueMS - nowMS : 0;
+}
+
+void schedulerIdle(uint32_t maxMS, bool wakeOnNotify)
+{
+  const uint32_t idleMS = schedulerIdleMS();
+  const uint32_t waitMS = (idleMS < maxMS) ? idleMS : maxMS;
+  if (!waitMS) return;
+  const uint32_t startUS = micros();
+  if (wakeOnNotify)
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(waitMS));
+  else
+    delay(waitMS);
+  const uint32_t idleUS = micros() - startUS;
+  SchedulerStats& stats = table().stats;
+  stats.idleUS += idleUS;
+  stats.idleTotalUS += idleUS;
+}
+
+uint8_t schedulerTaskCount(uint8_t core)
+{
+  return tables[core].taskCount;
+}
+
+const SchedulerTask& schedulerTask(uint8_t task, uint8_t core)
+{
+  return tables[core].tasks[task];
+}
+
+const SchedulerStats& schedulerStats(uint8_t core)
+{
+  return tables[core].stats;
+}
+
+float schedulerIdlePercent(uint8_t core)
+{
+  const SchedulerStats& stats = tables[core].stats;
+  const uint32_t elapsedMS = millis() - stats.sinceMS;
+  return elapsedMS ? (float)(stats.idleUS / 10.0 / elapsedMS) : 0.0f;
+}
+
+void schedulerStatsReset()
+{
+  SchedulerTable& t = table();
+  for (uint8_t task = 0; task < t.taskCount; task++) {
+    t.tasks[task].runs = t.tasks[task].skipped = t.tasks[task].lateMaxMS = t.tasks[task].busyMaxUS = 0;
+    t.tasks[task].busyUS = 0;
+  }
+  t.stats.sinceMS = millis();
+  t.stats.idleUS = 0;
+}
+
+String schedulerReport()
+{
+  const uint8_t core = xPortGetCoreID();
+  const SchedulerTable& t = tables[core];
+  String report = String("Scheduler on core ") + core + " since last report: " + schedulerIdlePercent(core)
+    + "% idle; task, runs, skipped, late max ms, busy max us, next due in ms";
+  for (uint8_t id = 0; id < t.taskCount; id++) {
+    const SchedulerTask& task = t.tasks[id];
+    report += String("\n  ") + task.name + ", " + task.runs + ", " + task.skipped + ", " + task.lateMaxMS + ", "
+      + task.busyMaxUS + ", " + (queued(t, id) ? String((int32_t)(task.dueMS - millis())) : String("-"));
+  }
+  return report;
+}
@@ -0,0 +1,61 @@
+/*
+  Project:      Powered Air Quality
+  Description:  deadline scheduler for loop()
+*/
+
+#ifndef SCHEDULER_H
+  #define SCHEDULER_H
+
+  #include <Arduino.h>
+
+  constexpr uint8_t kSchedulerTaskMax = 12;  // per core; single core, loop() has all the tasks
+  constexpr uint32_t kSchedulerIdleForever = UINT32_MAX;  // schedulerIdleMS() with nothing queued
+
+  struct SchedulerTask {
+    const char* name;
+    void (*function)();
+    uint32_t periodMS;   // 0 for a one shot task
+    uint32_t dueMS;      // deadline while queued
+    uint8_t heapIndex;   // position in the heap, kSchedulerTaskMax when not queued
+    // since schedulerStatsReset()
+    uint32_t runs;
+    uint32_t skipped;    // periods skipped after running late by more than a period
+    uint32_t lateMaxMS;  // longest wait past a deadline
+    uint32_t busyMaxUS;  // longest run
+    uint64_t busyUS;
+  };
+
+  struct SchedulerStats {
+    uint32_t sinceMS;    // millis() at schedulerStatsReset()
+    uint64_t idleUS;     // time spent in schedulerIdle()
+    uint64_t idleTotalUS; // same, never reset
+  };
+
+  // Each core has its own task table; these act on the calling core's
+  void schedulerClear();
+  // returns the task's id, or kSchedulerTaskMax if the table is full; not queued until schedulerAt()
+  uint8_t schedulerAdd(const char* name, void (*function)(), uint32_t periodMS);
+  // queues, or moves, the task's deadline; within 24 days of now, deadlines compare wrapping
+  void schedulerAt(uint8_t task, uint32_t dueMS);
+  void schedulerPeriod(uint8_t task, uint32_t periodMS);  // from the task's next requeue
+  void schedulerCancel(uint8_t task);
+  bool schedulerQueued(uint8_t task);
+
+  // runs the tasks that are due, earliest deadline first, and requeues a periodic task one
+  // period after its deadline, skipping the periods it fell behind; returns schedulerIdleMS()
+  uint32_t schedulerRun();
+  uint32_t schedulerIdleMS();
+  // delay()s until the next deadline, at most maxMS; with wakeOnNotify it waits in
+  // ulTaskNotifyTake() instead, so another task's xTaskNotifyGive() ends it early
+  void schedulerIdle(uint32_t maxMS, bool wakeOnNotify = false);
+
+  // read only, so a report on one core can include the other's figures
+  uint8_t schedulerTaskCount(uint8_t core = xPortGetCoreID());
+  const SchedulerTask& schedulerTask(uint8_t task, uint8_t core = xPortGetCoreID());
+  const SchedulerStats& schedulerStats(uint8_t core = xPortGetCoreID());
+  // percentage of the time since schedulerStatsReset() spent idle
+  float schedulerIdlePercent(uint8_t core = xPortGetCoreID());
+  void schedulerStatsReset();
+  String schedulerReport();
+
+#endif  // #ifdef SCHEDULER_H
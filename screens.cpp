@@ -7,6 +7,7 @@
 #include <Measure.hpp>
 #include "config.h"
 #include "powered_air_quality.h"
+#include "dual_core.h"       // SampleSnapshot
 #include <TFT_eSPI.h> // https://github.com/Bodmer/TFT_eSPI
 
 // https://fonts.google.com/specimen/Roboto
@@ -22,18 +23,14 @@
 
 // Shared helper function(s) and globals
 extern uint8_t networkRSSIRead();
-extern bool OWMAirPollutionRead();
-extern bool OWMForecastRead();
 extern void debugMessage(String messageText, uint8_t messageLevel);
 extern uint16_t getWarningColor(uint8_t, float);
 extern uint16_t getWarningTextColor(uint8_t, float);
 extern TFT_eSPI display;
-extern uint32_t timeLastReportMS;
-extern Measure<kSampleCapacity> totalTemperatureF, totalHumidity, totalCO2, totalVOCIndex, totalPM25, totalNOxIndex;
-extern struct SiteForecast owmSiteForecast;
+extern SampleSnapshot screenData;  // loop()'s copy of the worker's latest sample snapshot
 
 // Forward declarations for local functions to help make ordering in this file easier
-void screenHelperGraph(uint16_t, uint16_t, uint16_t, uint16_t, Measure<kSampleCapacity>, uint8_t, String);
+void screenHelperGraph(uint16_t, uint16_t, uint16_t, uint16_t, uint32_t, const HistoryRange&, uint8_t, uint8_t, String);
 void screenHelperHeaderBar(uint16_t, uint16_t, String header);
 String getWarningLabel(uint8_t, float);
 void screenHelperWiFiStatus(uint16_t, uint16_t, uint16_t);
@@ -90,18 +87,18 @@ void screenPM25()
   display.setTextDatum(MC_DATUM);
 
   // Indoor
-  display.drawSmoothArc(xIndoorPMCircle, yPMCircles, circleRadius, circleInnerRadius, 0, 360, getWarningColor(PM_DATA, totalPM25.getCurrent()), TFT_BLACK);
+  display.drawSmoothArc(xIndoorPMCircle, yPMCircles, circleRadius, circleInnerRadius, 0, 360, getWarningColor(PM_DATA, screenData.pm25.getCurrent()), TFT_BLACK);
   // value and label inside the circle
   display.loadFont(Roboto_Bold_36);
-  display.setTextColor(getWarningColor(PM_DATA,totalPM25.getCurrent()), TFT_BLACK, true);  // Use highlight color look-up
-  display.drawFloat(totalPM25.getCurrent(), 1, xIndoorPMCircle, yPMCircles);
+  display.setTextColor(getWarningColor(PM_DATA,screenData.pm25.getCurrent()), TFT_BLACK, true);  // Use highlight color look-up
+  display.drawFloat(screenData.pm25.getCurrent(), 1, xIndoorPMCircle, yPMCircles);
   
   // Outside
-  if (OWMAirPollutionRead()) {
-    display.drawSmoothArc(xOutdoorPMCircle, yPMCircles, circleRadius, circleInnerRadius, 0, 360, getWarningColor(PM_DATA,owmAirQuality.pm25), TFT_BLACK);
+  if (screenData.owmAirQualityValid) {
+    display.drawSmoothArc(xOutdoorPMCircle, yPMCircles, circleRadius, circleInnerRadius, 0, 360, getWarningColor(PM_DATA,screenData.owmAirQuality.pm25), TFT_BLACK);
     // value and label inside the circle
-    display.setTextColor(getWarningColor(PM_DATA,owmAirQuality.pm25), TFT_BLACK, true); // Use highlight color look-up 
-    display.drawFloat(owmAirQuality.pm25, 1, xOutdoorPMCircle, yPMCircles);
+    display.setTextColor(getWarningColor(PM_DATA,screenData.owmAirQuality.pm25), TFT_BLACK, true); // Use highlight color look-up 
+    display.drawFloat(screenData.owmAirQuality.pm25, 1, xOutdoorPMCircle, yPMCircles);
   }
   else
   {
@@ -122,29 +119,30 @@ void screenVOC()
 
   debugMessage("screenVOC() start",1);
 
-  bgcolor = getWarningColor(VOC_DATA,totalVOCIndex.getCurrent());
-  fgcolor = getWarningTextColor(VOC_DATA,totalVOCIndex.getCurrent());
+  bgcolor = getWarningColor(VOC_DATA,screenData.vocIndex.getCurrent());
+  fgcolor = getWarningTextColor(VOC_DATA,screenData.vocIndex.getCurrent());
   screenHelperHeaderBar(fgcolor,bgcolor,"VOC Level");
 
   display.setTextDatum(MC_DATUM);
 
   // If VOCIndex has no values, alert the user
-  if (totalVOCIndex.getStored() == 0) {
+  if (screenData.vocIndex.getStored() == 0) {
     display.loadFont(Roboto_Regular_18);
     display.setTextColor(TFT_RED, TFT_BLACK, true);
-    display.drawString("No data", (display.width() / 2), (display.height() / 2));
+    display.drawString(screenData.warmingUp[channelVOC] ? "Warming up" : "No data", (display.width() / 2),
+      (display.height() / 2));
   }
   else {
     // Draw segmented arc showing color range and current VOCIndex in that range
-    arcMeter(xCircle,yCircle,display.width(),vocRange(totalVOCIndex.getCurrent()));
+    arcMeter(xCircle,yCircle,display.width(),vocRange(screenData.vocIndex.getCurrent()));
 
     // Display VOCIndex value and label inside the arc
     display.loadFont(Roboto_Bold_60);
-    display.setTextColor(getWarningColor(VOC_DATA,totalVOCIndex.getCurrent()), TFT_BLACK, true);  // Use highlight color look-up 
-    display.drawFloat((totalVOCIndex.getCurrent() +.5), 0, xValue, yValue);
+    display.setTextColor(getWarningColor(VOC_DATA,screenData.vocIndex.getCurrent()), TFT_BLACK, true);  // Use highlight color look-up 
+    display.drawFloat((screenData.vocIndex.getCurrent() +.5), 0, xValue, yValue);
     display.loadFont(Roboto_Regular_24);
     display.setTextColor(TFT_WHITE, TFT_BLACK, true);
-    display.drawString(getWarningLabel(VOC_DATA,totalVOCIndex.getCurrent()), xValue, yCircle);
+    display.drawString(getWarningLabel(VOC_DATA,screenData.vocIndex.getCurrent()), xValue, yCircle);
   }
   display.unloadFont();
   debugMessage("screenVOC() end",1);
@@ -158,31 +156,32 @@ void screenCO2()
 
   debugMessage("screenCO2() start",1);
 
-  bgcolor = getWarningColor(CO2_DATA,totalCO2.getCurrent());
-  fgcolor = getWarningTextColor(CO2_DATA,totalCO2.getCurrent());
+  bgcolor = getWarningColor(CO2_DATA,screenData.co2.getCurrent());
+  fgcolor = getWarningTextColor(CO2_DATA,screenData.co2.getCurrent());
   screenHelperHeaderBar(fgcolor,bgcolor,"Recent CO2 Values");
 
   display.loadFont(Roboto_Regular_36);
 
   // if CO2 values are not yet available, display "NA"
-  if (totalCO2.getStored() == 0) {
+  if (screenData.co2.getStored() == 0) {
     display.setTextColor(TFT_RED, TFT_BLACK, true);
     display.setTextDatum(MC_DATUM);
-    display.drawString("NA", (display.width() / 2), (display.height() / 2));
+    display.drawString(screenData.warmingUp[channelCO2] ? "Warming up" : "NA", (display.width() / 2),
+      (display.height() / 2));
   }
   else {
     // display generalized CO₂ level
     display.setTextDatum(BL_DATUM);
-    display.setTextColor(getWarningColor(CO2_DATA,totalCO2.getCurrent()), TFT_BLACK, true);
-    display.drawString(getWarningLabel(CO2_DATA,totalCO2.getCurrent()),kXMargins, yValue - 3);
+    display.setTextColor(getWarningColor(CO2_DATA,screenData.co2.getCurrent()), TFT_BLACK, true);
+    display.drawString(getWarningLabel(CO2_DATA,screenData.co2.getCurrent()),kXMargins, yValue - 3);
 
     // display current CO₂ value
     display.setTextDatum(BR_DATUM);
     display.setTextColor(TFT_WHITE, TFT_BLACK, true);
-    display.drawString((String(uint16_t(totalCO2.getCurrent())) + "ppm"), (display.width()-(2*kXMargins)), yValue - 3);
+    display.drawString((String(uint16_t(screenData.co2.getCurrent())) + "ppm"), (display.width()-(2*kXMargins)), yValue - 3);
 
     // recent CO₂ graph
-    screenHelperGraph(kXMargins, yValue, (display.width()-(2*kXMargins)),((display.height()-yValue)-kYMargins), totalCO2, CO2_DATA, "");
+    screenHelperGraph(kXMargins, yValue, (display.width()-(2*kXMargins)),((display.height()-yValue)-kYMargins), screenData.historyEnd, screenData.historyRange[historyCO2], historyCO2, CO2_DATA, "");
   }
   display.unloadFont();
   debugMessage("screenCO2() end",1);
@@ -217,7 +216,7 @@ void screenHelperHeaderBar(uint16_t fgcolor, uint16_t bgcolor, String header)
   screenHelperWiFiStatus((display.width() - kXMargins - kIconWidth), yStatusRegionFloor, bgcolor);
   
   #if defined(MQTT) || defined(INFLUX) || defined(HASSIO_MQTT) || defined(THINGSPEAK)
-    if ((timeLastReportMS == 0) || ((millis() - timeLastReportMS) >= (timeReportMS * reportFailureThreshold))) {
+    if ((screenData.lastReportMS == 0) || ((millis() - screenData.lastReportMS) >= (timeReportMS * reportFailureThreshold))) {
       // we haven't successfully written to a network endpoint at all or before the reportFailureThreshold
       // display.drawBitmap(initialX, initialY, checkmark_12x15, 12, 15, TFT_BLACK);
       iconfgcolor = TFT_RED;
@@ -257,23 +256,23 @@ void screenHelperWiFiStatus(uint16_t x, uint16_t y, uint16_t bgColor)
   const uint16_t cx = x + 10;
   const uint16_t cy = y - dotRadius;
 
-  hardwareData.rssi = networkRSSIRead();
+  const uint8_t rssi = networkRSSIRead();
 
-  if (hardwareData.rssi > 80) {
+  if (rssi > 80) {
     // not usable internet, all black
     circleColor = TFT_BLACK;
     arcOneColor = TFT_BLACK;
     arcTwoColor = TFT_BLACK;
     // add debug message
   }
-  if (hardwareData.rssi > 70) {
+  if (rssi > 70) {
     // poor internet, circle white, arcs black
     circleColor = TFT_WHITE;
     arcOneColor = TFT_BLACK;
     arcTwoColor = TFT_BLACK;
     // add debug message
   }
-  if (hardwareData.rssi > 60) {
+  if (rssi > 60) {
     // moderate internet, circle and first arc white, last arc black
     circleColor = TFT_WHITE;
     arcOneColor = TFT_WHITE;
@@ -365,13 +364,16 @@ uint8_t vocRange(float vocIndex)
   return vocRange;
 }
 
-void screenHelperGraph(uint16_t initialX, uint16_t initialY, uint16_t width, uint16_t height, Measure<kSampleCapacity> measure, uint8_t datatype, String xLabel)
+void screenHelperGraph(uint16_t initialX, uint16_t initialY, uint16_t width, uint16_t height, uint32_t historyEnd, const HistoryRange& range, uint8_t channel, uint8_t datatype, String xLabel)
+// Graphs a channel of sampleHistory, the samples before historyEnd, scaled to their range
+// (see SampleSnapshot). Up to kSampleCapacity samples are points in fixed slots, the newest
+// at the right; more are spread over the width, a point per kGraphColumnPx column averaging
+// the samples in it
 {
-  uint8_t stored, capacity;
-  int8_t loop; // upper bound is kSampleCapacity definition (size of Measure retained storage)
+  uint16_t stored, points, slots, point;
   uint16_t text1Width, text1Height, graphLineY;
-  uint16_t deltaX, x, y, xp, yp;  // graphing positions
-  float minValue, maxValue, value, range, average;
+  uint16_t x, y, xp = 0, yp = 0;  // graphing positions
+  float minValue, maxValue, value, spread, average;
   bool firstpoint = true;
 
   // screen layout assists in pixels
@@ -379,41 +381,32 @@ void screenHelperGraph(uint16_t initialX, uint16_t initialY, uint16_t width, uin
 
   debugMessage("screenHelperGraph() start",1);
 
-  stored   = measure.getStored();
-  capacity = measure.getCapacity();
+  stored = sampleHistory.available(historyEnd);
+  const uint32_t first = historyEnd - stored;
 
   display.fillRect(initialX,initialY,width,height,TFT_BLACK);
 
-  // Save ourselves some work if we don't have data to plot
-  if(stored == 0) {
+  // Save ourselves some work if we don't have data to plot; the worker kept min/max as
+  // samples came in, missing values left out
+  if(stored == 0 || !range.valid) {
+    stored = 0;
     xLabel = "Awaiting samples";
     minValue = 0;    // Nothing to plot so arbitrarily set min and max to produce a y axis, but
     maxValue = 100;  // might be good to make this smarter (perhaps don't try plotting at all)
   }
   else {
-    // Scan the array for min/max, only checking valid values in retained storage
-    for(loop=capacity-stored;loop<capacity;loop++) {
-      value = measure.getMember(loop);  // As we use 'value' a lot here...
-      if(firstpoint == true) {
-        // This is our first data point. Initialize min/max
-        minValue = value;
-        maxValue = value;
-        firstpoint = false;
-        continue;
-      }
-      if(value < minValue) minValue = value;
-      if(value > maxValue) maxValue = value;
-    }
+    minValue = range.minValue;
+    maxValue = range.maxValue;
     debugMessage(String("Min sample value is ") + minValue + ", max is " + maxValue, 2);
 
     // Since we have data, attempt to scale graph area based on range in data values but with some
     // padding above and below the graphed data itself.  Also have max and min labels
     // as multiples of 10.
-    range = maxValue - minValue;
-    if(range < 10.0) range = 50.0;
+    spread = maxValue - minValue;
+    if(spread < 10.0) spread = 50.0;
     average = (maxValue + minValue)/2.0;
-    maxValue = (int16_t)(10.0 * ceil((average + range)/10.0));
-    minValue = (int16_t)(10.0 * floor((average - range)/10.0));
+    maxValue = (int16_t)(10.0 * ceil((average + spread)/10.0));
+    minValue = (int16_t)(10.0 * floor((average - spread)/10.0));
   }
 
   display.loadFont(Roboto_Regular_12);
@@ -450,13 +443,29 @@ void screenHelperGraph(uint16_t initialX, uint16_t initialY, uint16_t width, uin
 
   // Plot however many data points we have both with filled circles at each
   // point and lines connecting the points.  Color the filled circles with the
-  // appropriate warning level color for the type of data being graphed.
-  deltaX = ((width-graphLineX) - 10) / (kSampleCapacity-1);  // X distance between points, 10 pixel padding for Y axis
-  firstpoint = true;  // Reset for plotting use
-  for(loop=capacity-stored;loop<capacity;loop++) {
-    x = graphLineX + 10 + (loop*deltaX);  // Include 10 pixel padding for Y axis
-    y = graphLineY - (((measure.getMember(loop) - minValue)/(maxValue-minValue)) * (graphLineY-initialY));
-    debugMessage(String("Graph position ") + loop + "'s y value is " + y,2);
+  // appropriate warning level color for the type of data being graphed. Once the points
+  // are too close for circles, color the lines instead.
+  const uint16_t plotWidth = (width-graphLineX) - 10;  // 10 pixel padding for Y axis
+  if (stored <= kSampleCapacity) {
+    points = stored;
+    slots = kSampleCapacity;
+  }
+  else {
+    points = (stored < plotWidth / kGraphColumnPx) ? stored : plotWidth / kGraphColumnPx;
+    slots = points;
+  }
+  const bool markers = (points == stored) && (plotWidth / (slots-1) >= kGraphMarkerPx);
+  for(point=0;point<points;point++) {
+    // the samples in this point's column, missing values left out; a column with none breaks the line
+    float low, high;
+    if (!sampleHistory.span(channel, first + (uint32_t)point * stored / points, first + (uint32_t)(point + 1) * stored / points,
+        low, high, value)) {
+      firstpoint = true;
+      continue;
+    }
+    x = graphLineX + 10 + ((uint32_t)(slots - points + point) * plotWidth / (slots-1));  // Include 10 pixel padding for Y axis
+    y = graphLineY - (((value - minValue)/(maxValue-minValue)) * (graphLineY-initialY));
+    debugMessage(String("Graph position ") + point + "'s y value is " + y,2);
 
     if(firstpoint) {
       // If this is the first drawn point then don't try to draw a line
@@ -466,16 +475,18 @@ void screenHelperGraph(uint16_t initialX, uint16_t initialY, uint16_t width, uin
     }
     else {
       // Draw line from previous point (if one) to this point
-      display.drawLine(xp,yp,x,y,TFT_WHITE);
+      display.drawLine(xp,yp,x,y,markers ? TFT_WHITE : getWarningColor(datatype,value));
     }
 
-    // Draw a filled circle representing the data value, using the warning color scheme appropriate for
-    // the specified sensor data type.
-    display.fillSmoothCircle(x,y,4,getWarningColor(datatype,measure.getMember(loop)));
+    if (markers) {
+      // Draw a filled circle representing the data value, using the warning color scheme appropriate for
+      // the specified sensor data type.
+      display.fillSmoothCircle(x,y,4,getWarningColor(datatype,value));
 
-    // redraw the last circle to eliminate the line overdrawn on it
-    if (!firstpoint)
-      display.fillSmoothCircle(xp,yp,4,getWarningColor(datatype,measure.getMember(loop)));
+      // redraw the last circle to eliminate the line overdrawn on it
+      if (xp != x)
+        display.fillSmoothCircle(xp,yp,4,getWarningColor(datatype,value));
+    }
 
     // Save x & y of this point to use as previous point for next one.
     xp = x;
@@ -583,9 +594,9 @@ void screenMain() {
   x0 = me + (ws/2);
   y0 = mt + 36;
   display.setTextColor(TFT_WHITE,TFT_BLACK);
-  display.drawString(String((uint16_t)(totalTemperatureF.getCurrent() + .5))+"°F",x0,y0);
+  display.drawString(String((uint16_t)(screenData.temperatureF.getCurrent() + .5))+"°F",x0,y0);
   display.setTextColor(TFT_CYAN, TFT_BLACK);
-  display.drawString(String((uint16_t)(totalHumidity.getCurrent() + .5))+"%",x0+10,y0+36);
+  display.drawString(String((uint16_t)(screenData.humidity.getCurrent() + .5))+"%",x0+10,y0+36);
   // Humidity "droplet" symbol
   display.fillSmoothCircle(x0-25,y0+35,7,TFT_CYAN,TFT_BLACK);
   display.fillTriangle(x0-25,y0+25,x0-20,y0+30,x0-30,y0+30,TFT_CYAN);
@@ -599,8 +610,8 @@ void screenMain() {
   mx = x0 + (ws/2);
   y0 = mt + hs + mm;
   my = y0 + arcGaugeHeight(ws) + 10;
-  wcolor = getWarningColor(VOC_DATA,totalVOCIndex.getCurrent());
-  windex = vocRange(totalVOCIndex.getCurrent());
+  wcolor = getWarningColor(VOC_DATA,screenData.vocIndex.getCurrent());
+  windex = vocRange(screenData.vocIndex.getCurrent());
   display.fillRoundRect(x0,y0,ws,hs,8,wcolor);  // Panel background
   arcGauge(mx,my,ws,windex);  // Gauge
   display.loadFont(Roboto_Regular_24);
@@ -618,8 +629,8 @@ void screenMain() {
   // y0 and my don't change (all in the same horizontal row)
   x0 = me + ws + mm;
   mx = x0 + (ws/2);
-  wcolor = getWarningColor(PM_DATA,totalPM25.getCurrent());
-  windex = pm25Range(totalPM25.getCurrent());
+  wcolor = getWarningColor(PM_DATA,screenData.pm25.getCurrent());
+  windex = pm25Range(screenData.pm25.getCurrent());
   display.fillRoundRect(x0,y0,ws,hs,8,wcolor);  // Panel background
   arcGauge(mx,my,ws,windex);  // Gauge
   display.loadFont(Roboto_Regular_24);
@@ -634,8 +645,8 @@ void screenMain() {
 
   // Now the wide CO2 panel on the right side of the top row
 
-  wcolor = getWarningColor(CO2_DATA,totalCO2.getCurrent());
-  windex = co2Range(totalCO2.getCurrent());
+  wcolor = getWarningColor(CO2_DATA,screenData.co2.getCurrent());
+  windex = co2Range(screenData.co2.getCurrent());
 
   // First draw the CO2 subpanel's quality scale. The dimensions of each element
   // are hand-calculated based on the width of the subpanel, which for this layout
@@ -675,7 +686,7 @@ void screenMain() {
   else {
     display.setTextColor(TFT_WHITE,wcolor,true);
   }
-  display.drawString(String((uint16_t)(totalCO2.getCurrent()+0.5)),mx+23,y0+8);
+  display.drawString(String((uint16_t)(screenData.co2.getCurrent()+0.5)),mx+23,y0+8);
 
   // And the panel's label with quality string
   x0 = me + ws + mm + 44;
@@ -795,8 +806,8 @@ void screenForecast() {
 
   debugMessage("screenForecast() start",1);
 
-  // Retrieve forecast data from OpenWeatherMap
-  if(!OWMForecastRead()) {
+  // Forecast data from OpenWeatherMap, fetched by the worker
+  if(!screenData.owmForecastValid) {
     // Unable to fetch forecast from OWM. 
     debugMessage("OWM Forecast - fetch failed!",1); 
     //TODO: What else to do here??
@@ -808,13 +819,13 @@ void screenForecast() {
   display.setTextColor(TFT_WHITE, TFT_BLACK);  // Adding a background colour erases previous text automatically
 
   // Draw status bar at the top of the screen
-  screenHelperHeaderBar(TFT_WHITE,TFT_DARKGREY,owmSiteForecast.cityName);
+  screenHelperHeaderBar(TFT_WHITE,TFT_DARKGREY,screenData.owmSiteForecast.cityName);
   /*
   display.fillRect(0,0,320,30,TFT_DARKGREY);
   display.loadFont(Roboto_Regular_18);
   display.setTextDatum(MC_DATUM);
   display.setTextColor(TFT_WHITE,TFT_DARKGREY,true);
-  display.drawString(owmSiteForecast.cityName,160,15);
+  display.drawString(screenData.owmSiteForecast.cityName,160,15);
   */
 
   x0 = 32;
@@ -828,12 +839,12 @@ void screenForecast() {
     }
     else {
       bgcolor = TFT_BLACK;
-      wxDay(wdayname[owmSiteForecast.forecastData[i].wday],x0,y0,bgcolor);
+      wxDay(wdayname[screenData.owmSiteForecast.forecastData[i].wday],x0,y0,bgcolor);
     }
 
     // Add weather condition icon
     y0 = 80;
-    switch(owmSiteForecast.forecastData[i].wxFcst) {
+    switch(screenData.owmSiteForecast.forecastData[i].wxFcst) {
       case FCST_NONE:
         // TODO: How to handle?  Ignore? Question mark??
         break;
@@ -856,12 +867,12 @@ void screenForecast() {
 
     // High and Low temperatures for the day
     y0 = 140;
-    wxTemperatures(owmSiteForecast.forecastData[i].maxTempF,
-      owmSiteForecast.forecastData[i].minTempF,x0,y0,bgcolor);
+    wxTemperatures(screenData.owmSiteForecast.forecastData[i].maxTempF,
+      screenData.owmSiteForecast.forecastData[i].minTempF,x0,y0,bgcolor);
 
     // Humidity for the day
     y0 = 200;
-    wxHumidity(owmSiteForecast.forecastData[i].humidity,x0,y0,bgcolor);
+    wxHumidity(screenData.owmSiteForecast.forecastData[i].humidity,x0,y0,bgcolor);
   }
   debugMessage("screenForecast() end",1);
 }
@@ -0,0 +1,126 @@
+/*
+  Project Name:   Powered Air Quality
+  Description:    per sensor health, with recovery in place instead of a reboot (see sensor_health.h)
+*/
+
+#include "Arduino.h"
+
+#include "config.h"               // failure limits and recovery backoff
+#include "sensor_health.h"
+
+extern void debugMessage(String messageText, uint8_t messageLevel);
+
+const char* const sensorName[kSensorCount] = {"scd4x", "sen5x"};
+const char* const sensorHealthStateName[kSensorHealthStateCount] = {"healthy", "degraded", "recovering", "failed"};
+
+namespace {
+  SensorHealth health[kSensorCount];
+
+  void stateSet(uint8_t sensor, uint8_t state)
+  {
+    if (health[sensor].state != state)
+      debugMessage(String(sensorName[sensor]) + " now " + sensorHealthStateName[state], 1);
+    health[sensor].state = state;
+  }
+
+  // the next attempt after a backoff that doubles with each failed one
+  void retrySchedule(uint8_t sensor)
+  {
+    SensorHealth& h = health[sensor];
+    uint32_t backoffMS = timeSensorRecoveryMS;
+    for (uint8_t attempt = 1; attempt < h.attempts && backoffMS < timeSensorRecoveryMaxMS; attempt++)
+      backoffMS *= 2;
+    if (backoffMS > timeSensorRecoveryMaxMS) backoffMS = timeSensorRecoveryMaxMS;
+    h.retryMS = millis() + backoffMS;
+    debugMessage(String(sensorName[sensor]) + " recovery in " + (backoffMS / 1000) + " seconds", 1);
+  }
+
+  // recovering, or failed once kSensorRecoveryAttempts attempts haven't brought back a good read
+  void recoveryWait(uint8_t sensor)
+  {
+    stateSet(sensor, (health[sensor].attempts >= kSensorRecoveryAttempts) ? healthFailed : healthRecovering);
+    retrySchedule(sensor);
+  }
+}
+
+void sensorHealthInit(uint8_t sensor, bool success)
+{
+  if (sensor >= kSensorCount) return;
+  if (success) {
+    health[sensor].failures = 0;
+    health[sensor].attempts = 0;
+    stateSet(sensor, healthHealthy);
+    return;
+  }
+  health[sensor].attempts = 1;
+  stateSet(sensor, healthRecovering);
+  retrySchedule(sensor);
+}
+
+void sensorHealthRead(uint8_t sensor, bool success)
+{
+  if (sensor >= kSensorCount || !sensorHealthReadable(sensor)) return;
+  SensorHealth& h = health[sensor];
+  if (success) {
+    // only a good read ends the recovery attempts, not a reinit that the sensor ACKs
+    h.failures = 0;
+    h.attempts = 0;
+    stateSet(sensor, healthHealthy);
+    return;
+  }
+  h.readFailures++;
+  if (++h.failures < kSensorDegradedLimit) {
+    stateSet(sensor, healthDegraded);
+    return;
+  }
+  if (!h.attempts) {
+    // recover at the next opportunity
+    h.retryMS = millis();
+    stateSet(sensor, healthRecovering);
+    return;
+  }
+  // reads failed again after a recovery: back off further
+  recoveryWait(sensor);
+}
+
+bool sensorHealthReadable(uint8_t sensor)
+{
+  return (sensor < kSensorCount) && (health[sensor].state <= healthDegraded);
+}
+
+bool sensorHealthRecoveryDue(uint8_t sensor)
+{
+  return !sensorHealthReadable(sensor) && (sensor < kSensorCount) && (int32_t)(millis() - health[sensor].retryMS) >= 0;
+}
+
+void sensorHealthRecovery(uint8_t sensor, bool success)
+{
+  if (sensor >= kSensorCount) return;
+  SensorHealth& h = health[sensor];
+  if (h.attempts < UINT8_MAX) h.attempts++;
+  h.recoveryAttempts++;
+  if (success) {
+    // readable again, attempts kept until a read succeeds
+    h.recoveries++;
+    h.failures = 0;
+    stateSet(sensor, healthHealthy);
+    return;
+  }
+  recoveryWait(sensor);
+}
+
+const SensorHealth& sensorHealth(uint8_t sensor)
+{
+  return health[sensor < kSensorCount ? sensor : 0];
+}
+
+String sensorHealthReport()
+{
+  String report = "sensor health:";
+  for (uint8_t sensor = 0; sensor < kSensorCount; sensor++) {
+    report += String(" ") + sensorName[sensor] + " " + sensorHealthStateName[health[sensor].state] + " ("
+      + health[sensor].readFailures + " read failures, " + health[sensor].recoveries + " of " + health[sensor].recoveryAttempts
+      + " recoveries)";
+  }
+  return report;
+}
@@ -0,0 +1,46 @@
+/*
+  Project:      Powered Air Quality
+  Description:  per sensor health, with recovery in place instead of a reboot
+*/
+
+#ifndef SENSOR_HEALTH_H
+  #define SENSOR_HEALTH_H
+
+  #include <Arduino.h>
+
+  enum sensorId : uint8_t { sensorSCD4x, sensorSEN5x, kSensorCount };
+  extern const char* const sensorName[kSensorCount];
+
+  enum sensorHealthState : uint8_t { healthHealthy, healthDegraded, healthRecovering, healthFailed,
+    kSensorHealthStateCount };
+  extern const char* const sensorHealthStateName[kSensorHealthStateCount];
+
+  struct SensorHealth {
+    uint8_t state;
+    uint8_t failures;        // read failures in a row
+    uint8_t attempts;        // recovery attempts since the sensor's last good read
+    uint32_t retryMS;        // millis() of the next recovery attempt, while recovering or failed
+    uint32_t recoveryAttempts; // since boot
+    uint32_t recoveries;     // successful recoveries since boot
+    uint32_t readFailures;   // since boot
+  };
+
+  // healthy, degraded after a failed read, recovering after kSensorDegradedLimit in a row
+  // (retried after a backoff doubling from timeSensorRecoveryMS), failed after
+  // kSensorRecoveryAttempts recoveries without a good read, even ones the sensor ACKed
+  // (retried every timeSensorRecoveryMaxMS)
+
+  // initialization result, e.g. in setup(): healthy, or recovering after the first backoff
+  void sensorHealthInit(uint8_t sensor, bool success);
+  // a read result, while healthy or degraded
+  void sensorHealthRead(uint8_t sensor, bool success);
+  // true while healthy or degraded
+  bool sensorHealthReadable(uint8_t sensor);
+  // true when a recovering or failed sensor's next recovery attempt is due
+  bool sensorHealthRecoveryDue(uint8_t sensor);
+  void sensorHealthRecovery(uint8_t sensor, bool success);
+
+  const SensorHealth& sensorHealth(uint8_t sensor);
+  String sensorHealthReport();
+
+#endif  // #ifdef SENSOR_HEALTH_H
@@ -0,0 +1,123 @@
+/*
+  Project Name:   Powered Air Quality
+  Description:    Record and replay raw sensor readings (see sensor_trace.h)
+*/
+
+#include "Arduino.h"
+#include <math.h>
+#include <vector>
+
+#include "config.h"               // hardware and internet configuration parameters
+#include "sensor_trace.h"
+
+namespace {
+  const char* kTracePrefix = "TRACE,";
+  const char* kSourceName[] = {"scd4x", "sen5x"};
+
+  std::vector<SensorTraceRecord> replayRecords;
+  size_t replayNext[2] = {0, 0};
+
+  String field(float value, unsigned int decimalPlaces)
+  {
+    return isnan(value) ? String("nan") : String(value, decimalPlaces);
+  }
+
+  // next comma separated field of line starting at position, empty fields parse as NAN
+  float fieldFloat(const char*& position)
+  {
+    char* end;
+    float value = strtof(position, &end);
+    if (end == position) value = NAN;
+    position = strchr(end, ',');
+    position = position ? position + 1 : end + strlen(end);
+    return value;
+  }
+}
+
+String sensorTraceFormat(const SensorTraceRecord& record)
+{
+  String line = String(kTracePrefix) + record.timeMS + "," + kSourceName[record.sensor] + "," + record.error + ",";
+  if (record.sensor == traceSCD4x)
+    line += String(record.co2) + "," + field(record.temperatureC, 2) + "," + field(record.humidity, 2) + ",,,,,,";
+  else
+    line += String(",") + field(record.temperatureC, 2) + "," + field(record.humidity, 2) + ","
+      + field(record.pm1, 1) + "," + field(record.pm25, 1) + "," + field(record.pm4, 1) + ","
+      + field(record.pm10, 1) + "," + field(record.vocIndex, 1) + "," + field(record.noxIndex, 1);
+  return line;
+}
+
+bool sensorTraceParse(const String& line, SensorTraceRecord& record)
+{
+  if (!line.startsWith(kTracePrefix)) return false;
+  const char* position = line.c_str() + strlen(kTracePrefix);
+
+  char* end;
+  record.timeMS = strtoul(position, &end, 10);
+  if (end == position || *end != ',') return false;
+  position = end + 1;
+
+  if (!strncmp(position, "scd4x,", 6)) record.sensor = traceSCD4x;
+  else if (!strncmp(position, "sen5x,", 6)) record.sensor = traceSEN5x;
+  else return false;
+  position += 6;
+
+  record.error = (uint16_t)strtoul(position, &end, 10);
+  if (end == position || *end != ',') return false;
+  position = end + 1;
+
+  const float co2 = fieldFloat(position);
+  record.co2 = isnan(co2) ? 0 : (uint16_t)co2;
+  record.temperatureC = fieldFloat(position);
+  record.humidity = fieldFloat(position);
+  record.pm1 = fieldFloat(position);
+  record.pm25 = fieldFloat(position);
+  record.pm4 = fieldFloat(position);
+  record.pm10 = fieldFloat(position);
+  record.vocIndex = fieldFloat(position);
+  record.noxIndex = fieldFloat(position);
+  return true;
+}
+
+void sensorTraceWrite([[maybe_unused]] const SensorTraceRecord& record)
+{
+  #ifdef SENSOR_TRACE
+    Serial.println(sensorTraceFormat(record));
+  #endif
+}
+
+void sensorTraceReplayAdd(const SensorTraceRecord& record)
+{
+  replayRecords.push_back(record);
+}
+
+bool sensorTraceReplayNext(uint8_t sensor, SensorTraceRecord& record)
+// the next not yet replayed record from sensor
+{
+  while (replayNext[sensor] < replayRecords.size()) {
+    const SensorTraceRecord& next = replayRecords[replayNext[sensor]++];
+    if (next.sensor == sensor) {
+      record = next;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool sensorTraceReplayNextBefore(uint8_t sensor, uint8_t before, SensorTraceRecord& record)
+{
+  size_t next = replayNext[sensor];
+  while (next < replayRecords.size() && replayRecords[next].sensor != sensor) next++;
+  for (size_t i = replayNext[before]; i < next; i++) {
+    if (replayRecords[i].sensor == before) return false;
+  }
+  return sensorTraceReplayNext(sensor, record);
+}
+
+uint32_t sensorTraceReplayRemaining(uint8_t sensor)
+{
+  uint32_t remaining = 0;
+  for (size_t i = replayNext[sensor]; i < replayRecords.size(); i++) {
+    if (replayRecords[i].sensor == sensor) remaining++;
+  }
+  return remaining;
+}
@@ -0,0 +1,42 @@
+/*
+  Project:      Powered Air Quality
+  Description:  raw sensor reading trace, recorded on Serial and replayed in place of the sensors
+*/
+
+#ifndef SENSOR_TRACE_H
+  #define SENSOR_TRACE_H
+
+  #include <Arduino.h>
+
+  enum sensorTraceSource : uint8_t { traceSCD4x, traceSEN5x };
+
+  struct SensorTraceRecord {
+    uint32_t timeMS;
+    uint8_t sensor;       // sensorTraceSource
+    uint16_t error;       // Sensirion driver error, 0 read ok, kSensorErrorNotReady
+    uint16_t co2;         // SCD4x, ppm
+    float temperatureC;
+    float humidity;       // RH%
+    float pm1, pm25, pm4, pm10; // SEN5x, ug/m3
+    float vocIndex;
+    float noxIndex;
+  };
+
+  // TRACE,<ms>,<scd4x|sen5x>,<error>,<co2>,<temperatureC>,<humidity>,<pm1>,<pm2.5>,<pm4>,<pm10>,<voc>,<nox>
+  // with the other sensor's fields empty
+  String sensorTraceFormat(const SensorTraceRecord& record);
+  // false for a line that isn't a trace record, so a captured serial log replays as is
+  bool sensorTraceParse(const String& line, SensorTraceRecord& record);
+  // prints the record on Serial with SENSOR_TRACE defined, otherwise does nothing
+  void sensorTraceWrite(const SensorTraceRecord& record);
+
+  // with SENSOR_TRACE_REPLAY defined the sensor reads take their readings from these, in order
+
+  void sensorTraceReplayAdd(const SensorTraceRecord& record);
+  bool sensorTraceReplayNext(uint8_t sensor, SensorTraceRecord& record);
+  // as sensorTraceReplayNext(), false once the next record from sensor was recorded after
+  // the next not yet replayed record from before
+  bool sensorTraceReplayNextBefore(uint8_t sensor, uint8_t before, SensorTraceRecord& record);
+  uint32_t sensorTraceReplayRemaining(uint8_t sensor);
+
+#endif  // #ifdef SENSOR_TRACE_H
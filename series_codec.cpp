@@ -0,0 +1,222 @@
+/*
+  Project Name:   Powered Air Quality
+  Description:    Gorilla style compression of the flash sample log's pages (see series_codec.h)
+*/
+
+#include "Arduino.h"
+
+#include "series_codec.h"
+
+namespace {
+  // deltas of deltas: a prefix, then the value offset into [0, 2^bits)
+  struct TimeBucket {
+    uint8_t prefix, prefixBits, bits;
+    int32_t low, high;
+  };
+  constexpr TimeBucket kTimeBuckets[] = {
+    {0b10, 2, 7, -63, 64},
+    {0b110, 3, 9, -255, 256},
+    {0b1110, 4, 12, -2047, 2048},
+  };
+
+  uint32_t floatBits(int16_t value)
+  {
+    const float asFloat = value;
+    uint32_t bits;
+    memcpy(&bits, &asFloat, sizeof(bits));
+    return bits;
+  }
+
+  int16_t floatValue(uint32_t bits)
+  {
+    float asFloat;
+    memcpy(&asFloat, &bits, sizeof(asFloat));
+    return (int16_t)asFloat;
+  }
+}
+
+void SeriesEncoder::begin(uint8_t *buffer, uint16_t bytes)
+{
+  _buffer = buffer;
+  _bitCapacity = (uint32_t)bytes * 8;
+  _bit = 0;
+  _state = SeriesState();
+}
+
+bool SeriesEncoder::write(uint32_t value, uint8_t bits)
+{
+  if (_bit + bits > _bitCapacity) return false;
+  // bit by bit, clearing as well as setting, over what a refused sample left behind
+  for (int8_t bit = bits - 1; bit >= 0; bit--, _bit++) {
+    const uint8_t mask = 0x80 >> (_bit & 7);
+    if ((value >> bit) & 1) _buffer[_bit >> 3] |= mask;
+    else _buffer[_bit >> 3] &= ~mask;
+  }
+  return true;
+}
+
+bool SeriesEncoder::valueWrite(uint8_t channel, int16_t value)
+{
+  const uint8_t mask = 1 << channel;
+  const bool wasMissing = _state.missing & mask;
+  if (value == kHistoryMissing) {
+    if (wasMissing) return write(0, 1);
+    _state.missing |= mask;
+    return write(0b11, 2) && write(kSeriesMissingCode, 10);
+  }
+  _state.missing &= ~mask;
+  const uint32_t bits = floatBits(value);
+  const uint32_t xored = bits ^ _state.bits[channel];
+  _state.bits[channel] = bits;
+  if (!xored && !wasMissing) return write(0, 1);
+
+  // back from missing unchanged, a window of one 0 bit
+  const uint8_t leading = xored ? __builtin_clz(xored) : 31, trailing = xored ? __builtin_ctz(xored) : 0;
+  const uint8_t windowLeading = _state.leading[channel], windowTrailing = _state.trailing[channel];
+  const uint8_t meaningful = 32 - leading - trailing;
+  // the previous window, unless it has grown wider than a new one and its counts
+  if (windowLeading != kSeriesNoWindow && leading >= windowLeading && trailing >= windowTrailing
+      && 32 - windowLeading - windowTrailing <= meaningful + 10)
+    return write(0b10, 2) && write(xored >> windowTrailing, 32 - windowLeading - windowTrailing);
+  _state.leading[channel] = leading;
+  _state.trailing[channel] = trailing;
+  return write(0b11, 2) && write(leading, 5) && write(meaningful - 1, 5) && write(xored >> trailing, meaningful);
+}
+
+bool SeriesEncoder::append(uint32_t timeS, const int16_t values[kHistoryChannelCount])
+{
+  const uint32_t startBit = _bit;
+  const SeriesState saved = _state;
+  bool fits = true;
+  if (!_state.count) {
+    fits = write(timeS, 32);
+    for (uint8_t channel = 0; channel < kHistoryChannelCount; channel++) {
+      _state.bits[channel] = floatBits(values[channel]);
+      _state.leading[channel] = kSeriesNoWindow;
+      if (values[channel] == kHistoryMissing) _state.missing |= 1 << channel;
+      fits = fits && write((uint16_t)values[channel], 16);
+    }
+  }
+  else {
+    const int32_t deltaS = timeS - _state.timeS;
+    const int32_t deltaOfDelta = deltaS - _state.deltaS;
+    _state.deltaS = deltaS;
+    if (!deltaOfDelta)
+      fits = write(0, 1);
+    else {
+      const TimeBucket *bucket = nullptr;
+      for (const TimeBucket& candidate : kTimeBuckets) {
+        if (deltaOfDelta >= candidate.low && deltaOfDelta <= candidate.high) {
+          bucket = &candidate;
+          break;
+        }
+      }
+      fits = bucket ? write(bucket->prefix, bucket->prefixBits) && write(deltaOfDelta - bucket->low, bucket->bits)
+        : write(0b1111, 4) && write((uint32_t)deltaOfDelta, 32);
+    }
+    for (uint8_t channel = 0; channel < kHistoryChannelCount && fits; channel++)
+      fits = valueWrite(channel, values[channel]);
+  }
+  if (!fits) {
+    _bit = startBit;
+    _state = saved;
+    return false;
+  }
+  _state.timeS = timeS;
+  _state.count++;
+  return true;
+}
+
+void SeriesDecoder::begin(const uint8_t *buffer, uint16_t bytes, uint16_t count)
+{
+  _buffer = buffer;
+  _bitCapacity = (uint32_t)bytes * 8;
+  _bit = 0;
+  _remaining = count;
+  _state = SeriesState();
+}
+
+bool SeriesDecoder::read(uint8_t bits, uint32_t& value)
+{
+  if (_bit + bits > _bitCapacity) return false;
+  value = 0;
+  for (uint8_t bit = 0; bit < bits; bit++, _bit++)
+    value = (value << 1) | ((_buffer[_bit >> 3] >> (7 - (_bit & 7))) & 1);
+  return true;
+}
+
+bool SeriesDecoder::valueRead(uint8_t channel, int16_t& value)
+{
+  const uint8_t mask = 1 << channel;
+  uint32_t changed, window, xored;
+  if (!read(1, changed)) return false;
+  if (changed) {
+    if (!read(1, window)) return false;
+    if (!window) {
+      // inside the previous window
+      if (_state.leading[channel] == kSeriesNoWindow
+          || !read(32 - _state.leading[channel] - _state.trailing[channel], xored))
+        return false;
+      xored <<= _state.trailing[channel];
+    }
+    else {
+      uint32_t code;
+      if (!read(10, code)) return false;
+      if (code == kSeriesMissingCode) {
+        _state.missing |= mask;
+        value = kHistoryMissing;
+        return true;
+      }
+      const uint8_t leading = code >> 5, meaningful = (code & 0x1F) + 1;
+      if (leading + meaningful > 32 || !read(meaningful, xored)) return false;
+      _state.leading[channel] = leading;
+      _state.trailing[channel] = 32 - leading - meaningful;
+      xored <<= _state.trailing[channel];
+    }
+    _state.bits[channel] ^= xored;
+    _state.missing &= ~mask;
+  }
+  value = (_state.missing & mask) ? kHistoryMissing : floatValue(_state.bits[channel]);
+  return true;
+}
+
+bool SeriesDecoder::next(uint32_t& timeS, int16_t values[kHistoryChannelCount])
+{
+  if (!_remaining) return false;
+  if (!_state.count) {
+    if (!read(32, _state.timeS)) return false;
+    for (uint8_t channel = 0; channel < kHistoryChannelCount; channel++) {
+      uint32_t first;
+      if (!read(16, first)) return false;
+      values[channel] = (int16_t)first;
+      _state.bits[channel] = floatBits(values[channel]);
+      _state.leading[channel] = kSeriesNoWindow;
+      if (values[channel] == kHistoryMissing) _state.missing |= 1 << channel;
+    }
+  }
+  else {
+    // the prefix's 1 bits pick the bucket
+    uint8_t ones = 0;
+    uint32_t bit = 1, offset;
+    while (ones < 4 && read(1, bit) && bit) ones++;
+    if (ones < 4 && bit) return false;
+    int32_t deltaOfDelta = 0;
+    if (ones == 4) {
+      if (!read(32, offset)) return false;
+      deltaOfDelta = (int32_t)offset;
+    }
+    else if (ones) {
+      const TimeBucket& bucket = kTimeBuckets[ones - 1];
+      if (!read(bucket.bits, offset)) return false;
+      deltaOfDelta = (int32_t)offset + bucket.low;
+    }
+    _state.deltaS += deltaOfDelta;
+    _state.timeS += _state.deltaS;
+    for (uint8_t channel = 0; channel < kHistoryChannelCount; channel++)
+      if (!valueRead(channel, values[channel])) return false;
+  }
+  timeS = _state.timeS;
+  _state.count++;
+  _remaining--;
+  return true;
+}
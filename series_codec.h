@@ -0,0 +1,70 @@
+/*
+  Project:      Powered Air Quality
+  Description:  Gorilla style compression of the flash sample log's pages (see sample_log.h)
+*/
+
+#ifndef SERIES_CODEC_H
+  #define SERIES_CODEC_H
+
+  #include <Arduino.h>
+
+  #include "sample_history.h"   // kHistoryChannelCount, fixed point values
+
+  constexpr uint8_t kSeriesNoWindow = 0xFF;
+  // a missing value is coded as a new window with counts that can't be one, 31 leading zeros
+  // and 32 meaningful bits; the value after it is XORed against the last one present
+  constexpr uint16_t kSeriesMissingCode = 0x3FF;
+
+  // the coding state after a sample, the same on both sides
+  struct SeriesState {
+    uint32_t timeS;
+    int32_t deltaS;
+    uint32_t bits[kHistoryChannelCount];      // float bits of the previous values
+    uint8_t leading[kHistoryChannelCount];    // the previous XOR window, kSeriesNoWindow before one
+    uint8_t trailing[kHistoryChannelCount];
+    uint8_t missing;                          // channels whose previous value was missing, by bit
+    uint16_t count;                           // samples in the block
+  };
+
+  // Gorilla style: times as deltas of deltas, values as the XOR of their float bits with
+  // the previous value's. Only the flash log is coded; the graphs' history in DRAM stays
+  // sample_history.h's int16 ring, which they and the window extrema read in place
+  class SeriesEncoder {
+    public:
+      // starts an empty block in bytes of buffer
+      void begin(uint8_t *buffer, uint16_t bytes);
+      // false, leaving the block as it was, if the sample doesn't fit
+      bool append(uint32_t timeS, const int16_t values[kHistoryChannelCount]);
+      uint16_t count() const { return _state.count; }
+      uint16_t bytesUsed() const { return (_bit + 7) / 8; }
+
+    private:
+      bool write(uint32_t value, uint8_t bits);
+      bool valueWrite(uint8_t channel, int16_t value);
+
+      uint8_t *_buffer = nullptr;
+      uint32_t _bitCapacity = 0;
+      uint32_t _bit = 0;
+      SeriesState _state = {};
+  };
+
+  // blocks only decode from their start
+  class SeriesDecoder {
+    public:
+      // a block of count samples in bytes of buffer
+      void begin(const uint8_t *buffer, uint16_t bytes, uint16_t count);
+      // the next sample; false at the end of the block, or if it is cut short
+      bool next(uint32_t& timeS, int16_t values[kHistoryChannelCount]);
+
+    private:
+      bool read(uint8_t bits, uint32_t& value);
+      bool valueRead(uint8_t channel, int16_t& value);
+
+      const uint8_t *_buffer = nullptr;
+      uint32_t _bitCapacity = 0;
+      uint32_t _bit = 0;
+      uint16_t _remaining = 0;
+      SeriesState _state = {};
+  };
+
+#endif  // #ifdef SERIES_CODEC_H
@@ -0,0 +1,80 @@
+/*
+  Project:      Powered Air Quality
+  Description:  minimum and maximum over a sliding window of samples, in constant time
+*/
+
+#ifndef SLIDING_EXTREMA_H
+  #define SLIDING_EXTREMA_H
+
+  #include <Arduino.h>
+
+  // The smallest and largest of the last kWindow samples of a series, from two monotonic
+  // deques of the samples that could still become either: include() is constant time
+  // amortized, extrema() constant time. The values stay in the caller's ring of kRing
+  // slots, sample % kRing; the deques hold only slots, 4 bytes per sample of the window.
+  // Not thread safe: the ring's writer includes and asks, and hands the answer on
+  template <uint16_t kWindow, uint16_t kRing>
+  class SlidingExtrema {
+    static_assert(kWindow > 0 && kWindow < kRing, "the ring holds the whole window and the newest");
+
+    public:
+      // sample is the newest, its value already at ring[sample % kRing]; present false
+      // leaves it out but still moves the window. Samples come one at a time in order, a
+      // gap in the numbering starts the window over
+      void include(uint32_t sample, const int16_t ring[kRing], bool present = true)
+      {
+        if (_started && sample != _newest + 1) clear();
+        _started = true;
+        _newest = sample;
+        const uint16_t slot = sample % kRing;
+        // the oldest leave first, then anything the new value beats
+        _lowest.expire(slot);
+        _highest.expire(slot);
+        if (!present) return;
+        const int16_t value = ring[slot];
+        while (_lowest.size && ring[_lowest.back()] >= value) _lowest.size--;
+        while (_highest.size && ring[_highest.back()] <= value) _highest.size--;
+        _lowest.push(slot);
+        _highest.push(slot);
+      }
+
+      // of the last kWindow samples up to the newest included; false if all are missing
+      bool extrema(const int16_t ring[kRing], int16_t& low, int16_t& high) const
+      {
+        if (!_lowest.size) return false;
+        low = ring[_lowest.front()];
+        high = ring[_highest.front()];
+        return true;
+      }
+
+      void clear()
+      {
+        _lowest.size = _highest.size = 0;
+        _started = false;
+      }
+
+    private:
+      // a ring of slots, oldest at head
+      struct Deque {
+        uint16_t slots[kWindow];
+        uint16_t head = 0, size = 0;
+
+        uint16_t front() const { return slots[head]; }
+        uint16_t back() const { return slots[(head + size - 1) % kWindow]; }
+        void push(uint16_t slot) { slots[(head + size++) % kWindow] = slot; }
+        // drops the slots kWindow or more samples older than the newest, at newest
+        void expire(uint16_t newest)
+        {
+          while (size && (uint16_t)((newest + kRing - front()) % kRing) >= kWindow) {
+            head = (head + 1) % kWindow;
+            size--;
+          }
+        }
+      };
+
+      Deque _lowest, _highest;
+      uint32_t _newest = 0;
+      bool _started = false;
+  };
+
+#endif  // #ifdef SLIDING_EXTREMA_H
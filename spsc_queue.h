@@ -0,0 +1,57 @@
+/*
+  Project:      Powered Air Quality
+  Description:  lock-free single producer, single consumer queue
+*/
+
+#ifndef SPSC_QUEUE_H
+  #define SPSC_QUEUE_H
+
+  #include <Arduino.h>
+  #include <atomic>
+
+  // one task may push() and one other task pop(), neither blocks; T is copied in and out
+  template <typename T, uint8_t kDepth>
+  class SPSCQueue {
+    public:
+      // producer only; false if the queue was full and the item was dropped
+      bool push(const T& item)
+      {
+        const uint8_t tail = _tail.load(std::memory_order_relaxed);
+        const uint8_t next = advance(tail);
+        if (next == _head.load(std::memory_order_acquire)) {
+          _dropped.fetch_add(1, std::memory_order_relaxed);
+          return false;
+        }
+        _slots[tail] = item;
+        _tail.store(next, std::memory_order_release);
+        return true;
+      }
+
+      // consumer only; false if the queue was empty
+      bool pop(T& item)
+      {
+        const uint8_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire)) return false;
+        item = _slots[head];
+        _head.store(advance(head), std::memory_order_release);
+        return true;
+      }
+
+      // either side; the other side may change it at any moment
+      bool empty() const
+      {
+        return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+      }
+      uint32_t dropped() const { return _dropped.load(std::memory_order_relaxed); }
+
+    private:
+      // one slot stays free, so head == tail only when empty
+      static uint8_t advance(uint8_t index) { return (index == kDepth) ? 0 : index + 1; }
+
+      T _slots[kDepth + 1];
+      std::atomic<uint8_t> _head{0};
+      std::atomic<uint8_t> _tail{0};
+      std::atomic<uint32_t> _dropped{0};
+  };
+
+#endif  // #ifdef SPSC_QUEUE_H